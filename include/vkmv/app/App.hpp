@@ -6,17 +6,39 @@
 #ifndef VKMV_APP_HPP
 #define VKMV_APP_HPP
 
+#include <functional>
+#include <string>
+
 #include "vkmv/app/Window.hpp"
 #include "vkmv/engine/Engine.hpp"
 #include "vkmv/renderer/Renderer.hpp"
+#include "vkmv/utils/JobSystem.hpp"
 
 namespace vkmv {
 
+/**
+ * @brief Runs before every frame and returns false to stop. May call stepFrame to produce frames while it runs.
+ */
+using FrameBeginFunc = std::function<bool(const std::function<bool()>& stepFrame)>;
+
 /**
  * @class App
  * @brief This class is the top level application for vkmv.
  * 
  * To run an instance of the model viewer, initialize 'App app', then call 'app.run()'.
+ * 
+ * Supported command line arguments:
+ * - <model>             Path to a glTF 2.0 file (.gltf or .glb) to load on startup
+ * - --headless          Render offscreen without a window, surface or swapchain
+ * - --width <pixels>    Headless render width (default 1280)
+ * - --height <pixels>   Headless render height (default 720)
+ * - --frames <count>    Number of headless frames to render before exiting (default 1)
+ * - --frames-in-flight <count>
+ *                       Frames recorded ahead of the GPU, from 1 to MAX_FRAMES_IN_FLIGHT (default 2)
+ * - --serial            Update and draw each frame one after the other on one thread, instead of recording
+ *                       frames on a render thread while the engine builds the next one
+ * - --trace <path>      Write a Chrome trace (chrome://tracing, Perfetto) of CPU scopes on every thread and the
+ *                       GPU scopes of recent frames to path
  */
 class App {
 public:
@@ -29,6 +51,21 @@ public:
     void run();
 
 private:
+    JobSystem jobSystem;
+
+    std::string modelPath;
+    bool headless = false;
+    unsigned int headlessWidth = 1280;
+    unsigned int headlessHeight = 720;
+    unsigned int headlessFrameCount = 1;
+    unsigned int framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+    bool pipelined = true;
+    std::string tracePath;
+
+    void runWindowed();
+    void runHeadless();
+    void runFrames(Engine& engine, Renderer& renderer, const FrameBeginFunc& beginFrame);
+    void stopTrace(const Renderer& renderer);
 
 };
 
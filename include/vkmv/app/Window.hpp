@@ -6,6 +6,8 @@
 #ifndef VKMV_WINDOW_HPP
 #define VKMV_WINDOW_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <stdexcept>
 
 #include <SDL3/SDL.h>
@@ -18,6 +20,9 @@ namespace vkmv {
 /**
  * @class Window
  * @brief Creates a window across a variety of platforms via SDL3.
+ * 
+ * Events are handled on the main thread, but the size in pixels is kept in an atomic so the thread recording
+ * frames can follow resizes without calling into SDL.
  */
 class Window {
 public:
@@ -30,10 +35,19 @@ public:
 
     SDL_Window* getWindow() const { return window; }
 
+    /**
+     * @brief Returns the drawable size in pixels as of the last handled resize. Zero while minimized.
+     */
+    VkExtent2D getPixelExtent() const;
+
 private:
     SDL_Window* window;
     bool quit = false;
 
+    std::atomic<uint64_t> pixelExtent{0};   // width in the high half, height in the low half
+
+    void refreshPixelExtent(bool minimized);
+
     void initWindow();
 };
 
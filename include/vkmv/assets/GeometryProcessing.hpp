@@ -0,0 +1,129 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_GEOMETRYPROCESSING_HPP
+#define VKMV_GEOMETRYPROCESSING_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace vkmv {
+
+/**
+ * CPU geometry algorithms used by the import pipeline. All functions operate on tightly packed float
+ * arrays and a triangle list; pass indices = nullptr for non-indexed geometry (indexCount is then the
+ * number of vertices consumed in order). None of them touch the GPU.
+ */
+
+/**
+ * @brief Computes area weighted smooth vertex normals (xyz) for a triangle list.
+ */
+void generateNormals(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, float* normals);
+
+/**
+ * @brief Computes per vertex tangents (xyz + handedness in w) from positions, normals and UVs.
+ * 
+ * Tangents are accumulated per triangle from UV gradients, then Gram-Schmidt orthogonalized against the normal.
+ * Vertices with degenerate UVs receive an arbitrary tangent perpendicular to the normal.
+ */
+void generateTangents(const float* positions, const float* normals, const float* texcoords, uint32_t vertexCount,
+                      const uint32_t* indices, uint32_t indexCount, float* tangents);
+
+constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+/**
+ * @brief A cluster of at most MESHLET_MAX_VERTICES vertices and MESHLET_MAX_TRIANGLES triangles.
+ * 
+ * The layout matches GpuMeshlet in shaders/scene.glsl. Every triangle of the meshlet faces away from a viewer at p
+ * if dot(center - p, coneAxis) >= coneCutoff * length(center - p) + radius.
+ */
+struct Meshlet {
+    uint32_t vertexOffset;      // first entry in the meshlet vertex array
+    uint32_t triangleOffset;    // first entry in the meshlet triangle array
+    uint32_t vertexCount;
+    uint32_t triangleCount;
+    float center[3];
+    float radius;
+    float coneAxis[3];
+    float coneCutoff;           // 1 when the triangles face too many directions to ever be culled
+};
+
+/**
+ * @brief Splits a triangle list into meshlets with bounding spheres and normal cones.
+ * 
+ * meshletVertices receives the source vertex indices each meshlet references. meshletTriangles receives one
+ * uint32 per triangle packing three 8 bit indices into the meshlet's vertices. Triangles are grown from the
+ * neighbours of the previous triangle so meshlets stay compact, which keeps spheres small and cones narrow.
+ * Degenerate triangles and triangles with out of range indices are dropped.
+ */
+void buildMeshlets(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                   std::vector<Meshlet>& meshlets, std::vector<uint32_t>& meshletVertices, std::vector<uint32_t>& meshletTriangles);
+
+/**
+ * @brief Simplifies a triangle list with quadric error metrics until at most targetIndexCount indices remain.
+ * 
+ * Edges are collapsed onto one of their endpoints, cheapest first, so the result indexes the input vertices and
+ * shares their vertex data. Vertices on attribute seams (several vertices at one position) or non-manifold edges
+ * never move and open borders only collapse along themselves, so the result can stay above the target.
+ * destination must hold indexCount indices. Returns the number of indices written; resultError receives the
+ * largest distance a collapsed vertex moved from its original surface, in position units.
+ */
+uint32_t simplifyMesh(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                      uint32_t targetIndexCount, uint32_t* destination, float* resultError);
+
+// FIFO post-transform cache size assumed by the reordering functions and the statistics
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+/**
+ * @brief Post-transform vertex cache behaviour of a triangle list under a simulated FIFO cache.
+ */
+struct VertexCacheStatistics {
+    uint64_t triangleCount = 0;
+    uint64_t vertexCount = 0;           // distinct vertices referenced
+    uint64_t transformedCount = 0;      // cache misses, each one vertex shader invocation
+
+    // Average cache miss ratio: transformed vertices per triangle, 0.5 at best for large regular meshes and 3 at worst
+    float acmr() const { return triangleCount > 0 ? static_cast<float>(transformedCount) / triangleCount : 0.0f; }
+
+    // Average transformed vertex ratio: transformed vertices per referenced vertex, 1 at best
+    float atvr() const { return vertexCount > 0 ? static_cast<float>(transformedCount) / vertexCount : 0.0f; }
+};
+
+/**
+ * @brief Simulates a FIFO cache of cacheSize entries over an indexed triangle list.
+ */
+VertexCacheStatistics analyzeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+/**
+ * @brief Reorders triangles for post-transform cache locality (Tipsify, Sander et al. 2007).
+ * 
+ * Triangles are emitted in fans around one vertex at a time, then the next fan vertex is picked among the ones
+ * just used that are still in the cache. Runs in linear time. destination must not alias indices.
+ */
+void optimizeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t* destination);
+
+/**
+ * @brief Reorders clusters of cache optimized triangles so outward facing ones are drawn first, reducing overdraw.
+ * 
+ * The triangle list is split where the cache restarts anyway, and further wherever starting over costs less than
+ * threshold times the cluster's ACMR (1.05 keeps ACMR within 5%). Clusters are then sorted by how far they face
+ * away from the mesh center. Operates in place; pass the output of optimizeVertexCache.
+ */
+void optimizeOverdraw(uint32_t* indices, uint32_t indexCount, const float* positions, uint32_t vertexCount, float threshold);
+
+constexpr uint32_t UNREFERENCED_VERTEX = ~0u;
+
+/**
+ * @brief Numbers vertices in order of first use so vertex fetches walk memory sequentially.
+ * 
+ * remap (vertexCount entries) receives each vertex's new index, or UNREFERENCED_VERTEX for vertices no triangle
+ * uses. Returns the number of referenced vertices. The caller applies remap to the indices and vertex data.
+ */
+uint32_t optimizeVertexFetchRemap(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t* remap);
+
+} // namespace vkmv
+
+#endif // VKMV_GEOMETRYPROCESSING_HPP
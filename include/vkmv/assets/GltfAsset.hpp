@@ -0,0 +1,190 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_GLTFASSET_HPP
+#define VKMV_GLTFASSET_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "vkmv/assets/Json.hpp"
+#include "vkmv/utils/MappedFile.hpp"
+
+namespace vkmv {
+
+constexpr uint32_t GLTF_INVALID_INDEX = UINT32_MAX;
+
+enum GltfComponentType : uint32_t {
+    GLTF_BYTE = 5120,
+    GLTF_UNSIGNED_BYTE = 5121,
+    GLTF_SHORT = 5122,
+    GLTF_UNSIGNED_SHORT = 5123,
+    GLTF_UNSIGNED_INT = 5125,
+    GLTF_FLOAT = 5126
+};
+
+enum GltfPrimitiveMode : uint32_t {
+    GLTF_MODE_POINTS = 0,
+    GLTF_MODE_LINES = 1,
+    GLTF_MODE_TRIANGLES = 4
+};
+
+struct GltfBuffer {
+    const uint8_t* data;
+    size_t size;
+    uint32_t file;          // index of the mapped file backing this buffer
+};
+
+struct GltfBufferView {
+    uint32_t buffer;
+    size_t byteOffset;
+    size_t byteLength;
+    uint32_t byteStride;    // 0 means tightly packed
+};
+
+struct GltfAccessor {
+    uint32_t bufferView;    // GLTF_INVALID_INDEX for accessors without data (all zeros)
+    size_t byteOffset;      // relative to the buffer view
+    uint32_t count;
+    uint32_t componentType;
+    uint32_t componentCount;
+    bool normalized;
+    bool sparse;
+    bool hasBounds;
+    float min[3];
+    float max[3];
+};
+
+struct GltfPrimitive {
+    uint32_t position = GLTF_INVALID_INDEX;
+    uint32_t normal = GLTF_INVALID_INDEX;
+    uint32_t tangent = GLTF_INVALID_INDEX;
+    uint32_t texcoord0 = GLTF_INVALID_INDEX;
+    uint32_t indices = GLTF_INVALID_INDEX;
+    uint32_t material = GLTF_INVALID_INDEX;
+    uint32_t mode = GLTF_MODE_TRIANGLES;
+};
+
+struct GltfMesh {
+    uint32_t firstPrimitive;
+    uint32_t primitiveCount;
+};
+
+struct GltfNode {
+    uint32_t mesh;
+    uint32_t firstChild;        // into GltfAsset::nodeChildren()
+    uint32_t childCount;
+    float localTransform[16];   // column major
+};
+
+struct GltfScene {
+    uint32_t firstRoot;         // into GltfAsset::sceneRoots()
+    uint32_t rootCount;
+};
+
+/**
+ * @brief Returns the size in bytes of a single component of the given GltfComponentType.
+ */
+uint32_t gltfComponentSize(uint32_t componentType);
+
+/**
+ * @class GltfAsset
+ * @brief A parsed glTF 2.0 (.gltf or .glb) file.
+ * 
+ * The file and any external buffers are memory mapped. The JSON is parsed into compact index tables,
+ * while binary data is never copied: accessorData() points directly into the mapped pages so that
+ * consumers can upload straight from them. The asset must outlive any pointer obtained from it.
+ * 
+ * Only the subset needed for geometry is read (buffers, views, accessors, meshes, nodes, scenes).
+ * Embedded data URIs are not supported.
+ */
+class GltfAsset {
+public:
+    /**
+     * @brief Maps and parses the file at path. Throws a runtime error if the file is malformed.
+     */
+    explicit GltfAsset(const std::string& path);
+
+    GltfAsset(const GltfAsset&) = delete;
+    GltfAsset& operator=(const GltfAsset&) = delete;
+
+    const std::vector<GltfBuffer>& buffers() const { return m_buffers; }
+    const std::vector<GltfBufferView>& bufferViews() const { return m_bufferViews; }
+    const std::vector<GltfAccessor>& accessors() const { return m_accessors; }
+    const std::vector<GltfPrimitive>& primitives() const { return m_primitives; }
+    const std::vector<GltfMesh>& meshes() const { return m_meshes; }
+    const std::vector<GltfNode>& nodes() const { return m_nodes; }
+    const std::vector<uint32_t>& nodeChildren() const { return m_nodeChildren; }
+    const std::vector<GltfScene>& scenes() const { return m_scenes; }
+    const std::vector<uint32_t>& sceneRoots() const { return m_sceneRoots; }
+
+    /**
+     * @brief Returns the scene to display, or GLTF_INVALID_INDEX if the file has no scenes.
+     */
+    uint32_t defaultScene() const { return m_defaultScene; }
+
+    /**
+     * @brief Returns a pointer into mapped memory to the first element of an accessor, or nullptr if it has no buffer view.
+     */
+    const uint8_t* accessorData(uint32_t accessor) const;
+
+    /**
+     * @brief Returns the distance in bytes between consecutive elements of an accessor.
+     */
+    uint32_t accessorStride(uint32_t accessor) const;
+
+    /**
+     * @brief Decodes up to 4 components of one accessor element to floats, applying normalization.
+     */
+    void readFloats(uint32_t accessor, uint32_t element, float* out) const;
+
+    /**
+     * @brief Decodes one element of a scalar integer accessor (e.g. indices).
+     */
+    uint32_t readUint(uint32_t accessor, uint32_t element) const;
+
+    /**
+     * @brief Returns a pointer into mapped memory to the start of a buffer view.
+     */
+    const uint8_t* bufferViewData(uint32_t bufferView) const;
+
+    /**
+     * @brief Hints that a buffer view is about to be read.
+     */
+    void prefetchBufferView(uint32_t bufferView) const;
+
+    /**
+     * @brief Drops the pages of a buffer view from resident memory once it has been consumed.
+     */
+    void releaseBufferView(uint32_t bufferView) const;
+
+private:
+    std::string m_directory;
+    std::vector<MappedFile> m_files;
+
+    std::vector<GltfBuffer> m_buffers;
+    std::vector<GltfBufferView> m_bufferViews;
+    std::vector<GltfAccessor> m_accessors;
+    std::vector<GltfPrimitive> m_primitives;
+    std::vector<GltfMesh> m_meshes;
+    std::vector<GltfNode> m_nodes;
+    std::vector<uint32_t> m_nodeChildren;
+    std::vector<GltfScene> m_scenes;
+    std::vector<uint32_t> m_sceneRoots;
+    uint32_t m_defaultScene = GLTF_INVALID_INDEX;
+
+    void parseJson(std::string_view json, const uint8_t* binChunk, size_t binChunkSize);
+    void parseBuffers(const JsonDocument& doc, const uint8_t* binChunk, size_t binChunkSize);
+    void parseBufferViews(const JsonDocument& doc);
+    void parseAccessors(const JsonDocument& doc);
+    void parseMeshes(const JsonDocument& doc);
+    void parseNodes(const JsonDocument& doc);
+    void parseScenes(const JsonDocument& doc);
+};
+
+} // namespace vkmv
+
+#endif // VKMV_GLTFASSET_HPP
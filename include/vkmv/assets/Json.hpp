@@ -0,0 +1,109 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_JSON_HPP
+#define VKMV_JSON_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vkmv {
+
+enum class JsonType : uint8_t {
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object
+};
+
+/**
+ * @brief A single value in a parsed JSON document.
+ * 
+ * Tokens are stored in document order. An object's children alternate key, value, key, value...
+ * 'next' is the index of the next sibling (skipping this token's entire subtree), so siblings are visited
+ * without recursion. The last child of a container has next == JsonDocument::INVALID, and a key's
+ * next is always its value.
+ */
+struct JsonToken {
+    JsonType type;
+    uint32_t start;     // byte offset of the value in the source (strings exclude their quotes)
+    uint32_t length;    // byte length of the value in the source
+    uint32_t size;      // number of elements for arrays, number of key/value pairs for objects, escapes for strings
+    uint32_t next;
+};
+
+/**
+ * @class JsonDocument
+ * @brief Minimal non-allocating-per-value JSON parser.
+ * 
+ * Parses a JSON text into a flat token table. The text is not copied, so the source must outlive
+ * the document. String escapes are validated while parsing and decoded on access, so only strings that
+ * contain escapes allocate. Keys are matched by their decoded text.
+ */
+class JsonDocument {
+public:
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    /**
+     * @brief Parses text, replacing any previous contents. Throws a runtime error on malformed input.
+     */
+    void parse(std::string_view text);
+
+    uint32_t root() const { return 0; }
+
+    const JsonToken& operator[](uint32_t token) const { return m_tokens[token]; }
+
+    /**
+     * @brief Returns the value for key in an object, or INVALID if absent (or token is not an object).
+     */
+    uint32_t find(uint32_t object, std::string_view key) const;
+
+    /**
+     * @brief Returns the first child of an array or the first key of an object, or INVALID if empty.
+     */
+    uint32_t firstChild(uint32_t token) const;
+
+    /**
+     * @brief Returns the next sibling of token within its parent, or INVALID after the last child.
+     */
+    uint32_t nextSibling(uint32_t token) const { return m_tokens[token].next; }
+
+    /**
+     * @brief Returns a string's source text, with any escapes as written. Use decodeString() for its value.
+     */
+    std::string_view string(uint32_t token) const;
+
+    /**
+     * @brief Returns a string's value with escapes decoded, code point escapes to UTF-8. Empty if token is not a string.
+     */
+    std::string decodeString(uint32_t token) const;
+
+    double number(uint32_t token, double fallback = 0.0) const;
+    bool boolean(uint32_t token, bool fallback = false) const;
+
+    /**
+     * @brief Convenience lookups that return fallback when the key is absent.
+     */
+    uint32_t findUint(uint32_t object, std::string_view key, uint32_t fallback) const;
+    double findNumber(uint32_t object, std::string_view key, double fallback) const;
+    std::string findString(uint32_t object, std::string_view key) const;
+
+private:
+    std::string_view m_text;
+    std::vector<JsonToken> m_tokens;
+
+    size_t parseValue(size_t pos, uint32_t depth);
+    size_t parseString(size_t pos);
+    size_t skipWhitespace(size_t pos) const;
+    [[noreturn]] void fail(const char* message, size_t pos) const;
+};
+
+} // namespace vkmv
+
+#endif // VKMV_JSON_HPP
@@ -19,18 +19,20 @@ namespace vkmv {
  * @brief Parameters required to select a physical device and create a logical device.
  */
 struct DeviceParams {
-    VkSurfaceKHR presentableSurface = VK_NULL_HANDLE;
+    VkSurfaceKHR presentableSurface = VK_NULL_HANDLE; // VK_NULL_HANDLE selects a headless device with no present queue
 };
 
 /**
  * @class Device
  * @brief Encapusulates a VkPhysicalDevice and VkDevice.
  * 
- * On initialization, selects the best physical device for vkmv and creates a logical device.
+ * On initialization, selects the best physical device for vkmv and creates a logical device. When the GPU
+ * exposes a transfer-only queue family, a queue from it is created for uploads; otherwise the transfer
+ * queue aliases the graphics queue.
  */
 class Device {
 public:
-    static void create(Instance* pInstance, DeviceParams params, Device* pDevice);
+    static void create(Instance* pInstance, DeviceParams* params, Device* pDevice);
 
     static void destroy(Device* pDevice);
 
@@ -46,22 +48,46 @@ public:
 
     VkQueue getPresentQueue() const { return m_presentQueue; }
 
+    uint32_t getTransferFamilyIndex() const { return m_transferFamilyIndex; }
+
+    VkQueue getTransferQueue() const { return m_transferQueue; }
+
+    /**
+     * @brief Returns true if uploads run on their own queue family, requiring queue family ownership transfers.
+     */
+    bool hasDedicatedTransferQueue() const { return m_transferFamilyIndex != m_graphicsFamilyIndex; }
+
     bool isExtensionEnabled(const char* extension) const;
 
+    /**
+     * @brief Returns true if this device was created without a presentable surface.
+     */
+    bool isHeadless() const { return m_headless; }
+
+    /**
+     * @brief Returns true if pipeline statistics queries are enabled, including across secondary command buffers.
+     */
+    bool hasPipelineStatistics() const { return m_pipelineStatistics; }
+
 private:
     VkPhysicalDevice m_vkPhysicalDevice = VK_NULL_HANDLE;
     VkDevice m_vkDevice = VK_NULL_HANDLE;
 
     uint32_t m_graphicsFamilyIndex = 0;
     uint32_t m_presentFamilyIndex = 0;
+    uint32_t m_transferFamilyIndex = 0;
 
     VkQueue m_graphicsQueue = VK_NULL_HANDLE;
     VkQueue m_presentQueue = VK_NULL_HANDLE;
+    VkQueue m_transferQueue = VK_NULL_HANDLE;
+
+    bool m_headless = false;
+    bool m_pipelineStatistics = false;
 
     std::vector<std::string> m_enabledDeviceExtensions;
 
-    static void pickPhysicalDevice(Instance* pInstance, DeviceParams params, Device* pDevice);
-    static void createDevice(Instance* pInstance, DeviceParams params, Device* pDevice);
+    static void pickPhysicalDevice(Instance* pInstance, DeviceParams* params, Device* pDevice);
+    static void createDevice(Instance* pInstance, DeviceParams* params, Device* pDevice);
 
 };
 
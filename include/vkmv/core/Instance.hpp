@@ -14,6 +14,13 @@
 
 namespace vkmv {
 
+/**
+ * @brief Parameters required to create an Instance.
+ */
+struct InstanceParams {
+    bool enableSurfaceExtensions = true; // set to false for headless rendering without a window
+};
+
 /**
  * @class Instance
  * @brief Encapsulates a Vulkan Instance.
@@ -31,7 +38,7 @@ public:
      * 
      * Not a library function. Setup is specific to vkmv.
      */
-    static void create(Instance* pInstance);
+    static void create(Instance* pInstance, InstanceParams* params);
 
     /**
      * @brief Destroys an Instance object. Do not use after destroying.
@@ -48,7 +55,7 @@ public:
     bool isExtensionEnabled(const char* extension) const;
 
 private:
-    static void createInstance(Instance* pInstance);
+    static void createInstance(Instance* pInstance, InstanceParams* params);
     static void createDebugMessenger(Instance* pInstance);
     static void destroyDebugMessenger(Instance* pInstance);
 
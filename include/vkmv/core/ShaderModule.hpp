@@ -6,6 +6,10 @@
 #ifndef VKMV_SHADERMODULE_HPP
 #define VKMV_SHADERMODULE_HPP
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include <vulkan/vulkan.h>
 
 #include "vkmv/core/Device.hpp"
@@ -16,11 +20,21 @@ namespace vkmv {
  * @class ShaderModule
  * @brief Encapsulates Vulkan ShaderModules with RAII principles.
  * 
- * 
+ * Modules are created from validated SPIR-V and remember the content hash of their bytecode, which the
+ * ShaderLibrary uses to share one VkShaderModule between identical files.
  */
 class ShaderModule {
 public:
-    static VkResult Create();
+    /**
+     * @brief Creates a shader module from SPIR-V words. Returns VK_ERROR_INITIALIZATION_FAILED if code is not SPIR-V,
+     * or is cut off inside an instruction.
+     */
+    static VkResult Create(Device* pDevice, const std::vector<uint32_t>& code, std::shared_ptr<ShaderModule>* pShaderModule);
+
+    /**
+     * @brief Returns the 64-bit FNV-1a hash of the given SPIR-V words.
+     */
+    static uint64_t hashCode(const std::vector<uint32_t>& code);
 
     ~ShaderModule();
 
@@ -29,12 +43,20 @@ public:
 
     VkShaderModule getShaderModule() const { return _shaderModule; }
 
+    uint64_t getHash() const { return hash; }
+
+    const std::vector<uint32_t>& getCode() const { return code; }
+
 private:
-    Device* device;
+    ShaderModule() = default;
+
+    Device* device = nullptr;
     VkShaderModule _shaderModule = VK_NULL_HANDLE;
+    uint64_t hash = 0;
+    std::vector<uint32_t> code;     // kept so modules with equal hashes can be told apart
 
 };
 
 } // namespace vkmv
 
-#endif // VKMV_SHADERMODULE_HPP
\ No newline at end of file
+#endif // VKMV_SHADERMODULE_HPP
@@ -6,18 +6,131 @@
 #ifndef VKMV_SWAPCHAIN_HPP
 #define VKMV_SWAPCHAIN_HPP
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vkmv/core/Device.hpp"
+
 namespace vkmv
 {
-    
+
+/**
+ * @brief Parameters required to create a swapchain.
+ */
+struct SwapchainParams {
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+    VkExtent2D extent{};    // used when the surface lets the swapchain pick its extent
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;     // falls back to FIFO when unsupported
+};
+
+/**
+ * @class Swapchain
+ * @brief Encapsulates a VkSwapchainKHR, its images and the semaphores their presents wait on.
+ * 
+ * The surface format is chosen once on creation. recreate() builds a new swapchain at another extent or with
+ * another present mode, with the current one as oldSwapchain, so presents already queued still complete, and hands the old
+ * swapchain back to be destroyed once the GPU is past the frames that used it. Nothing else is rebuilt, and no
+ * wait for the device to go idle is needed.
+ * 
+ * Acquires, presents and recreation may run on one thread while another waits for presents; a mutex provides the
+ * external synchronization the swapchain handles, current and retired, need between them.
+ */
 class Swapchain {
 public:
-    static void create();
-    static void destroy();
+    /**
+     * @brief The resources of a replaced swapchain, which frames in flight may still present from.
+     */
+    struct Retired {
+        VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+        std::vector<VkImageView> imageViews;
+        std::vector<VkSemaphore> renderSemaphores;
+    };
+
+    static void create(Device* pDevice, SwapchainParams* params, Swapchain* pSwapchain);
+
+    static void destroy(Swapchain* pSwapchain);
+
+    /**
+     * @brief Replaces the swapchain with one at extent, presenting with presentMode if supported and FIFO
+     * otherwise. The returned resources must be passed to destroyRetired() once every submission that acquired
+     * from or presented to them has finished.
+     */
+    Retired recreate(VkExtent2D extent, VkPresentModeKHR presentMode);
+
+    static void destroyRetired(VkDevice device, Retired& retired);
+
+    /**
+     * @brief Acquires the next image, signaling semaphore. Returns the result of vkAcquireNextImageKHR; on
+     * VK_ERROR_OUT_OF_DATE_KHR nothing was acquired and the swapchain must be recreated.
+     */
+    VkResult acquireNextImage(VkSemaphore semaphore, uint32_t* pImageIndex);
+
+    /**
+     * @brief Presents imageIndex on queue once its render semaphore is signaled. A nonzero presentId tags the
+     * present for vkWaitForPresentKHR and requires VK_KHR_present_id. Returns the result of vkQueuePresentKHR.
+     */
+    VkResult present(VkQueue queue, uint32_t imageIndex, uint64_t presentId = 0);
+
+    /**
+     * @brief Waits up to timeout nanoseconds for the present tagged presentId to swapchain, which is the current
+     * swapchain or one it replaced that hasn't been destroyed yet. Returns the result of vkWaitForPresentKHR.
+     * 
+     * The wait is split into short slices, and acquires and presents queued behind one go ahead before the next,
+     * so they are held back by at most one slice.
+     */
+    VkResult waitForPresent(PFN_vkWaitForPresentKHR waitForPresentKHR, VkSwapchainKHR swapchain, uint64_t presentId, uint64_t timeout);
+
+    VkSwapchainKHR getSwapchain() const { return m_swapchain; }
+
+    VkSurfaceFormatKHR getFormat() const { return m_format; }
+
+    VkExtent2D getExtent() const { return m_extent; }
+
+    VkPresentModeKHR getPresentMode() const { return m_presentMode; }
+
+    const std::vector<VkPresentModeKHR>& getSupportedPresentModes() const { return m_supportedPresentModes; }
+
+    uint32_t getImageCount() const { return static_cast<uint32_t>(m_images.size()); }
+
+    VkImage getImage(uint32_t imageIndex) const { return m_images[imageIndex]; }
+
+    VkImageView getImageView(uint32_t imageIndex) const { return m_imageViews[imageIndex]; }
+
+    /**
+     * @brief Returns the binary semaphore the submission rendering to imageIndex signals and its present waits on.
+     */
+    VkSemaphore getRenderSemaphore(uint32_t imageIndex) const { return m_renderSemaphores[imageIndex]; }
+
 private:
+    Device* m_device = nullptr;
+    VkSurfaceKHR m_surface = VK_NULL_HANDLE;
+
+    VkSwapchainKHR m_swapchain = VK_NULL_HANDLE;
+    VkSurfaceFormatKHR m_format{};
+    VkPresentModeKHR m_presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    std::vector<VkPresentModeKHR> m_supportedPresentModes;
+    VkExtent2D m_extent{};
+
+    std::mutex m_mutex;                         // held around every call that uses a swapchain handle
+    std::condition_variable m_callsDone;
+    std::atomic<uint32_t> m_queuedCalls{0};     // acquires and presents waiting for m_mutex
+
+    std::vector<VkImage> m_images;
+    std::vector<VkImageView> m_imageViews;
+    std::vector<VkSemaphore> m_renderSemaphores;
 
+    static void chooseFormat(Swapchain* pSwapchain);
+    static void choosePresentMode(Swapchain* pSwapchain, VkPresentModeKHR presentMode);
+    static void createSwapchain(Swapchain* pSwapchain, VkExtent2D extent, VkSwapchainKHR oldSwapchain);
+    static void createImageResources(Swapchain* pSwapchain);
 };
 
 } // namespace vkmv
 
 
-#endif // VKMV_SWAPCHAIN_HPP
\ No newline at end of file
+#endif // VKMV_SWAPCHAIN_HPP
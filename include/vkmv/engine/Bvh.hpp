@@ -0,0 +1,104 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_BVH_HPP
+#define VKMV_BVH_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "vkmv/engine/InstanceCulling.hpp"
+
+namespace vkmv {
+
+// Children per node; one SSE register holds the same bound of all of them
+constexpr uint32_t BVH_WIDTH = 4;
+
+/**
+ * @brief A node of the 4 wide tree, bounds stored per axis so one instruction tests all children.
+ * 
+ * Every child covers a contiguous range of Bvh items. Leaf children have child BVH_LEAF, inner ones the index of
+ * their node, which always comes after its parent. Unused slots have an empty item range and inverted bounds.
+ */
+struct BvhNode {
+    float minX[BVH_WIDTH], minY[BVH_WIDTH], minZ[BVH_WIDTH];
+    float maxX[BVH_WIDTH], maxY[BVH_WIDTH], maxZ[BVH_WIDTH];
+    uint32_t child[BVH_WIDTH];
+    uint32_t firstItem[BVH_WIDTH];
+    uint32_t itemCount[BVH_WIDTH];
+};
+
+constexpr uint32_t BVH_LEAF = UINT32_MAX;
+
+struct BvhHit {
+    uint32_t instance;
+    float distance;             // along the ray, in units of its direction's length
+};
+
+/**
+ * @class Bvh
+ * @brief Bounding volume hierarchy over instance bounding spheres, for queries that would otherwise scan every
+ * instance.
+ * 
+ * build() splits with the surface area heuristic over binned centroids, then collapses the binary tree into 4
+ * wide nodes. Moving instances only need refit(), which recomputes bounds bottom up in one pass over the nodes and
+ * must run between setSphere() and the next query; since the topology is kept, quality drops as instances travel,
+ * and getDegradation() tells when a rebuild pays off.
+ * 
+ * The tree keeps its own copy of the spheres in leaf order, so refits and queries read them sequentially.
+ */
+class Bvh {
+public:
+    /**
+     * @brief Rebuilds the tree over every sphere of the store.
+     */
+    void build(const InstanceStore& store);
+
+    /**
+     * @brief Moves an instance's sphere. Queries prune and accept whole subtrees by their node bounds, so they
+     * may miss the instance, or report it where it no longer is, until the next refit().
+     */
+    void setSphere(uint32_t instance, const float sphere[4]);
+
+    /**
+     * @brief Recomputes the node bounds from the current spheres.
+     */
+    void refit();
+
+    /**
+     * @brief Surface area heuristic cost of the tree now, relative to right after the last build.
+     */
+    float getDegradation() const { return m_builtCost > 0.0f ? m_cost / m_builtCost : 1.0f; }
+
+    uint32_t size() const { return static_cast<uint32_t>(m_instances.size()); }
+    uint32_t getNodeCount() const { return static_cast<uint32_t>(m_nodes.size()); }
+
+    /**
+     * @brief Same result as cullSpheres, but whole subtrees outside or inside the frustum are decided at once.
+     */
+    uint32_t cullFrustum(const float planes[6][4], std::vector<uint8_t>& visibility) const;
+
+    /**
+     * @brief Finds the closest sphere the ray enters within maxDistance. A ray starting inside a sphere hits it
+     * at distance 0. Returns false if nothing is hit.
+     */
+    bool raycast(const float origin[3], const float direction[3], float maxDistance, BvhHit& hit) const;
+
+private:
+    std::vector<BvhNode> m_nodes;
+
+    // Items are ordered so that every subtree is a contiguous range
+    std::vector<uint32_t> m_instances;      // instance of each item
+    std::vector<uint32_t> m_itemOfInstance;
+    std::vector<float> m_spheres;           // 4 per item
+    float m_cost = 0.0f;
+    float m_builtCost = 0.0f;
+
+    float computeCost() const;
+};
+
+} // namespace vkmv
+
+#endif // VKMV_BVH_HPP
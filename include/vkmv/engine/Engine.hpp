@@ -6,8 +6,13 @@
 #ifndef VKMV_ENGINE_HPP
 #define VKMV_ENGINE_HPP
 
+#include <string>
+
 #include <SDL3/SDL_events.h>
 
+#include "vkmv/engine/Bvh.hpp"
+#include "vkmv/engine/InstanceCulling.hpp"
+#include "vkmv/engine/SceneGraph.hpp"
 #include "vkmv/renderer/Renderer.hpp"
 
 namespace vkmv {
@@ -35,8 +40,71 @@ private:
     float collapsed_width = 30.0f;
     float anim_progress = 1.0f;
 
+    // Orbit camera around the center of the loaded scene
+    float cameraYaw = 0.0f;
+    float cameraPitch = 0.3f;
+    float cameraZoom = 1.0f;
+    bool cameraDragging = false;
+    float cameraDragDistance = 0.0f;
+
+    // Camera of the last update, to turn clicks into rays
+    float cameraEye[3] = {0.0f, 0.0f, 1.0f};
+    float cameraTarget[3] = {0.0f, 0.0f, 0.0f};
+    float cameraAspect = 1.0f;
+
+    // Every model's nodes hang off a root of its own, so moving the root moves the whole model
+    SceneGraph sceneGraph;
+    std::vector<uint32_t> modelRoots;
+    std::vector<uint32_t> nodeInstances;        // entry of Renderer::getLodInstances() per node, or SCENE_NODE_NONE
+    std::vector<float> instanceScales;          // largest axis scale of each instance's world transform
+    bool spinModels = false;
+    float spinAngle = 0.0f;
+    uint32_t updatedNodes = 0;
+    float sceneMilliseconds = 0.0f;
+
+    // Spatial index over the instance world spheres, refit as they move and rebuilt when the refits wore it down
+    Bvh bvh;
+    uint32_t bvhBuilds = 0;
+    float bvhMilliseconds = 0.0f;
+    uint32_t pickedInstance = SCENE_NODE_NONE;
+    float pickedDistance = 0.0f;
+
+    // Instances are frustum culled on the CPU before the renderer sees them, so culled ones cost no GPU work
+    bool cpuCulling = true;
+    bool bvhCulling = false;
+    CullKernel cullKernel = getBestCullKernel();
+    InstanceStore instanceStore;
+    std::vector<uint8_t> instanceVisibility;
+    uint32_t visibleInstances = 0;
+    float cullMilliseconds = 0.0f;
+
+    // Per instance level of detail, chosen from the projected geometric error of each level
+    bool lodEnabled = true;
+    float lodPixelError = 1.0f;
+    uint64_t lodTriangles = 0;
+    uint64_t fullTriangles = 0;
+
+    // Frame pacing handed to the renderer; fewer queued frames trade throughput for input latency
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+    int maxQueuedFrames = DEFAULT_FRAMES_IN_FLIGHT;
+
+    // Off when headless, whose frames are read back at the resolution they were asked for
+    bool dynamicResolution = true;
+    float gpuBudgetMilliseconds = DEFAULT_GPU_FRAME_BUDGET;
+
+    bool profilerPanelOpen = false;
+    std::string profilerStatus;
+
     void newUIFrame();
     void buildUI();
+    void buildProfilerUI();
+    void renderUI(RenderableState& r);
+    void updateCamera(RenderableState& r);
+    void updateScene(RenderableState& r);
+    void updateBvh(bool moved);
+    void pickInstance(float x, float y);
+    void cullInstances(const RenderableState& r);
+    void selectLods(RenderableState& r);
 
 };
 
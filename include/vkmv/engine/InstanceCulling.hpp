@@ -0,0 +1,79 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_INSTANCECULLING_HPP
+#define VKMV_INSTANCECULLING_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace vkmv {
+
+// Spheres per kernel iteration; InstanceStore pads its arrays to a multiple of this
+constexpr uint32_t CULL_BATCH_SIZE = 8;
+
+/**
+ * @class InstanceStore
+ * @brief World space bounding spheres of instances, stored as separate center x, y, z and radius arrays.
+ * 
+ * The structure of arrays layout lets the cull kernels load the same component of 8 instances with one
+ * instruction. Padding entries past size() are never reported visible.
+ */
+class InstanceStore {
+public:
+    /**
+     * @brief Grows or shrinks the store, keeping the spheres of instances below both sizes.
+     */
+    void resize(uint32_t count);
+    uint32_t size() const { return m_count; }
+
+    void setSphere(uint32_t index, const float sphere[4]);
+
+    const float* centerX() const { return m_centerX.data(); }
+    const float* centerY() const { return m_centerY.data(); }
+    const float* centerZ() const { return m_centerZ.data(); }
+    const float* radius() const { return m_radius.data(); }
+
+private:
+    uint32_t m_count = 0;
+    std::vector<float> m_centerX;
+    std::vector<float> m_centerY;
+    std::vector<float> m_centerZ;
+    std::vector<float> m_radius;
+};
+
+enum class CullKernel {
+    Scalar,
+    SSE,        // SSE2, 4 spheres per instruction
+    AVX2,       // AVX2 and FMA, 8 spheres per instruction
+};
+
+const char* getCullKernelName(CullKernel kernel);
+
+/**
+ * @brief Returns whether the CPU (and OS) can run the given kernel.
+ */
+bool isCullKernelSupported(CullKernel kernel);
+
+/**
+ * @brief Returns the widest kernel the CPU supports.
+ */
+CullKernel getBestCullKernel();
+
+/**
+ * @brief Tests every sphere of the store against 6 inward facing planes (see extractFrustumPlanes).
+ * 
+ * visibility receives one bit per instance, instance i in bit i % 8 of byte i / 8, and is resized to
+ * cover the store. Returns the number of visible instances. Unsupported kernels fall back to scalar.
+ */
+uint32_t cullSpheres(const InstanceStore& store, const float planes[6][4], CullKernel kernel, std::vector<uint8_t>& visibility);
+
+inline bool isInstanceVisible(const std::vector<uint8_t>& visibility, uint32_t index) {
+    return (visibility[index / 8] >> (index % 8)) & 1;
+}
+
+} // namespace vkmv
+
+#endif // VKMV_INSTANCECULLING_HPP
@@ -0,0 +1,83 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_SCENEGRAPH_HPP
+#define VKMV_SCENEGRAPH_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace vkmv {
+
+// Parent of root nodes, and the result of lookups that find nothing
+constexpr uint32_t SCENE_NODE_NONE = UINT32_MAX;
+
+/**
+ * @class SceneGraph
+ * @brief Transform hierarchy with local and world transforms and bounds in contiguous arrays.
+ * 
+ * Nodes are stored sorted by depth, so every parent comes before its children. Setting a local transform only
+ * flags the node; update() then makes one pass from the first flagged node, recomputing the world transform of
+ * flagged nodes and of nodes whose parent changed in the same pass. Subtrees that did not move cost a flag test
+ * per node and no matrix math.
+ * 
+ * Adding nodes may reorder the arrays, so nodes are referred to by handles that stay valid for the graph's lifetime.
+ */
+class SceneGraph {
+public:
+    /**
+     * @brief Adds a node under parent, or a root if parent is SCENE_NODE_NONE, and returns its handle.
+     * 
+     * The parent must already exist. The world transform is computed on the next update().
+     */
+    uint32_t addNode(uint32_t parent, const float localTransform[16]);
+
+    /**
+     * @brief Sets a model space bounding sphere (center and radius) that update() keeps in world space.
+     */
+    void setLocalBounds(uint32_t node, const float sphere[4]);
+
+    void setLocalTransform(uint32_t node, const float localTransform[16]);
+
+    const float* getLocalTransform(uint32_t node) const { return &m_local[m_slots[node] * 16]; }
+    const float* getWorldTransform(uint32_t node) const { return &m_world[m_slots[node] * 16]; }
+    const float* getWorldBounds(uint32_t node) const { return &m_worldBounds[m_slots[node] * 4]; }
+
+    uint32_t size() const { return static_cast<uint32_t>(m_slots.size()); }
+
+    /**
+     * @brief Propagates changed local transforms to the world transforms and bounds of their subtrees.
+     * 
+     * Returns the handles of every node whose world transform was recomputed, parents before children. The list
+     * is valid until the next update().
+     */
+    const std::vector<uint32_t>& update();
+
+private:
+    // Indexed by handle
+    std::vector<uint32_t> m_slots;
+
+    // Indexed by slot, in depth order
+    std::vector<uint32_t> m_handles;
+    std::vector<uint32_t> m_parents;        // slot of the parent, or SCENE_NODE_NONE
+    std::vector<uint32_t> m_depths;
+    std::vector<float> m_local;             // 16 per node, column major
+    std::vector<float> m_world;
+    std::vector<float> m_localBounds;       // 4 per node
+    std::vector<float> m_worldBounds;
+    std::vector<uint8_t> m_dirty;           // local transform or bounds changed since the last update
+    std::vector<uint8_t> m_changed;         // world transform recomputed by the last update
+
+    uint32_t m_firstDirty = SCENE_NODE_NONE;
+    bool m_sorted = true;
+    std::vector<uint32_t> m_changedNodes;
+
+    void markDirty(uint32_t slot);
+    void sortByDepth();
+};
+
+} // namespace vkmv
+
+#endif // VKMV_SCENEGRAPH_HPP
@@ -0,0 +1,86 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_COMMANDRECORDER_HPP
+#define VKMV_COMMANDRECORDER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vkmv/utils/JobSystem.hpp"
+
+namespace vkmv {
+
+/**
+ * @brief Records the items [begin, end) of a split pass into a secondary command buffer.
+ */
+using ChunkRecordFunc = std::function<void(VkCommandBuffer buf, uint32_t begin, uint32_t end)>;
+
+/**
+ * @class CommandRecorder
+ * @brief Records long runs of draws in parallel, as secondary command buffers continuing a dynamic rendering pass.
+ * 
+ * Every thread of the job system, plus the one recording frames, has a command pool per frame in flight, so no
+ * pool is ever used by two threads. Secondary buffers are allocated from them on first use and recycled when the
+ * frame slot comes around again.
+ * 
+ * The recording thread works on chunks itself instead of waiting: workers take chunks as they come free, and if
+ * all of them are busy with other jobs the recording thread ends up recording every chunk.
+ */
+class CommandRecorder {
+public:
+    void init(VkDevice device, uint32_t queueFamilyIndex, JobSystem* pJobSystem, uint32_t framesInFlight);
+
+    void cleanup();
+
+    /**
+     * @brief Resets the pools of frameSlot. The GPU must be done with the slot's previous frame.
+     */
+    void beginFrame(uint32_t frameSlot);
+
+    /**
+     * @brief Splits [0, count) into chunks of at least minChunkSize, records them in parallel and executes them in
+     * order from primary.
+     * 
+     * primary must be inside vkCmdBeginRendering with VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT, with the
+     * attachments described by renderingInfo. Secondary buffers inherit no dynamic state, so record sets its own.
+     */
+    void recordChunks(VkCommandBuffer primary, const VkCommandBufferInheritanceRenderingInfo& renderingInfo, uint32_t count,
+                      uint32_t minChunkSize, const ChunkRecordFunc& record);
+
+    /**
+     * @brief Returns how many threads can record at once.
+     */
+    uint32_t getThreadCount() const { return threadCount; }
+
+    /**
+     * @brief Lets secondary buffers run while a pipeline statistics query counting statistics is active.
+     * Requires the inheritedQueries feature.
+     */
+    void setInheritedStatistics(VkQueryPipelineStatisticFlags statistics) { inheritedStatistics = statistics; }
+
+private:
+    VkDevice _device = VK_NULL_HANDLE;
+    JobSystem* jobSystem = nullptr;
+
+    struct ThreadPool {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> buffers;
+        uint32_t usedBuffers = 0;
+    };
+    std::vector<ThreadPool> pools;          // threadCount per frame slot
+    uint32_t threadCount = 0;
+    uint32_t frameSlot = 0;
+    VkQueryPipelineStatisticFlags inheritedStatistics = 0;
+
+    VkCommandBuffer acquireSecondary(uint32_t thread);
+};
+
+} // namespace vkmv
+
+#endif // VKMV_COMMANDRECORDER_HPP
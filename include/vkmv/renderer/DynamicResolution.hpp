@@ -0,0 +1,53 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_DYNAMICRESOLUTION_HPP
+#define VKMV_DYNAMICRESOLUTION_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+namespace vkmv {
+
+// Leaves headroom under a 60 Hz refresh for the CPU side and presentation
+constexpr float DEFAULT_GPU_FRAME_BUDGET = 14.0f;     // milliseconds
+
+// Below this the upscaled image gets too blurry to be worth the time saved
+constexpr float MIN_RENDER_SCALE = 0.5f;
+
+/**
+ * @class DynamicResolution
+ * @brief Scales the resolution frames are rendered at so their GPU time stays within a budget.
+ * 
+ * Fed the GPU time of every frame the profiler reads back, the scale moves towards the one that would have met the
+ * budget. It applies to both axes; render targets stay allocated at the full extent and frames render into their
+ * top left corner, so a changing scale never reallocates anything.
+ * 
+ * Frames are recorded on one thread; the scale may be read from any.
+ */
+class DynamicResolution {
+public:
+    /**
+     * @brief Adapts the scale to a frame's GPU time, or resets it to 1 when not enabled. A gpuMilliseconds of 0
+     * means no new frame was measured.
+     */
+    void update(bool enabled, float gpuMilliseconds, float budgetMilliseconds);
+
+    /**
+     * @brief Returns the part of extent frames render at, at the current scale.
+     */
+    VkExtent2D getScaledExtent(VkExtent2D extent) const;
+
+    float getScale() const { return scale.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<float> scale{1.0f};
+};
+
+} // namespace vkmv
+
+#endif // VKMV_DYNAMICRESOLUTION_HPP
@@ -0,0 +1,215 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_FRAMEGRAPH_HPP
+#define VKMV_FRAMEGRAPH_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vkmv/renderer/GpuProfiler.hpp"
+#include "vkmv/renderer/ResourceManager.hpp"
+
+namespace vkmv {
+
+using FrameGraphResource = uint32_t;
+
+/**
+ * @brief How a pass accesses a resource. Each usage maps to the narrowest stage, access and layout that covers it.
+ */
+enum class ResourceUsage {
+    ColorAttachment,
+    DepthAttachment,
+    DepthRead,
+    SampledFragment,
+    SampledCompute,
+    StorageReadCompute,
+    StorageWriteCompute,
+    StorageReadVertex,
+    TransferSrc,
+    TransferDst,
+    VertexBuffer,
+    IndexBuffer,
+    IndirectBuffer,
+    UniformBuffer,
+    Present,
+};
+
+/**
+ * @brief An image created and owned by the graph, alive only while passes use it.
+ */
+struct TransientImageDesc {
+    VkFormat format;
+    VkExtent3D extent;
+    VkImageUsageFlags usageFlags;
+};
+
+/**
+ * @class FrameGraph
+ * @brief Orders a frame's passes and derives the barriers between them from declared resource usage.
+ * 
+ * Passes are added in submission order and declare every image or buffer they read or write. On execute,
+ * passes whose writes never reach an exported resource or a later live pass are culled. Before each remaining
+ * pass, all required layout transitions and memory dependencies are recorded as a single vkCmdPipelineBarrier2,
+ * using only the stages and accesses of the usages involved. Read-after-read in the same layout needs no barrier.
+ * 
+ * Transient images live from the first to the last live pass that uses them, or to the end of the graph if exported.
+ * Transients whose lifetimes don't overlap share memory, and the first barrier of an image placed over an earlier one
+ * waits on that image's last accesses. Allocations are kept per frame slot and only rebuilt when the set of
+ * transients or their lifetimes change.
+ * 
+ * The graph is rebuilt every frame: call reset(), import or create the frame's resources, add passes, then execute().
+ */
+class FrameGraph {
+public:
+    using RecordFunc = std::function<void(VkCommandBuffer buf)>;
+
+    class PassBuilder {
+    public:
+        PassBuilder& read(FrameGraphResource resource, ResourceUsage usage);
+        PassBuilder& write(FrameGraphResource resource, ResourceUsage usage);
+
+        /**
+         * @brief Keeps the pass alive even if nothing reads its outputs, e.g. for readbacks or queries.
+         */
+        PassBuilder& sideEffects();
+
+    private:
+        friend class FrameGraph;
+        PassBuilder(FrameGraph& graph, uint32_t pass) : graph(graph), pass(pass) {}
+
+        FrameGraph& graph;
+        uint32_t pass;
+    };
+
+    /**
+     * @brief With a profiler, every live pass is timed as a scope of its own, counting pipeline statistics.
+     */
+    void init(ResourceManager* pResourceManager, GpuProfiler* pProfiler = nullptr);
+
+    void cleanup();
+
+    /**
+     * @brief Adds an image owned outside the graph. Its contents are discarded if initialLayout is UNDEFINED.
+     * 
+     * initialStage is the stage a queue submission already waits on before first use (e.g. the swapchain acquire
+     * semaphore's wait stage), so the first barrier can chain from it instead of waiting on everything.
+     */
+    FrameGraphResource importImage(const std::string& name, VkImage image, VkImageLayout initialLayout,
+                                   VkPipelineStageFlags2 initialStage = VK_PIPELINE_STAGE_2_NONE,
+                                   VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT);
+
+    FrameGraphResource importBuffer(const std::string& name, VkBuffer buffer);
+
+    /**
+     * @brief Adds a transient image. Its contents are undefined before the first pass that writes it.
+     */
+    FrameGraphResource createImage(const std::string& name, const TransientImageDesc& desc);
+
+    /**
+     * @brief Returns a graph image. Transient images are only allocated once execute() starts recording passes.
+     */
+    const AllocatedImage& getImage(FrameGraphResource resource) const { return resources[resource].allocatedImage; }
+
+    /**
+     * @brief Marks a resource as consumed after the graph, transitioning it to finalUsage at the end of execute.
+     */
+    void exportResource(FrameGraphResource resource, ResourceUsage finalUsage);
+
+    PassBuilder addPass(const std::string& name, RecordFunc record);
+
+    /**
+     * @brief Culls unused passes, then records the live passes and their batched barriers into buf.
+     */
+    void execute(VkCommandBuffer buf);
+
+    /**
+     * @brief Clears all passes and resources while keeping their storage for the next frame.
+     * 
+     * Transient images are taken from frameSlot; the GPU must be done with the last frame executed on the same slot.
+     */
+    void reset(uint32_t frameSlot);
+
+    size_t getPassCount() const { return passes.size(); }
+
+    size_t getCulledPassCount() const { return culledPassCount; }
+
+    /**
+     * @brief Returns the memory allocated for the current slot's transient images, and what they would need unaliased.
+     */
+    VkDeviceSize getTransientMemorySize() const { return transientSlots.empty() ? 0 : transientSlots[frameSlot].group.allocatedSize; }
+
+    VkDeviceSize getUnaliasedTransientMemorySize() const { return transientSlots.empty() ? 0 : transientSlots[frameSlot].group.unaliasedSize; }
+
+private:
+    struct Access {
+        FrameGraphResource resource;
+        ResourceUsage usage;
+        bool write;
+    };
+
+    struct Pass {
+        std::string name;
+        RecordFunc record;
+        std::vector<Access> accesses;
+        bool sideEffects = false;
+        bool live = false;
+    };
+
+    struct Resource {
+        std::string name;
+        VkImage image = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkImageAspectFlags aspectMask = 0;
+        AllocatedImage allocatedImage{};
+
+        bool transient = false;
+        TransientImageDesc desc{};
+        int32_t aliasIndex = -1;    // index into the slot's AliasedImageGroup, or -1 if not allocated this frame
+        bool touched = false;
+
+        bool exported = false;
+        ResourceUsage finalUsage = ResourceUsage::Present;
+
+        // Tracked state while recording
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags2 writeStages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 writeAccess = VK_ACCESS_2_NONE;
+        VkPipelineStageFlags2 readStages = VK_PIPELINE_STAGE_2_NONE;   // Stages that read since the last write
+        VkPipelineStageFlags2 visibleStages = VK_PIPELINE_STAGE_2_NONE; // Stages the last write was made visible to
+        VkAccessFlags2 visibleAccess = VK_ACCESS_2_NONE;
+    };
+
+    ResourceManager* resourceManager = nullptr;
+    GpuProfiler* profiler = nullptr;
+
+    std::vector<Pass> passes;
+    std::vector<Resource> resources;
+    size_t culledPassCount = 0;
+
+    struct TransientSlot {
+        std::vector<AliasedImageDesc> descs;
+        AliasedImageGroup group;
+    };
+    std::vector<TransientSlot> transientSlots;
+    uint32_t frameSlot = 0;
+
+    std::vector<VkImageMemoryBarrier2> imageBarriers;
+    std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+
+    void cull();
+    void allocateTransients();
+    void addAliasingDependencies(Resource& resource);
+    void addBarrier(Resource& resource, ResourceUsage usage, bool write);
+    void flushBarriers(VkCommandBuffer buf);
+};
+
+} // namespace vkmv
+
+#endif // VKMV_FRAMEGRAPH_HPP
@@ -0,0 +1,115 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_FRAMEPACER_HPP
+#define VKMV_FRAMEPACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <vulkan/vulkan.h>
+
+#include "vkmv/core/Swapchain.hpp"
+
+namespace vkmv {
+
+/**
+ * @brief Input to display latency of recent frames, in milliseconds.
+ */
+struct FramePacingStats {
+    float latencyMilliseconds = 0.0f;       // of the last frame displayed
+    float averageMilliseconds = 0.0f;
+    float maxMilliseconds = 0.0f;
+    bool measuredAtPresent = false;         // false when measured at GPU completion, without VK_KHR_present_wait
+};
+
+/**
+ * @class FramePacer
+ * @brief Limits how many frames are queued ahead of the display and measures their input to display latency.
+ * 
+ * A thread of its own follows every drawn frame until it is displayed: with VK_KHR_present_wait it waits for the
+ * frame's present id, otherwise for its value on the frame timeline. The thread building frames calls
+ * waitToBuild() before sampling input, which holds it back until at most maxQueuedFrames - 1 earlier frames are
+ * still on their way to the display. Input is then sampled as late as the queue depth allows, instead of waiting
+ * behind full queues after being sampled.
+ */
+class FramePacer {
+public:
+    /**
+     * @brief Starts the pacing thread. waitForPresent is null when presents can't be waited for.
+     */
+    void init(VkDevice device, VkSemaphore frameTimeline, PFN_vkWaitForPresentKHR waitForPresent);
+
+    /**
+     * @brief Stops the pacing thread. The device must be idle.
+     */
+    void cleanup();
+
+    /**
+     * @brief Builder side: blocks until one more frame may be queued, then counts it as built. Best effort; gives
+     * up after a while so a stalled renderer can't hang the builder.
+     */
+    void waitToBuild();
+
+    /**
+     * @brief Renderer side: follows a submitted frame until it is displayed. presentId is 0 and swapchain null
+     * for frames that aren't presented, or if presents can't be waited for. Waits go through swapchain, which
+     * serializes them with its acquires and presents.
+     */
+    void frameSubmitted(uint64_t timelineValue, Swapchain* swapchain, uint64_t presentId, std::chrono::steady_clock::time_point inputTime);
+
+    /**
+     * @brief Blocks until no frame presented to swapchain is still being followed, so it can be destroyed.
+     */
+    void releaseSwapchain(VkSwapchainKHR swapchain);
+
+    void setMaxQueuedFrames(uint32_t frames) { maxQueuedFrames.store(frames, std::memory_order_relaxed); }
+
+    bool canWaitForPresent() const { return waitForPresent != nullptr; }
+
+    FramePacingStats getStats() const;
+
+private:
+    VkDevice _device = VK_NULL_HANDLE;
+    VkSemaphore frameTimeline = VK_NULL_HANDLE;
+    PFN_vkWaitForPresentKHR waitForPresent = nullptr;
+
+    struct PendingFrame {
+        uint64_t timelineValue;
+        Swapchain* owner;
+        VkSwapchainKHR swapchain;           // the one presented to, which owner may have replaced since
+        uint64_t presentId;
+        std::chrono::steady_clock::time_point inputTime;
+    };
+
+    std::atomic<uint32_t> maxQueuedFrames{1};
+    uint64_t builtFrames = 0;               // builder thread only
+
+    mutable std::mutex mutex;               // guards everything below
+    std::condition_variable pendingCondition;
+    std::condition_variable displayedCondition;
+    std::deque<PendingFrame> pending;       // the front is the frame being waited for
+    uint64_t displayedFrames = 0;
+    bool stopping = false;
+
+    static constexpr uint32_t LATENCY_HISTORY = 64;
+    float latencies[LATENCY_HISTORY] = {};
+    uint32_t latencyCount = 0;
+    float lastLatency = 0.0f;
+
+    std::thread thread;
+
+    void followFrames();
+    VkResult waitForDisplay(const PendingFrame& frame);
+};
+
+} // namespace vkmv
+
+#endif // VKMV_FRAMEPACER_HPP
@@ -0,0 +1,85 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_FRAMETIMELINE_HPP
+#define VKMV_FRAMETIMELINE_HPP
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+#include <vulkan/vulkan.h>
+
+namespace vkmv {
+
+/**
+ * @class FrameTimeline
+ * @brief Counts graphics queue submissions on a timeline semaphore and retires resources once the GPU passes them.
+ * 
+ * Every frame submission signals the next value, so one semaphore tells how far the GPU is for every frame in
+ * flight at once: waiting for a frame slot is a wait for the value its last submission signaled, and anything
+ * still referenced by recorded commands is handed to retire() instead of being destroyed on the spot.
+ * 
+ * All calls are made from the thread recording frames.
+ */
+class FrameTimeline {
+public:
+    void init(VkDevice device);
+
+    /**
+     * @brief Runs every pending retirement and destroys the semaphore. The device must be idle.
+     */
+    void cleanup();
+
+    VkSemaphore getSemaphore() const { return semaphore; }
+
+    /**
+     * @brief Returns the value the next submission will signal, which covers every command recorded until then.
+     */
+    uint64_t getPendingValue() const { return submittedValue + 1; }
+
+    /**
+     * @brief Claims the pending value for a submission, which must signal it. Returns the value.
+     */
+    uint64_t advance() { return ++submittedValue; }
+
+    /**
+     * @brief Returns the highest value the GPU has signaled.
+     */
+    uint64_t getCompletedValue();
+
+    /**
+     * @brief Blocks until the GPU has signaled value. Returns immediately for values already known to be reached.
+     */
+    void wait(uint64_t value);
+
+    /**
+     * @brief Calls destroy once the GPU finishes the pending submission. Commands recorded so far may still use
+     * whatever destroy releases.
+     */
+    void retire(std::function<void()> destroy);
+
+    /**
+     * @brief Runs the retirements of every submission the GPU has finished, in the order they were made.
+     */
+    void collect();
+
+private:
+    VkDevice _device = VK_NULL_HANDLE;
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+
+    uint64_t submittedValue = 0;    // value signaled by the most recent submission
+    uint64_t completedValue = 0;    // last value read back from the semaphore
+
+    struct Retirement {
+        uint64_t value;
+        std::function<void()> destroy;
+    };
+    std::deque<Retirement> retirements;
+};
+
+} // namespace vkmv
+
+#endif // VKMV_FRAMETIMELINE_HPP
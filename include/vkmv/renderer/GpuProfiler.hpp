@@ -0,0 +1,168 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_GPUPROFILER_HPP
+#define VKMV_GPUPROFILER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace vkmv {
+
+// Scopes timed per frame; later ones are dropped
+constexpr uint32_t MAX_GPU_SCOPES = 64;
+
+// Frames kept for trace export, a few seconds' worth
+constexpr uint32_t GPU_PROFILE_HISTORY = 256;
+
+/**
+ * @brief Pipeline statistics counted over a scope.
+ */
+struct GpuPipelineStatistics {
+    uint64_t inputVertices = 0;
+    uint64_t inputPrimitives = 0;
+    uint64_t vertexInvocations = 0;
+    uint64_t clippingInvocations = 0;
+    uint64_t clippingPrimitives = 0;
+    uint64_t fragmentInvocations = 0;
+    uint64_t computeInvocations = 0;
+};
+
+struct GpuScope {
+    std::string name;
+    uint32_t depth = 0;                 // 0 for the whole frame
+    double beginMilliseconds = 0.0;     // from the start of the frame
+    double endMilliseconds = 0.0;
+    bool hasStatistics = false;
+    GpuPipelineStatistics statistics;
+};
+
+struct GpuFrameProfile {
+    uint64_t frame = 0;
+    double startMilliseconds = 0.0;     // on the GPU clock, from the start of the first frame profiled
+    double submitMicroseconds = 0.0;    // on the CPU trace clock, when the frame was submitted; 0 if unknown
+    std::vector<GpuScope> scopes;       // in the order they began, each after its parent
+};
+
+/**
+ * @class GpuProfiler
+ * @brief Times nested scopes of a frame's commands with timestamp queries, and counts pipeline statistics over
+ * innermost scopes where the device supports them.
+ * 
+ * Every frame slot has its own range of queries, so results are read back when the slot comes around again: the
+ * frame timeline has shown the slot's previous frame finished by then and reading never waits. Results lag the
+ * frame being recorded by the frames in flight.
+ * 
+ * Scopes are recorded from the thread recording frames, into its primary command buffer and outside of rendering.
+ * Results may be read from any thread.
+ */
+class GpuProfiler {
+public:
+    /**
+     * @brief Creates the query pools. Without timestamp support on the queue family, nothing is recorded.
+     */
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex, uint32_t framesInFlight, bool pipelineStatistics);
+
+    void cleanup();
+
+    /**
+     * @brief Reads back the slot's previous frame, which must have finished, then opens the frame's root scope.
+     * Returns true if a frame was read back.
+     */
+    bool beginFrame(VkCommandBuffer buf, uint32_t frameSlot);
+
+    /**
+     * @brief Closes the root scope and any scope left open.
+     */
+    void endFrame(VkCommandBuffer buf);
+
+    /**
+     * @brief Opens a scope nested in the innermost open one. With statistics, pipeline statistics are counted over
+     * it too, unless an enclosing scope already counts them; statistics queries can't nest.
+     */
+    void beginScope(VkCommandBuffer buf, const std::string& name, bool statistics = false);
+
+    void endScope(VkCommandBuffer buf);
+
+    /**
+     * @brief Stamps the frame being recorded with the CPU trace clock's time, right after it was submitted.
+     */
+    void frameSubmitted();
+
+    bool isSupported() const { return timestampPool != VK_NULL_HANDLE; }
+
+    bool hasPipelineStatistics() const { return statisticsPool != VK_NULL_HANDLE; }
+
+    /**
+     * @brief Returns the statistics counted by statistics queries, which secondary command buffers must inherit.
+     */
+    VkQueryPipelineStatisticFlags getStatisticFlags() const;
+
+    /**
+     * @brief Returns the GPU time of the last frame read back, in milliseconds.
+     */
+    float getFrameMilliseconds() const { return frameMilliseconds.load(std::memory_order_relaxed); }
+
+    GpuFrameProfile getLastFrame() const;
+
+    /**
+     * @brief Writes the frames kept to path as Chrome trace event JSON, for chrome://tracing or Perfetto. Returns
+     * false, reporting to stderr, if the file can't be written.
+     */
+    bool writeChromeTrace(const std::string& path) const;
+
+    /**
+     * @brief Writes the frames kept as Chrome trace events, each preceded by a comma, on the CPU trace clock so
+     * they line up with a CpuTracer trace they are appended to.
+     */
+    void writeTraceEvents(std::ostream& out) const;
+
+private:
+    VkDevice _device = VK_NULL_HANDLE;
+    VkQueryPool timestampPool = VK_NULL_HANDLE;     // 2 * MAX_GPU_SCOPES per frame slot
+    VkQueryPool statisticsPool = VK_NULL_HANDLE;    // MAX_GPU_SCOPES per frame slot
+    float timestampPeriod = 1.0f;                   // nanoseconds per tick
+    uint64_t timestampMask = 0;
+
+    // Recording thread only
+    struct RecordedScope {
+        std::string name;
+        uint32_t depth;
+        uint32_t statisticsQuery;       // within the slot, or UINT32_MAX
+    };
+    struct FrameSlot {
+        std::vector<RecordedScope> scopes;
+        uint32_t statisticsCount = 0;
+        uint64_t frame = 0;
+        double submitMicroseconds = 0.0;
+    };
+    std::vector<FrameSlot> slots;
+    uint32_t currentSlot = 0;
+    uint64_t frameCount = 0;
+    std::vector<uint32_t> openScopes;   // scope indices, UINT32_MAX for scopes past MAX_GPU_SCOPES
+    bool statisticsOpen = false;
+    uint64_t previousStart = 0;         // timestamp of the last frame read back
+    double previousStartMilliseconds = 0.0;
+    bool hasPreviousStart = false;
+
+    std::atomic<float> frameMilliseconds{0.0f};
+
+    mutable std::mutex mutex;           // guards the frames read back
+    std::deque<GpuFrameProfile> history;
+
+    bool readBack(uint32_t frameSlot);
+    double toMilliseconds(uint64_t from, uint64_t to) const;
+};
+
+} // namespace vkmv
+
+#endif // VKMV_GPUPROFILER_HPP
@@ -0,0 +1,221 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_GPUSCENE_HPP
+#define VKMV_GPUSCENE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vkmv/core/Device.hpp"
+#include "vkmv/renderer/CommandRecorder.hpp"
+#include "vkmv/renderer/FrameGraph.hpp"
+#include "vkmv/renderer/Model.hpp"
+#include "vkmv/renderer/ResourceManager.hpp"
+#include "vkmv/renderer/ShaderLibrary.hpp"
+
+namespace vkmv {
+
+// Draws are split by index type, since an indirect count draw binds a single index buffer and type
+enum DrawStream : uint32_t {
+    DRAW_STREAM_INDEXED_UINT16 = 0,
+    DRAW_STREAM_INDEXED_UINT32 = 1,
+    DRAW_STREAM_NON_INDEXED = 2,
+    DRAW_STREAM_COUNT = 3,
+};
+
+// Meshlets culled per task shader workgroup, or per compute workgroup on the fallback path
+constexpr uint32_t MESHLETS_PER_TASK = 32;
+
+// GPU side layouts; must match shaders/scene.glsl. GpuMeshlet is Meshlet from GeometryProcessing.hpp.
+
+struct GpuDrawItem {
+    float sphere[4];        // model space center and radius; the cull pass applies the instance transform
+    uint32_t instance;
+    uint32_t primitive;
+    uint32_t pad[2];
+};
+
+struct GpuPrimitive {
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    uint32_t vertexCount;
+    uint32_t vertexOffset;          // compact vertices, see VertexLayout.hpp
+    uint32_t vertexStride;
+    uint32_t stream;
+    uint32_t meshletCount;          // 0 when the primitive is drawn whole by the indirect streams
+    uint32_t meshletOffset;
+    uint32_t meshletVertexOffset;
+    uint32_t meshletTriangleOffset;
+    uint32_t lodCount;
+    uint32_t pad;
+    float dequantScale[4];          // PositionQuantization, w unused
+    float dequantBias[4];
+};
+
+struct GpuClusterTask {
+    uint32_t drawItem;
+    uint32_t firstMeshlet;
+    uint32_t meshletCount;
+    uint32_t lod;
+};
+
+/**
+ * @brief What level of detail selection needs to know about one model instance.
+ * 
+ * Instances can move, so bounds and errors are in the space of the instance's mesh; scale them by the instance's
+ * current transform. Levels past a primitive's own lodCount fall back to its last level, so errors and triangle
+ * counts cover the mesh as a whole.
+ */
+struct LodInstance {
+    float sphere[4] = {};                   // mesh space center and radius
+    float errors[MAX_LOD_COUNT] = {};       // mesh space geometric error of each level
+    uint64_t triangles[MAX_LOD_COUNT] = {};
+    uint32_t lodCount = 1;
+};
+
+/**
+ * @brief A new world transform for one entry of GpuScene::getLodInstances().
+ */
+struct InstanceTransform {
+    uint32_t instance;
+    float transform[16];                    // column major
+};
+
+struct GpuSceneHeader {
+    VkDeviceAddress drawItems;
+    VkDeviceAddress primitives;
+    VkDeviceAddress transforms;
+    VkDeviceAddress geometry;
+    VkDeviceAddress clusterTasks;
+    uint32_t drawItemCount;
+    uint32_t clusterTaskCount;
+    uint32_t streamBase[DRAW_STREAM_COUNT];
+};
+
+/**
+ * @class GpuScene
+ * @brief GPU resident draw data for compute frustum culling and indirect drawing.
+ * 
+ * Every (instance, primitive) pair of a model becomes a draw item with a bounding sphere, which is moved by the
+ * instance's current transform. Each frame a compute pass culls all draw items against the view frustum and appends the survivors to a compacted
+ * command stream per index type, which the scene pass consumes with vkCmdDrawIndexedIndirectCount and
+ * vkCmdDrawIndirectCount. The CPU records a fixed number of commands per model regardless of instance count;
+ * scenes with many models record them in parallel chunks on the job system.
+ * Vertices are pulled from the model's geometry buffer by device address, so primitives with different
+ * layouts share one pipeline.
+ * 
+ * Primitives with meshlets skip the per draw item streams and are culled per meshlet against the frustum and
+ * their normal cones instead. With VK_EXT_mesh_shader, task shaders cull and launch mesh shaders for the
+ * survivors. Otherwise a compute pass appends each visible meshlet as a non-indexed indirect draw.
+ * 
+ * Meshlets of every detail level have cluster tasks. Each frame the detail level of every instance is written
+ * to a per frame selection buffer, and tasks of the other levels exit without culling anything.
+ * 
+ * Instance transforms stay in device local buffers. Changed ones are written to a per frame staging buffer and
+ * copied over before the cull passes, so a frame only transfers the instances that moved.
+ */
+class GpuScene {
+public:
+    void init(Device* pDevice, ResourceManager* pResourceManager, ShaderLibrary* pShaderLibrary, CommandRecorder* pCommandRecorder,
+              uint32_t framesInFlight);
+
+    void cleanup();
+
+    /**
+     * @brief Builds the draw data for a model. The model's geometry buffer must outlive the scene.
+     */
+    void addModel(const Model& model);
+
+    /**
+     * @brief Adds the cull passes and a scene pass that clears and draws into colorTarget and depthTarget.
+     * 
+     * cameraPosition is the world space eye position, used for meshlet cone culling. instanceLods holds the detail
+     * level of each entry of getLodInstances(), or LOD_CULLED to skip the instance without any GPU culling work;
+     * instances past its end are drawn at full detail. transformUpdates replaces the world transforms of the given
+     * instances from this frame on. Both are copied into frameSlot's buffers right away, so the GPU must be done
+     * with the slot's previous frame.
+     */
+    void addPasses(FrameGraph& frameGraph, uint32_t frameSlot, const float viewProjection[16], const float cameraPosition[3],
+                   const std::vector<uint32_t>& instanceLods, const std::vector<InstanceTransform>& transformUpdates,
+                   FrameGraphResource colorTarget, FrameGraphResource depthTarget, VkExtent2D extent);
+
+    /**
+     * @brief Returns the world space bounds of every draw item as added. Returns false if the scene is empty.
+     */
+    bool getBounds(float boundsMin[3], float boundsMax[3]) const;
+
+    uint32_t getDrawItemCount() const { return drawItemCount; }
+
+    /**
+     * @brief Returns one entry per instance of every added model, drawable or not, in the order the models were added.
+     */
+    const std::vector<LodInstance>& getLodInstances() const { return lodInstances; }
+
+    bool usesMeshShaders() const { return meshShaders; }
+
+private:
+    VkDevice _device;
+    ResourceManager* resourceManager = nullptr;
+    ShaderLibrary* shaderLibrary = nullptr;
+    CommandRecorder* commandRecorder = nullptr;
+
+    bool meshShaders = false;
+    PFN_vkCmdDrawMeshTasksEXT cmdDrawMeshTasks = nullptr;
+
+    VkPipelineLayout cullPipelineLayout = VK_NULL_HANDLE;
+    VkPipelineLayout drawPipelineLayout = VK_NULL_HANDLE;
+    VkPipelineLayout meshletPipelineLayout = VK_NULL_HANDLE;
+    VkPipelineLayout meshletCullPipelineLayout = VK_NULL_HANDLE;
+    VkPipelineLayout meshletDrawPipelineLayout = VK_NULL_HANDLE;
+    PipelineHandle cullPipeline;
+    PipelineHandle drawPipeline;
+    PipelineHandle meshletPipeline;         // task + mesh shaders
+    PipelineHandle meshletCullPipeline;     // fallback compute cull
+    PipelineHandle meshletDrawPipeline;     // fallback indirect draw
+
+    struct ModelDrawData {
+        VkBuffer geometry;
+        AllocatedBuffer header;
+        AllocatedBuffer drawItems;
+        AllocatedBuffer primitives;
+        AllocatedBuffer transforms;
+        AllocatedBuffer clusterTasks;
+        uint32_t drawItemCount;
+        uint32_t streamBase[DRAW_STREAM_COUNT];
+        uint32_t streamCapacity[DRAW_STREAM_COUNT];
+        uint32_t clusterTaskCount;
+        uint32_t clusterCapacity;           // meshlets that can be visible at once, at the largest detail levels
+        uint32_t firstLodInstance;
+        uint32_t instanceCount;
+
+        // Written by the cull passes, so each frame in flight has its own
+        std::vector<AllocatedBuffer> commands;
+        std::vector<AllocatedBuffer> counts;
+        std::vector<AllocatedBuffer> lodSelections;     // detail level per instance, written by the CPU
+        std::vector<AllocatedBuffer> clusters;          // fallback only: visible (draw item, meshlet) pairs
+        std::vector<AllocatedBuffer> clusterCommands;   // fallback only: one VkDrawIndirectCommand per visible meshlet
+    };
+    std::vector<ModelDrawData> models;
+    std::vector<LodInstance> lodInstances;
+
+    // Host visible, one per frame in flight; grown when a frame moves more instances than fit
+    std::vector<AllocatedBuffer> transformStaging;
+
+    uint32_t framesInFlight = 0;
+    uint32_t drawItemCount = 0;
+    float boundsMin[3];
+    float boundsMax[3];
+
+    void createPipelines();
+    AllocatedBuffer createStaticBuffer(const void* data, VkDeviceSize size);
+    void addTransformPass(FrameGraph& frameGraph, uint32_t frameSlot, const std::vector<InstanceTransform>& transformUpdates);
+};
+
+} // namespace vkmv
+
+#endif // VKMV_GPUSCENE_HPP
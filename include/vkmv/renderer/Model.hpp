@@ -0,0 +1,99 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_MODEL_HPP
+#define VKMV_MODEL_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vkmv/renderer/ResourceManager.hpp"
+#include "vkmv/renderer/VertexLayout.hpp"
+
+namespace vkmv {
+
+// Upper bound on the detail levels of a primitive, the full resolution one included
+constexpr uint32_t MAX_LOD_COUNT = 6;
+
+// Detail level selection of an instance culled on the CPU; nothing of it is drawn
+constexpr uint32_t LOD_CULLED = UINT32_MAX;
+
+/**
+ * @brief One detail level of a primitive: a range of its meshlets, simplified from the level before.
+ */
+struct ModelLod {
+    uint32_t firstMeshlet = 0;
+    uint32_t meshletCount = 0;
+    uint32_t triangleCount = 0;
+    float error = 0.0f;                     // model space distance from the full resolution surface; 0 for level 0
+};
+
+struct ModelPrimitive {
+    // Interleaved vertices in Model::geometry, packed in vertexFormat with positions quantized over the bounds
+    VkDeviceSize vertexOffset = 0;
+    VertexFormat vertexFormat = VERTEX_FORMAT_COMPACT;
+    PositionQuantization quantization;
+
+    VkDeviceSize indexOffset = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    uint32_t indexCount = 0;                // 0 for non-indexed primitives
+    uint32_t vertexCount = 0;
+
+    // Meshlets built at import; Meshlet, vertex and packed triangle arrays in Model::geometry. The arrays hold
+    // every detail level, each level a contiguous range of meshlets.
+    VkDeviceSize meshletOffset = 0;
+    VkDeviceSize meshletVertexOffset = 0;
+    VkDeviceSize meshletTriangleOffset = 0;
+    uint32_t meshletCount = 0;
+    ModelLod lods[MAX_LOD_COUNT];
+    uint32_t lodCount = 0;
+
+    float boundsMin[3] = {0.0f, 0.0f, 0.0f};
+    float boundsMax[3] = {0.0f, 0.0f, 0.0f};
+};
+
+struct ModelMesh {
+    uint32_t firstPrimitive;
+    uint32_t primitiveCount;
+};
+
+// Parent of the root nodes of a model
+constexpr uint32_t MODEL_NODE_ROOT = UINT32_MAX;
+
+/**
+ * @brief A node of the model's transform hierarchy. Model::nodes is sorted by depth, so parents come first.
+ */
+struct ModelNode {
+    uint32_t parent;                        // index into Model::nodes, or MODEL_NODE_ROOT
+    float localTransform[16];               // column major, relative to the parent
+};
+
+struct ModelInstance {
+    uint32_t mesh;
+    uint32_t node;                          // index into Model::nodes
+    float transform[16];                    // column major, model space, as imported
+};
+
+/**
+ * @brief GPU resident geometry of a loaded model.
+ * 
+ * All vertex and index data lives in a single buffer. Primitives reference it by byte offset; their vertices
+ * are repacked into one of the compact layouts of VertexLayout.hpp at import.
+ */
+struct Model {
+    AllocatedBuffer geometry{};
+    std::vector<ModelPrimitive> primitives;
+    std::vector<ModelMesh> meshes;
+    std::vector<ModelNode> nodes;
+    std::vector<ModelInstance> instances;
+};
+
+void destroyModel(ResourceManager& resourceManager, Model& model);
+
+} // namespace vkmv
+
+#endif // VKMV_MODEL_HPP
@@ -0,0 +1,211 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_MODELIMPORTER_HPP
+#define VKMV_MODELIMPORTER_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vkmv/assets/GeometryProcessing.hpp"
+#include "vkmv/assets/GltfAsset.hpp"
+#include "vkmv/renderer/Model.hpp"
+#include "vkmv/renderer/ResourceManager.hpp"
+#include "vkmv/renderer/VertexLayout.hpp"
+#include "vkmv/utils/JobSystem.hpp"
+
+namespace vkmv {
+
+/**
+ * @brief One copy of generated data into the intermediate buffer of a batch.
+ */
+struct GeometryUpload {
+    VkDeviceSize dstOffset;
+    const void* data;       // null for vertices, which upload() packs straight into the staging memory instead
+    VkDeviceSize size;
+    uint32_t primitive;     // whose vertices a null data stands for
+};
+
+/**
+ * @class ModelImport
+ * @brief Imports a glTF file on a JobSystem, then uploads it incrementally from the render thread.
+ * 
+ * The CPU stages run as jobs as soon as the import is constructed:
+ * - Parsing: map the file and build the glTF index tables
+ * - Decoding: decode positions, indices and attributes, generate missing normals
+ * - Cache optimization: reorder the triangles of indexed primitives for the post-transform cache and overdraw, then
+ *   their vertices in order of first use
+ * - LOD generation: simplify every primitive into a chain of detail levels with quadric error metrics
+ * - Meshlet generation: split every detail level into meshlets with bounding spheres and normal cones
+ * - Tangent generation: for primitives with UVs but no tangents
+ * - Upload preparation: lay out the geometry buffer, fill the primitive tables
+ * 
+ * Primitives are processed in batches whose estimated decoded size fits the batch budget, so the heap never holds
+ * more than about one batch of geometry however large the model is. Within a batch, every stage but the layout
+ * runs in parallel per primitive. Once a batch is ready, upload() stages a bounded number of bytes of it per call
+ * into an intermediate buffer, so the render loop keeps presenting while large models stream in. Vertices are
+ * quantized into one of the compact layouts of VertexLayout.hpp only then, in parallel and straight into the
+ * memory the ResourceManager hands out, so packed vertices never sit on the heap. The fully staged batch is freed
+ * along with the file pages only it read, and the next one starts processing. After the last batch the GPU copies
+ * every intermediate buffer into Model::geometry, whose size is only known by then.
+ */
+class ModelImport {
+public:
+    enum class Stage {
+        Parsing,
+        Processing,
+        Ready,
+        Failed
+    };
+
+    /**
+     * @brief Starts importing path. batchBudget bounds the decoded geometry of a batch; a primitive larger than it
+     * makes up a batch on its own.
+     */
+    ModelImport(JobSystem& jobSystem, std::string path, size_t batchBudget);
+
+    /**
+     * @brief Waits for any running jobs, since they reference this object.
+     */
+    ~ModelImport();
+
+    ModelImport(const ModelImport&) = delete;
+    ModelImport& operator=(const ModelImport&) = delete;
+
+    Stage getStage() const { return m_stage.load(std::memory_order_acquire); }
+
+    const std::string& getPath() const { return m_path; }
+
+    /**
+     * @brief Returns the failure reason. Only valid once getStage() returns Failed.
+     */
+    const std::string& getError() const { return m_error; }
+
+    /**
+     * @brief Blocks until the CPU stages of the current batch finish, running jobs on the calling thread meanwhile.
+     */
+    void wait();
+
+    /**
+     * @brief Stages up to byteBudget bytes of the current batch. Returns true once the whole model has been
+     * enqueued.
+     * 
+     * Only valid once getStage() returns Ready. When the batch is fully staged its CPU data is freed and the next
+     * batch starts processing, setting the stage back to Processing. The call that stages the last batch allocates
+     * Model::geometry and enqueues the copies into it.
+     */
+    bool upload(ResourceManager& resourceManager, VkDeviceSize byteBudget);
+
+    /**
+     * @brief Hands over the finished model. Only valid once upload() has returned true.
+     */
+    Model takeModel() { return std::move(m_model); }
+
+    /**
+     * @brief Frees the GPU memory of an import that won't finish, e.g. one that failed. Only valid while no jobs
+     * are running, see wait().
+     */
+    void cancel(ResourceManager& resourceManager);
+
+    /**
+     * @brief Vertex cache behaviour of every indexed primitive as stored in the file and as reordered by the import.
+     * Only valid once upload() has returned true.
+     */
+    const VertexCacheStatistics& getSourceCacheStatistics() const { return m_sourceCacheStatistics; }
+    const VertexCacheStatistics& getOptimizedCacheStatistics() const { return m_optimizedCacheStatistics; }
+
+private:
+    struct PrimitiveData {
+        uint32_t gltfPrimitive;
+
+        // Indexed primitives are rewritten in cache optimized triangle order and vertex fetch order, with 16 bit
+        // indices when the vertices allow it. Non-indexed primitives keep the file's vertex order.
+        uint32_t vertexCount = 0;
+        std::vector<uint32_t> vertexOrder;          // source vertex of each reordered vertex; empty when not reordered
+        std::vector<uint16_t> indices16;
+        std::vector<uint32_t> indices32;
+        VertexCacheStatistics sourceCacheStatistics;
+        VertexCacheStatistics optimizedCacheStatistics;
+
+        // Decoded attributes in the final vertex order; upload() packs them in vertexFormat
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<float> tangents;                // empty without texcoords
+        std::vector<float> texcoords;
+        VertexFormat vertexFormat = VERTEX_FORMAT_COMPACT;
+        PositionQuantization quantization;
+
+        // Generated streams
+        std::vector<Meshlet> meshlets;
+        std::vector<uint32_t> meshletVertices;
+        std::vector<uint32_t> meshletTriangles;
+        std::vector<ModelLod> lods;
+
+        VkDeviceSize verticesOffset = 0;
+        VkDeviceSize indicesOffset = 0;
+        VkDeviceSize meshletsOffset = 0;
+        VkDeviceSize meshletVerticesOffset = 0;
+        VkDeviceSize meshletTrianglesOffset = 0;
+    };
+
+    // A run of consecutive primitives that is processed and uploaded as a unit
+    struct ImportBatch {
+        uint32_t firstPrimitive;
+        uint32_t endPrimitive;
+        VkDeviceSize geometryOffset = 0;    // of the batch's range in Model::geometry
+        VkDeviceSize size = 0;
+        AllocatedBuffer buffer{};           // intermediate buffer the batch is staged into
+    };
+
+    // Vertices of a primitive to pack into reserved upload memory
+    struct VertexPack {
+        uint32_t primitive;
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+        uint8_t* dst;
+    };
+
+    JobSystem& m_jobSystem;
+    JobCounter m_counter;
+
+    std::string m_path;
+    size_t m_batchBudget;
+    std::atomic<Stage> m_stage{Stage::Parsing};
+    std::string m_error;
+
+    std::unique_ptr<GltfAsset> m_asset;
+    Model m_model;
+    std::vector<PrimitiveData> m_primitiveData;
+    VertexCacheStatistics m_sourceCacheStatistics;
+    VertexCacheStatistics m_optimizedCacheStatistics;
+
+    std::vector<ImportBatch> m_batches;
+    uint32_t m_currentBatch = 0;
+    std::vector<uint32_t> m_lastBatchOfView;    // last batch reading each buffer view, UINT32_MAX for none
+
+    VkDeviceSize m_geometrySize = 0;
+    std::vector<GeometryUpload> m_uploads;      // of the current batch
+    size_t m_nextUpload = 0;
+    VkDeviceSize m_nextUploadOffset = 0;
+
+    void run();
+    void buildTables();
+    void planBatches();
+    void processBatch();
+    void processPrimitive(uint32_t index);
+    void reorderPrimitive(PrimitiveData& data, std::vector<uint32_t>& indices, std::vector<float>& positions);
+    void layoutBatch();
+    void packVertexRange(const VertexPack& pack) const;
+    void preparePrimitive(uint32_t index);
+    void buildNodes();
+};
+
+} // namespace vkmv
+
+#endif // VKMV_MODELIMPORTER_HPP
@@ -0,0 +1,79 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_PIPELINECACHE_HPP
+#define VKMV_PIPELINECACHE_HPP
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+
+namespace vkmv {
+
+/**
+ * @class PipelineCache
+ * @brief Owns the renderer's VkPipelineCache and persists it to disk between runs.
+ * 
+ * On init, cache data from a previous run is loaded if its header matches this physical device (vendor ID,
+ * device ID and pipelineCacheUUID); mismatching or corrupt files are ignored, since some drivers do not
+ * validate the data themselves. Pipelines created off the main thread go through per-thread caches that
+ * are merged into the main cache before it is written back at cleanup.
+ */
+class PipelineCache {
+public:
+    /**
+     * @brief Creates the main cache, seeded from path if it holds compatible data.
+     */
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& path);
+
+    /**
+     * @brief Merges the per-thread caches, saves the result and destroys every cache.
+     */
+    void cleanup();
+
+    /**
+     * @brief Returns the main cache, for pipelines created on the render thread or by libraries such as ImGui.
+     */
+    VkPipelineCache getCache() const { return cache; }
+
+    /**
+     * @brief Returns the calling thread's cache, creating it on first use.
+     */
+    VkPipelineCache getThreadCache();
+
+    VkPipeline createGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo);
+
+    VkPipeline createComputePipeline(const VkComputePipelineCreateInfo& createInfo);
+
+    /**
+     * @brief Merges the per-thread caches into the main cache and writes it to disk. Failures are only logged.
+     */
+    void save();
+
+    /**
+     * @brief Returns the platform's per-user cache location for the pipeline cache file.
+     */
+    static std::string getDefaultPath();
+
+private:
+    VkPhysicalDevice _physicalDevice;
+    VkDevice _device;
+    std::string path;
+
+    VkPipelineCache cache = VK_NULL_HANDLE;
+
+    std::mutex threadCachesMutex;
+    std::unordered_map<std::thread::id, VkPipelineCache> threadCaches;
+    std::thread::id mainThread;
+
+    VkPipelineCache selectCache();
+};
+
+} // namespace vkmv
+
+#endif // VKMV_PIPELINECACHE_HPP
@@ -6,7 +6,13 @@
 #ifndef VKMV_RENDERER_HPP
 #define VKMV_RENDERER_HPP
 
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 #include <vulkan/vulkan.h>
@@ -17,25 +23,96 @@
 #include "vkmv/app/Window.hpp"
 #include "vkmv/core/Device.hpp"
 #include "vkmv/core/Instance.hpp"
+#include "vkmv/core/Swapchain.hpp"
+#include "vkmv/renderer/CommandRecorder.hpp"
+#include "vkmv/renderer/DynamicResolution.hpp"
+#include "vkmv/renderer/FrameGraph.hpp"
+#include "vkmv/renderer/FramePacer.hpp"
+#include "vkmv/renderer/FrameTimeline.hpp"
+#include "vkmv/renderer/GpuProfiler.hpp"
+#include "vkmv/renderer/GpuScene.hpp"
+#include "vkmv/renderer/Model.hpp"
+#include "vkmv/renderer/ModelImporter.hpp"
+#include "vkmv/renderer/PipelineCache.hpp"
 #include "vkmv/renderer/ResourceManager.hpp"
+#include "vkmv/renderer/ShaderLibrary.hpp"
+#include "vkmv/renderer/UIDrawSnapshot.hpp"
 
 namespace vkmv {
 
-constexpr unsigned int NUM_FRAMES_IN_FLIGHT = 2;
+// Frames the CPU may record ahead of the GPU unless the renderer is told otherwise
+constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+// Upper bound on model geometry copied per frame while imports stream in
+constexpr VkDeviceSize IMPORT_UPLOAD_BUDGET = 64 * 1024 * 1024;
+
+// Decoded geometry an import holds at once; its generated streams are smaller, so a batch uploads in about a frame
+constexpr size_t IMPORT_BATCH_BUDGET = IMPORT_UPLOAD_BUDGET;
+
+// Compiled SPIR-V is loaded from, and watched for changes in, this directory relative to the working directory
+constexpr const char* SHADER_DIRECTORY = "shaders";
 
 struct RenderableState {
+    float viewProjection[16] = {1, 0, 0, 0,
+                                0, 1, 0, 0,
+                                0, 0, 1, 0,
+                                0, 0, 0, 1};
+    float cameraPosition[3] = {0, 0, 0};
+
+    // Detail level per entry of Renderer::getLodInstances(), or LOD_CULLED; instances without an entry draw at full detail
+    std::vector<uint32_t> instanceLods;
+
+    // Instances whose world transform changed since the previous frame; the GPU keeps the last transform of the rest
+    std::vector<InstanceTransform> transformUpdates;
+
+    // The frame's UI, copied so the renderer can record it while the next UI frame is built
+    UIDrawSnapshot ui;
+
+    // Falls back to FIFO when the surface doesn't support it; ignored when headless
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+
+    // Frames, from 1 to the frames in flight, that may be on their way to the display while the next is built
+    uint32_t maxQueuedFrames = DEFAULT_FRAMES_IN_FLIGHT;
 
+    // When the input this frame reflects was sampled, for measuring its latency to the display
+    std::chrono::steady_clock::time_point inputTime;
+
+    // Scales the scene's resolution to keep the GPU time of frames within the budget; the UI stays at full resolution
+    bool dynamicResolution = false;
+    float gpuBudgetMilliseconds = DEFAULT_GPU_FRAME_BUDGET;
 };
 
 /**
  * @class Renderer
  * @brief Encapsulates all Vulkan rendering logic.
  * 
- * Intended to be run on a window and receive updates from an engine class.
+ * Intended to be run on a window and receive updates from an engine class. When constructed with only
+ * an extent, the renderer is headless: no surface, swapchain or present queue is created and each frame
+ * is left in its frame graph render target instead of being presented.
+ * 
+ * Windowed frames follow the window's size: the swapchain is recreated when the window is resized or presentation
+ * reports it out of date. Frames that have no image to present to, e.g. while minimized, are still rendered, so no
+ * state handed to drawFrame() is lost.
+ * 
+ * How far frames run ahead of the display is paced separately from the frames in flight: whoever builds frames calls
+ * waitForFramePacing() before sampling input, which admits at most RenderableState::maxQueuedFrames frames between
+ * input and display.
  */
 class Renderer {
 public:
-    Renderer(const Window& window);
+    /**
+     * @brief Creates a renderer presenting to window. Long passes are recorded in parallel on jobSystem's workers.
+     * 
+     * framesInFlight frames, from 1 to MAX_FRAMES_IN_FLIGHT, may be recorded before the GPU finishes the first.
+     */
+    Renderer(const Window& window, JobSystem& jobSystem, uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT);
+
+    /**
+     * @brief Creates a headless renderer that draws offscreen at the given extent.
+     */
+    Renderer(VkExtent2D extent, JobSystem& jobSystem, uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT);
+
     ~Renderer();
 
     /**
@@ -45,38 +122,125 @@ public:
 
     void drawFrame(RenderableState& r);
 
+    /**
+     * @brief Blocks until the frame about to be built can be queued without exceeding the requested maximum of
+     * queued frames. Call it right before sampling the frame's input; safe to call from any one thread.
+     */
+    void waitForFramePacing() { framePacer.waitToBuild(); }
+
+    /**
+     * @brief Returns the input to display latency of recent frames. Safe to call from any thread.
+     */
+    FramePacingStats getFramePacingStats() const { return framePacer.getStats(); }
+
+    /**
+     * @brief Returns the present modes the window's surface supports, or none when headless.
+     */
+    const std::vector<VkPresentModeKHR>& getSupportedPresentModes() const { return swapchain.getSupportedPresentModes(); }
+
+    uint32_t getFramesInFlight() const { return framesInFlight; }
+
+    /**
+     * @brief Returns the GPU timings and pipeline statistics of recent frames. Its results are safe to read from
+     * any thread.
+     */
+    const GpuProfiler& getGpuProfiler() const { return gpuProfiler; }
+
+    bool isDynamicResolutionSupported() const { return gpuProfiler.isSupported(); }
+
+    /**
+     * @brief Returns the scale the scene is rendered at, per axis. Safe to call from any thread.
+     */
+    float getRenderScale() const { return dynamicResolution.getScale(); }
+
+    /**
+     * @brief Returns the GPU time of a recent frame in milliseconds. Safe to call from any thread.
+     */
+    float getGpuFrameMilliseconds() const { return gpuProfiler.getFrameMilliseconds(); }
+
+    /**
+     * @brief Starts importing a glTF 2.0 (.gltf or .glb) file on the job system.
+     * 
+     * Returns immediately. Parsing and processing run on worker threads, and the geometry is uploaded over the
+     * following frames. Failed imports are reported to stderr and dropped.
+     */
+    void importModel(const std::string& path, JobSystem& jobSystem);
+
+    bool isImporting() const { return !imports.empty(); }
+
+    /**
+     * @brief Locks the models, LOD instances, scene bounds and import queue, which drawFrame() changes when an
+     * import finishes. Another thread must hold the lock while it reads them.
+     */
+    std::unique_lock<std::mutex> lockScene() const { return std::unique_lock<std::mutex>(sceneMutex); }
+
+    /**
+     * @brief Blocks until every pending import is uploaded. Throws a runtime error if any import failed.
+     */
+    void waitForImports();
+
+    bool isHeadless() const { return window == nullptr; }
+
+    /**
+     * @brief Returns the extent frames are rendered at. Follows the window; safe to call from any thread.
+     */
+    VkExtent2D getRenderExtent() const;
+
+    /**
+     * @brief Gets the world space bounds of every loaded model. Returns false if nothing has been loaded yet.
+     */
+    bool getSceneBounds(float boundsMin[3], float boundsMax[3]) const { return gpuScene.getBounds(boundsMin, boundsMax); }
+
+    /**
+     * @brief Gets the mesh space bounds, per level errors and triangle counts of every instance of every loaded model.
+     */
+    const std::vector<LodInstance>& getLodInstances() const { return gpuScene.getLodInstances(); }
+
+    /**
+     * @brief Gets every loaded model, in load order. Their instances, in order, are the entries of getLodInstances().
+     */
+    const std::vector<Model>& getModels() const { return models; }
+
 private:
-    const Window& window;
+    const Window* window = nullptr;
+    JobSystem* jobSystem = nullptr;
 
     struct FrameData {
         VkCommandPool commandPool;
         VkCommandBuffer mainCommandBuffer;
 
         VkSemaphore swapchainSemaphore;
-        VkFence renderFence;
-
-        AllocatedImage renderTargetImage;
-    };
-    FrameData frames[NUM_FRAMES_IN_FLIGHT];
-    int frameCount = 0;
-    unsigned int width, height;
-
-    struct swapchainImageResource {
-        VkSemaphore renderSemaphore;
+        uint64_t timelineValue = 0;     // frame timeline value signaled by the slot's last submission
     };
-    std::vector<swapchainImageResource> swapchainImageResources;
+    std::vector<FrameData> frames;
+    uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+    uint64_t frameCount = 0;
+    unsigned int width = 0, height = 0;
+    std::atomic<uint64_t> renderExtent{0};  // width and height for other threads, width in the high half
 
     Instance instance;
-    VkSurfaceKHR surface;
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
     Device device;
+    PipelineCache pipelineCache;
+    ShaderLibrary shaderLibrary;
 
-    VkSwapchainKHR swapchain;
-    VkSurfaceFormatKHR swapchainImageFormat;
-    VkExtent2D swapchainExtent;
-    std::vector<VkImage> swapchainImages;
-    std::vector<VkImageView> swapchainImageViews;
+    Swapchain swapchain;
+    VkExtent2D requestedSwapchainExtent{};  // window extent the swapchain was last created for
+    VkPresentModeKHR requestedPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+    bool swapchainOutOfDate = false;
 
+    FrameTimeline frameTimeline;
+    FramePacer framePacer;
+    GpuProfiler gpuProfiler;
+    DynamicResolution dynamicResolution;
     ResourceManager resourceManager;
+    FrameGraph frameGraph;
+    CommandRecorder commandRecorder;
+    GpuScene gpuScene;
+
+    std::vector<Model> models;
+    std::deque<std::unique_ptr<ModelImport>> imports;
+    mutable std::mutex sceneMutex;
 
     void initRenderer();
     void cleanup();
@@ -85,18 +249,20 @@ private:
     void pickPhysicalDevice();
     void createDevice();
     void createSwapchain();
-    void destroySwapchain();
+    void recreateSwapchain(VkExtent2D extent);
+    bool acquireSwapchainImage(uint32_t& imageIndex);
     void createCommandPools();
     void createSyncObjects();
-    void createRenderTargets();
-    void destroyRenderTargets();
 
     void initImGUI();
     void cleanupImGUI();
 
     FrameData& getCurrentFrame();
-    void refreshWindowDims();
-    void recordMainCommands(RenderableState& r, VkCommandBuffer& buf, VkImage& swapchainImage);
+    uint32_t getFrameSlot() const { return static_cast<uint32_t>(frameCount % framesInFlight); }
+    void setRenderExtent(VkExtent2D extent);
+    void processImports(VkDeviceSize byteBudget);
+    void addMainPasses(RenderableState& r, FrameGraphResource renderTarget);
+    void addPresentPasses(FrameGraphResource renderTarget, VkImage swapchainImage);
 };
 
 } // namespace vkmv
@@ -6,6 +6,10 @@
 #ifndef VKMV_RESOURCEMANAGER_HPP
 #define VKMV_RESOURCEMANAGER_HPP
 
+#include <cstdint>
+#include <deque>
+#include <vector>
+
 #include <vulkan/vulkan.h>
 
 #include <vk_mem_alloc.h>
@@ -23,20 +27,61 @@ struct AllocatedImage {
 struct AllocatedBuffer {
     VkBuffer buffer;
     VmaAllocation allocation;
+    VkDeviceSize size;
+    void* mappedData;   // non-null when the allocation is persistently mapped (host visible)
+};
+
+/**
+ * @brief An image that shares memory with others whose use intervals [firstUse, lastUse] do not overlap.
+ */
+struct AliasedImageDesc {
+    VkFormat format;
+    VkImageUsageFlags usageFlags;
+    VkExtent3D extent;
+    uint32_t firstUse;
+    uint32_t lastUse;
+};
+
+struct AliasedImage {
+    AllocatedImage image;       // image.allocation is the shared allocation and must not be freed on its own
+    uint32_t allocationIndex;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+};
+
+struct AliasedImageGroup {
+    std::vector<VmaAllocation> allocations;
+    std::vector<AliasedImage> images;   // in the order of the descs they were created from
+    VkDeviceSize allocatedSize = 0;
+    VkDeviceSize unaliasedSize = 0;     // what separate allocations would have needed
 };
 
+/**
+ * @brief Returns the aspects a view of the whole image should cover for format.
+ */
+VkImageAspectFlags getGenericAspectMask(VkFormat format);
+
 /**
  * @class ResourceManager
- * @brief
+ * @brief Owns the VMA allocator and creates, uploads to and destroys GPU images and buffers.
  * 
+ * Uploads are staged in a persistently mapped ring buffer and batched: enqueue* calls only copy into the ring,
+ * submitUploads() then records every pending copy with one vkCmdCopyBuffer2 per destination buffer and submits
+ * them on the transfer queue, signaling a timeline semaphore. The graphics side calls recordUploadAcquires() and
+ * waits on the returned timeline value. When the transfer queue belongs to its own family, ownership of every
+ * uploaded range is released by the transfer queue and acquired by the graphics queue; with a single family
+ * (e.g. lavapipe) the semaphore wait alone orders the copies before their use.
  * 
+ * Data whose destination can't be allocated yet is assembled in intermediate buffers, which stay with the transfer
+ * queue, and copied into place on the GPU with enqueueBufferCopy() once it can.
  */
 class ResourceManager {
 public:
     /**
      * @brief Initializes this class. Must be called before calling another other ResourceManager functions.
      */
-    void init(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device);
+    void init(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, uint32_t graphicsFamilyIndex,
+              uint32_t transferFamilyIndex, VkQueue transferQueue);
 
     /**
      * @brief Cleans up this class. No calls may be used again after calling cleanup.
@@ -47,13 +92,164 @@ public:
 
     void destroyAllocatedImage(AllocatedImage allocatedImage);
 
+    /**
+     * @brief Creates device local images, placing images whose use intervals don't overlap in the same memory.
+     * 
+     * Images with compatible memory types share one allocation. Each image's contents are undefined at its first use,
+     * and the caller must order accesses to overlapping memory (see AliasedImage offsets) across use intervals.
+     */
+    AliasedImageGroup allocateAliasedImages(const std::vector<AliasedImageDesc>& descs);
+
+    void destroyAliasedImages(AliasedImageGroup& group);
+
+    /**
+     * @brief Allocates a buffer. Pass VMA_ALLOCATION_CREATE_HOST_ACCESS_* | VMA_ALLOCATION_CREATE_MAPPED_BIT flags
+     * to request a persistently mapped buffer, in which case mappedData is set if mapping succeeded.
+     */
+    AllocatedBuffer allocateBuffer(VkDeviceSize size, VkBufferUsageFlags usageFlags, VmaAllocationCreateFlags allocationFlags = 0);
+
+    void destroyAllocatedBuffer(AllocatedBuffer allocatedBuffer);
+
+    /**
+     * @brief Returns the device address of a buffer created with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT.
+     */
+    VkDeviceAddress getBufferAddress(const AllocatedBuffer& buffer) const;
+
+    /**
+     * @brief Stages up to size bytes for a copy into dst at dstOffset. Returns the number of bytes accepted.
+     * 
+     * Mapped destinations are written directly and always accepted in full. Otherwise as much as fits in the
+     * staging ring is accepted; the caller retries the remainder on a later frame or after flushUploads().
+     * The destination must not be in use by the GPU until the copies have been acquired.
+     */
+    VkDeviceSize enqueueBufferUpload(const AllocatedBuffer& dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+    /**
+     * @brief Like enqueueBufferUpload(), but returns where the caller writes the accepted bytes instead of copying
+     * them from memory. accepted is set to how many bytes were reserved, a multiple of granularity when size is one;
+     * the result is null if none were.
+     * 
+     * The reserved memory is flushed by the next submitUploads(), so it must be written before then.
+     */
+    void* reserveBufferUpload(const AllocatedBuffer& dst, VkDeviceSize dstOffset, VkDeviceSize size, VkDeviceSize granularity,
+                              VkDeviceSize& accepted);
+
+    /**
+     * @brief Allocates a buffer that only the transfer queue uses, to assemble uploads whose final destination
+     * isn't known yet. Uploads into it stay owned by the transfer queue, so enqueueBufferCopy() can read them.
+     * 
+     * Host visible memory is used when available, so reserveBufferUpload() writes it directly.
+     */
+    AllocatedBuffer allocateIntermediateBuffer(VkDeviceSize size);
+
+    /**
+     * @brief Destroys an intermediate buffer once every upload enqueued so far, including copies out of it, has
+     * finished.
+     */
+    void destroyIntermediateBuffer(const AllocatedBuffer& buffer);
+
+    /**
+     * @brief Copies size bytes from an intermediate buffer into dst with the next submitUploads(), after every
+     * upload into src submitted before or with it.
+     */
+    void enqueueBufferCopy(const AllocatedBuffer& src, VkDeviceSize srcOffset, const AllocatedBuffer& dst, VkDeviceSize dstOffset,
+                           VkDeviceSize size);
+
+    /**
+     * @brief Submits every pending copy on the transfer queue.
+     */
+    void submitUploads();
+
+    /**
+     * @brief Records the graphics side of every upload submitted since the last call into buf.
+     * 
+     * Returns the upload timeline value the submission containing buf must wait on (at
+     * VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT), or 0 if nothing was uploaded.
+     */
+    uint64_t recordUploadAcquires(VkCommandBuffer buf);
+
+    VkSemaphore getUploadSemaphore() const { return uploadSemaphore; }
+
+    /**
+     * @brief Frees the staging memory and the intermediate buffers of every upload submission the transfer queue
+     * has finished.
+     */
+    void retireUploads();
+
+    /**
+     * @brief Submits the pending copies and waits for them to finish.
+     * 
+     * For blocking loads (startup, headless runs); all staging memory is free afterwards. The copies still
+     * have to be acquired with recordUploadAcquires() before use.
+     */
+    void flushUploads();
+
 private:
     VkInstance _instance;
     VkPhysicalDevice _physicalDevice;
     VkDevice _device;
+    uint32_t _graphicsFamilyIndex;
+    uint32_t _transferFamilyIndex;
+    VkQueue _transferQueue;
 
     VmaAllocator allocator;
 
+    struct UploadBatch {
+        VkCommandBuffer commandBuffer;
+        uint64_t timelineValue;     // reusable once the upload semaphore reaches this value
+    };
+
+    VkCommandPool uploadCommandPool = VK_NULL_HANDLE;
+    std::vector<UploadBatch> uploadBatches;
+
+    VkSemaphore uploadSemaphore = VK_NULL_HANDLE;
+    uint64_t uploadTimelineValue = 0;   // value signaled by the most recent upload submission
+    uint64_t unacquiredTimelineValue = 0;
+
+    std::vector<VkBufferMemoryBarrier2> pendingBufferAcquires;
+
+    struct PendingBufferCopy {
+        VkBuffer src;       // stagingBuffer, or an intermediate buffer
+        VkBuffer dst;
+        VkBufferCopy2 region;
+    };
+
+    struct PendingFlush {
+        VmaAllocation allocation;
+        VkDeviceSize offset;
+        VkDeviceSize size;
+    };
+
+    struct RetiringBuffer {
+        AllocatedBuffer buffer;
+        uint64_t timelineValue;     // destroyed once the upload semaphore reaches this value
+    };
+
+    struct RingSubmission {
+        uint64_t timelineValue;
+        uint64_t allocatedEnd;
+    };
+
+    // Ring positions are monotonic byte counters; the offset into stagingBuffer is the counter modulo its size
+    AllocatedBuffer stagingBuffer{};
+    uint64_t stagingAllocated = 0;
+    uint64_t stagingRetired = 0;
+    std::deque<RingSubmission> stagingSubmissions;
+
+    std::vector<PendingBufferCopy> pendingBufferCopies;
+    std::vector<PendingFlush> pendingFlushes;
+
+    // Intermediate buffers are never released to the graphics queue; they stay listed until destroyed
+    std::vector<VkBuffer> intermediateBuffers;
+    std::vector<RetiringBuffer> retiringBuffers;
+
+    uint8_t* stageBufferUpload(const AllocatedBuffer& dst, VkDeviceSize dstOffset, VkDeviceSize size, VkDeviceSize granularity,
+                               PendingFlush& flush);
+    bool isIntermediateBuffer(VkBuffer buffer) const;
+    VkDeviceSize stagingContiguousSpace(VkDeviceSize& wrapPadding);
+    VkDeviceSize allocateStaging(VkDeviceSize size);
+    VkCommandBuffer acquireUploadCommandBuffer(uint64_t timelineValue);
+
 };
 
 } // namespace vkmv
@@ -0,0 +1,101 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_SHADERLIBRARY_HPP
+#define VKMV_SHADERLIBRARY_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vkmv/core/Device.hpp"
+#include "vkmv/core/ShaderModule.hpp"
+#include "vkmv/renderer/FrameTimeline.hpp"
+#include "vkmv/renderer/PipelineCache.hpp"
+
+namespace vkmv {
+
+/**
+ * @brief Builds a pipeline from its shader modules, given in the order their paths were registered.
+ */
+using PipelineBuilder = std::function<VkPipeline(PipelineCache& pipelineCache, const std::vector<std::shared_ptr<ShaderModule>>& shaders)>;
+
+using PipelineHandle = uint32_t;
+
+/**
+ * @class ShaderLibrary
+ * @brief Loads SPIR-V from the shader directory, deduplicates modules by content and hot reloads pipelines.
+ * 
+ * Shader files are addressed by their path relative to the shader directory. Two files with identical
+ * bytecode share a single VkShaderModule. Pipelines are registered with the shader paths they use and a
+ * builder; when the watcher sees one of those files change, processReloads() rebuilds only the pipelines
+ * that depend on it. A file that fails to load keeps the previous pipeline alive and is reported to stderr.
+ */
+class ShaderLibrary {
+public:
+    void init(Device* pDevice, PipelineCache* pPipelineCache, FrameTimeline* pFrameTimeline, const std::string& shaderDirectory);
+
+    void cleanup();
+
+    /**
+     * @brief Returns the module for a SPIR-V file, reusing any live module with the same bytecode.
+     */
+    std::shared_ptr<ShaderModule> load(const std::string& path);
+
+    /**
+     * @brief Builds a pipeline and keeps it up to date with its shader files. Throws a runtime error on failure.
+     */
+    PipelineHandle registerPipeline(const std::vector<std::string>& shaderPaths, PipelineBuilder builder);
+
+    VkPipeline getPipeline(PipelineHandle handle) const { return pipelines[handle].pipeline; }
+
+    /**
+     * @brief Rebuilds the pipelines affected by shader files changed since the last call. Returns true if any were rebuilt.
+     * 
+     * Replaced pipelines are retired on the frame timeline, since frames in flight may still use them. Must be
+     * called outside of command recording.
+     */
+    bool processReloads();
+
+private:
+    Device* device = nullptr;
+    PipelineCache* pipelineCache = nullptr;
+    FrameTimeline* frameTimeline = nullptr;
+    std::filesystem::path shaderDirectory;
+
+    std::unordered_map<std::string, std::shared_ptr<ShaderModule>> files;
+    std::unordered_map<uint64_t, std::weak_ptr<ShaderModule>> modulesByHash;
+
+    struct RegisteredPipeline {
+        std::vector<std::string> shaderPaths;
+        PipelineBuilder builder;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+    };
+    std::vector<RegisteredPipeline> pipelines;
+
+    std::thread watcher;
+    std::mutex watchMutex;
+    std::condition_variable watchCondition;
+    bool stopWatching = false;
+    std::set<std::string> changedPaths;
+
+    std::shared_ptr<ShaderModule> createModule(const std::vector<uint32_t>& code);
+    VkPipeline buildPipeline(const RegisteredPipeline& registered);
+    void watchShaderDirectory();
+};
+
+} // namespace vkmv
+
+#endif // VKMV_SHADERLIBRARY_HPP
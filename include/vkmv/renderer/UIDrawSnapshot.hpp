@@ -0,0 +1,48 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_UIDRAWSNAPSHOT_HPP
+#define VKMV_UIDRAWSNAPSHOT_HPP
+
+#include <vector>
+
+#include "imgui.h"
+
+namespace vkmv {
+
+/**
+ * @class UIDrawSnapshot
+ * @brief Owned copy of a frame's ImGui draw data.
+ * 
+ * ImGui::GetDrawData() points into buffers the next ImGui::NewFrame() reuses, so a frame recorded on another
+ * thread than the one building the UI draws a snapshot instead. Draw lists are kept between captures, so once
+ * their buffers have grown a capture only copies.
+ */
+class UIDrawSnapshot {
+public:
+    UIDrawSnapshot() = default;
+    ~UIDrawSnapshot();
+
+    UIDrawSnapshot(const UIDrawSnapshot&) = delete;
+    UIDrawSnapshot& operator=(const UIDrawSnapshot&) = delete;
+
+    /**
+     * @brief Copies the draw data of the current ImGui context's last rendered frame.
+     */
+    void capture(const ImDrawData* drawData);
+
+    /**
+     * @brief Returns the captured draw data, or nullptr if nothing was captured.
+     */
+    ImDrawData* getDrawData() { return m_drawData.Valid ? &m_drawData : nullptr; }
+
+private:
+    ImDrawData m_drawData;
+    std::vector<ImDrawList*> m_lists;
+};
+
+} // namespace vkmv
+
+#endif // VKMV_UIDRAWSNAPSHOT_HPP
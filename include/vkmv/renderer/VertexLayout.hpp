@@ -0,0 +1,153 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_VERTEXLAYOUT_HPP
+#define VKMV_VERTEXLAYOUT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <vulkan/vulkan.h>
+
+namespace vkmv {
+
+/**
+ * @brief Maps 16 bit unsigned normalized positions back to model space: position = unorm * scale + bias.
+ */
+struct PositionQuantization {
+    float scale[3] = {1.0f, 1.0f, 1.0f};
+    float bias[3] = {0.0f, 0.0f, 0.0f};
+};
+
+/**
+ * @brief Returns the quantization spanning the bounding box of tightly packed float3 positions.
+ */
+PositionQuantization computePositionQuantization(const float* positions, uint32_t vertexCount);
+
+/**
+ * @brief Decoded per vertex attributes a layout packs from, all tightly packed floats.
+ */
+struct VertexAttributes {
+    const float* positions = nullptr;       // 3 per vertex
+    const float* normals = nullptr;         // 3 per vertex, unit length
+    const float* tangents = nullptr;        // 4 per vertex, xyz and handedness; nullptr without tangents
+    const float* texcoords = nullptr;       // 2 per vertex
+    PositionQuantization quantization;
+};
+
+/*
+ * Attributes a VertexLayout is assembled from. Each one knows its Vulkan format, its size and how to pack one
+ * vertex; sizes are multiples of 4 so every attribute stays word aligned for vertex pulling.
+ */
+
+/**
+ * @brief Position quantized to 16 bits per axis over the primitive's bounds. w is 1 so that
+ * dequantization can be applied as an affine matrix.
+ */
+struct QuantizedPosition {
+    static constexpr VkFormat format = VK_FORMAT_R16G16B16A16_UNORM;
+    static constexpr uint32_t size = 8;
+    static void pack(const VertexAttributes& source, uint32_t vertex, uint8_t* destination);
+};
+
+/**
+ * @brief Normal and tangent in one word. xy is the octahedral encoded normal, z the tangent's angle around the
+ * normal (divided by pi) in a basis derived from the decoded normal, w the bitangent handedness.
+ */
+struct TangentFrame {
+    static constexpr VkFormat format = VK_FORMAT_R8G8B8A8_SNORM;
+    static constexpr uint32_t size = 4;
+    static void pack(const VertexAttributes& source, uint32_t vertex, uint8_t* destination);
+};
+
+/**
+ * @brief Texture coordinates as half floats, which keeps wrapping UVs outside 0..1 intact.
+ */
+struct HalfTexcoord {
+    static constexpr VkFormat format = VK_FORMAT_R16G16_SFLOAT;
+    static constexpr uint32_t size = 4;
+    static void pack(const VertexAttributes& source, uint32_t vertex, uint8_t* destination);
+};
+
+/**
+ * @class VertexLayout
+ * @brief An interleaved vertex made of the given attributes, in order.
+ * 
+ * Stride, offsets and the Vulkan attribute descriptions are computed at compile time, and pack() is
+ * specialized per layout so the per vertex loop has no runtime format switches.
+ */
+template<typename... Attributes>
+struct VertexLayout {
+    static constexpr uint32_t attributeCount = sizeof...(Attributes);
+    static constexpr uint32_t stride = (Attributes::size + ...);
+
+    template<typename Attribute>
+    static constexpr uint32_t offsetOf() {
+        static_assert((std::is_same_v<Attribute, Attributes> || ...), "Attribute is not part of this layout!");
+
+        uint32_t offset = 0;
+        bool found = false;
+        ((found = found || std::is_same_v<Attribute, Attributes>, offset += found ? 0 : Attributes::size), ...);
+        return offset;
+    }
+
+    static constexpr VkVertexInputBindingDescription bindingDescription(uint32_t binding) {
+        return VkVertexInputBindingDescription{binding, stride, VK_VERTEX_INPUT_RATE_VERTEX};
+    }
+
+    /**
+     * @brief One description per attribute; locations follow the attribute order.
+     */
+    static constexpr std::array<VkVertexInputAttributeDescription, attributeCount> attributeDescriptions(uint32_t binding) {
+        std::array<VkVertexInputAttributeDescription, attributeCount> descriptions{};
+        uint32_t location = 0;
+        uint32_t offset = 0;
+        ((descriptions[location] = VkVertexInputAttributeDescription{location, binding, Attributes::format, offset},
+          location++, offset += Attributes::size), ...);
+        return descriptions;
+    }
+
+    static void pack(const VertexAttributes& source, uint32_t vertexCount, uint8_t* destination) {
+        for(uint32_t v = 0; v < vertexCount; v++) {
+            uint8_t* vertex = destination + static_cast<size_t>(v) * stride;
+            uint32_t offset = 0;
+            ((Attributes::pack(source, v, vertex + offset), offset += Attributes::size), ...);
+        }
+    }
+};
+
+// Layouts geometry is imported into; shaders/scene.glsl decodes both
+using CompactVertex = VertexLayout<QuantizedPosition, TangentFrame>;
+using TexturedCompactVertex = VertexLayout<QuantizedPosition, TangentFrame, HalfTexcoord>;
+
+static_assert(CompactVertex::stride == 12 && TexturedCompactVertex::stride == 16, "Compact vertices grew!");
+
+enum VertexFormat : uint32_t {
+    VERTEX_FORMAT_COMPACT = 0,              // CompactVertex
+    VERTEX_FORMAT_COMPACT_TEXTURED = 1,     // TexturedCompactVertex
+    VERTEX_FORMAT_COUNT = 2,
+};
+
+/**
+ * @brief Runtime view of a layout, for code that only knows a VertexFormat.
+ */
+struct VertexFormatInfo {
+    uint32_t stride;
+    const VkVertexInputAttributeDescription* attributes;    // binding 0
+    uint32_t attributeCount;
+};
+
+VertexFormatInfo getVertexFormatInfo(VertexFormat format);
+
+/**
+ * @brief Packs vertexCount vertices into destination with the layout of format.
+ */
+void packVertices(VertexFormat format, const VertexAttributes& source, uint32_t vertexCount, uint8_t* destination);
+
+} // namespace vkmv
+
+#endif // VKMV_VERTEXLAYOUT_HPP
@@ -0,0 +1,126 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_CPUTRACE_HPP
+#define VKMV_CPUTRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VKMV_TRACE_TSC 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace vkmv {
+
+/**
+ * @brief Reads the trace clock: the time stamp counter on x86, which is far cheaper than the steady clock, and
+ * steady clock nanoseconds elsewhere.
+ */
+inline uint64_t readTraceClock() {
+#ifdef VKMV_TRACE_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/**
+ * @brief Escapes a string for a JSON string literal in a trace: quotes and backslashes are escaped, control
+ * characters dropped.
+ */
+std::string escapeTraceString(const std::string& string);
+
+/**
+ * @brief Writes further trace events to a trace being finished, each preceded by a comma.
+ */
+using TraceEventWriter = std::function<void(std::ostream& out)>;
+
+/**
+ * @class CpuTracer
+ * @brief Collects scopes timed on any thread into a Chrome trace (chrome://tracing, Perfetto).
+ * 
+ * Every thread records into a ring buffer of its own, which only that thread writes and only the flushing thread
+ * reads, so recording takes no lock: a scope costs two clock reads and one ring write. The flushing thread drains the
+ * rings every few milliseconds and appends their events to the trace file. A ring that fills up between flushes drops
+ * events, which are counted and reported when the trace stops.
+ * 
+ * Scopes cost one relaxed load while no trace is running. Times are microseconds since tracing was first used, the
+ * clock getMicroseconds() reads, so other timelines (e.g. the GPU's) can be placed alongside.
+ */
+class CpuTracer {
+public:
+    /**
+     * @brief Starts writing a trace to path. Throws a runtime error if the file can't be opened.
+     */
+    static void start(const std::string& path);
+
+    /**
+     * @brief Flushes every ring, lets appendEvents add its own events and closes the trace. Does nothing if no
+     * trace is running.
+     */
+    static void stop(const TraceEventWriter& appendEvents = nullptr);
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Names the calling thread's track in traces.
+     */
+    static void setThreadName(const std::string& name);
+
+    /**
+     * @brief Records a scope of the calling thread. name must outlive the trace, e.g. be a string literal.
+     */
+    static void record(const char* name, uint64_t begin, uint64_t end);
+
+    /**
+     * @brief Returns the time on the trace's clock, in microseconds.
+     */
+    static double getMicroseconds();
+
+private:
+    static inline std::atomic<bool> s_enabled{false};
+};
+
+/**
+ * @brief Records the time from its construction to its destruction while a trace is running.
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : m_name(name), m_begin(CpuTracer::isEnabled() ? readTraceClock() : 0) {}
+
+    ~TraceScope() {
+        if(m_begin != 0) CpuTracer::record(m_name, m_begin, readTraceClock());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_begin;
+};
+
+} // namespace vkmv
+
+// Traces the rest of the enclosing scope under name, a string literal. Defining VKMV_DISABLE_TRACE compiles it out.
+#ifdef VKMV_DISABLE_TRACE
+#define VKMV_TRACE_SCOPE(name) ((void)0)
+#else
+#define VKMV_TRACE_CONCAT_INNER(a, b) a##b
+#define VKMV_TRACE_CONCAT(a, b) VKMV_TRACE_CONCAT_INNER(a, b)
+#define VKMV_TRACE_SCOPE(name) ::vkmv::TraceScope VKMV_TRACE_CONCAT(vkmvTraceScope, __LINE__)(name)
+#endif
+
+#endif // VKMV_CPUTRACE_HPP
@@ -0,0 +1,125 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_JOBSYSTEM_HPP
+#define VKMV_JOBSYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vkmv {
+
+/**
+ * @brief Counts the outstanding jobs of a group. A group is done when the count returns to zero.
+ */
+class JobCounter {
+public:
+    bool isDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> m_pending{0};
+};
+
+/**
+ * @class JobSystem
+ * @brief Fixed pool of worker threads with per-worker work-stealing deques.
+ * 
+ * Jobs submitted from a worker go to the bottom of that worker's deque and are popped LIFO for cache
+ * locality; idle workers steal FIFO from the top of other deques. Jobs submitted from any other thread
+ * (e.g. the render loop) go through a shared injection queue. Workers sleep when there is no work.
+ * 
+ * wait() runs other jobs instead of blocking, so jobs may wait on the jobs they spawn.
+ */
+class JobSystem {
+public:
+    using JobFunction = std::function<void()>;
+
+    /**
+     * @brief Starts workerCount threads. 0 uses one thread per hardware thread, minus one for the caller.
+     */
+    explicit JobSystem(unsigned int workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * @brief Queues fn for execution. If counter is given, it is incremented now and decremented once fn returns.
+     */
+    void submit(JobFunction fn, JobCounter* counter = nullptr);
+
+    /**
+     * @brief Calls fn(begin, end) over [0, count) in chunks of at most grainSize, in parallel.
+     */
+    void parallelFor(uint32_t count, uint32_t grainSize, std::function<void(uint32_t, uint32_t)> fn, JobCounter* counter);
+
+    /**
+     * @brief Returns once counter is done, executing queued jobs in the meantime.
+     */
+    void wait(JobCounter& counter);
+
+    unsigned int getWorkerCount() const { return static_cast<unsigned int>(m_workers.size()); }
+
+    /**
+     * @brief Returns the calling worker's index, or getWorkerCount() on threads that are not workers of this
+     * system. Those threads share the one index, so only one of them at a time may use per thread resources.
+     */
+    unsigned int getThreadIndex() const;
+
+private:
+    struct Job {
+        JobFunction fn;
+        JobCounter* counter;
+    };
+
+    /**
+     * Chase-Lev deque with a fixed capacity. push/pop are owner-only, steal may be called from any thread.
+     */
+    class WorkStealingDeque {
+    public:
+        static constexpr int64_t CAPACITY = 4096;
+
+        bool push(Job* job);
+        Job* pop();
+        Job* steal();
+
+    private:
+        alignas(64) std::atomic<int64_t> m_top{0};
+        alignas(64) std::atomic<int64_t> m_bottom{0};
+        std::atomic<Job*> m_buffer[CAPACITY] = {};
+    };
+
+    struct Worker {
+        WorkStealingDeque deque;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    std::mutex m_injectionMutex;
+    std::deque<Job*> m_injectionQueue;
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCondition;
+    std::atomic<uint32_t> m_queuedJobs{0};
+    std::atomic<bool> m_running{true};
+
+    void enqueue(Job* job);
+    Job* findJob();
+    void execute(Job* job);
+    void workerLoop(unsigned int index);
+};
+
+} // namespace vkmv
+
+#endif // VKMV_JOBSYSTEM_HPP
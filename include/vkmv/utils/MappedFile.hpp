@@ -0,0 +1,69 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_MAPPEDFILE_HPP
+#define VKMV_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace vkmv {
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a file with RAII principles.
+ * 
+ * Pages are only faulted in when touched, so large files can be read without ever being copied onto
+ * the heap. prefetch() and release() let callers stream through a file while keeping resident memory low.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief Maps the whole file at path. Throws a runtime error on failure.
+     */
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const uint8_t* data() const { return m_data; }
+
+    size_t size() const { return m_size; }
+
+    /**
+     * @brief Hints that the given range will be read soon.
+     */
+    void prefetch(const void* ptr, size_t size) const;
+
+    /**
+     * @brief Hints that the given range is no longer needed so its pages can be dropped from memory.
+     */
+    void release(const void* ptr, size_t size) const;
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+
+    void unmap();
+};
+
+} // namespace vkmv
+
+#endif // VKMV_MAPPEDFILE_HPP
@@ -0,0 +1,41 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_MATH_HPP
+#define VKMV_MATH_HPP
+
+namespace vkmv {
+
+// Matrices are column major float[16], matching glTF and GLSL
+
+void multiplyMatrices(const float a[16], const float b[16], float out[16]);
+
+/**
+ * @brief Right handed perspective projection into Vulkan clip space (y down, depth 0 at zNear to 1 at zFar).
+ */
+void perspectiveMatrix(float fovY, float aspect, float zNear, float zFar, float out[16]);
+
+void lookAtMatrix(const float eye[3], const float target[3], const float up[3], float out[16]);
+
+/**
+ * @brief Extracts the 6 frustum planes (left, right, bottom, top, near, far) from a view projection matrix.
+ * 
+ * Planes are normalized with normals pointing inwards, so a sphere is outside if dot(n, c) + d < -r for any plane.
+ */
+void extractFrustumPlanes(const float viewProjection[16], float planes[6][4]);
+
+/**
+ * @brief Returns the length of the longest of the transform's three axes, i.e. its largest scale factor.
+ */
+float getMaxScale(const float transform[16]);
+
+/**
+ * @brief Returns a sphere enclosing the given sphere after transform, scaling the radius by the largest axis scale.
+ */
+void transformSphere(const float transform[16], const float center[3], float radius, float outCenter[3], float* outRadius);
+
+} // namespace vkmv
+
+#endif // VKMV_MATH_HPP
@@ -0,0 +1,118 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#ifndef VKMV_TRIPLEBUFFER_HPP
+#define VKMV_TRIPLEBUFFER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace vkmv {
+
+/**
+ * @class TripleBuffer
+ * @brief Hands values from one writer thread to one reader thread without either waiting on the other's work.
+ * 
+ * Of the three slots, the writer owns one and the reader owns one; the third is the last published. Publishing
+ * and reading each swap their own slot with the published one in a single atomic exchange, so neither side ever
+ * touches a slot the other is using. A flag in the same atomic tells whether the published slot is new.
+ * 
+ * The waits only sleep until the other side's next exchange; the mutex guards nothing but the sleep itself.
+ */
+template<typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    T& getWriteSlot() { return m_slots[m_back]; }
+    T& getReadSlot() { return m_slots[m_front]; }
+
+    /**
+     * @brief Publishes the write slot and takes the previously published one to write next.
+     * 
+     * Returns true if that slot was never read, in which case it still holds the dropped value.
+     */
+    bool publish() {
+        uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_back | FRESH_BIT), std::memory_order_acq_rel);
+        m_back = previous & INDEX_MASK;
+        notify();
+        return (previous & FRESH_BIT) != 0;
+    }
+
+    /**
+     * @brief Makes the newest published value the read slot. Returns false, keeping the read slot, if nothing
+     * was published since the last read.
+     */
+    bool read() {
+        if(!(m_middle.load(std::memory_order_relaxed) & FRESH_BIT)) return false;
+
+        uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & INDEX_MASK;
+        notify();
+        return true;
+    }
+
+    /**
+     * @brief Reader side: blocks until a new value is published, then reads it. Returns false once the buffer is
+     * closed and every published value has been read.
+     */
+    bool waitAndRead() {
+        {
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleepCondition.wait(lock, [this]() { return isFresh() || m_closed.load(std::memory_order_acquire); });
+        }
+        return read();
+    }
+
+    /**
+     * @brief Writer side: blocks until the last published value has been read. Returns false if the buffer was
+     * closed instead.
+     */
+    bool waitForRead() {
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepCondition.wait(lock, [this]() { return !isFresh() || m_closed.load(std::memory_order_acquire); });
+        return !m_closed.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Wakes both sides for good. Either side may close, e.g. when it stops on an error.
+     */
+    void close() {
+        m_closed.store(true, std::memory_order_release);
+        notify();
+    }
+
+    bool isClosed() const { return m_closed.load(std::memory_order_acquire); }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH_BIT = 0x4;
+
+    T m_slots[3];
+    uint8_t m_front = 0;                    // reader's slot
+    uint8_t m_back = 2;                     // writer's slot
+    std::atomic<uint8_t> m_middle{1};       // published slot, with FRESH_BIT until it is read
+
+    std::atomic<bool> m_closed{false};
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCondition;
+
+    bool isFresh() const { return (m_middle.load(std::memory_order_acquire) & FRESH_BIT) != 0; }
+
+    void notify() {
+        // Taking the lock orders this notify after a sleeping side's predicate check
+        { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+        m_sleepCondition.notify_all();
+    }
+};
+
+} // namespace vkmv
+
+#endif // VKMV_TRIPLEBUFFER_HPP
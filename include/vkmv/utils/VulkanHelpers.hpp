@@ -10,8 +10,6 @@
 
 namespace vkmv {
 
-void transitionImageLayout(VkCommandBuffer buf, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout);
-
 void blitImageToImage(VkCommandBuffer buf, VkImage src, VkImage dst, VkExtent3D srcSize, VkExtent3D dstSize);
 
 } // namespace vkmv
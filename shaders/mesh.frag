@@ -0,0 +1,19 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#version 460
+
+layout(location = 0) in vec3 inNormal;
+
+layout(location = 0) out vec4 outColor;
+
+const vec3 LIGHT_DIRECTION = vec3(0.4, 0.8, 0.45);
+
+void main() {
+    vec3 normal = normalize(inNormal);
+    float diffuse = abs(dot(normal, normalize(LIGHT_DIRECTION)));
+
+    outColor = vec4(vec3(0.8) * (0.2 + 0.8 * diffuse), 1.0);
+}
@@ -0,0 +1,28 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#version 460
+#extension GL_GOOGLE_include_directive : require
+
+#include "scene.glsl"
+
+layout(push_constant) uniform DrawConstants {
+    mat4 viewProjection;
+    SceneHeader scene;
+} pc;
+
+layout(location = 0) out vec3 outNormal;
+
+// Vertices are pulled from the model's geometry buffer, so one pipeline draws every primitive layout
+void main() {
+    GpuDrawItem item = DrawItems(pc.scene.drawItems).drawItems[gl_InstanceIndex];
+    GpuPrimitive primitive = Primitives(pc.scene.primitives).primitives[item.primitive];
+    mat4 transform = Transforms(pc.scene.transforms).transforms[item.instance];
+
+    vec3 position = loadPosition(pc.scene, primitive, gl_VertexIndex);
+
+    gl_Position = pc.viewProjection * transform * vec4(position, 1.0);
+    outNormal = mat3(transform) * loadNormal(pc.scene, primitive, gl_VertexIndex);
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+// Meshlet culling and decoding shared by the task/mesh shader path and the compute/indirect fallback.
+// Include after scene.glsl.
+
+struct TaskPayload {
+    uint drawItem;
+    uint meshlets[MESHLETS_PER_TASK];
+};
+
+// Normalized, inward facing planes from a column major view projection with 0..1 depth
+void extractFrustumPlanes(mat4 m, out vec4 planes[6]) {
+    vec4 row0 = vec4(m[0][0], m[1][0], m[2][0], m[3][0]);
+    vec4 row1 = vec4(m[0][1], m[1][1], m[2][1], m[3][1]);
+    vec4 row2 = vec4(m[0][2], m[1][2], m[2][2], m[3][2]);
+    vec4 row3 = vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    planes[0] = row3 + row0;
+    planes[1] = row3 - row0;
+    planes[2] = row3 + row1;
+    planes[3] = row3 - row1;
+    planes[4] = row2;
+    planes[5] = row3 - row2;
+
+    for(int p = 0; p < 6; p++) planes[p] /= length(planes[p].xyz);
+}
+
+bool isMeshletVisible(GpuMeshlet meshlet, mat4 transform, vec4 planes[6], vec3 cameraPosition) {
+    vec3 center = (transform * vec4(meshlet.sphere.xyz, 1.0)).xyz;
+    vec3 scale = vec3(length(transform[0].xyz), length(transform[1].xyz), length(transform[2].xyz));
+    float maxScale = max(scale.x, max(scale.y, scale.z));
+    float minScale = min(scale.x, min(scale.y, scale.z));
+    float radius = meshlet.sphere.w * maxScale;
+
+    for(int p = 0; p < 6; p++) {
+        if(dot(planes[p].xyz, center) + planes[p].w < -radius) return false;
+    }
+
+    // Cones only survive uniform scale; mirroring flips the winding and with it the axis
+    if(meshlet.cone.w < 1.0 && maxScale <= minScale * 1.001) {
+        mat3 linear = mat3(transform);
+        vec3 axis = normalize(linear * meshlet.cone.xyz) * sign(determinant(linear));
+        vec3 toCenter = center - cameraPosition;
+        if(dot(toCenter, axis) >= meshlet.cone.w * length(toCenter) + radius) return false;
+    }
+
+    return true;
+}
+
+// Unpacks a triangle's meshlet local vertex indices, reversing the winding for mirrored instances
+uvec3 meshletTriangle(uint packed, bool mirrored) {
+    uvec3 triangle = uvec3(packed & 0xFF, (packed >> 8) & 0xFF, (packed >> 16) & 0xFF);
+    return mirrored ? triangle.xzy : triangle;
+}
@@ -0,0 +1,36 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#version 460
+#extension GL_GOOGLE_include_directive : require
+
+#include "scene.glsl"
+#include "meshlet.glsl"
+
+layout(buffer_reference, std430) readonly buffer VisibleClusters { uvec2 clusters[]; };
+
+layout(push_constant) uniform MeshletDrawConstants {
+    mat4 viewProjection;
+    SceneHeader scene;
+    VisibleClusters clusters;
+} pc;
+
+layout(location = 0) out vec3 outNormal;
+
+// Draws one meshlet per instance of a non-indexed draw; gl_VertexIndex walks the meshlet's triangles
+void main() {
+    uvec2 cluster = pc.clusters.clusters[gl_InstanceIndex];
+    GpuDrawItem item = DrawItems(pc.scene.drawItems).drawItems[cluster.x];
+    GpuPrimitive primitive = Primitives(pc.scene.primitives).primitives[item.primitive];
+    mat4 transform = Transforms(pc.scene.transforms).transforms[item.instance];
+
+    GpuMeshlet meshlet = Meshlets(pc.scene.geometry + primitive.meshletOffset).meshlets[cluster.y];
+    uint packed = MeshletTriangles(pc.scene.geometry + primitive.meshletTriangleOffset).meshletTriangles[meshlet.triangleOffset + gl_VertexIndex / 3];
+    uvec3 triangle = meshletTriangle(packed, determinant(mat3(transform)) < 0.0);
+    uint vertex = MeshletVertices(pc.scene.geometry + primitive.meshletVertexOffset).meshletVertices[meshlet.vertexOffset + triangle[gl_VertexIndex % 3]];
+
+    gl_Position = pc.viewProjection * transform * vec4(loadPosition(pc.scene, primitive, vertex), 1.0);
+    outNormal = mat3(transform) * loadNormal(pc.scene, primitive, vertex);
+}
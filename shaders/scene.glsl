@@ -0,0 +1,146 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+// Shared layout of the GPU scene; must match the Gpu* structs in GpuScene.hpp
+
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+
+#define STREAM_INDEXED_UINT16 0
+#define STREAM_INDEXED_UINT32 1
+#define STREAM_NON_INDEXED 2
+#define STREAM_COUNT 3
+
+struct GpuDrawItem {
+    vec4 sphere;            // model space center and radius
+    uint instance;
+    uint primitive;
+    uint pad0;
+    uint pad1;
+};
+
+struct GpuPrimitive {
+    uint indexCount;
+    uint firstIndex;
+    uint vertexCount;
+    uint vertexOffset;      // compact vertices, see VertexLayout.hpp
+    uint vertexStride;
+    uint stream;
+    uint meshletCount;      // 0 when the primitive is drawn whole by the indirect streams
+    uint meshletOffset;
+    uint meshletVertexOffset;
+    uint meshletTriangleOffset;
+    uint lodCount;          // detail levels among the meshlets
+    uint pad;
+    vec4 dequantScale;      // position = unorm16 position * scale + bias
+    vec4 dequantBias;
+};
+
+struct GpuMeshlet {
+    uint vertexOffset;
+    uint triangleOffset;
+    uint vertexCount;
+    uint triangleCount;
+    vec4 sphere;            // model space center and radius
+    vec4 cone;              // axis and cutoff
+};
+
+// A task covers up to MESHLETS_PER_TASK consecutive meshlets of one detail level of a draw item
+struct GpuClusterTask {
+    uint drawItem;
+    uint firstMeshlet;
+    uint meshletCount;
+    uint lod;
+};
+
+#define MESHLETS_PER_TASK 32
+
+// The counts buffer holds one count per stream, then the visible meshlet count of the fallback path
+#define CLUSTER_COUNT_SLOT STREAM_COUNT
+
+layout(buffer_reference, std430) readonly buffer DrawItems { GpuDrawItem drawItems[]; };
+layout(buffer_reference, std430) readonly buffer Primitives { GpuPrimitive primitives[]; };
+layout(buffer_reference, std430) readonly buffer Transforms { mat4 transforms[]; };
+layout(buffer_reference, std430) readonly buffer ClusterTasks { GpuClusterTask clusterTasks[]; };
+layout(buffer_reference, std430) readonly buffer Meshlets { GpuMeshlet meshlets[]; };
+layout(buffer_reference, std430) readonly buffer MeshletVertices { uint meshletVertices[]; };
+layout(buffer_reference, std430) readonly buffer MeshletTriangles { uint meshletTriangles[]; };
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer CompactVertex { uint words[4]; };
+
+// Detail level chosen for each instance this frame
+layout(buffer_reference, std430) readonly buffer LodSelections { uint lods[]; };
+
+layout(buffer_reference, std430) readonly buffer SceneHeader {
+    uint64_t drawItems;
+    uint64_t primitives;
+    uint64_t transforms;
+    uint64_t geometry;
+    uint64_t clusterTasks;
+    uint drawItemCount;
+    uint clusterTaskCount;
+    uint streamBase[STREAM_COUNT];
+};
+
+// Selection of an instance the CPU already culled
+#define LOD_CULLED 0xFFFFFFFFu
+
+// A task only culls if its level is the one selected for the instance, or the primitive's coarsest below that
+bool isTaskLodSelected(GpuClusterTask task, GpuDrawItem item, GpuPrimitive primitive, LodSelections selections) {
+    uint selected = selections.lods[item.instance];
+    return selected != LOD_CULLED && task.lod == min(selected, primitive.lodCount - 1);
+}
+
+// Compact vertex layouts: unorm16 x4 position, then snorm8 x4 tangent frame, then (if textured) half x2 UV
+#define VERTEX_POSITION_WORD 0
+#define VERTEX_FRAME_WORD 2
+#define VERTEX_TEXCOORD_WORD 3
+
+CompactVertex vertexAt(SceneHeader scene, GpuPrimitive primitive, uint vertex) {
+    return CompactVertex(scene.geometry + primitive.vertexOffset + uint64_t(vertex) * primitive.vertexStride);
+}
+
+// Matches octDecode in VertexLayout.cpp
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+// Matches tangentBasis in VertexLayout.cpp
+void tangentBasis(vec3 n, out vec3 b1, out vec3 b2) {
+    float s = n.z >= -0.001 ? 1.0 : -1.0;
+    float a = -1.0 / (s + n.z);
+    float b = n.x * n.y * a;
+    b1 = vec3(1.0 + s * n.x * n.x * a, s * b, -s * n.x);
+    b2 = vec3(b, s + n.y * n.y * a, -n.y);
+}
+
+vec3 loadPosition(SceneHeader scene, GpuPrimitive primitive, uint vertex) {
+    CompactVertex v = vertexAt(scene, primitive, vertex);
+    vec3 quantized = vec3(unpackUnorm2x16(v.words[VERTEX_POSITION_WORD]), unpackUnorm2x16(v.words[VERTEX_POSITION_WORD + 1]).x);
+    return quantized * primitive.dequantScale.xyz + primitive.dequantBias.xyz;
+}
+
+vec3 loadNormal(SceneHeader scene, GpuPrimitive primitive, uint vertex) {
+    vec4 frame = unpackSnorm4x8(vertexAt(scene, primitive, vertex).words[VERTEX_FRAME_WORD]);
+    return octDecode(frame.xy);
+}
+
+// xyz is the tangent, w the bitangent handedness
+vec4 loadTangent(SceneHeader scene, GpuPrimitive primitive, uint vertex) {
+    vec4 frame = unpackSnorm4x8(vertexAt(scene, primitive, vertex).words[VERTEX_FRAME_WORD]);
+    vec3 b1, b2;
+    tangentBasis(octDecode(frame.xy), b1, b2);
+
+    float angle = frame.z * 3.14159265;
+    return vec4(cos(angle) * b1 + sin(angle) * b2, frame.w);
+}
+
+// Only valid for textured layouts (vertexStride 16)
+vec2 loadTexcoord(SceneHeader scene, GpuPrimitive primitive, uint vertex) {
+    return unpackHalf2x16(vertexAt(scene, primitive, vertex).words[VERTEX_TEXCOORD_WORD]);
+}
@@ -3,39 +3,219 @@
 // This file is part of the vulkan-model-viewer project.
 // This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
 
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
 #include <SDL3/SDL_events.h>
 
 #include "vkmv/app/App.hpp"
+#include "vkmv/utils/CpuTrace.hpp"
+#include "vkmv/utils/TripleBuffer.hpp"
 
 namespace vkmv
 {
 
+// Parses the value following a numeric command line flag
+static unsigned int parseUnsignedArg(int argc, char* argv[], int& i) {
+    if(i + 1 >= argc) throw std::runtime_error(std::string("Missing value for argument: ") + argv[i]);
+
+    try {
+        return static_cast<unsigned int>(std::stoul(argv[++i]));
+    } catch(const std::exception&) {
+        throw std::runtime_error(std::string("Invalid value for argument: ") + argv[i - 1]);
+    }
+}
+
+struct LiveResizeWatch {
+    Window* window;
+    const std::function<bool()>* stepFrame;
+};
+
+// Some platforms block in SDL_PollEvent for the whole of a window resize drag and only report the new sizes to
+// event watches. Following them and drawing on every expose keeps frames coming at the new size during the drag.
+static bool SDLCALL onLiveResizeEvent(void* userdata, SDL_Event* event) {
+    LiveResizeWatch* watch = static_cast<LiveResizeWatch*>(userdata);
+
+    if(event->type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED) watch->window->handleEvent(*event);
+    if(event->type == SDL_EVENT_WINDOW_EXPOSED && event->window.windowID == SDL_GetWindowID(watch->window->getWindow())) {
+        (*watch->stepFrame)();
+    }
+    return true;
+}
+
 App::App(int argc, char* argv[]) {
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
 
+        if(arg == "--headless") {
+            headless = true;
+        } else if(arg == "--width") {
+            headlessWidth = parseUnsignedArg(argc, argv, i);
+        } else if(arg == "--height") {
+            headlessHeight = parseUnsignedArg(argc, argv, i);
+        } else if(arg == "--frames") {
+            headlessFrameCount = parseUnsignedArg(argc, argv, i);
+        } else if(arg == "--frames-in-flight") {
+            framesInFlight = parseUnsignedArg(argc, argv, i);
+        } else if(arg == "--serial") {
+            pipelined = false;
+        } else if(arg == "--trace") {
+            if(i + 1 >= argc) throw std::runtime_error("Missing value for argument: " + arg);
+            tracePath = argv[++i];
+        } else if(arg.rfind("--", 0) != 0 && modelPath.empty()) {
+            modelPath = arg;
+        } else {
+            throw std::runtime_error("Unknown argument: " + arg);
+        }
+    }
+
+    if(headlessWidth == 0 || headlessHeight == 0) throw std::runtime_error("Headless extent must be non-zero!");
+    if(framesInFlight == 0 || framesInFlight > MAX_FRAMES_IN_FLIGHT) {
+        throw std::runtime_error("Frames in flight must be between 1 and " + std::to_string(MAX_FRAMES_IN_FLIGHT) + "!");
+    }
 }
 
 App::~App() {
-
+    // Only reached with a trace still running if a run failed; it keeps the CPU side
+    CpuTracer::stop();
 }
 
 void App::run() {
-    RenderableState state;
+    if(!tracePath.empty()) CpuTracer::start(tracePath);
+    CpuTracer::setThreadName("Main");
+
+    if(headless) {
+        runHeadless();
+    } else {
+        runWindowed();
+    }
+}
 
+void App::runWindowed() {
     Window w;
-    Renderer renderer(w);
+    Renderer renderer(w, jobSystem, framesInFlight);
     Engine engine(renderer);
 
-    while(!w.shouldClose()) {
-        SDL_Event e;
-        while(SDL_PollEvent(&e) != false) {
-            w.handleEvent(e);
-            renderer.handleEvent(e);
-            engine.handleEvent(e);
+    if(!modelPath.empty()) renderer.importModel(modelPath, jobSystem);
+
+    runFrames(engine, renderer, [&](const std::function<bool()>& stepFrame) {
+        LiveResizeWatch watch{&w, &stepFrame};
+        SDL_AddEventWatch(onLiveResizeEvent, &watch);
+
+        {
+            VKMV_TRACE_SCOPE("Poll Events");
+
+            SDL_Event e;
+            while(SDL_PollEvent(&e) != false) {
+                w.handleEvent(e);
+                renderer.handleEvent(e);
+                engine.handleEvent(e);
+            }
         }
 
-        engine.update(state);
-        renderer.drawFrame(state);
+        SDL_RemoveEventWatch(onLiveResizeEvent, &watch);
+        return !w.shouldClose();
+    });
+
+    stopTrace(renderer);
+}
+
+/**
+ * Renders a fixed number of frames as fast as the device allows. No SDL subsystem is initialized, so this
+ * runs on machines without a display server (e.g. CI runners using lavapipe).
+ */
+void App::runHeadless() {
+    Renderer renderer(VkExtent2D{headlessWidth, headlessHeight}, jobSystem, framesInFlight);
+    Engine engine(renderer);
+
+    if(!modelPath.empty()) {
+        renderer.importModel(modelPath, jobSystem);
+        renderer.waitForImports();
+    }
+
+    unsigned int frame = 0;
+    runFrames(engine, renderer, [&](const std::function<bool()>&) { return frame++ < headlessFrameCount; });
+
+    stopTrace(renderer);
+}
+
+/**
+ * Updates and draws frames until beginFrame returns false. beginFrame runs on this thread before every update, and
+ * is given the step that updates and hands off one frame, should it need to produce frames itself while it runs.
+ * 
+ * Every step ends by waiting for the renderer's frame pacing, so the next frame's events are polled by beginFrame
+ * only once that frame may be queued, rather than going stale while it waits behind earlier frames.
+ */
+void App::runFrames(Engine& engine, Renderer& renderer, const FrameBeginFunc& beginFrame) {
+    if(!pipelined) {
+        RenderableState state;
+        std::function<bool()> stepFrame = [&]() {
+            engine.update(state);
+            renderer.drawFrame(state);
+            renderer.waitForFramePacing();
+            return true;
+        };
+
+        renderer.waitForFramePacing();
+        while(beginFrame(stepFrame) && stepFrame()) {}
+        return;
+    }
+
+    // The engine stays on this thread with SDL and ImGui; frames are recorded on a thread of their own
+    TripleBuffer<RenderableState> states;
+    std::exception_ptr renderError;
+
+    std::thread renderThread([&]() {
+        CpuTracer::setThreadName("Render");
+
+        try {
+            while(states.waitAndRead()) renderer.drawFrame(states.getReadSlot());
+        } catch(...) {
+            renderError = std::current_exception();
+        }
+        states.close();
+    });
+
+    // Frame N + 1 is built while frame N is recorded. Waiting for frame N to be taken first keeps the engine one
+    // frame ahead, so no frame is dropped and every frame's transform updates reach the GPU.
+    auto reserveFrame = [&]() {
+        {
+            VKMV_TRACE_SCOPE("Wait For Render Thread");
+            if(!states.waitForRead()) return false;
+        }
+        renderer.waitForFramePacing();
+        return true;
+    };
+
+    std::function<bool()> stepFrame = [&]() {
+        engine.update(states.getWriteSlot());
+        states.publish();
+        return reserveFrame();
+    };
+
+    try {
+        if(reserveFrame()) {
+            while(beginFrame(stepFrame) && stepFrame()) {}
+        }
+    } catch(...) {
+        states.close();
+        renderThread.join();
+        throw;
     }
+
+    // Frames already published are still drawn
+    states.close();
+    renderThread.join();
+    if(renderError) std::rethrow_exception(renderError);
+}
+
+/**
+ * Stops the trace while the renderer still holds the GPU's frames, and appends them on the trace's clock.
+ */
+void App::stopTrace(const Renderer& renderer) {
+    CpuTracer::stop([&](std::ostream& out) { renderer.getGpuProfiler().writeTraceEvents(out); });
 }
 
 } // namespace vkmv
@@ -10,9 +10,11 @@ namespace vkmv {
 Window::Window() {
     SDL_Init(SDL_INIT_VIDEO);
 
-    window = SDL_CreateWindow("Vulkan Model Viewer", 640, 480, SDL_WINDOW_VULKAN);
+    window = SDL_CreateWindow("Vulkan Model Viewer", 640, 480, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
 
     if(!window) throw std::runtime_error("Failed to create SDL3 window!"); 
+
+    refreshPixelExtent(false);
 }
 
 Window::~Window() {
@@ -23,6 +25,22 @@ Window::~Window() {
 void Window::handleEvent(SDL_Event event) {
     if(event.type == SDL_EVENT_QUIT) quit = true;
     if(event.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED && event.window.windowID == SDL_GetWindowID(window)) quit = true;
+
+    if(event.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED || event.type == SDL_EVENT_WINDOW_RESTORED) refreshPixelExtent(false);
+    if(event.type == SDL_EVENT_WINDOW_MINIMIZED) refreshPixelExtent(true);
+}
+
+VkExtent2D Window::getPixelExtent() const {
+    uint64_t extent = pixelExtent.load(std::memory_order_relaxed);
+    return VkExtent2D{static_cast<uint32_t>(extent >> 32), static_cast<uint32_t>(extent)};
+}
+
+void Window::refreshPixelExtent(bool minimized) {
+    // Some platforms keep reporting the last size while minimized, where there is nothing to present to
+    int w = 0, h = 0;
+    if(!minimized) SDL_GetWindowSizeInPixels(window, &w, &h);
+
+    pixelExtent.store((static_cast<uint64_t>(w) << 32) | static_cast<uint32_t>(h), std::memory_order_relaxed);
 }
 
 void Window::initWindow() {
@@ -0,0 +1,918 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/assets/GeometryProcessing.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+namespace vkmv {
+
+static inline uint32_t triangleVertex(const uint32_t* indices, uint32_t i) {
+    return indices ? indices[i] : i;
+}
+
+static inline void normalize3(float* v, const float* fallback) {
+    float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+
+    if(length > 1e-20f) {
+        v[0] /= length;
+        v[1] /= length;
+        v[2] /= length;
+    } else {
+        v[0] = fallback[0];
+        v[1] = fallback[1];
+        v[2] = fallback[2];
+    }
+}
+
+void generateNormals(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, float* normals) {
+    for(uint32_t i = 0; i < vertexCount * 3; i++) normals[i] = 0.0f;
+
+    for(uint32_t i = 0; i + 2 < indexCount; i += 3) {
+        uint32_t a = triangleVertex(indices, i);
+        uint32_t b = triangleVertex(indices, i + 1);
+        uint32_t c = triangleVertex(indices, i + 2);
+        if(a >= vertexCount || b >= vertexCount || c >= vertexCount) continue;
+
+        const float* pa = positions + a * 3;
+        const float* pb = positions + b * 3;
+        const float* pc = positions + c * 3;
+
+        float e1[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+        float e2[3] = {pc[0] - pa[0], pc[1] - pa[1], pc[2] - pa[2]};
+
+        // The unnormalized cross product weights each face by its area
+        float n[3] = {e1[1] * e2[2] - e1[2] * e2[1],
+                      e1[2] * e2[0] - e1[0] * e2[2],
+                      e1[0] * e2[1] - e1[1] * e2[0]};
+
+        for(uint32_t v : {a, b, c}) {
+            normals[v * 3 + 0] += n[0];
+            normals[v * 3 + 1] += n[1];
+            normals[v * 3 + 2] += n[2];
+        }
+    }
+
+    static const float up[3] = {0.0f, 1.0f, 0.0f};
+    for(uint32_t v = 0; v < vertexCount; v++) normalize3(normals + v * 3, up);
+}
+
+void generateTangents(const float* positions, const float* normals, const float* texcoords, uint32_t vertexCount,
+                      const uint32_t* indices, uint32_t indexCount, float* tangents) {
+    std::vector<float> bitangents(vertexCount * 3, 0.0f);
+    for(uint32_t i = 0; i < vertexCount * 4; i++) tangents[i] = 0.0f;
+
+    for(uint32_t i = 0; i + 2 < indexCount; i += 3) {
+        uint32_t a = triangleVertex(indices, i);
+        uint32_t b = triangleVertex(indices, i + 1);
+        uint32_t c = triangleVertex(indices, i + 2);
+        if(a >= vertexCount || b >= vertexCount || c >= vertexCount) continue;
+
+        const float* pa = positions + a * 3;
+        const float* pb = positions + b * 3;
+        const float* pc = positions + c * 3;
+        const float* ta = texcoords + a * 2;
+        const float* tb = texcoords + b * 2;
+        const float* tc = texcoords + c * 2;
+
+        float e1[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+        float e2[3] = {pc[0] - pa[0], pc[1] - pa[1], pc[2] - pa[2]};
+        float du1 = tb[0] - ta[0], dv1 = tb[1] - ta[1];
+        float du2 = tc[0] - ta[0], dv2 = tc[1] - ta[1];
+
+        float det = du1 * dv2 - du2 * dv1;
+        if(std::fabs(det) < 1e-20f) continue;
+        float r = 1.0f / det;
+
+        float t[3] = {(e1[0] * dv2 - e2[0] * dv1) * r, (e1[1] * dv2 - e2[1] * dv1) * r, (e1[2] * dv2 - e2[2] * dv1) * r};
+        float s[3] = {(e2[0] * du1 - e1[0] * du2) * r, (e2[1] * du1 - e1[1] * du2) * r, (e2[2] * du1 - e1[2] * du2) * r};
+
+        for(uint32_t v : {a, b, c}) {
+            for(int k = 0; k < 3; k++) {
+                tangents[v * 4 + k] += t[k];
+                bitangents[v * 3 + k] += s[k];
+            }
+        }
+    }
+
+    for(uint32_t v = 0; v < vertexCount; v++) {
+        const float* n = normals + v * 3;
+        float* t = tangents + v * 4;
+        const float* b = bitangents.data() + v * 3;
+
+        // Gram-Schmidt: remove the normal component
+        float d = n[0] * t[0] + n[1] * t[1] + n[2] * t[2];
+        t[0] -= n[0] * d;
+        t[1] -= n[1] * d;
+        t[2] -= n[2] * d;
+
+        // Any vector perpendicular to the normal is an acceptable fallback
+        float fallback[3];
+        if(std::fabs(n[0]) < 0.9f) {
+            fallback[0] = 0.0f; fallback[1] = n[2]; fallback[2] = -n[1];
+        } else {
+            fallback[0] = -n[2]; fallback[1] = 0.0f; fallback[2] = n[0];
+        }
+        normalize3(fallback, fallback);
+        normalize3(t, fallback);
+
+        // Handedness: does (n x t) point along the accumulated bitangent?
+        float c[3] = {n[1] * t[2] - n[2] * t[1], n[2] * t[0] - n[0] * t[2], n[0] * t[1] - n[1] * t[0]};
+        t[3] = (c[0] * b[0] + c[1] * b[1] + c[2] * b[2]) < 0.0f ? -1.0f : 1.0f;
+    }
+}
+
+constexpr uint32_t NO_TRIANGLE = ~0u;
+constexpr uint8_t NO_SLOT = 0xFF;
+
+/**
+ * Fills the sphere and cone of a finished meshlet. The sphere is centered on the vertex AABB; the cone axis is the
+ * mean triangle normal and its cutoff is the sine of the widest angle to it.
+ */
+static void computeMeshletBounds(const float* positions, const uint32_t* meshletVertices, const uint32_t* meshletTriangles, Meshlet& meshlet) {
+    float boundsMin[3] = {positions[meshletVertices[0] * 3], positions[meshletVertices[0] * 3 + 1], positions[meshletVertices[0] * 3 + 2]};
+    float boundsMax[3] = {boundsMin[0], boundsMin[1], boundsMin[2]};
+    for(uint32_t v = 1; v < meshlet.vertexCount; v++) {
+        const float* p = positions + meshletVertices[v] * 3;
+        for(int k = 0; k < 3; k++) {
+            boundsMin[k] = std::min(boundsMin[k], p[k]);
+            boundsMax[k] = std::max(boundsMax[k], p[k]);
+        }
+    }
+
+    float radiusSquared = 0.0f;
+    for(int k = 0; k < 3; k++) meshlet.center[k] = 0.5f * (boundsMin[k] + boundsMax[k]);
+    for(uint32_t v = 0; v < meshlet.vertexCount; v++) {
+        const float* p = positions + meshletVertices[v] * 3;
+        float d[3] = {p[0] - meshlet.center[0], p[1] - meshlet.center[1], p[2] - meshlet.center[2]};
+        radiusSquared = std::max(radiusSquared, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    }
+    meshlet.radius = std::sqrt(radiusSquared);
+
+    static const float zero[3] = {0.0f, 0.0f, 0.0f};
+    std::vector<float> normals(meshlet.triangleCount * 3);
+    float axis[3] = {0.0f, 0.0f, 0.0f};
+    for(uint32_t t = 0; t < meshlet.triangleCount; t++) {
+        uint32_t packed = meshletTriangles[t];
+        const float* pa = positions + meshletVertices[packed & 0xFF] * 3;
+        const float* pb = positions + meshletVertices[(packed >> 8) & 0xFF] * 3;
+        const float* pc = positions + meshletVertices[(packed >> 16) & 0xFF] * 3;
+
+        float e1[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+        float e2[3] = {pc[0] - pa[0], pc[1] - pa[1], pc[2] - pa[2]};
+        float* n = normals.data() + t * 3;
+        n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+        n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+        n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+        normalize3(n, zero);
+        for(int k = 0; k < 3; k++) axis[k] += n[k];
+    }
+
+    normalize3(axis, zero);
+
+    float minDot = 1.0f;
+    for(uint32_t t = 0; t < meshlet.triangleCount; t++) {
+        const float* n = normals.data() + t * 3;
+        minDot = std::min(minDot, n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2]);
+    }
+
+    for(int k = 0; k < 3; k++) meshlet.coneAxis[k] = axis[k];
+
+    // Cones wider than ~84 degrees would almost never cull, so they are disabled outright
+    meshlet.coneCutoff = (minDot <= 0.1f) ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+}
+
+void buildMeshlets(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                   std::vector<Meshlet>& meshlets, std::vector<uint32_t>& meshletVertices, std::vector<uint32_t>& meshletTriangles) {
+    uint32_t triangleCount = indexCount / 3;
+
+    auto corner = [&](uint32_t triangle, uint32_t c) { return triangleVertex(indices, triangle * 3 + c); };
+
+    // Vertex to triangle adjacency, skipping triangles that will never be emitted
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for(uint32_t t = 0; t < triangleCount; t++) {
+        uint32_t a = corner(t, 0), b = corner(t, 1), c = corner(t, 2);
+        if(a >= vertexCount || b >= vertexCount || c >= vertexCount || a == b || b == c || a == c) {
+            emitted[t] = 1;
+            continue;
+        }
+        adjacencyOffsets[a + 1]++;
+        adjacencyOffsets[b + 1]++;
+        adjacencyOffsets[c + 1]++;
+    }
+    for(uint32_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+
+    std::vector<uint32_t> adjacency(adjacencyOffsets[vertexCount]);
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for(uint32_t t = 0; t < triangleCount; t++) {
+        if(emitted[t]) continue;
+        for(uint32_t c = 0; c < 3; c++) adjacency[fill[corner(t, c)]++] = t;
+    }
+
+    // Index of each vertex within the meshlet being built
+    std::vector<uint8_t> slots(vertexCount, NO_SLOT);
+
+    Meshlet current{};
+    current.vertexOffset = static_cast<uint32_t>(meshletVertices.size());
+    current.triangleOffset = static_cast<uint32_t>(meshletTriangles.size());
+
+    // Running centroid and bounds of the meshlet's vertices, used to keep meshlets round rather than strip shaped
+    float centroidSum[3] = {0.0f, 0.0f, 0.0f};
+    float boundsMin[3], boundsMax[3];
+
+    auto finish = [&]() {
+        if(current.triangleCount == 0) return;
+
+        computeMeshletBounds(positions, meshletVertices.data() + current.vertexOffset, meshletTriangles.data() + current.triangleOffset, current);
+        for(uint32_t v = 0; v < current.vertexCount; v++) slots[meshletVertices[current.vertexOffset + v]] = NO_SLOT;
+        meshlets.push_back(current);
+
+        centroidSum[0] = centroidSum[1] = centroidSum[2] = 0.0f;
+
+        current = Meshlet{};
+        current.vertexOffset = static_cast<uint32_t>(meshletVertices.size());
+        current.triangleOffset = static_cast<uint32_t>(meshletTriangles.size());
+    };
+
+    auto newVertexCount = [&](uint32_t triangle) {
+        uint32_t count = 0;
+        for(uint32_t c = 0; c < 3; c++) count += (slots[corner(triangle, c)] == NO_SLOT) ? 1 : 0;
+        return count;
+    };
+
+    auto distanceToCentroid = [&](uint32_t triangle) {
+        float distance = 0.0f;
+        for(int k = 0; k < 3; k++) {
+            float centroid = centroidSum[k] / static_cast<float>(current.vertexCount);
+            float d = (positions[corner(triangle, 0) * 3 + k] + positions[corner(triangle, 1) * 3 + k] + positions[corner(triangle, 2) * 3 + k]) / 3.0f - centroid;
+            distance += d * d;
+        }
+        return distance;
+    };
+
+    // Picks the unemitted neighbour of the given vertices that adds the fewest new vertices, then the one closest to the centroid
+    auto bestNeighbour = [&](const uint32_t* vertices, uint32_t count) {
+        uint32_t best = NO_TRIANGLE, bestScore = 4;
+        float bestDistance = 0.0f;
+        for(uint32_t i = 0; i < count; i++) {
+            for(uint32_t a = adjacencyOffsets[vertices[i]]; a < adjacencyOffsets[vertices[i] + 1]; a++) {
+                uint32_t t = adjacency[a];
+                if(emitted[t]) continue;
+
+                uint32_t score = newVertexCount(t);
+                if(score > bestScore) continue;
+
+                float distance = (current.vertexCount > 0) ? distanceToCentroid(t) : 0.0f;
+                if(score < bestScore || distance < bestDistance) {
+                    best = t;
+                    bestScore = score;
+                    bestDistance = distance;
+                }
+            }
+        }
+        return best;
+    };
+
+    uint32_t cursor = 0;
+    uint32_t last = NO_TRIANGLE;
+
+    while(true) {
+        uint32_t next = NO_TRIANGLE;
+
+        // Search around the last triangle first; the whole meshlet is only scanned once that neighbourhood is exhausted
+        if(last != NO_TRIANGLE) {
+            uint32_t lastCorners[3] = {corner(last, 0), corner(last, 1), corner(last, 2)};
+            next = bestNeighbour(lastCorners, 3);
+        }
+        if(next == NO_TRIANGLE && current.vertexCount > 0) next = bestNeighbour(meshletVertices.data() + current.vertexOffset, current.vertexCount);
+
+        // Disconnected: continue in index order, which is usually spatially coherent. A triangle that lands well
+        // outside the meshlet's bounds starts a new meshlet instead of inflating this one's sphere.
+        if(next == NO_TRIANGLE) {
+            while(cursor < triangleCount && emitted[cursor]) cursor++;
+            if(cursor == triangleCount) break;
+            next = cursor;
+
+            if(current.vertexCount > 0) {
+                float extent = 0.0f;
+                for(int k = 0; k < 3; k++) extent = std::max(extent, boundsMax[k] - boundsMin[k]);
+
+                bool far = false;
+                for(int k = 0; k < 3; k++) {
+                    float c = (positions[corner(next, 0) * 3 + k] + positions[corner(next, 1) * 3 + k] + positions[corner(next, 2) * 3 + k]) / 3.0f;
+                    far = far || c < boundsMin[k] - extent || c > boundsMax[k] + extent;
+                }
+                if(far) finish();
+            }
+        }
+
+        if(current.vertexCount + newVertexCount(next) > MESHLET_MAX_VERTICES || current.triangleCount == MESHLET_MAX_TRIANGLES) finish();
+
+        uint32_t packed = 0;
+        for(uint32_t c = 0; c < 3; c++) {
+            uint32_t v = corner(next, c);
+            if(slots[v] == NO_SLOT) {
+                slots[v] = static_cast<uint8_t>(current.vertexCount++);
+                meshletVertices.push_back(v);
+                for(int k = 0; k < 3; k++) {
+                    float p = positions[v * 3 + k];
+                    centroidSum[k] += p;
+                    boundsMin[k] = (current.vertexCount == 1) ? p : std::min(boundsMin[k], p);
+                    boundsMax[k] = (current.vertexCount == 1) ? p : std::max(boundsMax[k], p);
+                }
+            }
+            packed |= static_cast<uint32_t>(slots[v]) << (8 * c);
+        }
+
+        meshletTriangles.push_back(packed);
+        current.triangleCount++;
+        emitted[next] = 1;
+        last = next;
+    }
+
+    finish();
+}
+
+// Symmetric 4x4 error quadric: Q(p) = p^T A p + 2 b.p + c, accumulated with the total weight of its planes
+struct Quadric {
+    float a00, a01, a02, a11, a12, a22;
+    float b0, b1, b2;
+    float c;
+    float weight;
+};
+
+enum class VertexKind : uint8_t {
+    Manifold,   // may collapse along any edge
+    Border,     // on an open boundary; may only collapse along the boundary
+    Locked,     // on an attribute seam or a non-manifold edge
+};
+
+struct Collapse {
+    uint32_t source;
+    uint32_t target;
+    float cost;
+};
+
+static void addPlane(Quadric& q, const float n[3], float d, float weight) {
+    q.a00 += weight * n[0] * n[0];
+    q.a01 += weight * n[0] * n[1];
+    q.a02 += weight * n[0] * n[2];
+    q.a11 += weight * n[1] * n[1];
+    q.a12 += weight * n[1] * n[2];
+    q.a22 += weight * n[2] * n[2];
+    q.b0 += weight * n[0] * d;
+    q.b1 += weight * n[1] * d;
+    q.b2 += weight * n[2] * d;
+    q.c += weight * d * d;
+    q.weight += weight;
+}
+
+static void addQuadric(Quadric& q, const Quadric& other) {
+    q.a00 += other.a00; q.a01 += other.a01; q.a02 += other.a02;
+    q.a11 += other.a11; q.a12 += other.a12; q.a22 += other.a22;
+    q.b0 += other.b0; q.b1 += other.b1; q.b2 += other.b2;
+    q.c += other.c;
+    q.weight += other.weight;
+}
+
+// Weighted mean squared distance of p to the quadric's planes
+static float evaluateQuadric(const Quadric& q, const float* p) {
+    float x = p[0], y = p[1], z = p[2];
+    float r = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z +
+              2.0f * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z) +
+              2.0f * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+    return std::fabs(r) / std::max(q.weight, 1e-20f);
+}
+
+static void triangleNormal(const float* pa, const float* pb, const float* pc, float* n) {
+    float e1[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+    float e2[3] = {pc[0] - pa[0], pc[1] - pa[1], pc[2] - pa[2]};
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+static inline uint64_t edgeKey(uint32_t a, uint32_t b) {
+    return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+// Border edges may be collapsed along themselves; this weight keeps the boundary from drifting inwards
+constexpr float BORDER_PLANE_WEIGHT = 10.0f;
+
+uint32_t simplifyMesh(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                      uint32_t targetIndexCount, uint32_t* destination, float* resultError) {
+    if(resultError) *resultError = 0.0f;
+
+    // Quadrics are built in a unit cube around the mesh so float precision does not depend on its placement
+    float boundsMin[3] = {FLT_MAX, FLT_MAX, FLT_MAX}, boundsMax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for(uint32_t v = 0; v < vertexCount; v++) {
+        for(int k = 0; k < 3; k++) {
+            boundsMin[k] = std::min(boundsMin[k], positions[v * 3 + k]);
+            boundsMax[k] = std::max(boundsMax[k], positions[v * 3 + k]);
+        }
+    }
+    float extent = std::max({boundsMax[0] - boundsMin[0], boundsMax[1] - boundsMin[1], boundsMax[2] - boundsMin[2], 1e-20f});
+
+    std::vector<float> points(static_cast<size_t>(vertexCount) * 3);
+    for(uint32_t v = 0; v < vertexCount; v++) {
+        for(int k = 0; k < 3; k++) points[v * 3 + k] = (positions[v * 3 + k] - boundsMin[k]) / extent;
+    }
+
+    uint32_t resultCount = 0;
+    for(uint32_t i = 0; i + 2 < indexCount; i += 3) {
+        uint32_t a = triangleVertex(indices, i);
+        uint32_t b = triangleVertex(indices, i + 1);
+        uint32_t c = triangleVertex(indices, i + 2);
+        if(a >= vertexCount || b >= vertexCount || c >= vertexCount || a == b || b == c || a == c) continue;
+
+        destination[resultCount++] = a;
+        destination[resultCount++] = b;
+        destination[resultCount++] = c;
+    }
+
+    // Vertices sharing a position are welded for topology; split vertices mark attribute seams
+    std::vector<uint32_t> order(vertexCount);
+    for(uint32_t v = 0; v < vertexCount; v++) order[v] = v;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return std::lexicographical_compare(positions + a * 3, positions + a * 3 + 3, positions + b * 3, positions + b * 3 + 3);
+    });
+
+    std::vector<uint32_t> weld(vertexCount);
+    std::vector<VertexKind> kind(vertexCount, VertexKind::Manifold);
+    for(uint32_t i = 0; i < vertexCount;) {
+        uint32_t end = i + 1;
+        while(end < vertexCount && std::equal(positions + order[i] * 3, positions + order[i] * 3 + 3, positions + order[end] * 3)) end++;
+
+        for(uint32_t j = i; j < end; j++) {
+            weld[order[j]] = order[i];
+            if(end - i > 1) kind[order[j]] = VertexKind::Locked;
+        }
+        i = end;
+    }
+
+    // Welded edges used by one triangle are borders, by more than two non-manifold. Collapses along a border create
+    // new border edges, so the list is rebuilt every pass.
+    std::vector<uint64_t> edges;
+    std::vector<uint64_t> borderEdges;
+    auto collectEdges = [&](bool classify) {
+        edges.clear();
+        for(uint32_t i = 0; i < resultCount; i += 3) {
+            for(int e = 0; e < 3; e++) {
+                uint32_t a = weld[destination[i + e]], b = weld[destination[i + (e + 1) % 3]];
+                if(a != b) edges.push_back(edgeKey(a, b));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        borderEdges.clear();
+        for(size_t i = 0; i < edges.size();) {
+            size_t end = i + 1;
+            while(end < edges.size() && edges[end] == edges[i]) end++;
+
+            uint32_t a = static_cast<uint32_t>(edges[i] >> 32), b = static_cast<uint32_t>(edges[i]);
+            if(end - i == 1) {
+                borderEdges.push_back(edges[i]);
+                if(classify) for(uint32_t v : {a, b}) if(kind[v] == VertexKind::Manifold) kind[v] = VertexKind::Border;
+            } else if(end - i > 2 && classify) {
+                kind[a] = kind[b] = VertexKind::Locked;
+            }
+            i = end;
+        }
+    };
+    collectEdges(true);
+
+    auto isBorderEdge = [&](uint32_t a, uint32_t b) {
+        return std::binary_search(borderEdges.begin(), borderEdges.end(), edgeKey(weld[a], weld[b]));
+    };
+
+    std::vector<Quadric> quadrics(vertexCount, Quadric{});
+    for(uint32_t i = 0; i < resultCount; i += 3) {
+        const uint32_t* t = destination + i;
+        float n[3];
+        triangleNormal(&points[t[0] * 3], &points[t[1] * 3], &points[t[2] * 3], n);
+
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if(length < 1e-20f) continue;
+        for(int k = 0; k < 3; k++) n[k] /= length;
+
+        const float* p0 = &points[t[0] * 3];
+        float d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+        for(int c = 0; c < 3; c++) addPlane(quadrics[t[c]], n, d, 0.5f * length);
+
+        // A plane through each border edge, perpendicular to the triangle, penalizes moving the boundary
+        for(int e = 0; e < 3; e++) {
+            uint32_t a = t[e], b = t[(e + 1) % 3];
+            if(kind[a] != VertexKind::Border || kind[b] != VertexKind::Border || !isBorderEdge(a, b)) continue;
+
+            const float* pa = &points[a * 3];
+            const float* pb = &points[b * 3];
+            float edge[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+            float bn[3] = {edge[1] * n[2] - edge[2] * n[1], edge[2] * n[0] - edge[0] * n[2], edge[0] * n[1] - edge[1] * n[0]};
+            float bl = std::sqrt(bn[0] * bn[0] + bn[1] * bn[1] + bn[2] * bn[2]);
+            if(bl < 1e-20f) continue;
+            for(int k = 0; k < 3; k++) bn[k] /= bl;
+
+            float bd = -(bn[0] * pa[0] + bn[1] * pa[1] + bn[2] * pa[2]);
+            float edgeLengthSquared = edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2];
+            addPlane(quadrics[a], bn, bd, edgeLengthSquared * BORDER_PLANE_WEIGHT);
+            addPlane(quadrics[b], bn, bd, edgeLengthSquared * BORDER_PLANE_WEIGHT);
+        }
+    }
+
+    auto canCollapse = [&](uint32_t source, uint32_t target) {
+        if(kind[source] == VertexKind::Manifold) return true;
+        return kind[source] == VertexKind::Border && isBorderEdge(source, target);
+    };
+
+    // Triangles around each vertex, as offsets into adjacency
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    auto buildAdjacency = [&]() {
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for(uint32_t i = 0; i < resultCount; i++) adjacencyOffsets[destination[i] + 1]++;
+        for(uint32_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+
+        adjacency.resize(resultCount);
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for(uint32_t i = 0; i < resultCount; i++) adjacency[fill[destination[i]]++] = i / 3;
+    };
+
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> collapseTarget(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    std::vector<uint32_t> remap(vertexCount);     // the vertex each input vertex was merged into
+    for(uint32_t v = 0; v < vertexCount; v++) remap[v] = v;
+    float maxError = 0.0f;
+
+    // Each pass collapses the cheapest edges whose vertices no earlier collapse of the pass has touched
+    bool firstPass = true;
+    while(resultCount > targetIndexCount) {
+        uint32_t triangleCount = resultCount / 3;
+        if(!firstPass) collectEdges(false);
+        firstPass = false;
+
+        buildAdjacency();
+
+        collapses.clear();
+        for(uint32_t i = 0; i < resultCount; i += 3) {
+            for(int e = 0; e < 3; e++) {
+                uint32_t a = destination[i + e], b = destination[i + (e + 1) % 3];
+
+                // Only one of the two triangles sharing an interior edge has to propose it
+                if(a > b && !isBorderEdge(a, b)) continue;
+
+                Quadric merged = quadrics[a];
+                addQuadric(merged, quadrics[b]);
+
+                float costAB = canCollapse(a, b) ? evaluateQuadric(merged, &points[b * 3]) : FLT_MAX;
+                float costBA = canCollapse(b, a) ? evaluateQuadric(merged, &points[a * 3]) : FLT_MAX;
+                if(costAB == FLT_MAX && costBA == FLT_MAX) continue;
+
+                collapses.push_back(costAB <= costBA ? Collapse{a, b, costAB} : Collapse{b, a, costBA});
+            }
+        }
+        if(collapses.empty()) break;
+
+        // An interior collapse removes two triangles. Collapses up to 1.5x the cost of the last one needed are taken
+        // in cost order; the rest only if too few of those survive the flip checks to make progress.
+        auto byCost = [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; };
+        size_t needed = std::min<size_t>((triangleCount - targetIndexCount / 3) / 2 + 1, collapses.size() - 1);
+        std::nth_element(collapses.begin(), collapses.begin() + needed, collapses.end(), byCost);
+        float costLimit = collapses[needed].cost * 1.5f;
+        auto expensive = std::partition(collapses.begin(), collapses.end(), [&](const Collapse& c) { return c.cost <= costLimit; });
+        std::sort(collapses.begin(), expensive, byCost);
+
+        for(uint32_t v = 0; v < vertexCount; v++) collapseTarget[v] = v;
+        std::fill(touched.begin(), touched.end(), false);
+        uint32_t applied = 0;
+
+        for(size_t i = 0; i < collapses.size() && triangleCount * 3 > targetIndexCount; i++) {
+            if(collapses.begin() + i == expensive) {
+                if(applied >= needed / 4) break;
+                std::sort(expensive, collapses.end(), byCost);
+            }
+
+            const Collapse& collapse = collapses[i];
+            if(touched[collapse.source] || touched[collapse.target]) continue;
+
+            // Reject collapses that flip a surviving triangle around the source. Already degenerate (collinear)
+            // triangles have no orientation to keep.
+            const float* target = &points[collapse.target * 3];
+            uint32_t removed = 0;
+            bool flips = false;
+
+            for(uint32_t a = adjacencyOffsets[collapse.source]; a < adjacencyOffsets[collapse.source + 1] && !flips; a++) {
+                uint32_t t[3];
+                for(int c = 0; c < 3; c++) t[c] = collapseTarget[destination[adjacency[a] * 3 + c]];
+
+                if(t[0] == collapse.target || t[1] == collapse.target || t[2] == collapse.target) {
+                    removed++;
+                    continue;
+                }
+
+                const float* p[3];
+                const float* moved[3];
+                for(int c = 0; c < 3; c++) {
+                    p[c] = &points[t[c] * 3];
+                    moved[c] = (t[c] == collapse.source) ? target : p[c];
+                }
+
+                float before[3], after[3];
+                triangleNormal(p[0], p[1], p[2], before);
+                triangleNormal(moved[0], moved[1], moved[2], after);
+
+                // Turning a normal by more than ~75 degrees folds the surface even if it does not flip it
+                float beforeLength = std::sqrt(before[0] * before[0] + before[1] * before[1] + before[2] * before[2]);
+                float afterLength = std::sqrt(after[0] * after[0] + after[1] * after[1] + after[2] * after[2]);
+                float turn = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+                flips = beforeLength > 1e-12f && turn <= 0.25f * beforeLength * afterLength;
+            }
+            if(flips) continue;
+
+            collapseTarget[collapse.source] = collapse.target;
+            addQuadric(quadrics[collapse.target], quadrics[collapse.source]);
+            touched[collapse.source] = touched[collapse.target] = true;
+
+            triangleCount -= removed;
+            maxError = std::max(maxError, collapse.cost);
+            applied++;
+        }
+        if(applied == 0) break;
+
+        for(uint32_t v = 0; v < vertexCount; v++) remap[v] = collapseTarget[remap[v]];
+
+        uint32_t write = 0;
+        for(uint32_t i = 0; i < resultCount; i += 3) {
+            uint32_t a = collapseTarget[destination[i]];
+            uint32_t b = collapseTarget[destination[i + 1]];
+            uint32_t c = collapseTarget[destination[i + 2]];
+            if(a == b || b == c || a == c) continue;
+
+            destination[write++] = a;
+            destination[write++] = b;
+            destination[write++] = c;
+        }
+        resultCount = write;
+    }
+
+    // Collapse costs average over every merged plane, which understates the deviation on curved surfaces. Each
+    // merged vertex is also measured against the closest plane of the triangles now around its replacement.
+    float measuredError = 0.0f;
+    buildAdjacency();
+    for(uint32_t v = 0; v < vertexCount; v++) {
+        uint32_t r = remap[v];
+        if(r == v || adjacencyOffsets[r] == adjacencyOffsets[r + 1]) continue;
+
+        float closest = FLT_MAX;
+        for(uint32_t a = adjacencyOffsets[r]; a < adjacencyOffsets[r + 1]; a++) {
+            const uint32_t* t = destination + adjacency[a] * 3;
+            float n[3];
+            triangleNormal(&points[t[0] * 3], &points[t[1] * 3], &points[t[2] * 3], n);
+
+            // Slivers have no reliable plane
+            float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if(length < 1e-12f) continue;
+
+            float d[3] = {points[v * 3] - points[r * 3], points[v * 3 + 1] - points[r * 3 + 1], points[v * 3 + 2] - points[r * 3 + 2]};
+            closest = std::min(closest, std::fabs(n[0] * d[0] + n[1] * d[1] + n[2] * d[2]) / length);
+        }
+        if(closest != FLT_MAX) measuredError = std::max(measuredError, closest);
+    }
+
+    if(resultError) *resultError = std::max(std::sqrt(maxError), measuredError) * extent;
+    return resultCount;
+}
+
+
+VertexCacheStatistics analyzeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize) {
+    VertexCacheStatistics statistics;
+
+    // A vertex is cached while fewer than cacheSize misses happened since it was loaded
+    std::vector<uint32_t> loadTime(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+
+    for(uint32_t i = 0; i + 2 < indexCount; i += 3) {
+        for(uint32_t c = 0; c < 3; c++) {
+            uint32_t v = indices[i + c];
+            if(v >= vertexCount) continue;
+
+            if(loadTime[v] == 0) statistics.vertexCount++;
+            if(time - loadTime[v] > cacheSize) {
+                loadTime[v] = time++;
+                statistics.transformedCount++;
+            }
+        }
+        statistics.triangleCount++;
+    }
+
+    return statistics;
+}
+
+void optimizeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t* destination) {
+    uint32_t triangleCount = indexCount / 3;
+
+    // Triangles around each vertex; liveTriangles counts the ones not emitted yet
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for(uint32_t i = 0; i < triangleCount * 3; i++) adjacencyOffsets[indices[i] + 1]++;
+    for(uint32_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for(uint32_t v = 0; v < vertexCount; v++) liveTriangles[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v];
+
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for(uint32_t i = 0; i < triangleCount * 3; i++) adjacency[fill[indices[i]]++] = i / 3;
+
+    std::vector<uint32_t> loadTime(vertexCount, 0);
+    uint32_t time = VERTEX_CACHE_SIZE + 1;
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    uint32_t cursor = 0;
+    uint32_t written = 0;
+
+    uint32_t fan = triangleCount > 0 ? indices[0] : UNREFERENCED_VERTEX;
+    while(fan != UNREFERENCED_VERTEX) {
+        candidates.clear();
+
+        for(uint32_t a = adjacencyOffsets[fan]; a < adjacencyOffsets[fan + 1]; a++) {
+            uint32_t t = adjacency[a];
+            if(emitted[t]) continue;
+            emitted[t] = true;
+
+            for(uint32_t c = 0; c < 3; c++) {
+                uint32_t v = indices[t * 3 + c];
+                destination[written++] = v;
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if(time - loadTime[v] > VERTEX_CACHE_SIZE) loadTime[v] = time++;
+            }
+        }
+
+        // Prefer the candidate that has been in the cache longest but will still be there after its remaining
+        // triangles are emitted; any live candidate beats none
+        fan = UNREFERENCED_VERTEX;
+        int64_t bestPriority = -1;
+        for(uint32_t v : candidates) {
+            if(liveTriangles[v] == 0) continue;
+
+            int64_t priority = 0;
+            if(time - loadTime[v] + 2 * liveTriangles[v] <= VERTEX_CACHE_SIZE) priority = time - loadTime[v];
+            if(priority > bestPriority) {
+                bestPriority = priority;
+                fan = v;
+            }
+        }
+
+        // Dead end: back up through recently used vertices, then scan for any vertex with triangles left
+        while(fan == UNREFERENCED_VERTEX && !deadEnds.empty()) {
+            uint32_t v = deadEnds.back();
+            deadEnds.pop_back();
+            if(liveTriangles[v] > 0) fan = v;
+        }
+        while(fan == UNREFERENCED_VERTEX && cursor < vertexCount) {
+            if(liveTriangles[cursor] > 0) fan = cursor;
+            cursor++;
+        }
+    }
+}
+
+void optimizeOverdraw(uint32_t* indices, uint32_t indexCount, const float* positions, uint32_t vertexCount, float threshold) {
+    uint32_t triangleCount = indexCount / 3;
+    if(triangleCount == 0) return;
+
+    std::vector<uint32_t> loadTime(vertexCount, 0);
+    uint32_t time = VERTEX_CACHE_SIZE + 1;
+
+    auto cacheMisses = [&](uint32_t t) {
+        uint32_t misses = 0;
+        for(uint32_t c = 0; c < 3; c++) {
+            uint32_t v = indices[t * 3 + c];
+            if(time - loadTime[v] > VERTEX_CACHE_SIZE) {
+                loadTime[v] = time++;
+                misses++;
+            }
+        }
+        return misses;
+    };
+    auto resetCache = [&]() {
+        // Advancing past every load time empties the cache without touching the whole array
+        time += VERTEX_CACHE_SIZE + 1;
+    };
+
+    // Hard boundaries: triangles that miss on all three vertices start over anyway
+    std::vector<uint32_t> hardBoundaries;
+    std::vector<uint8_t> sequentialMisses(triangleCount);
+    uint64_t inputMisses = 0;
+    for(uint32_t t = 0; t < triangleCount; t++) {
+        sequentialMisses[t] = static_cast<uint8_t>(cacheMisses(t));
+        inputMisses += sequentialMisses[t];
+        if(sequentialMisses[t] == 3) hardBoundaries.push_back(t);
+    }
+    hardBoundaries.push_back(triangleCount);
+
+    // Soft boundaries: split a hard cluster wherever the part since the last split is already cheap enough
+    std::vector<uint32_t> clusters;
+    for(size_t h = 0; h + 1 < hardBoundaries.size(); h++) {
+        uint32_t start = hardBoundaries[h], end = hardBoundaries[h + 1];
+
+        // The budget is what the cluster costs in the input order, where it may start on a warm cache
+        uint32_t clusterMisses = 0;
+        for(uint32_t t = start; t < end; t++) clusterMisses += sequentialMisses[t];
+        float target = threshold * static_cast<float>(clusterMisses) / (end - start);
+
+        resetCache();
+        clusters.push_back(start);
+        uint32_t misses = 0, softStart = start;
+        for(uint32_t t = start; t < end; t++) {
+            misses += cacheMisses(t);
+
+            if(t + 1 < end && static_cast<float>(misses) <= target * (t + 1 - softStart)) {
+                clusters.push_back(t + 1);
+                resetCache();
+                misses = 0;
+                softStart = t + 1;
+            }
+        }
+
+        // The part after the last split was never checked; one over budget goes back into the cluster before it
+        if(softStart > start && static_cast<float>(misses) > target * (end - softStart)) clusters.pop_back();
+    }
+    clusters.push_back(triangleCount);
+
+    // Area weighted centroid and normal per cluster, and of the whole mesh
+    size_t clusterCount = clusters.size() - 1;
+    std::vector<float> clusterData(clusterCount * 7, 0.0f);     // centroid * area, area, normal
+    float meshCentroid[3] = {0.0f, 0.0f, 0.0f}, meshArea = 0.0f;
+
+    for(size_t k = 0; k < clusterCount; k++) {
+        float* data = &clusterData[k * 7];
+
+        for(uint32_t t = clusters[k]; t < clusters[k + 1]; t++) {
+            const float* pa = positions + indices[t * 3] * 3;
+            const float* pb = positions + indices[t * 3 + 1] * 3;
+            const float* pc = positions + indices[t * 3 + 2] * 3;
+
+            float n[3];
+            triangleNormal(pa, pb, pc, n);
+            float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            for(int i = 0; i < 3; i++) {
+                float centroid = (pa[i] + pb[i] + pc[i]) / 3.0f;
+                data[i] += centroid * area;
+                data[4 + i] += n[i];
+                meshCentroid[i] += centroid * area;
+            }
+            data[3] += area;
+            meshArea += area;
+        }
+    }
+    for(int i = 0; i < 3; i++) meshCentroid[i] /= std::max(meshArea, 1e-20f);
+
+    std::vector<float> sortKeys(clusterCount);
+    for(size_t k = 0; k < clusterCount; k++) {
+        const float* data = &clusterData[k * 7];
+        float normalLength = std::sqrt(data[4] * data[4] + data[5] * data[5] + data[6] * data[6]);
+        if(data[3] <= 0.0f || normalLength <= 0.0f) continue;
+
+        float key = 0.0f;
+        for(int i = 0; i < 3; i++) key += (data[i] / data[3] - meshCentroid[i]) * data[4 + i] / normalLength;
+        sortKeys[k] = key;
+    }
+
+    std::vector<uint32_t> order(clusterCount);
+    for(uint32_t k = 0; k < clusterCount; k++) order[k] = k;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> sorted;
+    sorted.reserve(triangleCount * 3);
+    for(uint32_t k : order) sorted.insert(sorted.end(), indices + clusters[k] * 3, indices + clusters[k + 1] * 3);
+
+    // Clusters land next to different neighbours than before, which the estimates above can't see; an order that
+    // ends up over budget anyway is dropped
+    VertexCacheStatistics sortedStatistics = analyzeVertexCache(sorted.data(), triangleCount * 3, vertexCount);
+    if(static_cast<float>(sortedStatistics.transformedCount) > threshold * static_cast<float>(inputMisses)) return;
+
+    std::copy(sorted.begin(), sorted.end(), indices);
+}
+
+uint32_t optimizeVertexFetchRemap(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t* remap) {
+    std::fill(remap, remap + vertexCount, UNREFERENCED_VERTEX);
+
+    uint32_t next = 0;
+    for(uint32_t i = 0; i < indexCount; i++) {
+        uint32_t v = indices[i];
+        if(v < vertexCount && remap[v] == UNREFERENCED_VERTEX) remap[v] = next++;
+    }
+
+    return next;
+}
+
+} // namespace vkmv
@@ -0,0 +1,475 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/assets/GltfAsset.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include "vkmv/utils/CpuTrace.hpp"
+
+namespace vkmv {
+
+constexpr uint32_t GLB_MAGIC = 0x46546C67;         // "glTF"
+constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;    // "JSON"
+constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;     // "BIN\0"
+
+uint32_t gltfComponentSize(uint32_t componentType) {
+    switch(componentType) {
+        case GLTF_BYTE:
+        case GLTF_UNSIGNED_BYTE: return 1;
+        case GLTF_SHORT:
+        case GLTF_UNSIGNED_SHORT: return 2;
+        case GLTF_UNSIGNED_INT:
+        case GLTF_FLOAT: return 4;
+        default: return 0;
+    }
+}
+
+static uint32_t componentCountFromType(std::string_view type) {
+    if(type == "SCALAR") return 1;
+    if(type == "VEC2") return 2;
+    if(type == "VEC3") return 3;
+    if(type == "VEC4") return 4;
+    if(type == "MAT2") return 4;
+    if(type == "MAT3") return 9;
+    if(type == "MAT4") return 16;
+    return 0;
+}
+
+static uint32_t readU32(const uint8_t* ptr) {
+    uint32_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+// Returns the value of a hex digit, or -1 for any other character
+static int hexDigitValue(char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Decodes %XX escapes, which exporters use for spaces and non-ASCII characters in buffer URIs
+static std::string decodeUri(std::string_view uri) {
+    std::string decoded;
+    decoded.reserve(uri.size());
+
+    for(size_t i = 0; i < uri.size(); i++) {
+        if(uri[i] != '%') {
+            decoded.push_back(uri[i]);
+            continue;
+        }
+
+        int high = i + 2 < uri.size() ? hexDigitValue(uri[i + 1]) : -1;
+        int low = i + 2 < uri.size() ? hexDigitValue(uri[i + 2]) : -1;
+        if(high < 0 || low < 0) throw std::runtime_error("Malformed escape in glTF URI: " + std::string(uri));
+
+        decoded.push_back(static_cast<char>(high * 16 + low));
+        i += 2;
+    }
+
+    return decoded;
+}
+
+// Builds a column major T * R * S matrix from glTF translation, rotation (quaternion xyzw) and scale
+static void composeTransform(const float t[3], const float q[4], const float s[3], float out[16]) {
+    float x = q[0], y = q[1], z = q[2], w = q[3];
+
+    out[0] = (1.0f - 2.0f * (y * y + z * z)) * s[0];
+    out[1] = (2.0f * (x * y + z * w)) * s[0];
+    out[2] = (2.0f * (x * z - y * w)) * s[0];
+    out[3] = 0.0f;
+
+    out[4] = (2.0f * (x * y - z * w)) * s[1];
+    out[5] = (1.0f - 2.0f * (x * x + z * z)) * s[1];
+    out[6] = (2.0f * (y * z + x * w)) * s[1];
+    out[7] = 0.0f;
+
+    out[8] = (2.0f * (x * z + y * w)) * s[2];
+    out[9] = (2.0f * (y * z - x * w)) * s[2];
+    out[10] = (1.0f - 2.0f * (x * x + y * y)) * s[2];
+    out[11] = 0.0f;
+
+    out[12] = t[0];
+    out[13] = t[1];
+    out[14] = t[2];
+    out[15] = 1.0f;
+}
+
+// Reads up to count numbers from a JSON array into out, leaving missing entries untouched
+static void readFloatArray(const JsonDocument& doc, uint32_t array, float* out, uint32_t count) {
+    uint32_t element = doc.firstChild(array);
+    for(uint32_t i = 0; i < count && element != JsonDocument::INVALID; i++) {
+        out[i] = static_cast<float>(doc.number(element, out[i]));
+        element = doc.nextSibling(element);
+    }
+}
+
+GltfAsset::GltfAsset(const std::string& path) {
+    VKMV_TRACE_SCOPE("Parse glTF");
+
+    m_directory = std::filesystem::path(path).parent_path().string();
+    m_files.emplace_back(path);
+
+    const MappedFile& file = m_files.front();
+    const uint8_t* data = file.data();
+    size_t size = file.size();
+
+    if(size >= 12 && readU32(data) == GLB_MAGIC) {
+        if(readU32(data + 4) != 2) throw std::runtime_error("Unsupported GLB version in " + path);
+
+        size_t length = std::min<size_t>(readU32(data + 8), size);
+
+        std::string_view json;
+        const uint8_t* binChunk = nullptr;
+        size_t binChunkSize = 0;
+
+        // Chunks are 4 byte aligned: a JSON chunk first, then an optional BIN chunk
+        size_t offset = 12;
+        while(offset + 8 <= length) {
+            uint32_t chunkLength = readU32(data + offset);
+            uint32_t chunkType = readU32(data + offset + 4);
+            offset += 8;
+
+            if(chunkLength > length - offset) throw std::runtime_error("Truncated GLB chunk in " + path);
+
+            if(chunkType == GLB_CHUNK_JSON && json.empty()) {
+                json = std::string_view(reinterpret_cast<const char*>(data + offset), chunkLength);
+            } else if(chunkType == GLB_CHUNK_BIN && binChunk == nullptr) {
+                binChunk = data + offset;
+                binChunkSize = chunkLength;
+            }
+
+            offset += (chunkLength + 3) & ~size_t(3);
+        }
+
+        if(json.empty()) throw std::runtime_error("GLB file has no JSON chunk: " + path);
+
+        parseJson(json, binChunk, binChunkSize);
+    } else {
+        parseJson(std::string_view(reinterpret_cast<const char*>(data), size), nullptr, 0);
+    }
+}
+
+const uint8_t* GltfAsset::accessorData(uint32_t accessor) const {
+    const GltfAccessor& a = m_accessors[accessor];
+    if(a.bufferView == GLTF_INVALID_INDEX) return nullptr;
+
+    return bufferViewData(a.bufferView) + a.byteOffset;
+}
+
+uint32_t GltfAsset::accessorStride(uint32_t accessor) const {
+    const GltfAccessor& a = m_accessors[accessor];
+
+    if(a.bufferView != GLTF_INVALID_INDEX && m_bufferViews[a.bufferView].byteStride != 0) {
+        return m_bufferViews[a.bufferView].byteStride;
+    }
+
+    return gltfComponentSize(a.componentType) * a.componentCount;
+}
+
+void GltfAsset::readFloats(uint32_t accessor, uint32_t element, float* out) const {
+    const GltfAccessor& a = m_accessors[accessor];
+    uint32_t count = std::min<uint32_t>(a.componentCount, 4);
+
+    const uint8_t* src = accessorData(accessor);
+    if(src == nullptr) {
+        for(uint32_t c = 0; c < count; c++) out[c] = 0.0f;
+        return;
+    }
+    src += static_cast<size_t>(element) * accessorStride(accessor);
+
+    // Normalized integer conversions follow the glTF specification (signed types clamp to -1)
+    for(uint32_t c = 0; c < count; c++) {
+        switch(a.componentType) {
+            case GLTF_FLOAT: {
+                std::memcpy(&out[c], src + c * 4, 4);
+                break;
+            }
+            case GLTF_UNSIGNED_BYTE: {
+                uint8_t v = src[c];
+                out[c] = a.normalized ? v / 255.0f : static_cast<float>(v);
+                break;
+            }
+            case GLTF_BYTE: {
+                int8_t v = static_cast<int8_t>(src[c]);
+                out[c] = a.normalized ? std::max(v / 127.0f, -1.0f) : static_cast<float>(v);
+                break;
+            }
+            case GLTF_UNSIGNED_SHORT: {
+                uint16_t v;
+                std::memcpy(&v, src + c * 2, 2);
+                out[c] = a.normalized ? v / 65535.0f : static_cast<float>(v);
+                break;
+            }
+            case GLTF_SHORT: {
+                int16_t v;
+                std::memcpy(&v, src + c * 2, 2);
+                out[c] = a.normalized ? std::max(v / 32767.0f, -1.0f) : static_cast<float>(v);
+                break;
+            }
+            case GLTF_UNSIGNED_INT: {
+                uint32_t v;
+                std::memcpy(&v, src + c * 4, 4);
+                out[c] = static_cast<float>(v);
+                break;
+            }
+        }
+    }
+}
+
+uint32_t GltfAsset::readUint(uint32_t accessor, uint32_t element) const {
+    const uint8_t* src = accessorData(accessor);
+    if(src == nullptr) return 0;
+    src += static_cast<size_t>(element) * accessorStride(accessor);
+
+    switch(m_accessors[accessor].componentType) {
+        case GLTF_UNSIGNED_BYTE:
+        case GLTF_BYTE:
+            return src[0];
+        case GLTF_UNSIGNED_SHORT:
+        case GLTF_SHORT: {
+            uint16_t v;
+            std::memcpy(&v, src, 2);
+            return v;
+        }
+        default:
+            return readU32(src);
+    }
+}
+
+const uint8_t* GltfAsset::bufferViewData(uint32_t bufferView) const {
+    const GltfBufferView& view = m_bufferViews[bufferView];
+    return m_buffers[view.buffer].data + view.byteOffset;
+}
+
+void GltfAsset::prefetchBufferView(uint32_t bufferView) const {
+    const GltfBufferView& view = m_bufferViews[bufferView];
+    m_files[m_buffers[view.buffer].file].prefetch(bufferViewData(bufferView), view.byteLength);
+}
+
+void GltfAsset::releaseBufferView(uint32_t bufferView) const {
+    const GltfBufferView& view = m_bufferViews[bufferView];
+    m_files[m_buffers[view.buffer].file].release(bufferViewData(bufferView), view.byteLength);
+}
+
+void GltfAsset::parseJson(std::string_view json, const uint8_t* binChunk, size_t binChunkSize) {
+    JsonDocument doc;
+    doc.parse(json);
+
+    if(doc[doc.root()].type != JsonType::Object) throw std::runtime_error("glTF root is not an object!");
+
+    std::string version = doc.findString(doc.find(doc.root(), "asset"), "version");
+    if(version.empty() || version[0] != '2') throw std::runtime_error("Only glTF 2.0 assets are supported!");
+
+    parseBuffers(doc, binChunk, binChunkSize);
+    parseBufferViews(doc);
+    parseAccessors(doc);
+    parseMeshes(doc);
+    parseNodes(doc);
+    parseScenes(doc);
+}
+
+void GltfAsset::parseBuffers(const JsonDocument& doc, const uint8_t* binChunk, size_t binChunkSize) {
+    uint32_t array = doc.find(doc.root(), "buffers");
+
+    for(uint32_t b = doc.firstChild(array); b != JsonDocument::INVALID; b = doc.nextSibling(b)) {
+        GltfBuffer buffer{};
+        size_t byteLength = static_cast<size_t>(doc.findNumber(b, "byteLength", 0.0));
+        std::string uri = doc.findString(b, "uri");
+
+        if(uri.empty()) {
+            // Only the first buffer of a GLB may omit its uri, and it refers to the BIN chunk
+            if(!m_buffers.empty() || binChunk == nullptr) throw std::runtime_error("glTF buffer has no uri and no BIN chunk!");
+            if(byteLength > binChunkSize) throw std::runtime_error("glTF buffer is larger than the BIN chunk!");
+
+            buffer.data = binChunk;
+            buffer.file = 0;
+        } else {
+            if(uri.substr(0, 5) == "data:") throw std::runtime_error("Embedded data URIs are not supported!");
+
+            std::filesystem::path bufferPath = std::filesystem::path(m_directory) / decodeUri(uri);
+            m_files.emplace_back(bufferPath.string());
+
+            if(byteLength > m_files.back().size()) throw std::runtime_error("glTF buffer is larger than its file: " + bufferPath.string());
+
+            buffer.data = m_files.back().data();
+            buffer.file = static_cast<uint32_t>(m_files.size() - 1);
+        }
+
+        buffer.size = byteLength;
+        m_buffers.push_back(buffer);
+    }
+}
+
+void GltfAsset::parseBufferViews(const JsonDocument& doc) {
+    uint32_t array = doc.find(doc.root(), "bufferViews");
+
+    for(uint32_t v = doc.firstChild(array); v != JsonDocument::INVALID; v = doc.nextSibling(v)) {
+        GltfBufferView view{};
+        view.buffer = doc.findUint(v, "buffer", GLTF_INVALID_INDEX);
+        view.byteOffset = static_cast<size_t>(doc.findNumber(v, "byteOffset", 0.0));
+        view.byteLength = static_cast<size_t>(doc.findNumber(v, "byteLength", 0.0));
+        view.byteStride = doc.findUint(v, "byteStride", 0);
+
+        if(view.buffer >= m_buffers.size()) throw std::runtime_error("glTF buffer view references an invalid buffer!");
+        if(view.byteOffset > m_buffers[view.buffer].size || view.byteLength > m_buffers[view.buffer].size - view.byteOffset) {
+            throw std::runtime_error("glTF buffer view is out of bounds!");
+        }
+
+        m_bufferViews.push_back(view);
+    }
+}
+
+void GltfAsset::parseAccessors(const JsonDocument& doc) {
+    uint32_t array = doc.find(doc.root(), "accessors");
+
+    for(uint32_t a = doc.firstChild(array); a != JsonDocument::INVALID; a = doc.nextSibling(a)) {
+        GltfAccessor accessor{};
+        accessor.bufferView = doc.findUint(a, "bufferView", GLTF_INVALID_INDEX);
+        accessor.byteOffset = static_cast<size_t>(doc.findNumber(a, "byteOffset", 0.0));
+        accessor.count = doc.findUint(a, "count", 0);
+        accessor.componentType = doc.findUint(a, "componentType", 0);
+        accessor.componentCount = componentCountFromType(doc.findString(a, "type"));
+        accessor.normalized = doc.boolean(doc.find(a, "normalized"));
+        accessor.sparse = doc.find(a, "sparse") != JsonDocument::INVALID;
+
+        uint32_t minArray = doc.find(a, "min");
+        uint32_t maxArray = doc.find(a, "max");
+        accessor.hasBounds = minArray != JsonDocument::INVALID && maxArray != JsonDocument::INVALID;
+        if(accessor.hasBounds) {
+            readFloatArray(doc, minArray, accessor.min, 3);
+            readFloatArray(doc, maxArray, accessor.max, 3);
+        }
+
+        uint32_t elementSize = gltfComponentSize(accessor.componentType) * accessor.componentCount;
+        if(elementSize == 0) throw std::runtime_error("glTF accessor has an invalid type!");
+
+        // Validate once here so consumers can read accessor data without bounds checks
+        if(accessor.bufferView != GLTF_INVALID_INDEX) {
+            if(accessor.bufferView >= m_bufferViews.size()) throw std::runtime_error("glTF accessor references an invalid buffer view!");
+
+            const GltfBufferView& view = m_bufferViews[accessor.bufferView];
+            size_t stride = view.byteStride != 0 ? view.byteStride : elementSize;
+            size_t required = accessor.count == 0 ? 0 : accessor.byteOffset + stride * (accessor.count - 1) + elementSize;
+
+            if(required > view.byteLength) throw std::runtime_error("glTF accessor is out of bounds!");
+        }
+
+        m_accessors.push_back(accessor);
+    }
+}
+
+void GltfAsset::parseMeshes(const JsonDocument& doc) {
+    uint32_t array = doc.find(doc.root(), "meshes");
+
+    auto checkAccessor = [this](uint32_t index) {
+        if(index != GLTF_INVALID_INDEX && index >= m_accessors.size()) throw std::runtime_error("glTF primitive references an invalid accessor!");
+        return index;
+    };
+
+    for(uint32_t m = doc.firstChild(array); m != JsonDocument::INVALID; m = doc.nextSibling(m)) {
+        GltfMesh mesh{};
+        mesh.firstPrimitive = static_cast<uint32_t>(m_primitives.size());
+
+        uint32_t primitives = doc.find(m, "primitives");
+        for(uint32_t p = doc.firstChild(primitives); p != JsonDocument::INVALID; p = doc.nextSibling(p)) {
+            uint32_t attributes = doc.find(p, "attributes");
+
+            GltfPrimitive primitive;
+            primitive.position = checkAccessor(doc.findUint(attributes, "POSITION", GLTF_INVALID_INDEX));
+            primitive.normal = checkAccessor(doc.findUint(attributes, "NORMAL", GLTF_INVALID_INDEX));
+            primitive.tangent = checkAccessor(doc.findUint(attributes, "TANGENT", GLTF_INVALID_INDEX));
+            primitive.texcoord0 = checkAccessor(doc.findUint(attributes, "TEXCOORD_0", GLTF_INVALID_INDEX));
+            primitive.indices = checkAccessor(doc.findUint(p, "indices", GLTF_INVALID_INDEX));
+            primitive.material = doc.findUint(p, "material", GLTF_INVALID_INDEX);
+            primitive.mode = doc.findUint(p, "mode", GLTF_MODE_TRIANGLES);
+
+            m_primitives.push_back(primitive);
+        }
+
+        mesh.primitiveCount = static_cast<uint32_t>(m_primitives.size()) - mesh.firstPrimitive;
+        m_meshes.push_back(mesh);
+    }
+}
+
+void GltfAsset::parseNodes(const JsonDocument& doc) {
+    uint32_t array = doc.find(doc.root(), "nodes");
+
+    for(uint32_t n = doc.firstChild(array); n != JsonDocument::INVALID; n = doc.nextSibling(n)) {
+        GltfNode node{};
+        node.mesh = doc.findUint(n, "mesh", GLTF_INVALID_INDEX);
+        if(node.mesh != GLTF_INVALID_INDEX && node.mesh >= m_meshes.size()) throw std::runtime_error("glTF node references an invalid mesh!");
+
+        uint32_t matrix = doc.find(n, "matrix");
+        if(matrix != JsonDocument::INVALID) {
+            static const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+            std::memcpy(node.localTransform, identity, sizeof(identity));
+            readFloatArray(doc, matrix, node.localTransform, 16);
+        } else {
+            float t[3] = {0.0f, 0.0f, 0.0f};
+            float r[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+            float s[3] = {1.0f, 1.0f, 1.0f};
+            readFloatArray(doc, doc.find(n, "translation"), t, 3);
+            readFloatArray(doc, doc.find(n, "rotation"), r, 4);
+            readFloatArray(doc, doc.find(n, "scale"), s, 3);
+            composeTransform(t, r, s, node.localTransform);
+        }
+
+        node.firstChild = static_cast<uint32_t>(m_nodeChildren.size());
+        uint32_t children = doc.find(n, "children");
+        for(uint32_t c = doc.firstChild(children); c != JsonDocument::INVALID; c = doc.nextSibling(c)) {
+            m_nodeChildren.push_back(static_cast<uint32_t>(doc.number(c)));
+        }
+        node.childCount = static_cast<uint32_t>(m_nodeChildren.size()) - node.firstChild;
+
+        m_nodes.push_back(node);
+    }
+
+    // Every node has at most one parent, or importers copy its subtree once per parent, which a few nodes listing
+    // each other twice blow up exponentially
+    std::vector<bool> hasParent(m_nodes.size(), false);
+    for(uint32_t child : m_nodeChildren) {
+        if(child >= m_nodes.size()) throw std::runtime_error("glTF node references an invalid child!");
+        if(hasParent[child]) throw std::runtime_error("glTF node has more than one parent!");
+        hasParent[child] = true;
+    }
+}
+
+void GltfAsset::parseScenes(const JsonDocument& doc) {
+    uint32_t array = doc.find(doc.root(), "scenes");
+
+    std::vector<bool> hasParent(m_nodes.size(), false);
+    for(uint32_t child : m_nodeChildren) hasParent[child] = true;
+
+    std::vector<uint32_t> rootOfScene(m_nodes.size(), GLTF_INVALID_INDEX);
+    for(uint32_t s = doc.firstChild(array); s != JsonDocument::INVALID; s = doc.nextSibling(s)) {
+        GltfScene scene{};
+        scene.firstRoot = static_cast<uint32_t>(m_sceneRoots.size());
+        uint32_t sceneIndex = static_cast<uint32_t>(m_scenes.size());
+
+        uint32_t roots = doc.find(s, "nodes");
+        for(uint32_t r = doc.firstChild(roots); r != JsonDocument::INVALID; r = doc.nextSibling(r)) {
+            uint32_t node = static_cast<uint32_t>(doc.number(r));
+            if(node >= m_nodes.size()) throw std::runtime_error("glTF scene references an invalid node!");
+            if(hasParent[node]) throw std::runtime_error("glTF scene root is also a child node!");
+            if(rootOfScene[node] == sceneIndex) throw std::runtime_error("glTF scene lists a root twice!");
+            rootOfScene[node] = sceneIndex;
+            m_sceneRoots.push_back(node);
+        }
+
+        scene.rootCount = static_cast<uint32_t>(m_sceneRoots.size()) - scene.firstRoot;
+        m_scenes.push_back(scene);
+    }
+
+    if(!m_scenes.empty()) m_defaultScene = std::min<uint32_t>(doc.findUint(doc.root(), "scene", 0), static_cast<uint32_t>(m_scenes.size() - 1));
+}
+
+} // namespace vkmv
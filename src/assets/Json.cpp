@@ -0,0 +1,326 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/assets/Json.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace vkmv {
+
+// Deeper documents are almost certainly malicious, and recursion would otherwise overflow the stack
+constexpr uint32_t MAX_JSON_DEPTH = 256;
+
+static int hexDigitValue(char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// The 4 hex digits of a unicode escape at pos, or UINT32_MAX if there aren't 4
+static uint32_t readCodeUnit(std::string_view text, size_t pos) {
+    if(pos + 4 > text.size()) return UINT32_MAX;
+
+    uint32_t unit = 0;
+    for(size_t i = pos; i < pos + 4; i++) {
+        int digit = hexDigitValue(text[i]);
+        if(digit < 0) return UINT32_MAX;
+        unit = unit * 16 + static_cast<uint32_t>(digit);
+    }
+    return unit;
+}
+
+static bool isHighSurrogate(uint32_t unit) { return unit >= 0xD800 && unit <= 0xDBFF; }
+static bool isLowSurrogate(uint32_t unit) { return unit >= 0xDC00 && unit <= 0xDFFF; }
+
+static void appendUtf8(std::string& out, uint32_t codePoint) {
+    if(codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if(codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if(codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+void JsonDocument::parse(std::string_view text) {
+    if(text.size() >= UINT32_MAX) throw std::runtime_error("JSON document is too large!");
+
+    m_text = text;
+    m_tokens.clear();
+    m_tokens.reserve(text.size() / 8);
+
+    size_t pos = parseValue(skipWhitespace(0), 0);
+    pos = skipWhitespace(pos);
+
+    // GLB pads the JSON chunk with trailing spaces, and some exporters add null terminators
+    while(pos < m_text.size() && m_text[pos] == '\0') pos++;
+    if(pos != m_text.size()) fail("Unexpected trailing characters", pos);
+}
+
+uint32_t JsonDocument::find(uint32_t object, std::string_view key) const {
+    if(object == INVALID || m_tokens[object].type != JsonType::Object) return INVALID;
+
+    uint32_t child = object + 1;
+    for(uint32_t i = 0; i < m_tokens[object].size; i++) {
+        uint32_t value = child + 1;
+
+        // Escaped keys are rare; only they pay for decoding
+        if(m_tokens[child].size == 0 ? string(child) == key : decodeString(child) == key) return value;
+        child = m_tokens[value].next;
+    }
+
+    return INVALID;
+}
+
+uint32_t JsonDocument::firstChild(uint32_t token) const {
+    if(token == INVALID || m_tokens[token].size == 0) return INVALID;
+    if(m_tokens[token].type != JsonType::Array && m_tokens[token].type != JsonType::Object) return INVALID;
+
+    return token + 1;
+}
+
+std::string_view JsonDocument::string(uint32_t token) const {
+    if(token == INVALID || m_tokens[token].type != JsonType::String) return {};
+
+    return m_text.substr(m_tokens[token].start, m_tokens[token].length);
+}
+
+/**
+ * Escapes were validated by parseString, so every one here is complete and surrogates come in pairs.
+ */
+std::string JsonDocument::decodeString(uint32_t token) const {
+    std::string_view text = string(token);
+    if(token == INVALID || m_tokens[token].size == 0) return std::string(text);
+
+    std::string decoded;
+    decoded.reserve(text.size());
+    for(size_t i = 0; i < text.size(); i++) {
+        if(text[i] != '\\') {
+            decoded += text[i];
+            continue;
+        }
+
+        char escape = text[++i];
+        switch(escape) {
+        case 'b': decoded += '\b'; break;
+        case 'f': decoded += '\f'; break;
+        case 'n': decoded += '\n'; break;
+        case 'r': decoded += '\r'; break;
+        case 't': decoded += '\t'; break;
+        case 'u': {
+            uint32_t codePoint = readCodeUnit(text, i + 1);
+            i += 4;
+            if(isHighSurrogate(codePoint)) {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (readCodeUnit(text, i + 3) - 0xDC00);
+                i += 6;
+            }
+            appendUtf8(decoded, codePoint);
+            break;
+        }
+        default: decoded += escape; break;      // '"', '\\' and '/' stand for themselves
+        }
+    }
+
+    return decoded;
+}
+
+double JsonDocument::number(uint32_t token, double fallback) const {
+    if(token == INVALID || m_tokens[token].type != JsonType::Number) return fallback;
+
+    // strtod needs a terminated string; JSON numbers are short so a stack copy suffices
+    char buffer[64];
+    size_t length = std::min<size_t>(m_tokens[token].length, sizeof(buffer) - 1);
+    std::memcpy(buffer, m_text.data() + m_tokens[token].start, length);
+    buffer[length] = '\0';
+
+    return std::strtod(buffer, nullptr);
+}
+
+bool JsonDocument::boolean(uint32_t token, bool fallback) const {
+    if(token == INVALID || m_tokens[token].type != JsonType::Bool) return fallback;
+
+    return m_text[m_tokens[token].start] == 't';
+}
+
+uint32_t JsonDocument::findUint(uint32_t object, std::string_view key, uint32_t fallback) const {
+    uint32_t token = find(object, key);
+    if(token == INVALID || m_tokens[token].type != JsonType::Number) return fallback;
+
+    double value = number(token);
+    if(value < 0.0 || value > static_cast<double>(UINT32_MAX)) return fallback;
+
+    return static_cast<uint32_t>(value);
+}
+
+double JsonDocument::findNumber(uint32_t object, std::string_view key, double fallback) const {
+    return number(find(object, key), fallback);
+}
+
+std::string JsonDocument::findString(uint32_t object, std::string_view key) const {
+    return decodeString(find(object, key));
+}
+
+size_t JsonDocument::skipWhitespace(size_t pos) const {
+    while(pos < m_text.size()) {
+        char c = m_text[pos];
+        if(c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+        pos++;
+    }
+
+    return pos;
+}
+
+/**
+ * Parses the value starting at pos and appends its tokens. Returns the position after the value.
+ */
+size_t JsonDocument::parseValue(size_t pos, uint32_t depth) {
+    if(depth > MAX_JSON_DEPTH) fail("Maximum nesting depth exceeded", pos);
+    if(pos >= m_text.size()) fail("Unexpected end of document", pos);
+
+    uint32_t index = static_cast<uint32_t>(m_tokens.size());
+    m_tokens.push_back(JsonToken{JsonType::Null, static_cast<uint32_t>(pos), 0, 0, 0});
+
+    char c = m_text[pos];
+
+    if(c == '{' || c == '[') {
+        bool isObject = (c == '{');
+        m_tokens[index].type = isObject ? JsonType::Object : JsonType::Array;
+        char close = isObject ? '}' : ']';
+
+        uint32_t count = 0;
+        uint32_t lastChild = INVALID;
+        pos = skipWhitespace(pos + 1);
+
+        if(pos < m_text.size() && m_text[pos] == close) {
+            pos++;
+        } else {
+            while(true) {
+                if(isObject) {
+                    if(pos >= m_text.size() || m_text[pos] != '"') fail("Expected object key", pos);
+                    pos = parseString(pos);
+
+                    pos = skipWhitespace(pos);
+                    if(pos >= m_text.size() || m_text[pos] != ':') fail("Expected ':'", pos);
+                    pos = skipWhitespace(pos + 1);
+                }
+
+                lastChild = static_cast<uint32_t>(m_tokens.size());
+                pos = skipWhitespace(parseValue(pos, depth + 1));
+                count++;
+
+                if(pos < m_text.size() && m_text[pos] == ',') {
+                    pos = skipWhitespace(pos + 1);
+                    continue;
+                }
+                if(pos < m_text.size() && m_text[pos] == close) {
+                    pos++;
+                    break;
+                }
+                fail(isObject ? "Expected ',' or '}'" : "Expected ',' or ']'", pos);
+            }
+        }
+
+        // Terminate the sibling chain so children can be iterated without knowing the count
+        if(lastChild != INVALID) m_tokens[lastChild].next = INVALID;
+
+        m_tokens[index].size = count;
+        m_tokens[index].length = static_cast<uint32_t>(pos - m_tokens[index].start);
+    } else if(c == '"') {
+        m_tokens.pop_back();
+        pos = parseString(pos);
+        index = static_cast<uint32_t>(m_tokens.size() - 1);
+    } else if(c == 't' || c == 'f' || c == 'n') {
+        std::string_view literal = (c == 't') ? "true" : (c == 'f') ? "false" : "null";
+        if(m_text.substr(pos, literal.size()) != literal) fail("Invalid literal", pos);
+
+        m_tokens[index].type = (c == 'n') ? JsonType::Null : JsonType::Bool;
+        m_tokens[index].length = static_cast<uint32_t>(literal.size());
+        pos += literal.size();
+    } else if(c == '-' || (c >= '0' && c <= '9')) {
+        size_t end = pos + 1;
+        while(end < m_text.size()) {
+            char d = m_text[end];
+            if(!((d >= '0' && d <= '9') || d == '.' || d == 'e' || d == 'E' || d == '+' || d == '-')) break;
+            end++;
+        }
+
+        m_tokens[index].type = JsonType::Number;
+        m_tokens[index].length = static_cast<uint32_t>(end - pos);
+        pos = end;
+    } else {
+        fail("Unexpected character", pos);
+    }
+
+    // Provisional; the enclosing container overwrites this for its last child
+    m_tokens[index].next = static_cast<uint32_t>(m_tokens.size());
+    return pos;
+}
+
+/**
+ * Appends a string token for the quoted string at pos. Returns the position after the closing quote.
+ */
+size_t JsonDocument::parseString(size_t pos) {
+    size_t start = pos + 1;
+    size_t end = start;
+    uint32_t escapes = 0;
+
+    while(true) {
+        if(end >= m_text.size()) fail("Unterminated string", pos);
+
+        char c = m_text[end];
+        if(c == '"') break;
+        if(static_cast<unsigned char>(c) < 0x20) fail("Control character in string", end);
+        if(c != '\\') {
+            end++;
+            continue;
+        }
+
+        if(end + 1 >= m_text.size()) fail("Unterminated string", pos);
+        char escape = m_text[end + 1];
+        escapes++;
+
+        if(escape != 'u') {
+            if(std::strchr("\"\\/bfnrt", escape) == nullptr || escape == '\0') fail("Invalid escape in string", end);
+            end += 2;
+            continue;
+        }
+
+        // A high surrogate must be followed by a low one; decodeString relies on it
+        uint32_t unit = readCodeUnit(m_text, end + 2);
+        if(unit == UINT32_MAX) fail("Invalid unicode escape in string", end);
+        if(isLowSurrogate(unit)) fail("Unpaired surrogate in string", end);
+        end += 6;
+
+        if(isHighSurrogate(unit)) {
+            uint32_t low = (m_text.substr(end, 2) == "\\u") ? readCodeUnit(m_text, end + 2) : UINT32_MAX;
+            if(low == UINT32_MAX || !isLowSurrogate(low)) fail("Unpaired surrogate in string", end);
+            end += 6;
+        }
+    }
+
+    uint32_t index = static_cast<uint32_t>(m_tokens.size());
+    m_tokens.push_back(JsonToken{JsonType::String, static_cast<uint32_t>(start), static_cast<uint32_t>(end - start), escapes, index + 1});
+
+    return end + 1;
+}
+
+void JsonDocument::fail(const char* message, size_t pos) const {
+    throw std::runtime_error(std::string("JSON parse error at byte ") + std::to_string(pos) + ": " + message);
+}
+
+} // namespace vkmv
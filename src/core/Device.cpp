@@ -3,6 +3,7 @@
 // This file is part of the vulkan-model-viewer project.
 // This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
 
+#include <algorithm>
 #include <queue>
 #include <stdexcept>
 
@@ -11,6 +12,8 @@
 namespace vkmv {
 
 void Device::create(Instance* pInstance, DeviceParams* params, Device* pDevice) {
+    pDevice->m_headless = (params->presentableSurface == VK_NULL_HANDLE);
+
     pickPhysicalDevice(pInstance, params, pDevice);
     createDevice(pInstance, params, pDevice);
 }
@@ -19,6 +22,10 @@ void Device::destroy(Device* pDevice) {
     vkDestroyDevice(pDevice->m_vkDevice, nullptr);
 }
 
+bool Device::isExtensionEnabled(const char* extension) const {
+    return std::find(m_enabledDeviceExtensions.begin(), m_enabledDeviceExtensions.end(), std::string(extension)) != m_enabledDeviceExtensions.end();
+}
+
 /**
  * Enumerates physical devices and selects the best one. Sets pDevice->_physicalDevice and pDevice->enabledExtensions.
  * 
@@ -26,11 +33,16 @@ void Device::destroy(Device* pDevice) {
  * 
  * Device suitibility is determined by:
  * - Supporting required extensions
- * - Supporting optional extensions
+ * - Supporting optional extensions (VK_EXT_mesh_shader, only counted if task and mesh shaders are both supported;
+ *   VK_KHR_present_id and VK_KHR_present_wait, only counted together)
  * - Possessing a queue family with supportsPresentation and graphicsBit
  * - Must have one or more surface format
+ * - Supporting the features the GPU driven renderer needs (buffer device address, draw indirect count, indirect first instance, int64)
  * - Prefer discrete gpus 
  * 
+ * Headless devices (no presentableSurface) skip the swapchain extension and every surface check, so
+ * software implementations such as lavapipe qualify.
+ * 
  * @note Perhaps I should refactor this into many smaller functions
  */
 void Device::pickPhysicalDevice(Instance* pInstance, DeviceParams* params, Device* pDevice) {
@@ -39,17 +51,28 @@ void Device::pickPhysicalDevice(Instance* pInstance, DeviceParams* params, Devic
     std::vector<VkPhysicalDevice> physicalDevices(deviceCount);
     vkEnumeratePhysicalDevices(pInstance->getInstance(), &deviceCount, physicalDevices.data());
 
-    if(deviceCount == 0) throw std::runtime_error("Failed to gind GPUs with Vulkan support!");
+    if(deviceCount == 0) throw std::runtime_error("Failed to find GPUs with Vulkan support!");
+
+    bool headless = (params->presentableSurface == VK_NULL_HANDLE);
 
     std::set<std::string> requiredDeviceExtensions;
     std::set<std::string> optionalDeviceExtensions;
 
-    requiredDeviceExtensions.insert(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    if(!headless) requiredDeviceExtensions.insert(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
     requiredDeviceExtensions.insert(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
     requiredDeviceExtensions.insert(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
 
+    // Meshlets are culled and drawn by task and mesh shaders when available, otherwise by compute and indirect draws
+    optionalDeviceExtensions.insert(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+
+    // Lets the frame pacer wait until a frame is actually displayed and measure its latency there
+    if(!headless) {
+        optionalDeviceExtensions.insert(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+        optionalDeviceExtensions.insert(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+    }
+
     struct CandidateData {
-        int score;
+        int score = 0;
         VkPhysicalDevice physicalDevice;
         bool qualified = true;
         std::vector<std::string> candidateEnabledExtensions;
@@ -101,16 +124,18 @@ void Device::pickPhysicalDevice(Instance* pInstance, DeviceParams* params, Devic
         vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
         bool graphicsFamilyFound = false;
-        bool presentFamilyFound = false; 
+        bool presentFamilyFound = headless; 
 
         uint32_t i = 0;
         for(const auto& queueFamily : queueFamilies){
             if(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) graphicsFamilyFound = true;
 
-            VkBool32 presentSupport = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, params->presentableSurface, &presentSupport);
+            if(!headless) {
+                VkBool32 presentSupport = false;
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, params->presentableSurface, &presentSupport);
 
-            if(presentSupport) presentFamilyFound = true;
+                if(presentSupport) presentFamilyFound = true;
+            }
 
             i++;
         }
@@ -121,14 +146,72 @@ void Device::pickPhysicalDevice(Instance* pInstance, DeviceParams* params, Devic
         }
 
         // GPU must have at least one available format
-        uint32_t formatCount;
-        vkGetPhysicalDeviceSurfaceFormatsKHR(device, params->presentableSurface, &formatCount, nullptr);
+        if(!headless) {
+            uint32_t formatCount;
+            vkGetPhysicalDeviceSurfaceFormatsKHR(device, params->presentableSurface, &formatCount, nullptr);
+
+            if(formatCount == 0) {
+                deviceTraits.qualified = false;
+                continue;
+            }
+        }
+
+        // GPU driven rendering pulls vertices through buffer device addresses and draws with indirect counts
+        VkPhysicalDeviceVulkan12Features vulkan12Features{};
+        vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
 
-        if(formatCount == 0) {
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &vulkan12Features;
+        vkGetPhysicalDeviceFeatures2(device, &features2);
+
+        if(!vulkan12Features.bufferDeviceAddress || !vulkan12Features.drawIndirectCount ||
+           !vulkan12Features.timelineSemaphore || !features2.features.shaderInt64 || !features2.features.drawIndirectFirstInstance) {
             deviceTraits.qualified = false;
             continue;
         }
 
+        // The mesh shader extension is only worth enabling if both task and mesh shaders are supported
+        std::vector<std::string>& enabled = deviceTraits.candidateEnabledExtensions;
+        auto meshShaderExtension = std::find(enabled.begin(), enabled.end(), std::string(VK_EXT_MESH_SHADER_EXTENSION_NAME));
+        if(meshShaderExtension != enabled.end()) {
+            VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures{};
+            meshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+            features2.pNext = &meshShaderFeatures;
+            vkGetPhysicalDeviceFeatures2(device, &features2);
+
+            if(!meshShaderFeatures.taskShader || !meshShaderFeatures.meshShader) {
+                enabled.erase(meshShaderExtension);
+                deviceTraits.score -= 500;
+            }
+        }
+
+        // Present ids are only of use to wait for, so both extensions and their features are needed or neither is kept
+        auto presentIdExtension = std::find(enabled.begin(), enabled.end(), std::string(VK_KHR_PRESENT_ID_EXTENSION_NAME));
+        auto presentWaitExtension = std::find(enabled.begin(), enabled.end(), std::string(VK_KHR_PRESENT_WAIT_EXTENSION_NAME));
+        if(presentIdExtension != enabled.end() || presentWaitExtension != enabled.end()) {
+            VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+            presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+            VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+            presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+            presentIdFeatures.pNext = &presentWaitFeatures;
+
+            features2.pNext = &presentIdFeatures;
+            vkGetPhysicalDeviceFeatures2(device, &features2);
+
+            if(presentIdExtension == enabled.end() || presentWaitExtension == enabled.end() ||
+               !presentIdFeatures.presentId || !presentWaitFeatures.presentWait) {
+                for(const char* name : {VK_KHR_PRESENT_ID_EXTENSION_NAME, VK_KHR_PRESENT_WAIT_EXTENSION_NAME}) {
+                    auto extension = std::find(enabled.begin(), enabled.end(), std::string(name));
+                    if(extension != enabled.end()) {
+                        enabled.erase(extension);
+                        deviceTraits.score -= 500;
+                    }
+                }
+            }
+        }
+
         // Prefer discrete GPUs (which tend to have better performance)
         VkPhysicalDeviceProperties deviceProperties;
         vkGetPhysicalDeviceProperties(device, &deviceProperties);
@@ -140,7 +223,8 @@ void Device::pickPhysicalDevice(Instance* pInstance, DeviceParams* params, Devic
         if(deviceTraits.qualified == true) candidates.push(deviceTraits);
     }
 
-    if(candidates.top().score > 0){
+    // Every candidate in the queue is qualified; software rasterizers may legitimately score 0
+    if(!candidates.empty()){
         pDevice->m_vkPhysicalDevice = candidates.top().physicalDevice;
         pDevice->m_enabledDeviceExtensions = candidates.top().candidateEnabledExtensions;
     } else {
@@ -166,6 +250,11 @@ void Device::createDevice(Instance* pInstance, DeviceParams* params, Device* pDe
             graphicsFamilyFound = true;
         }
 
+        if(pDevice->m_headless) {
+            i++;
+            continue;
+        }
+
         VkBool32 presentSupport = false;
         vkGetPhysicalDeviceSurfaceSupportKHR(pDevice->m_vkPhysicalDevice, i, params->presentableSurface, &presentSupport);
 
@@ -177,8 +266,28 @@ void Device::createDevice(Instance* pInstance, DeviceParams* params, Device* pDe
         i++;
     }
 
+    // Headless devices never present, so the present family simply aliases the graphics family
+    if(pDevice->m_headless) pDevice->m_presentFamilyIndex = pDevice->m_graphicsFamilyIndex;
+
+    // Transfer-only families map to the copy engines on discrete GPUs, letting uploads overlap rendering.
+    // Coarse image transfer granularity would restrict image copies, so only families with 1x1x1 qualify.
+    pDevice->m_transferFamilyIndex = pDevice->m_graphicsFamilyIndex;
+    i = 0;
+    for (const auto& queueFamily : queueFamilies) {
+        bool transferOnly = (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+                            !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+        VkExtent3D granularity = queueFamily.minImageTransferGranularity;
+
+        if(transferOnly && granularity.width == 1 && granularity.height == 1 && granularity.depth == 1) {
+            pDevice->m_transferFamilyIndex = i;
+            break;
+        }
+
+        i++;
+    }
+
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-    std::set<uint32_t> uniqueQueueFamilies = { pDevice->m_graphicsFamilyIndex, pDevice->m_presentFamilyIndex };
+    std::set<uint32_t> uniqueQueueFamilies = { pDevice->m_graphicsFamilyIndex, pDevice->m_presentFamilyIndex, pDevice->m_transferFamilyIndex };
 
     float queuePriority = 1.0f;
     for(uint32_t queueFamily : uniqueQueueFamilies) {
@@ -191,7 +300,17 @@ void Device::createDevice(Instance* pInstance, DeviceParams* params, Device* pDe
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(pDevice->m_vkPhysicalDevice, &supportedFeatures);
+
     VkPhysicalDeviceFeatures deviceFeatures{};
+    deviceFeatures.shaderInt64 = VK_TRUE;
+    deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+
+    // Optional; the scene is drawn from secondary command buffers, which statistics queries must be inherited into
+    pDevice->m_pipelineStatistics = supportedFeatures.pipelineStatisticsQuery && supportedFeatures.inheritedQueries;
+    deviceFeatures.pipelineStatisticsQuery = pDevice->m_pipelineStatistics;
+    deviceFeatures.inheritedQueries = pDevice->m_pipelineStatistics;
 
     std::vector<const char*> extensions;
     for(auto& string : pDevice->m_enabledDeviceExtensions) {
@@ -206,9 +325,16 @@ void Device::createDevice(Instance* pInstance, DeviceParams* params, Device* pDe
     createInfo.ppEnabledExtensionNames = extensions.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
 
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+    vulkan12Features.bufferDeviceAddress = VK_TRUE;
+    vulkan12Features.drawIndirectCount = VK_TRUE;
+
     VkPhysicalDeviceSynchronization2Features synchronization2{};
     synchronization2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
     synchronization2.synchronization2 = VK_TRUE;
+    synchronization2.pNext = &vulkan12Features;
 
     VkPhysicalDeviceDynamicRenderingFeatures dynamicRendering{};
     dynamicRendering.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
@@ -217,12 +343,37 @@ void Device::createDevice(Instance* pInstance, DeviceParams* params, Device* pDe
 
     createInfo.pNext = &dynamicRendering;
 
+    VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures{};
+    meshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+    meshShaderFeatures.taskShader = VK_TRUE;
+    meshShaderFeatures.meshShader = VK_TRUE;
+
+    if(pDevice->isExtensionEnabled(VK_EXT_MESH_SHADER_EXTENSION_NAME)) {
+        meshShaderFeatures.pNext = &dynamicRendering;
+        createInfo.pNext = &meshShaderFeatures;
+    }
+
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+    presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    presentWaitFeatures.presentWait = VK_TRUE;
+
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+    presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    presentIdFeatures.presentId = VK_TRUE;
+    presentIdFeatures.pNext = &presentWaitFeatures;
+
+    if(pDevice->isExtensionEnabled(VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+        presentWaitFeatures.pNext = const_cast<void*>(createInfo.pNext);
+        createInfo.pNext = &presentIdFeatures;
+    }
+
     if(vkCreateDevice(pDevice->m_vkPhysicalDevice, &createInfo, nullptr, &pDevice->m_vkDevice) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create device!");
     }
 
     vkGetDeviceQueue(pDevice->m_vkDevice, pDevice->m_graphicsFamilyIndex, 0, &pDevice->m_graphicsQueue);
-    vkGetDeviceQueue(pDevice->m_vkDevice, pDevice->m_presentFamilyIndex, 0, &pDevice->m_presentQueue);
+    if(!pDevice->m_headless) vkGetDeviceQueue(pDevice->m_vkDevice, pDevice->m_presentFamilyIndex, 0, &pDevice->m_presentQueue);
+    vkGetDeviceQueue(pDevice->m_vkDevice, pDevice->m_transferFamilyIndex, 0, &pDevice->m_transferQueue);
 }
 
 } // namespace vkmv
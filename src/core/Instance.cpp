@@ -12,8 +12,8 @@
 
 namespace vkmv {
 
-void Instance::create(Instance* pInstance) {
-    createInstance(pInstance);
+void Instance::create(Instance* pInstance, InstanceParams* params) {
+    createInstance(pInstance, params);
     createDebugMessenger(pInstance);
 }
 
@@ -43,7 +43,7 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
  * 
  * @note This was copied from an older piece of code and could use some cleanup.
  */
-void Instance::createInstance(Instance* pInstance) {
+void Instance::createInstance(Instance* pInstance, InstanceParams* params) {
 
     // Allow optional and required layers and extensions to be specified
     // Currently none are explitly added, and this structure is for future use
@@ -59,12 +59,15 @@ void Instance::createInstance(Instance* pInstance) {
 
     // Insert extensions required by the windowing system
     // These extensions are platform specific, so SDL will assist with this
-    uint32_t displayExtensionCount;
-    const char* const *displayExtensions = SDL_Vulkan_GetInstanceExtensions(&displayExtensionCount);
-    if(displayExtensions == nullptr) throw std::runtime_error("Failed to get SDL Vulkan instance extensions!");
-
-    for(int ext = 0; ext < displayExtensionCount; ext++)
-        requiredInstanceExtensions.insert(displayExtensions[ext]);
+    // Headless instances never create a surface, so SDL is not queried (or even initialized)
+    if(params->enableSurfaceExtensions) {
+        uint32_t displayExtensionCount;
+        const char* const *displayExtensions = SDL_Vulkan_GetInstanceExtensions(&displayExtensionCount);
+        if(displayExtensions == nullptr) throw std::runtime_error("Failed to get SDL Vulkan instance extensions!");
+
+        for(int ext = 0; ext < displayExtensionCount; ext++)
+            requiredInstanceExtensions.insert(displayExtensions[ext]);
+    }
 
     // Insert validation layers and extensions for debug builds only
     #ifndef NDEBUG
@@ -7,4 +7,61 @@
 
 namespace vkmv {
 
-} // namespace vkmv
\ No newline at end of file
+static constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+static constexpr size_t SPIRV_HEADER_WORDS = 5;
+
+/**
+ * Checks the header, and that the instructions' word counts add up to exactly the words after it. A truncated file,
+ * e.g. one still being written by the shader compiler, ends inside an instruction and fails the walk.
+ */
+static bool isValidSpirv(const std::vector<uint32_t>& code) {
+    if(code.size() < SPIRV_HEADER_WORDS || code[0] != SPIRV_MAGIC || code[3] == 0) return false;
+
+    size_t word = SPIRV_HEADER_WORDS;
+    while(word < code.size()) {
+        uint32_t wordCount = code[word] >> 16;
+        if(wordCount == 0 || wordCount > code.size() - word) return false;
+        word += wordCount;
+    }
+    return true;
+}
+
+VkResult ShaderModule::Create(Device* pDevice, const std::vector<uint32_t>& code, std::shared_ptr<ShaderModule>* pShaderModule) {
+    if(!isValidSpirv(code)) return VK_ERROR_INITIALIZATION_FAILED;
+
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size() * sizeof(uint32_t);
+    createInfo.pCode = code.data();
+
+    VkShaderModule shaderModule;
+    VkResult result = vkCreateShaderModule(pDevice->getDevice(), &createInfo, nullptr, &shaderModule);
+    if(result != VK_SUCCESS) return result;
+
+    std::shared_ptr<ShaderModule> module(new ShaderModule());
+    module->device = pDevice;
+    module->_shaderModule = shaderModule;
+    module->hash = hashCode(code);
+    module->code = code;
+
+    *pShaderModule = std::move(module);
+    return VK_SUCCESS;
+}
+
+uint64_t ShaderModule::hashCode(const std::vector<uint32_t>& code) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for(uint32_t word : code) {
+        for(int i = 0; i < 4; i++) {
+            hash ^= (word >> (i * 8)) & 0xff;
+            hash *= 0x100000001b3ull;
+        }
+    }
+
+    return hash;
+}
+
+ShaderModule::~ShaderModule() {
+    if(_shaderModule != VK_NULL_HANDLE) vkDestroyShaderModule(device->getDevice(), _shaderModule, nullptr);
+}
+
+} // namespace vkmv
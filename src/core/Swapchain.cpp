@@ -5,8 +5,259 @@
 
 #include "vkmv/core/Swapchain.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "vkmv/utils/CpuTrace.hpp"
+
 namespace vkmv {
-    
 
+// Longest an acquire or present waits behind a wait for presents
+constexpr uint64_t PRESENT_WAIT_SLICE = 500'000;      // nanoseconds
+
+void Swapchain::create(Device* pDevice, SwapchainParams* params, Swapchain* pSwapchain) {
+    pSwapchain->m_device = pDevice;
+    pSwapchain->m_surface = params->surface;
+
+    chooseFormat(pSwapchain);
+    choosePresentMode(pSwapchain, params->presentMode);
+    createSwapchain(pSwapchain, params->extent, VK_NULL_HANDLE);
+    createImageResources(pSwapchain);
+}
+
+void Swapchain::destroy(Swapchain* pSwapchain) {
+    Retired current{pSwapchain->m_swapchain, std::move(pSwapchain->m_imageViews), std::move(pSwapchain->m_renderSemaphores)};
+    destroyRetired(pSwapchain->m_device->getDevice(), current);
+
+    pSwapchain->m_swapchain = VK_NULL_HANDLE;
+    pSwapchain->m_images.clear();
+}
+
+Swapchain::Retired Swapchain::recreate(VkExtent2D extent, VkPresentModeKHR presentMode) {
+    // The old swapchain is passed as oldSwapchain, which needs the same synchronization as presenting to it
+    m_queuedCalls++;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_queuedCalls--;
+
+    Retired retired{m_swapchain, std::move(m_imageViews), std::move(m_renderSemaphores)};
+
+    choosePresentMode(this, presentMode);
+
+    createSwapchain(this, extent, retired.swapchain);
+    lock.unlock();
+    m_callsDone.notify_all();
+
+    createImageResources(this);
+
+    return retired;
+}
+
+void Swapchain::destroyRetired(VkDevice device, Retired& retired) {
+    for(VkSemaphore semaphore : retired.renderSemaphores) vkDestroySemaphore(device, semaphore, nullptr);
+    for(VkImageView imageView : retired.imageViews) vkDestroyImageView(device, imageView, nullptr);
+    vkDestroySwapchainKHR(device, retired.swapchain, nullptr);
+
+    retired = Retired{};
+}
+
+VkResult Swapchain::acquireNextImage(VkSemaphore semaphore, uint32_t* pImageIndex) {
+    m_queuedCalls++;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_queuedCalls--;
+
+    VkResult result = vkAcquireNextImageKHR(m_device->getDevice(), m_swapchain, UINT64_MAX, semaphore, VK_NULL_HANDLE, pImageIndex);
+    lock.unlock();
+    m_callsDone.notify_all();
+
+    return result;
+}
+
+VkResult Swapchain::present(VkQueue queue, uint32_t imageIndex, uint64_t presentId) {
+    VKMV_TRACE_SCOPE("Present");
+
+    VkPresentInfoKHR presentInfo{};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.pSwapchains = &m_swapchain;
+    presentInfo.swapchainCount = 1;
+    presentInfo.pImageIndices = &imageIndex;
+
+    presentInfo.pWaitSemaphores = &m_renderSemaphores[imageIndex];
+    presentInfo.waitSemaphoreCount = 1;
+
+    VkPresentIdKHR presentIdInfo{};
+    presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+    presentIdInfo.swapchainCount = 1;
+    presentIdInfo.pPresentIds = &presentId;
+
+    if(presentId != 0) presentInfo.pNext = &presentIdInfo;
+
+    m_queuedCalls++;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_queuedCalls--;
+
+    VkResult result = vkQueuePresentKHR(queue, &presentInfo);
+    lock.unlock();
+    m_callsDone.notify_all();
+
+    return result;
+}
+
+VkResult Swapchain::waitForPresent(PFN_vkWaitForPresentKHR waitForPresentKHR, VkSwapchainKHR swapchain, uint64_t presentId, uint64_t timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    uint64_t waited = 0;
+    while(true) {
+        // m_queuedCalls only drops with m_mutex held, so the notification can't come between the check and the wait
+        m_callsDone.wait(lock, [this]() { return m_queuedCalls.load() == 0; });
+
+        uint64_t slice = std::min(PRESENT_WAIT_SLICE, timeout - waited);
+        VkResult result = waitForPresentKHR(m_device->getDevice(), swapchain, presentId, slice);
+        waited += slice;
+        if(result != VK_TIMEOUT || waited >= timeout) return result;
+    }
+}
+
+/**
+ * Prefers B8G8R8A8_SRGB with the sRGB color space. The format doesn't change when the swapchain is recreated, so
+ * nothing created against it has to be rebuilt.
+ */
+void Swapchain::chooseFormat(Swapchain* pSwapchain) {
+    VkPhysicalDevice physicalDevice = pSwapchain->m_device->getPhysicalDevice();
+
+    // Select a Format
+    uint32_t formatCount;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, pSwapchain->m_surface, &formatCount, nullptr);
+    std::vector<VkSurfaceFormatKHR> formats(formatCount);
+    vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, pSwapchain->m_surface, &formatCount, formats.data());
+
+    pSwapchain->m_format = formats[0];
+    for(const auto& format : formats) {
+        if(format.format == VK_FORMAT_B8G8R8A8_SRGB && format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+            pSwapchain->m_format = format;
+            break;
+        }
+    }
+
+}
+
+/**
+ * Uses presentMode if the surface supports it, and FIFO, which every surface supports, otherwise.
+ */
+void Swapchain::choosePresentMode(Swapchain* pSwapchain, VkPresentModeKHR presentMode) {
+    VkPhysicalDevice physicalDevice = pSwapchain->m_device->getPhysicalDevice();
+
+    if(pSwapchain->m_supportedPresentModes.empty()) {
+        uint32_t presentModeCount;
+        vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, pSwapchain->m_surface, &presentModeCount, nullptr);
+        pSwapchain->m_supportedPresentModes.resize(presentModeCount);
+        vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, pSwapchain->m_surface, &presentModeCount, pSwapchain->m_supportedPresentModes.data());
+    }
+
+    const std::vector<VkPresentModeKHR>& supported = pSwapchain->m_supportedPresentModes;
+    bool isSupported = std::find(supported.begin(), supported.end(), presentMode) != supported.end();
+
+    pSwapchain->m_presentMode = isSupported ? presentMode : VK_PRESENT_MODE_FIFO_KHR;
+}
+
+void Swapchain::createSwapchain(Swapchain* pSwapchain, VkExtent2D extent, VkSwapchainKHR oldSwapchain) {
+    Device* device = pSwapchain->m_device;
+
+    // Query for surface capabilities; they change with the window
+    VkSurfaceCapabilitiesKHR surfaceCaps;
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device->getPhysicalDevice(), pSwapchain->m_surface, &surfaceCaps);
+
+    uint32_t imageCount = surfaceCaps.minImageCount + 1;
+    if(surfaceCaps.maxImageCount > 0 && imageCount > surfaceCaps.maxImageCount) {
+        imageCount = surfaceCaps.maxImageCount;
+    }
+
+    // Select an extent
+    if(surfaceCaps.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
+        pSwapchain->m_extent = surfaceCaps.currentExtent;
+    } else {
+        pSwapchain->m_extent = {std::clamp(extent.width, surfaceCaps.minImageExtent.width, surfaceCaps.maxImageExtent.width),
+                                std::clamp(extent.height, surfaceCaps.minImageExtent.height, surfaceCaps.maxImageExtent.height)};
+    }
+
+    VkSwapchainCreateInfoKHR createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    createInfo.surface = pSwapchain->m_surface;
+    createInfo.minImageCount = imageCount;
+    createInfo.imageFormat = pSwapchain->m_format.format;
+    createInfo.imageColorSpace = pSwapchain->m_format.colorSpace;
+    createInfo.imageExtent = pSwapchain->m_extent;
+    createInfo.imageArrayLayers = 1;
+    createInfo.imageUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+    uint32_t queueFamilyIndices[] = {device->getGraphicsFamilyIndex(), device->getPresentFamilyIndex()};
+
+    if(device->getGraphicsFamilyIndex() != device->getPresentFamilyIndex()){
+        createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+        createInfo.queueFamilyIndexCount = 2;
+        createInfo.pQueueFamilyIndices = queueFamilyIndices;
+    } else {
+        createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    }
+
+    createInfo.preTransform = surfaceCaps.currentTransform;
+    createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    createInfo.presentMode = pSwapchain->m_presentMode;
+    createInfo.clipped = VK_TRUE;
+
+    // Lets the driver hand over resources, and keeps presents already queued to the old swapchain valid
+    createInfo.oldSwapchain = oldSwapchain;
+
+    if(vkCreateSwapchainKHR(device->getDevice(), &createInfo, nullptr, &pSwapchain->m_swapchain) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create swapchain!");
+    }
+
+    vkGetSwapchainImagesKHR(device->getDevice(), pSwapchain->m_swapchain, &imageCount, nullptr);
+    pSwapchain->m_images.resize(imageCount);
+    vkGetSwapchainImagesKHR(device->getDevice(), pSwapchain->m_swapchain, &imageCount, pSwapchain->m_images.data());
+}
+
+/**
+ * Creates a view and a render semaphore per image. The old swapchain's semaphores may still be waited on by its
+ * pending presents, so they are never reused.
+ */
+void Swapchain::createImageResources(Swapchain* pSwapchain) {
+    VkDevice device = pSwapchain->m_device->getDevice();
+
+    pSwapchain->m_imageViews.resize(pSwapchain->m_images.size());
+    for(size_t i = 0; i < pSwapchain->m_imageViews.size(); i++) {
+        VkImageViewCreateInfo viewCreateInfo{};
+        viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewCreateInfo.image = pSwapchain->m_images[i];
+        viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewCreateInfo.format = pSwapchain->m_format.format;
+
+        viewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+        viewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+        viewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+        viewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+
+        viewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewCreateInfo.subresourceRange.baseMipLevel = 0;
+        viewCreateInfo.subresourceRange.levelCount = 1;
+        viewCreateInfo.subresourceRange.baseArrayLayer = 0;
+        viewCreateInfo.subresourceRange.layerCount = 1;
+
+        if(vkCreateImageView(device, &viewCreateInfo, nullptr, &pSwapchain->m_imageViews[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create swapchain image view!");
+        }
+    }
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    pSwapchain->m_renderSemaphores.resize(pSwapchain->m_images.size());
+    for(size_t i = 0; i < pSwapchain->m_renderSemaphores.size(); i++) {
+        if(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &pSwapchain->m_renderSemaphores[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create semaphore!");
+        }
+    }
+}
 
 } // namespace vkmv
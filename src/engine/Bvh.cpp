@@ -0,0 +1,593 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/engine/Bvh.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// SSE2 is part of every x86-64 target; node tests fall back to plain loops elsewhere
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VKMV_BVH_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace vkmv {
+
+// Candidate split planes are the boundaries between this many centroid bins
+constexpr uint32_t SAH_BIN_COUNT = 16;
+
+// Items per leaf child; larger ranges are always split, and the collapse may halve smaller ones to fill a node
+constexpr uint32_t MAX_LEAF_SIZE = 4;
+
+// Cost of visiting a node, relative to testing one item
+constexpr float SAH_TRAVERSAL_COST = 1.0f;
+
+struct Aabb {
+    float min[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float max[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+    void grow(const Aabb& other) {
+        for(int k = 0; k < 3; k++) {
+            min[k] = std::min(min[k], other.min[k]);
+            max[k] = std::max(max[k], other.max[k]);
+        }
+    }
+
+    void growPoint(const float point[3]) {
+        for(int k = 0; k < 3; k++) {
+            min[k] = std::min(min[k], point[k]);
+            max[k] = std::max(max[k], point[k]);
+        }
+    }
+
+    // Half the surface area, which is all the heuristic's ratios need
+    float area() const {
+        if(min[0] > max[0]) return 0.0f;
+        float x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+        return x * y + y * z + z * x;
+    }
+};
+
+static Aabb getSphereBounds(const float sphere[4]) {
+    Aabb bounds;
+    for(int k = 0; k < 3; k++) {
+        bounds.min[k] = sphere[k] - sphere[3];
+        bounds.max[k] = sphere[k] + sphere[3];
+    }
+    return bounds;
+}
+
+static Aabb getSlotBounds(const BvhNode& node, uint32_t slot) {
+    Aabb bounds;
+    bounds.min[0] = node.minX[slot];
+    bounds.min[1] = node.minY[slot];
+    bounds.min[2] = node.minZ[slot];
+    bounds.max[0] = node.maxX[slot];
+    bounds.max[1] = node.maxY[slot];
+    bounds.max[2] = node.maxZ[slot];
+    return bounds;
+}
+
+static void setSlotBounds(BvhNode& node, uint32_t slot, const Aabb& bounds) {
+    node.minX[slot] = bounds.min[0];
+    node.minY[slot] = bounds.min[1];
+    node.minZ[slot] = bounds.min[2];
+    node.maxX[slot] = bounds.max[0];
+    node.maxY[slot] = bounds.max[1];
+    node.maxZ[slot] = bounds.max[2];
+}
+
+static BvhNode createEmptyNode() {
+    BvhNode node{};
+    for(uint32_t slot = 0; slot < BVH_WIDTH; slot++) {
+        setSlotBounds(node, slot, Aabb{});
+        node.child[slot] = BVH_LEAF;
+    }
+    return node;
+}
+
+void Bvh::build(const InstanceStore& store) {
+    uint32_t count = store.size();
+    m_nodes.clear();
+
+    // Build items are partitioned in place, so every pass over a range reads memory sequentially
+    struct BuildItem {
+        Aabb bounds;
+        float centroid[3];
+        uint32_t instance;
+    };
+    std::vector<BuildItem> items(count);
+    for(uint32_t i = 0; i < count; i++) {
+        float sphere[4] = {store.centerX()[i], store.centerY()[i], store.centerZ()[i], store.radius()[i]};
+        items[i].bounds = getSphereBounds(sphere);
+        std::copy(sphere, sphere + 3, items[i].centroid);
+        items[i].instance = i;
+    }
+
+    // Binary tree first; leaves have left == BVH_LEAF. Each node knows its bounds before it is split, so a range
+    // is only read by the binning and the partition.
+    struct BinaryNode {
+        Aabb bounds;
+        Aabb centroidBounds;
+        uint32_t left, right;
+        uint32_t first, count;
+    };
+    auto createBinaryNode = [&](uint32_t first, uint32_t itemCount) {
+        BinaryNode node{Aabb{}, Aabb{}, BVH_LEAF, BVH_LEAF, first, itemCount};
+        for(uint32_t i = first; i < first + itemCount; i++) {
+            node.bounds.grow(items[i].bounds);
+            node.centroidBounds.growPoint(items[i].centroid);
+        }
+        return node;
+    };
+
+    std::vector<BinaryNode> binary;
+    std::vector<uint32_t> stack;
+    if(count > 0) {
+        binary.push_back(createBinaryNode(0, count));
+        stack.push_back(0);
+    }
+
+    struct Bin {
+        Aabb bounds;
+        uint32_t count = 0;
+    };
+
+    while(!stack.empty()) {
+        uint32_t index = stack.back();
+        stack.pop_back();
+
+        uint32_t first = binary[index].first;
+        uint32_t itemCount = binary[index].count;
+        if(itemCount <= MAX_LEAF_SIZE) continue;
+
+        BuildItem* begin = items.data() + first;
+        BuildItem* end = begin + itemCount;
+        const Aabb centroidBounds = binary[index].centroidBounds;
+
+        // Binning every axis finds barely better splits than the widest one alone, at three times the cost
+        int axis = 0;
+        for(int k = 1; k < 3; k++) {
+            if(centroidBounds.max[k] - centroidBounds.min[k] > centroidBounds.max[axis] - centroidBounds.min[axis]) axis = k;
+        }
+        float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+        float binScale = extent > 0.0f ? SAH_BIN_COUNT / extent : 0.0f;
+        auto binOf = [&](const BuildItem& item) {
+            return std::min(static_cast<uint32_t>((item.centroid[axis] - centroidBounds.min[axis]) * binScale), SAH_BIN_COUNT - 1);
+        };
+
+        Bin bins[SAH_BIN_COUNT];
+        for(const BuildItem* item = begin; item != end; item++) {
+            Bin& bin = bins[binOf(*item)];
+            bin.bounds.grow(item->bounds);
+            bin.count++;
+        }
+
+        // Sweep the bins from both sides; split after bin s costs A(left) * N(left) + A(right) * N(right)
+        bool found = false;
+        uint32_t bestSplit = 0;
+        float bestCost = FLT_MAX;
+        Aabb bestLeft, bestRight;
+
+        if(binScale > 0.0f) {
+            Aabb rightBounds[SAH_BIN_COUNT];
+            uint32_t rightCounts[SAH_BIN_COUNT];
+            Aabb right;
+            uint32_t rightCount = 0;
+            for(uint32_t b = SAH_BIN_COUNT - 1; b > 0; b--) {
+                right.grow(bins[b].bounds);
+                rightCount += bins[b].count;
+                rightBounds[b] = right;
+                rightCounts[b] = rightCount;
+            }
+
+            Aabb left;
+            uint32_t leftCount = 0;
+            for(uint32_t s = 0; s + 1 < SAH_BIN_COUNT; s++) {
+                left.grow(bins[s].bounds);
+                leftCount += bins[s].count;
+                if(leftCount == 0 || rightCounts[s + 1] == 0) continue;
+
+                float cost = left.area() * leftCount + rightBounds[s + 1].area() * rightCounts[s + 1];
+                if(cost < bestCost) {
+                    found = true;
+                    bestCost = cost;
+                    bestSplit = s;
+                    bestLeft = left;
+                    bestRight = rightBounds[s + 1];
+                }
+            }
+        }
+
+        BinaryNode leftNode, rightNode;
+        if(found) {
+            // Partition by hand to gather each side's centroid bounds on the way
+            Aabb leftCentroids, rightCentroids;
+            BuildItem* middle = begin;
+            BuildItem* last = end;
+            while(middle < last) {
+                if(binOf(*middle) <= bestSplit) {
+                    leftCentroids.growPoint(middle->centroid);
+                    middle++;
+                } else {
+                    last--;
+                    std::swap(*middle, *last);
+                    rightCentroids.growPoint(last->centroid);
+                }
+            }
+
+            uint32_t leftCount = static_cast<uint32_t>(middle - begin);
+            leftNode = BinaryNode{bestLeft, leftCentroids, BVH_LEAF, BVH_LEAF, first, leftCount};
+            rightNode = BinaryNode{bestRight, rightCentroids, BVH_LEAF, BVH_LEAF, first + leftCount, itemCount - leftCount};
+        } else {
+            // Coincident centroids give the heuristic nothing to separate; halve the range
+            leftNode = createBinaryNode(first, itemCount / 2);
+            rightNode = createBinaryNode(first + itemCount / 2, itemCount - itemCount / 2);
+        }
+
+        uint32_t left = static_cast<uint32_t>(binary.size());
+        binary.push_back(leftNode);
+        binary.push_back(rightNode);
+        binary[index].left = left;
+        binary[index].right = left + 1;
+        stack.push_back(left);
+        stack.push_back(left + 1);
+    }
+
+    if(count == 0) {
+        m_instances.clear();
+        m_itemOfInstance.clear();
+        m_spheres.clear();
+        m_cost = m_builtCost = 0.0f;
+        return;
+    }
+
+    // Collapse into wide nodes: starting from a node's two children, the largest inner child is replaced by its own
+    // children until the node is full. A node left with leaves only fills up by halving its largest leaf, so the
+    // bottom of the tree doesn't end up with half empty nodes. Nodes are emitted before their children, which
+    // refit() relies on.
+    struct CollapseEntry {
+        uint32_t binary;
+        uint32_t node;
+    };
+    auto splitLeaf = [&](uint32_t index) {
+        uint32_t first = binary[index].first;
+        uint32_t itemCount = binary[index].count;
+        const Aabb& centroidBounds = binary[index].centroidBounds;
+
+        int axis = 0;
+        for(int k = 1; k < 3; k++) {
+            if(centroidBounds.max[k] - centroidBounds.min[k] > centroidBounds.max[axis] - centroidBounds.min[axis]) axis = k;
+        }
+        std::sort(items.begin() + first, items.begin() + first + itemCount, [axis](const BuildItem& a, const BuildItem& b) {
+            return a.centroid[axis] < b.centroid[axis];
+        });
+
+        uint32_t left = static_cast<uint32_t>(binary.size());
+        binary.push_back(createBinaryNode(first, itemCount / 2));
+        binary.push_back(createBinaryNode(first + itemCount / 2, itemCount - itemCount / 2));
+        binary[index].left = left;
+        binary[index].right = left + 1;
+    };
+
+    std::vector<CollapseEntry> work = {CollapseEntry{0, 0}};
+    m_nodes.push_back(createEmptyNode());
+
+    while(!work.empty()) {
+        CollapseEntry entry = work.back();
+        work.pop_back();
+
+        uint32_t children[BVH_WIDTH];
+        uint32_t childCount = 0;
+        if(binary[entry.binary].left == BVH_LEAF) {
+            children[childCount++] = entry.binary;
+        } else {
+            children[childCount++] = binary[entry.binary].left;
+            children[childCount++] = binary[entry.binary].right;
+        }
+
+        while(childCount < BVH_WIDTH) {
+            int largest = -1;
+            for(uint32_t c = 0; c < childCount; c++) {
+                if(binary[children[c]].left == BVH_LEAF) continue;
+                if(largest < 0 || binary[children[c]].bounds.area() > binary[children[largest]].bounds.area()) largest = static_cast<int>(c);
+            }
+            if(largest < 0) {
+                for(uint32_t c = 0; c < childCount; c++) {
+                    if(binary[children[c]].count < 2) continue;
+                    if(largest < 0 || binary[children[c]].count > binary[children[largest]].count) largest = static_cast<int>(c);
+                }
+                if(largest < 0) break;
+                splitLeaf(children[largest]);
+            }
+
+            uint32_t expanded = children[largest];
+            children[largest] = binary[expanded].left;
+            children[childCount++] = binary[expanded].right;
+        }
+
+        BvhNode node = createEmptyNode();
+        for(uint32_t slot = 0; slot < childCount; slot++) {
+            const BinaryNode& child = binary[children[slot]];
+            setSlotBounds(node, slot, child.bounds);
+            node.firstItem[slot] = child.first;
+            node.itemCount[slot] = child.count;
+
+            if(child.left != BVH_LEAF) {
+                node.child[slot] = static_cast<uint32_t>(m_nodes.size());
+                m_nodes.push_back(createEmptyNode());
+                work.push_back(CollapseEntry{children[slot], node.child[slot]});
+            }
+        }
+        m_nodes[entry.node] = node;
+    }
+
+    m_instances.resize(count);
+    m_itemOfInstance.resize(count);
+    m_spheres.resize(static_cast<size_t>(count) * 4);
+    for(uint32_t i = 0; i < count; i++) {
+        uint32_t instance = items[i].instance;
+        m_instances[i] = instance;
+        m_itemOfInstance[instance] = i;
+        m_spheres[i * 4 + 0] = store.centerX()[instance];
+        m_spheres[i * 4 + 1] = store.centerY()[instance];
+        m_spheres[i * 4 + 2] = store.centerZ()[instance];
+        m_spheres[i * 4 + 3] = store.radius()[instance];
+    }
+
+    m_cost = computeCost();
+    m_builtCost = m_cost;
+}
+
+void Bvh::setSphere(uint32_t instance, const float sphere[4]) {
+    std::copy(sphere, sphere + 4, &m_spheres[static_cast<size_t>(m_itemOfInstance[instance]) * 4]);
+}
+
+void Bvh::refit() {
+    for(size_t n = m_nodes.size(); n-- > 0;) {
+        BvhNode& node = m_nodes[n];
+        for(uint32_t slot = 0; slot < BVH_WIDTH; slot++) {
+            if(node.itemCount[slot] == 0) continue;
+
+            Aabb bounds;
+            if(node.child[slot] == BVH_LEAF) {
+                for(uint32_t i = node.firstItem[slot]; i < node.firstItem[slot] + node.itemCount[slot]; i++) bounds.grow(getSphereBounds(&m_spheres[i * 4]));
+            } else {
+                const BvhNode& child = m_nodes[node.child[slot]];
+                for(uint32_t c = 0; c < BVH_WIDTH; c++) if(child.itemCount[c] > 0) bounds.grow(getSlotBounds(child, c));
+            }
+            setSlotBounds(node, slot, bounds);
+        }
+    }
+
+    m_cost = computeCost();
+}
+
+/**
+ * Expected cost of a query that visits every node with a probability proportional to its area.
+ */
+float Bvh::computeCost() const {
+    if(m_nodes.empty()) return 0.0f;
+
+    Aabb root;
+    for(uint32_t slot = 0; slot < BVH_WIDTH; slot++) if(m_nodes[0].itemCount[slot] > 0) root.grow(getSlotBounds(m_nodes[0], slot));
+
+    float cost = 0.0f;
+    for(const BvhNode& node : m_nodes) {
+        for(uint32_t slot = 0; slot < BVH_WIDTH; slot++) {
+            if(node.itemCount[slot] == 0) continue;
+            float weight = (node.child[slot] == BVH_LEAF) ? static_cast<float>(node.itemCount[slot]) : SAH_TRAVERSAL_COST;
+            cost += getSlotBounds(node, slot).area() * weight;
+        }
+    }
+
+    float area = root.area();
+    return area > 0.0f ? cost / area : cost;
+}
+
+/**
+ * Sets bit i of outside for children entirely behind a plane, and of inside for children entirely in front of all
+ * six. Per plane only the box corner farthest along the normal (for outside) and the nearest (for inside) matter.
+ */
+static void classifyChildren(const BvhNode& node, const float planes[6][4], int& outside, int& inside) {
+#ifdef VKMV_BVH_SSE
+    __m128 minX = _mm_loadu_ps(node.minX), minY = _mm_loadu_ps(node.minY), minZ = _mm_loadu_ps(node.minZ);
+    __m128 maxX = _mm_loadu_ps(node.maxX), maxY = _mm_loadu_ps(node.maxY), maxZ = _mm_loadu_ps(node.maxZ);
+    __m128 anyOutside = _mm_setzero_ps();
+    __m128 allInside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    const __m128 zero = _mm_setzero_ps();
+
+    for(int p = 0; p < 6; p++) {
+        __m128 nx = _mm_set1_ps(planes[p][0]), ny = _mm_set1_ps(planes[p][1]), nz = _mm_set1_ps(planes[p][2]), d = _mm_set1_ps(planes[p][3]);
+
+        __m128 farX = planes[p][0] >= 0.0f ? maxX : minX, nearX = planes[p][0] >= 0.0f ? minX : maxX;
+        __m128 farY = planes[p][1] >= 0.0f ? maxY : minY, nearY = planes[p][1] >= 0.0f ? minY : maxY;
+        __m128 farZ = planes[p][2] >= 0.0f ? maxZ : minZ, nearZ = planes[p][2] >= 0.0f ? minZ : maxZ;
+
+        __m128 farDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, farX), _mm_mul_ps(ny, farY)), _mm_add_ps(_mm_mul_ps(nz, farZ), d));
+        __m128 nearDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nearX), _mm_mul_ps(ny, nearY)), _mm_add_ps(_mm_mul_ps(nz, nearZ), d));
+
+        anyOutside = _mm_or_ps(anyOutside, _mm_cmplt_ps(farDistance, zero));
+        allInside = _mm_and_ps(allInside, _mm_cmpge_ps(nearDistance, zero));
+    }
+
+    outside = _mm_movemask_ps(anyOutside);
+    inside = _mm_movemask_ps(allInside);
+#else
+    outside = 0;
+    inside = 0;
+    for(uint32_t slot = 0; slot < BVH_WIDTH; slot++) {
+        Aabb box = getSlotBounds(node, slot);
+        bool anyOutside = false, allInside = true;
+        for(int p = 0; p < 6; p++) {
+            float farDistance = planes[p][3], nearDistance = planes[p][3];
+            for(int k = 0; k < 3; k++) {
+                farDistance += planes[p][k] * (planes[p][k] >= 0.0f ? box.max[k] : box.min[k]);
+                nearDistance += planes[p][k] * (planes[p][k] >= 0.0f ? box.min[k] : box.max[k]);
+            }
+            anyOutside = anyOutside || farDistance < 0.0f;
+            allInside = allInside && nearDistance >= 0.0f;
+        }
+        outside |= static_cast<int>(anyOutside) << slot;
+        inside |= static_cast<int>(allInside) << slot;
+    }
+#endif
+}
+
+/**
+ * Slab test of the ray against every child. Returns bit i set for children entered before maxDistance, with the
+ * entry distance (clamped to 0 for rays starting inside) in entry[i].
+ */
+static int intersectChildren(const BvhNode& node, const float origin[3], const float inverseDirection[3], float maxDistance, float entry[BVH_WIDTH]) {
+#ifdef VKMV_BVH_SSE
+    __m128 tNear = _mm_setzero_ps();
+    __m128 tFar = _mm_set1_ps(maxDistance);
+
+    const float* minimums[3] = {node.minX, node.minY, node.minZ};
+    const float* maximums[3] = {node.maxX, node.maxY, node.maxZ};
+    for(int k = 0; k < 3; k++) {
+        __m128 o = _mm_set1_ps(origin[k]), inverse = _mm_set1_ps(inverseDirection[k]);
+        __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(minimums[k]), o), inverse);
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(maximums[k]), o), inverse);
+        tNear = _mm_max_ps(tNear, _mm_min_ps(t0, t1));
+        tFar = _mm_min_ps(tFar, _mm_max_ps(t0, t1));
+    }
+
+    _mm_storeu_ps(entry, tNear);
+    return _mm_movemask_ps(_mm_cmple_ps(tNear, tFar));
+#else
+    int mask = 0;
+    for(uint32_t slot = 0; slot < BVH_WIDTH; slot++) {
+        Aabb box = getSlotBounds(node, slot);
+        float tNear = 0.0f, tFar = maxDistance;
+        for(int k = 0; k < 3; k++) {
+            float t0 = (box.min[k] - origin[k]) * inverseDirection[k];
+            float t1 = (box.max[k] - origin[k]) * inverseDirection[k];
+            tNear = std::max(tNear, std::min(t0, t1));
+            tFar = std::min(tFar, std::max(t0, t1));
+        }
+        entry[slot] = tNear;
+        mask |= static_cast<int>(tNear <= tFar) << slot;
+    }
+    return mask;
+#endif
+}
+
+uint32_t Bvh::cullFrustum(const float planes[6][4], std::vector<uint8_t>& visibility) const {
+    visibility.assign((static_cast<size_t>(size()) + CULL_BATCH_SIZE - 1) / CULL_BATCH_SIZE, 0);
+    if(m_nodes.empty()) return 0;
+
+    uint32_t visible = 0;
+    auto markVisible = [&](uint32_t instance) {
+        visibility[instance / 8] |= static_cast<uint8_t>(1u << (instance % 8));
+        visible++;
+    };
+
+    std::vector<uint32_t> stack = {0};
+    while(!stack.empty()) {
+        const BvhNode& node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        int outside, inside;
+        classifyChildren(node, planes, outside, inside);
+
+        for(uint32_t slot = 0; slot < BVH_WIDTH; slot++) {
+            if(node.itemCount[slot] == 0 || (outside >> slot) & 1) continue;
+
+            uint32_t first = node.firstItem[slot], last = first + node.itemCount[slot];
+            if((inside >> slot) & 1) {
+                for(uint32_t i = first; i < last; i++) markVisible(m_instances[i]);
+            } else if(node.child[slot] != BVH_LEAF) {
+                stack.push_back(node.child[slot]);
+            } else {
+                // Same test as the linear kernels, so both report the same instances
+                for(uint32_t i = first; i < last; i++) {
+                    const float* sphere = &m_spheres[i * 4];
+                    float minimum = FLT_MAX;
+                    for(int p = 0; p < 6; p++) minimum = std::min(minimum, planes[p][0] * sphere[0] + planes[p][1] * sphere[1] + planes[p][2] * sphere[2] + planes[p][3]);
+                    if(minimum >= -sphere[3]) markVisible(m_instances[i]);
+                }
+            }
+        }
+    }
+
+    return visible;
+}
+
+bool Bvh::raycast(const float origin[3], const float direction[3], float maxDistance, BvhHit& hit) const {
+    if(m_nodes.empty()) return false;
+
+    float inverseDirection[3];
+    for(int k = 0; k < 3; k++) inverseDirection[k] = 1.0f / direction[k];
+    float a = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+    if(a <= 0.0f) return false;
+
+    float closest = maxDistance;
+    bool found = false;
+
+    struct StackEntry {
+        uint32_t node;
+        float entry;
+    };
+    std::vector<StackEntry> stack = {StackEntry{0, 0.0f}};
+
+    while(!stack.empty()) {
+        StackEntry top = stack.back();
+        stack.pop_back();
+        if(top.entry > closest) continue;
+
+        const BvhNode& node = m_nodes[top.node];
+        float entry[BVH_WIDTH];
+        int mask = intersectChildren(node, origin, inverseDirection, closest, entry);
+
+        // Push the farthest children first so the nearest is visited next and shrinks closest early
+        uint32_t order[BVH_WIDTH];
+        uint32_t orderCount = 0;
+        for(uint32_t slot = 0; slot < BVH_WIDTH; slot++) {
+            if(node.itemCount[slot] == 0 || !((mask >> slot) & 1)) continue;
+
+            uint32_t o = orderCount++;
+            for(; o > 0 && entry[order[o - 1]] < entry[slot]; o--) order[o] = order[o - 1];
+            order[o] = slot;
+        }
+
+        for(uint32_t o = 0; o < orderCount; o++) {
+            uint32_t slot = order[o];
+            if(node.child[slot] != BVH_LEAF) {
+                stack.push_back(StackEntry{node.child[slot], entry[slot]});
+                continue;
+            }
+
+            for(uint32_t i = node.firstItem[slot]; i < node.firstItem[slot] + node.itemCount[slot]; i++) {
+                const float* sphere = &m_spheres[i * 4];
+                float oc[3] = {origin[0] - sphere[0], origin[1] - sphere[1], origin[2] - sphere[2]};
+                float radius = sphere[3];
+                float b = oc[0] * direction[0] + oc[1] * direction[1] + oc[2] * direction[2];
+                float c = oc[0] * oc[0] + oc[1] * oc[1] + oc[2] * oc[2] - radius * radius;
+
+                float t;
+                if(c <= 0.0f) {
+                    t = 0.0f;
+                } else {
+                    float discriminant = b * b - a * c;
+                    if(b >= 0.0f || discriminant < 0.0f) continue;
+                    t = (-b - std::sqrt(discriminant)) / a;
+                }
+
+                if(t <= closest) {
+                    closest = t;
+                    hit = BvhHit{m_instances[i], t};
+                    found = true;
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+} // namespace vkmv
@@ -9,10 +9,44 @@
 #include "imgui_impl_sdl3.h"
 #include "imgui_impl_vulkan.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "vkmv/utils/CpuTrace.hpp"
+#include "vkmv/utils/Math.hpp"
+
 namespace vkmv {
 
+static const char* getPresentModeName(VkPresentModeKHR presentMode) {
+    switch(presentMode) {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR: return "Immediate";
+    case VK_PRESENT_MODE_MAILBOX_KHR: return "Mailbox";
+    case VK_PRESENT_MODE_FIFO_KHR: return "FIFO";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO relaxed";
+    default: return "Other";
+    }
+}
+
+constexpr float CAMERA_FOV_Y = 0.8f;
+
+// Radians per second of the "Spin models" animation
+constexpr float SPIN_SPEED = 0.5f;
+constexpr float TWO_PI = 6.28318530718f;
+
+// Refits leave the tree's topology alone; once its cost doubles a full rebuild is worth the time
+constexpr float BVH_REBUILD_DEGRADATION = 2.0f;
+
+// Mouse travel in pixels below which a left click picks instead of orbiting
+constexpr float PICK_CLICK_DISTANCE = 3.0f;
+
+// Written to the working directory by the GPU profiler panel
+constexpr const char* GPU_TRACE_PATH = "gpu_trace.json";
+
 Engine::Engine(const Renderer& renderer)
-: renderer(renderer) {
+: renderer(renderer), maxQueuedFrames(static_cast<int>(renderer.getFramesInFlight())), dynamicResolution(!renderer.isHeadless()) {
 
 }
 
@@ -22,12 +56,302 @@ Engine::~Engine() {
 
 void Engine::handleEvent(SDL_Event e) {
     ImGui_ImplSDL3_ProcessEvent(&e);
+
+    bool uiCaptured = ImGui::GetIO().WantCaptureMouse;
+
+    switch(e.type) {
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        if(e.button.button == SDL_BUTTON_LEFT && !uiCaptured) {
+            cameraDragging = true;
+            cameraDragDistance = 0.0f;
+        }
+        break;
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+        if(e.button.button == SDL_BUTTON_LEFT && cameraDragging) {
+            cameraDragging = false;
+            if(cameraDragDistance < PICK_CLICK_DISTANCE) pickInstance(e.button.x, e.button.y);
+        }
+        break;
+    case SDL_EVENT_MOUSE_MOTION:
+        if(cameraDragging) {
+            cameraDragDistance += std::abs(e.motion.xrel) + std::abs(e.motion.yrel);
+            cameraYaw -= e.motion.xrel * 0.01f;
+            cameraPitch = std::clamp(cameraPitch + e.motion.yrel * 0.01f, -1.5f, 1.5f);
+        }
+        break;
+    case SDL_EVENT_MOUSE_WHEEL:
+        if(!uiCaptured) cameraZoom = std::clamp(cameraZoom * std::pow(0.9f, e.wheel.y), 0.05f, 20.0f);
+        break;
+    default:
+        break;
+    }
 }
 
 void Engine::update(RenderableState& r) {
+    VKMV_TRACE_SCOPE("Engine Update");
+
+    // Events were polled right before this update
+    r.inputTime = std::chrono::steady_clock::now();
+    r.presentMode = presentMode;
+    r.maxQueuedFrames = static_cast<uint32_t>(maxQueuedFrames);
+    r.dynamicResolution = dynamicResolution;
+    r.gpuBudgetMilliseconds = gpuBudgetMilliseconds;
+
+    // The renderer may be adding models on its own thread
+    std::unique_lock<std::mutex> sceneLock = renderer.lockScene();
+
     newUIFrame();
 
     buildUI();
+
+    renderUI(r);
+
+    updateCamera(r);
+
+    updateScene(r);
+
+    cullInstances(r);
+
+    selectLods(r);
+}
+
+/**
+ * Frames the scene bounds so the whole model is in view at zoom 1, whatever its scale.
+ */
+void Engine::updateCamera(RenderableState& r) {
+    float boundsMin[3] = {-1.0f, -1.0f, -1.0f}, boundsMax[3] = {1.0f, 1.0f, 1.0f};
+    renderer.getSceneBounds(boundsMin, boundsMax);
+
+    float target[3], radius = 0.0f;
+    for(int i = 0; i < 3; i++) {
+        target[i] = 0.5f * (boundsMin[i] + boundsMax[i]);
+        radius += (boundsMax[i] - boundsMin[i]) * (boundsMax[i] - boundsMin[i]);
+    }
+    radius = std::max(0.5f * std::sqrt(radius), 1e-3f);
+
+    float distance = cameraZoom * radius / std::sin(CAMERA_FOV_Y * 0.5f);
+
+    float eye[3] = {target[0] + distance * std::cos(cameraPitch) * std::sin(cameraYaw),
+                    target[1] + distance * std::sin(cameraPitch),
+                    target[2] + distance * std::cos(cameraPitch) * std::cos(cameraYaw)};
+    float up[3] = {0.0f, 1.0f, 0.0f};
+
+    VkExtent2D extent = renderer.getRenderExtent();
+    float aspect = static_cast<float>(extent.width) / static_cast<float>(std::max(extent.height, 1u));
+
+    float view[16], projection[16];
+    lookAtMatrix(eye, target, up, view);
+    perspectiveMatrix(CAMERA_FOV_Y, aspect, std::max(distance - radius, distance * 1e-3f), distance + radius, projection);
+    multiplyMatrices(projection, view, r.viewProjection);
+    std::memcpy(r.cameraPosition, eye, sizeof(eye));
+
+    std::memcpy(cameraEye, eye, sizeof(eye));
+    std::memcpy(cameraTarget, target, sizeof(target));
+    cameraAspect = aspect;
+}
+
+/**
+ * Adds the nodes of models that finished importing, animates the model roots and propagates the changes. Only
+ * instances below a changed node get new world bounds and have their transform sent to the renderer.
+ */
+void Engine::updateScene(RenderableState& r) {
+    VKMV_TRACE_SCOPE("Update Scene");
+
+    static const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+    const std::vector<Model>& models = renderer.getModels();
+    const std::vector<LodInstance>& instances = renderer.getLodInstances();
+    r.transformUpdates.clear();
+
+    uint32_t instanceCount = instanceStore.size();
+    std::vector<uint32_t> nodes;
+    for(size_t m = modelRoots.size(); m < models.size(); m++) {
+        const Model& model = models[m];
+        uint32_t root = sceneGraph.addNode(SCENE_NODE_NONE, identity);
+        modelRoots.push_back(root);
+
+        // Model nodes are sorted by depth, so parents are added first
+        nodes.resize(model.nodes.size());
+        for(size_t n = 0; n < model.nodes.size(); n++) {
+            const ModelNode& node = model.nodes[n];
+            nodes[n] = sceneGraph.addNode(node.parent == MODEL_NODE_ROOT ? root : nodes[node.parent], node.localTransform);
+        }
+
+        nodeInstances.resize(sceneGraph.size(), SCENE_NODE_NONE);
+        for(const ModelInstance& instance : model.instances) {
+            nodeInstances[nodes[instance.node]] = instanceCount;
+            sceneGraph.setLocalBounds(nodes[instance.node], instances[instanceCount].sphere);
+            instanceCount++;
+        }
+    }
+    instanceStore.resize(instanceCount);
+    instanceScales.resize(instanceCount, 1.0f);
+
+    if(spinModels && !modelRoots.empty()) {
+        spinAngle = std::fmod(spinAngle + ImGui::GetIO().DeltaTime * SPIN_SPEED, TWO_PI);
+
+        // Rotation about the vertical axis through the center of the scene
+        float boundsMin[3] = {0.0f, 0.0f, 0.0f}, boundsMax[3] = {0.0f, 0.0f, 0.0f};
+        renderer.getSceneBounds(boundsMin, boundsMax);
+        float x = 0.5f * (boundsMin[0] + boundsMax[0]), z = 0.5f * (boundsMin[2] + boundsMax[2]);
+        float c = std::cos(spinAngle), s = std::sin(spinAngle);
+
+        float rotation[16] = {c, 0.0f, -s, 0.0f,
+                              0.0f, 1.0f, 0.0f, 0.0f,
+                              s, 0.0f, c, 0.0f,
+                              x - (c * x + s * z), 0.0f, z - (c * z - s * x), 1.0f};
+        for(uint32_t root : modelRoots) sceneGraph.setLocalTransform(root, rotation);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    const std::vector<uint32_t>& changed = sceneGraph.update();
+    bool moved = false;
+    for(uint32_t node : changed) {
+        uint32_t instance = nodeInstances[node];
+        if(instance == SCENE_NODE_NONE) continue;
+
+        const float* transform = sceneGraph.getWorldTransform(node);
+        instanceStore.setSphere(instance, sceneGraph.getWorldBounds(node));
+        if(instance < bvh.size()) bvh.setSphere(instance, sceneGraph.getWorldBounds(node));
+        instanceScales[instance] = getMaxScale(transform);
+        moved = true;
+
+        InstanceTransform update{instance, {}};
+        std::memcpy(update.transform, transform, sizeof(update.transform));
+        r.transformUpdates.push_back(update);
+    }
+
+    updatedNodes = static_cast<uint32_t>(changed.size());
+    sceneMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    updateBvh(moved);
+}
+
+/**
+ * Builds the tree when instances were added, otherwise refits it if any moved. Spheres must be in the store first.
+ */
+void Engine::updateBvh(bool moved) {
+    bool rebuild = bvh.size() != instanceStore.size();
+    if(!rebuild && !moved) return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    if(!rebuild) {
+        bvh.refit();
+        rebuild = bvh.getDegradation() > BVH_REBUILD_DEGRADATION;
+    }
+    if(rebuild) {
+        bvh.build(instanceStore);
+        bvhBuilds++;
+    }
+
+    bvhMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Casts a ray from the camera through a window position and keeps the closest instance whose bounding sphere it hits.
+ */
+void Engine::pickInstance(float x, float y) {
+    ImVec2 display = ImGui::GetIO().DisplaySize;
+    if(display.x <= 0.0f || display.y <= 0.0f) return;
+
+    float forward[3], right[3], up[3];
+    for(int i = 0; i < 3; i++) forward[i] = cameraTarget[i] - cameraEye[i];
+    float length = std::sqrt(forward[0] * forward[0] + forward[1] * forward[1] + forward[2] * forward[2]);
+    for(float& f : forward) f /= length;
+
+    // Same basis as lookAtMatrix with world up +Y
+    right[0] = -forward[2];
+    right[1] = 0.0f;
+    right[2] = forward[0];
+    length = std::sqrt(right[0] * right[0] + right[2] * right[2]);
+    for(float& f : right) f /= length;
+    up[0] = right[1] * forward[2] - right[2] * forward[1];
+    up[1] = right[2] * forward[0] - right[0] * forward[2];
+    up[2] = right[0] * forward[1] - right[1] * forward[0];
+
+    float tanHalfFov = std::tan(CAMERA_FOV_Y * 0.5f);
+    float ndcX = (2.0f * x / display.x - 1.0f) * tanHalfFov * cameraAspect;
+    float ndcY = (1.0f - 2.0f * y / display.y) * tanHalfFov;
+
+    float direction[3];
+    for(int i = 0; i < 3; i++) direction[i] = forward[i] + right[i] * ndcX + up[i] * ndcY;
+
+    BvhHit hit;
+    if(bvh.raycast(cameraEye, direction, FLT_MAX, hit)) {
+        pickedInstance = hit.instance;
+        length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+        pickedDistance = hit.distance * length;
+    } else {
+        pickedInstance = SCENE_NODE_NONE;
+    }
+}
+
+/**
+ * Tests every instance's world bounding sphere against the view frustum. The camera and scene must be updated first.
+ */
+void Engine::cullInstances(const RenderableState& r) {
+    VKMV_TRACE_SCOPE("Cull Instances");
+
+    if(!cpuCulling) {
+        instanceVisibility.assign((instanceStore.size() + CULL_BATCH_SIZE - 1) / CULL_BATCH_SIZE, 0xFF);
+        visibleInstances = instanceStore.size();
+        cullMilliseconds = 0.0f;
+        return;
+    }
+
+    float planes[6][4];
+    extractFrustumPlanes(r.viewProjection, planes);
+
+    auto start = std::chrono::steady_clock::now();
+    if(bvhCulling) visibleInstances = bvh.cullFrustum(planes, instanceVisibility);
+    else visibleInstances = cullSpheres(instanceStore, planes, cullKernel, instanceVisibility);
+    cullMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Picks for every visible instance the coarsest level whose error, projected at the instance's closest point to the
+ * camera, stays within lodPixelError pixels. Culled instances are marked LOD_CULLED. Instances must be culled first.
+ */
+void Engine::selectLods(RenderableState& r) {
+    VKMV_TRACE_SCOPE("Select LODs");
+
+    const std::vector<LodInstance>& instances = renderer.getLodInstances();
+    r.instanceLods.assign(instances.size(), 0);
+    lodTriangles = 0;
+    fullTriangles = 0;
+
+    // Pixels covered by one world unit at distance 1
+    float pixelsPerUnit = static_cast<float>(renderer.getRenderExtent().height) / (2.0f * std::tan(CAMERA_FOV_Y * 0.5f));
+
+    for(uint32_t i = 0; i < instances.size(); i++) {
+        if(!isInstanceVisible(instanceVisibility, i)) {
+            r.instanceLods[i] = LOD_CULLED;
+            continue;
+        }
+
+        const LodInstance& instance = instances[i];
+        uint32_t lod = 0;
+
+        if(lodEnabled) {
+            float d[3] = {instanceStore.centerX()[i] - r.cameraPosition[0], instanceStore.centerY()[i] - r.cameraPosition[1],
+                          instanceStore.centerZ()[i] - r.cameraPosition[2]};
+            float distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) - instanceStore.radius()[i];
+
+            // Errors are in mesh space; the largest axis scale bounds how much the instance magnifies them
+            float scale = instanceScales[i] * pixelsPerUnit;
+
+            // Inside the bounds some part may be arbitrarily close, so only instances fully in front are reduced
+            if(distance > 0.0f) {
+                while(lod + 1 < instance.lodCount && instance.errors[lod + 1] * scale <= lodPixelError * distance) lod++;
+            }
+        }
+
+        r.instanceLods[i] = lod;
+        lodTriangles += instance.triangles[lod];
+        fullTriangles += instance.triangles[0];
+    }
 }
 
 /**
@@ -35,18 +359,190 @@ void Engine::update(RenderableState& r) {
  */
 void Engine::newUIFrame() {
     ImGui_ImplVulkan_NewFrame();
-    ImGui_ImplSDL3_NewFrame();
+
+    if(renderer.isHeadless()) {
+        // No platform backend is attached when headless, so size and timing are provided here
+        ImGuiIO& io = ImGui::GetIO();
+        VkExtent2D extent = renderer.getRenderExtent();
+        io.DisplaySize = ImVec2(static_cast<float>(extent.width), static_cast<float>(extent.height));
+        io.DeltaTime = 1.0f / 60.0f;
+    } else {
+        ImGui_ImplSDL3_NewFrame();
+    }
+
     ImGui::NewFrame();
 }
 
+/**
+ * @brief Ends the UI frame and copies its draw data into the state, so the renderer can record it on another thread
+ */
+void Engine::renderUI(RenderableState& r) {
+    ImGui::Render();
+    r.ui.capture(ImGui::GetDrawData());
+}
+
 void Engine::buildUI() {
+    VKMV_TRACE_SCOPE("Build UI");
+
     ImVec2 viewport = ImGui::GetMainViewport()->WorkPos;
     ImVec2 viewportSize = ImGui::GetMainViewport()->WorkSize;
 
     ImGui::BeginMainMenuBar();
 
+    if(ImGui::BeginMenu("View")) {
+        ImGui::MenuItem("Scene Panel", nullptr, &panel_open);
+        ImGui::MenuItem("GPU Profiler", nullptr, &profilerPanelOpen);
+        ImGui::EndMenu();
+    }
+
+    if(renderer.isImporting()) ImGui::TextUnformatted("Importing model...");
+
     ImGui::EndMainMenuBar();
 
+    if(profilerPanelOpen) buildProfilerUI();
+
+    if(!panel_open) return;
+
+    ImGui::SetNextWindowPos(viewport, ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(panel_width, viewportSize.y * 0.5f), ImGuiCond_FirstUseEver);
+
+    if(ImGui::Begin("Scene", &panel_open)) {
+        if(ImGui::CollapsingHeader("Level of Detail", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::Checkbox("Automatic LOD", &lodEnabled);
+            ImGui::SliderFloat("Max error (px)", &lodPixelError, 0.25f, 16.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+
+            // Counted over the instances that survive CPU culling
+            ImGui::Text("Triangles: %llu / %llu", static_cast<unsigned long long>(lodTriangles), static_cast<unsigned long long>(fullTriangles));
+        }
+
+        if(ImGui::CollapsingHeader("Culling", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::Checkbox("CPU frustum culling", &cpuCulling);
+            ImGui::Checkbox("Hierarchical (BVH)", &bvhCulling);
+
+            if(ImGui::BeginCombo("Kernel", getCullKernelName(cullKernel))) {
+                for(CullKernel kernel : {CullKernel::Scalar, CullKernel::SSE, CullKernel::AVX2}) {
+                    if(!isCullKernelSupported(kernel)) continue;
+                    if(ImGui::Selectable(getCullKernelName(kernel), kernel == cullKernel)) cullKernel = kernel;
+                }
+                ImGui::EndCombo();
+            }
+
+            ImGui::Text("Instances: %u / %u", visibleInstances, instanceStore.size());
+            ImGui::Text("CPU cull: %.3f ms", cullMilliseconds);
+        }
+
+        if(ImGui::CollapsingHeader("Scene Graph", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::Checkbox("Spin models", &spinModels);
+
+            ImGui::Text("Nodes updated: %u / %u", updatedNodes, sceneGraph.size());
+            ImGui::Text("Update: %.3f ms", sceneMilliseconds);
+        }
+
+        if(ImGui::CollapsingHeader("BVH", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::Text("Nodes: %u, builds: %u", bvh.getNodeCount(), bvhBuilds);
+            ImGui::Text("Degradation: %.2f", bvh.getDegradation());
+            ImGui::Text("Refit/build: %.3f ms", bvhMilliseconds);
+
+            // Picking hits bounding spheres; triangles only live on the GPU
+            if(pickedInstance != SCENE_NODE_NONE) ImGui::Text("Picked: instance %u at %.2f", pickedInstance, pickedDistance);
+            else ImGui::TextUnformatted("Picked: none (click the scene)");
+        }
+
+        if(ImGui::CollapsingHeader("Frame Pacing", ImGuiTreeNodeFlags_DefaultOpen)) {
+            const std::vector<VkPresentModeKHR>& presentModes = renderer.getSupportedPresentModes();
+            if(!presentModes.empty() && ImGui::BeginCombo("Present mode", getPresentModeName(presentMode))) {
+                for(VkPresentModeKHR mode : presentModes) {
+                    if(ImGui::Selectable(getPresentModeName(mode), mode == presentMode)) presentMode = mode;
+                }
+                ImGui::EndCombo();
+            }
+
+            ImGui::SliderInt("Max queued frames", &maxQueuedFrames, 1, static_cast<int>(renderer.getFramesInFlight()));
+
+            // Without VK_KHR_present_wait the display can't be waited for, and latency ends at GPU completion
+            FramePacingStats stats = renderer.getFramePacingStats();
+            ImGui::Text("Input to %s: %.2f ms", stats.measuredAtPresent ? "present" : "GPU done", stats.latencyMilliseconds);
+            ImGui::Text("Average: %.2f ms, max: %.2f ms", stats.averageMilliseconds, stats.maxMilliseconds);
+        }
+
+        if(ImGui::CollapsingHeader("Dynamic Resolution", ImGuiTreeNodeFlags_DefaultOpen)) {
+            if(renderer.isDynamicResolutionSupported()) {
+                ImGui::Checkbox("Dynamic resolution", &dynamicResolution);
+                ImGui::SliderFloat("GPU budget (ms)", &gpuBudgetMilliseconds, 4.0f, 33.0f, "%.1f");
+
+                VkExtent2D extent = renderer.getRenderExtent();
+                float scale = renderer.getRenderScale();
+                ImGui::Text("GPU: %.2f ms", renderer.getGpuFrameMilliseconds());
+                ImGui::Text("Scale: %.0f%% (%.0f x %.0f)", scale * 100.0f, extent.width * scale, extent.height * scale);
+            } else {
+                ImGui::TextUnformatted("Unsupported: no GPU timestamps");
+            }
+        }
+    }
+    ImGui::End();
+
+}
+
+/**
+ * @brief Shows the scopes of the last frame the GPU profiler read back, indented by nesting. Hovering a scope with
+ * pipeline statistics shows them all.
+ */
+void Engine::buildProfilerUI() {
+    const GpuProfiler& profiler = renderer.getGpuProfiler();
+
+    ImVec2 viewportSize = ImGui::GetMainViewport()->WorkSize;
+    ImGui::SetNextWindowSize(ImVec2(360.0f, viewportSize.y * 0.4f), ImGuiCond_FirstUseEver);
+
+    if(ImGui::Begin("GPU Profiler", &profilerPanelOpen)) {
+        if(!profiler.isSupported()) {
+            ImGui::TextUnformatted("Unsupported: no GPU timestamps");
+            ImGui::End();
+            return;
+        }
+
+        GpuFrameProfile frame = profiler.getLastFrame();
+        ImGui::Text("Frame %llu: %.3f ms", static_cast<unsigned long long>(frame.frame), profiler.getFrameMilliseconds());
+        if(!profiler.hasPipelineStatistics()) ImGui::TextDisabled("Pipeline statistics unsupported");
+
+        if(ImGui::BeginTable("Scopes", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("Scope");
+            ImGui::TableSetupColumn("ms");
+            ImGui::TableSetupColumn("Fragments");
+            ImGui::TableHeadersRow();
+
+            for(const GpuScope& scope : frame.scopes) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%*s%s", static_cast<int>(2 * scope.depth), "", scope.name.c_str());
+
+                if(scope.hasStatistics && ImGui::IsItemHovered()) {
+                    const GpuPipelineStatistics& s = scope.statistics;
+                    ImGui::SetTooltip("Input vertices: %llu\nInput primitives: %llu\nVertex invocations: %llu\n"
+                                      "Clipping invocations: %llu\nClipping primitives: %llu\n"
+                                      "Fragment invocations: %llu\nCompute invocations: %llu",
+                                      static_cast<unsigned long long>(s.inputVertices), static_cast<unsigned long long>(s.inputPrimitives),
+                                      static_cast<unsigned long long>(s.vertexInvocations), static_cast<unsigned long long>(s.clippingInvocations),
+                                      static_cast<unsigned long long>(s.clippingPrimitives), static_cast<unsigned long long>(s.fragmentInvocations),
+                                      static_cast<unsigned long long>(s.computeInvocations));
+                }
+
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", scope.endMilliseconds - scope.beginMilliseconds);
+
+                ImGui::TableNextColumn();
+                if(scope.hasStatistics) ImGui::Text("%llu", static_cast<unsigned long long>(scope.statistics.fragmentInvocations));
+                else ImGui::TextDisabled("-");
+            }
+            ImGui::EndTable();
+        }
+
+        if(ImGui::Button("Export Chrome trace")) {
+            bool written = profiler.writeChromeTrace(GPU_TRACE_PATH);
+            profilerStatus = written ? std::string("Wrote ") + GPU_TRACE_PATH : std::string("Failed to write ") + GPU_TRACE_PATH;
+        }
+        if(!profilerStatus.empty()) ImGui::TextUnformatted(profilerStatus.c_str());
+    }
+    ImGui::End();
 }
 
 } // namespace vkmv
\ No newline at end of file
@@ -0,0 +1,214 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/engine/InstanceCulling.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <cfloat>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VKMV_CULL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX2 and FMA instructions inside functions compiled for them; MSVC always does
+#if defined(__GNUC__) || defined(__clang__)
+#define VKMV_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define VKMV_TARGET_AVX2
+#endif
+
+namespace vkmv {
+
+void InstanceStore::resize(uint32_t count) {
+    m_count = count;
+
+    // Entries past the old padding start out as zero spheres; existing ones are kept
+    size_t padded = (static_cast<size_t>(count) + CULL_BATCH_SIZE - 1) / CULL_BATCH_SIZE * CULL_BATCH_SIZE;
+    m_centerX.resize(padded, 0.0f);
+    m_centerY.resize(padded, 0.0f);
+    m_centerZ.resize(padded, 0.0f);
+    m_radius.resize(padded, 0.0f);
+}
+
+void InstanceStore::setSphere(uint32_t index, const float sphere[4]) {
+    m_centerX[index] = sphere[0];
+    m_centerY[index] = sphere[1];
+    m_centerZ[index] = sphere[2];
+    m_radius[index] = sphere[3];
+}
+
+// Kernels write one visibility byte per batch of CULL_BATCH_SIZE spheres; cullSpheres masks the padding and counts
+
+static void cullScalar(const InstanceStore& store, const float planes[6][4], uint8_t* visibility) {
+    uint32_t batches = (store.size() + CULL_BATCH_SIZE - 1) / CULL_BATCH_SIZE;
+
+    for(uint32_t b = 0; b < batches; b++) {
+        uint8_t bits = 0;
+        for(uint32_t lane = 0; lane < CULL_BATCH_SIZE; lane++) {
+            size_t i = static_cast<size_t>(b) * CULL_BATCH_SIZE + lane;
+            float x = store.centerX()[i], y = store.centerY()[i], z = store.centerZ()[i];
+
+            // Branch free so the compiler can keep every plane in flight
+            float minimum = planes[0][0] * x + planes[0][1] * y + planes[0][2] * z + planes[0][3];
+            for(int p = 1; p < 6; p++) minimum = std::min(minimum, planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3]);
+
+            bits |= static_cast<uint8_t>(minimum >= -store.radius()[i]) << lane;
+        }
+        visibility[b] = bits;
+    }
+}
+
+#ifdef VKMV_CULL_X86
+
+static void cullSSE(const InstanceStore& store, const float planes[6][4], uint8_t* visibility) {
+    uint32_t batches = (store.size() + CULL_BATCH_SIZE - 1) / CULL_BATCH_SIZE;
+
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for(int p = 0; p < 6; p++) {
+        planeX[p] = _mm_set1_ps(planes[p][0]);
+        planeY[p] = _mm_set1_ps(planes[p][1]);
+        planeZ[p] = _mm_set1_ps(planes[p][2]);
+        planeW[p] = _mm_set1_ps(planes[p][3]);
+    }
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    for(uint32_t b = 0; b < batches; b++) {
+        int bits = 0;
+        for(uint32_t half = 0; half < 2; half++) {
+            size_t i = static_cast<size_t>(b) * CULL_BATCH_SIZE + half * 4;
+            __m128 x = _mm_loadu_ps(store.centerX() + i);
+            __m128 y = _mm_loadu_ps(store.centerY() + i);
+            __m128 z = _mm_loadu_ps(store.centerZ() + i);
+            __m128 negativeRadius = _mm_xor_ps(_mm_loadu_ps(store.radius() + i), signBit);
+
+            __m128 minimum = _mm_set1_ps(FLT_MAX);
+            for(int p = 0; p < 6; p++) {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+                                             _mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+                minimum = _mm_min_ps(minimum, distance);
+            }
+            bits |= _mm_movemask_ps(_mm_cmpge_ps(minimum, negativeRadius)) << (half * 4);
+        }
+        visibility[b] = static_cast<uint8_t>(bits);
+    }
+}
+
+VKMV_TARGET_AVX2 static void cullAVX2(const InstanceStore& store, const float planes[6][4], uint8_t* visibility) {
+    uint32_t batches = (store.size() + CULL_BATCH_SIZE - 1) / CULL_BATCH_SIZE;
+
+    __m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for(int p = 0; p < 6; p++) {
+        planeX[p] = _mm256_set1_ps(planes[p][0]);
+        planeY[p] = _mm256_set1_ps(planes[p][1]);
+        planeZ[p] = _mm256_set1_ps(planes[p][2]);
+        planeW[p] = _mm256_set1_ps(planes[p][3]);
+    }
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    for(uint32_t b = 0; b < batches; b++) {
+        size_t i = static_cast<size_t>(b) * CULL_BATCH_SIZE;
+        __m256 x = _mm256_loadu_ps(store.centerX() + i);
+        __m256 y = _mm256_loadu_ps(store.centerY() + i);
+        __m256 z = _mm256_loadu_ps(store.centerZ() + i);
+        __m256 negativeRadius = _mm256_xor_ps(_mm256_loadu_ps(store.radius() + i), signBit);
+
+        // Visible if the smallest signed distance to any plane is at least -radius
+        __m256 minimum = _mm256_fmadd_ps(planeX[0], x, _mm256_fmadd_ps(planeY[0], y, _mm256_fmadd_ps(planeZ[0], z, planeW[0])));
+        for(int p = 1; p < 6; p++) {
+            __m256 distance = _mm256_fmadd_ps(planeX[p], x, _mm256_fmadd_ps(planeY[p], y, _mm256_fmadd_ps(planeZ[p], z, planeW[p])));
+            minimum = _mm256_min_ps(minimum, distance);
+        }
+
+        visibility[b] = static_cast<uint8_t>(_mm256_movemask_ps(_mm256_cmp_ps(minimum, negativeRadius, _CMP_GE_OQ)));
+    }
+}
+
+static bool cpuSupportsAVX2() {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7) return false;
+
+    // FMA, OSXSAVE and AVX, then the OS must save the YMM registers
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if(!fma || !osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+#endif // VKMV_CULL_X86
+
+const char* getCullKernelName(CullKernel kernel) {
+    switch(kernel) {
+        case CullKernel::Scalar: return "Scalar";
+        case CullKernel::SSE: return "SSE";
+        case CullKernel::AVX2: return "AVX2";
+        default: return "Unknown";
+    }
+}
+
+bool isCullKernelSupported(CullKernel kernel) {
+#ifdef VKMV_CULL_X86
+    // SSE2 is part of x86-64, and every 32 bit target this builds for
+    static const bool avx2 = cpuSupportsAVX2();
+    if(kernel == CullKernel::SSE) return true;
+    if(kernel == CullKernel::AVX2) return avx2;
+#endif
+    return kernel == CullKernel::Scalar;
+}
+
+CullKernel getBestCullKernel() {
+    if(isCullKernelSupported(CullKernel::AVX2)) return CullKernel::AVX2;
+    if(isCullKernelSupported(CullKernel::SSE)) return CullKernel::SSE;
+    return CullKernel::Scalar;
+}
+
+uint32_t cullSpheres(const InstanceStore& store, const float planes[6][4], CullKernel kernel, std::vector<uint8_t>& visibility) {
+    uint32_t batches = (store.size() + CULL_BATCH_SIZE - 1) / CULL_BATCH_SIZE;
+    visibility.resize(batches);
+    if(batches == 0) return 0;
+
+    if(!isCullKernelSupported(kernel)) kernel = CullKernel::Scalar;
+
+    switch(kernel) {
+#ifdef VKMV_CULL_X86
+        case CullKernel::AVX2: cullAVX2(store, planes, visibility.data()); break;
+        case CullKernel::SSE: cullSSE(store, planes, visibility.data()); break;
+#endif
+        default: cullScalar(store, planes, visibility.data()); break;
+    }
+
+    uint32_t tail = store.size() % CULL_BATCH_SIZE;
+    if(tail != 0) visibility[batches - 1] &= static_cast<uint8_t>((1u << tail) - 1);
+
+    size_t visible = 0;
+    size_t words = visibility.size() / sizeof(uint64_t);
+    for(size_t w = 0; w < words; w++) {
+        uint64_t word;
+        std::memcpy(&word, visibility.data() + w * sizeof(uint64_t), sizeof(word));
+        visible += std::bitset<64>(word).count();
+    }
+    for(size_t b = words * sizeof(uint64_t); b < visibility.size(); b++) visible += std::bitset<8>(visibility[b]).count();
+
+    return static_cast<uint32_t>(visible);
+}
+
+} // namespace vkmv
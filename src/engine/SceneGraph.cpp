@@ -0,0 +1,137 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/engine/SceneGraph.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "vkmv/utils/Math.hpp"
+
+namespace vkmv {
+
+uint32_t SceneGraph::addNode(uint32_t parent, const float localTransform[16]) {
+    uint32_t parentSlot = SCENE_NODE_NONE;
+    uint32_t depth = 0;
+    if(parent != SCENE_NODE_NONE) {
+        if(parent >= m_slots.size()) throw std::runtime_error("Scene graph node parent does not exist!");
+        parentSlot = m_slots[parent];
+        depth = m_depths[parentSlot] + 1;
+    }
+
+    // Appending keeps parents first either way; only the depth order needs restoring
+    if(!m_depths.empty() && depth < m_depths.back()) m_sorted = false;
+
+    uint32_t handle = static_cast<uint32_t>(m_slots.size());
+    uint32_t slot = static_cast<uint32_t>(m_handles.size());
+    m_slots.push_back(slot);
+
+    m_handles.push_back(handle);
+    m_parents.push_back(parentSlot);
+    m_depths.push_back(depth);
+    m_local.insert(m_local.end(), localTransform, localTransform + 16);
+    m_world.resize(m_world.size() + 16);
+    m_localBounds.resize(m_localBounds.size() + 4, 0.0f);
+    m_worldBounds.resize(m_worldBounds.size() + 4, 0.0f);
+    m_dirty.push_back(0);
+    m_changed.push_back(0);
+
+    markDirty(slot);
+    return handle;
+}
+
+void SceneGraph::setLocalBounds(uint32_t node, const float sphere[4]) {
+    uint32_t slot = m_slots[node];
+    std::memcpy(&m_localBounds[slot * 4], sphere, 4 * sizeof(float));
+    markDirty(slot);
+}
+
+void SceneGraph::setLocalTransform(uint32_t node, const float localTransform[16]) {
+    uint32_t slot = m_slots[node];
+    std::memcpy(&m_local[slot * 16], localTransform, 16 * sizeof(float));
+    markDirty(slot);
+}
+
+const std::vector<uint32_t>& SceneGraph::update() {
+    for(uint32_t handle : m_changedNodes) m_changed[m_slots[handle]] = 0;
+    m_changedNodes.clear();
+
+    if(!m_sorted) sortByDepth();
+    if(m_firstDirty == SCENE_NODE_NONE) return m_changedNodes;
+
+    // Parents precede children, so a parent's changed flag is final by the time its children are visited
+    uint32_t count = static_cast<uint32_t>(m_handles.size());
+    for(uint32_t slot = m_firstDirty; slot < count; slot++) {
+        uint32_t parent = m_parents[slot];
+        if(!m_dirty[slot] && (parent == SCENE_NODE_NONE || !m_changed[parent])) continue;
+
+        float* world = &m_world[slot * 16];
+        if(parent == SCENE_NODE_NONE) std::memcpy(world, &m_local[slot * 16], 16 * sizeof(float));
+        else multiplyMatrices(&m_world[parent * 16], &m_local[slot * 16], world);
+
+        const float* local = &m_localBounds[slot * 4];
+        float* bounds = &m_worldBounds[slot * 4];
+        transformSphere(world, local, local[3], bounds, &bounds[3]);
+
+        m_dirty[slot] = 0;
+        m_changed[slot] = 1;
+        m_changedNodes.push_back(m_handles[slot]);
+    }
+
+    m_firstDirty = SCENE_NODE_NONE;
+    return m_changedNodes;
+}
+
+void SceneGraph::markDirty(uint32_t slot) {
+    m_dirty[slot] = 1;
+    m_firstDirty = std::min(m_firstDirty, slot);
+}
+
+/**
+ * Stable counting sort of every array by depth. Nodes of equal depth keep their order, so the result only
+ * depends on the order nodes were added in.
+ */
+void SceneGraph::sortByDepth() {
+    uint32_t count = static_cast<uint32_t>(m_handles.size());
+    uint32_t maxDepth = *std::max_element(m_depths.begin(), m_depths.end());
+
+    std::vector<uint32_t> offsets(maxDepth + 2, 0);
+    for(uint32_t depth : m_depths) offsets[depth + 1]++;
+    for(uint32_t d = 1; d < offsets.size(); d++) offsets[d] += offsets[d - 1];
+
+    std::vector<uint32_t> newSlots(count);
+    for(uint32_t slot = 0; slot < count; slot++) newSlots[slot] = offsets[m_depths[slot]]++;
+
+    auto permute = [&](auto& array, size_t width) {
+        std::remove_reference_t<decltype(array)> sorted(array.size());
+        for(uint32_t slot = 0; slot < count; slot++) {
+            std::copy_n(array.begin() + slot * width, width, sorted.begin() + newSlots[slot] * width);
+        }
+        array.swap(sorted);
+    };
+
+    permute(m_handles, 1);
+    permute(m_parents, 1);
+    permute(m_depths, 1);
+    permute(m_local, 16);
+    permute(m_world, 16);
+    permute(m_localBounds, 4);
+    permute(m_worldBounds, 4);
+    permute(m_dirty, 1);
+    permute(m_changed, 1);
+
+    m_firstDirty = SCENE_NODE_NONE;
+    for(uint32_t slot = 0; slot < count; slot++) {
+        if(m_parents[slot] != SCENE_NODE_NONE) m_parents[slot] = newSlots[m_parents[slot]];
+        m_slots[m_handles[slot]] = slot;
+        if(m_dirty[slot] && m_firstDirty == SCENE_NODE_NONE) m_firstDirty = slot;
+    }
+
+    m_sorted = true;
+}
+
+} // namespace vkmv
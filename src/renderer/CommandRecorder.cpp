@@ -0,0 +1,128 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/renderer/CommandRecorder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "vkmv/utils/CpuTrace.hpp"
+
+namespace vkmv {
+
+void CommandRecorder::init(VkDevice device, uint32_t queueFamilyIndex, JobSystem* pJobSystem, uint32_t framesInFlight) {
+    _device = device;
+    jobSystem = pJobSystem;
+
+    // Workers, plus the thread recording the frame
+    threadCount = jobSystem->getWorkerCount() + 1;
+    pools.resize(static_cast<size_t>(threadCount) * framesInFlight);
+
+    VkCommandPoolCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    createInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    createInfo.queueFamilyIndex = queueFamilyIndex;
+
+    for(ThreadPool& pool : pools) {
+        if(vkCreateCommandPool(_device, &createInfo, nullptr, &pool.pool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create secondary command pool!");
+        }
+    }
+}
+
+void CommandRecorder::cleanup() {
+    for(ThreadPool& pool : pools) vkDestroyCommandPool(_device, pool.pool, nullptr);
+    pools.clear();
+}
+
+void CommandRecorder::beginFrame(uint32_t frameSlot) {
+    this->frameSlot = frameSlot;
+
+    // Resetting the pool resets every buffer allocated from it at once
+    for(uint32_t t = 0; t < threadCount; t++) {
+        ThreadPool& pool = pools[frameSlot * threadCount + t];
+        if(pool.usedBuffers == 0) continue;
+
+        vkResetCommandPool(_device, pool.pool, 0);
+        pool.usedBuffers = 0;
+    }
+}
+
+void CommandRecorder::recordChunks(VkCommandBuffer primary, const VkCommandBufferInheritanceRenderingInfo& renderingInfo, uint32_t count,
+                                   uint32_t minChunkSize, const ChunkRecordFunc& record) {
+    if(count == 0) return;
+
+    uint32_t chunkSize = std::max({minChunkSize, (count + threadCount - 1) / threadCount, 1u});
+    uint32_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.pNext = &renderingInfo;
+    inheritanceInfo.pipelineStatistics = inheritedStatistics;
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    // Owned by the jobs too: one may only start after every chunk is taken and this call has returned, in which
+    // case it touches nothing but this
+    struct ChunkQueue {
+        std::atomic<uint32_t> nextChunk{0};
+        std::atomic<uint32_t> recordedChunks{0};
+        std::vector<VkCommandBuffer> buffers;
+    };
+    std::shared_ptr<ChunkQueue> queue = std::make_shared<ChunkQueue>();
+    queue->buffers.resize(chunkCount);
+
+    auto recordAvailable = [this, queue, chunkCount, chunkSize, count, &beginInfo, &record]() {
+        for(uint32_t chunk = queue->nextChunk.fetch_add(1, std::memory_order_relaxed); chunk < chunkCount;
+            chunk = queue->nextChunk.fetch_add(1, std::memory_order_relaxed)) {
+            VKMV_TRACE_SCOPE("Record Chunk");
+            VkCommandBuffer buf = acquireSecondary(jobSystem->getThreadIndex());
+
+            vkBeginCommandBuffer(buf, &beginInfo);
+                uint32_t begin = chunk * chunkSize;
+                record(buf, begin, std::min(count, begin + chunkSize));
+            vkEndCommandBuffer(buf);
+
+            queue->buffers[chunk] = buf;
+            queue->recordedChunks.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    for(uint32_t helper = 1; helper < std::min(chunkCount, threadCount); helper++) jobSystem->submit(recordAvailable);
+    recordAvailable();
+
+    // Only chunks a worker is in the middle of are left; their recording is short
+    while(queue->recordedChunks.load(std::memory_order_acquire) < chunkCount) std::this_thread::yield();
+
+    vkCmdExecuteCommands(primary, chunkCount, queue->buffers.data());
+}
+
+VkCommandBuffer CommandRecorder::acquireSecondary(uint32_t thread) {
+    ThreadPool& pool = pools[frameSlot * threadCount + thread];
+
+    if(pool.usedBuffers == pool.buffers.size()) {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = pool.pool;
+        allocInfo.commandBufferCount = 1;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+
+        VkCommandBuffer buf;
+        if(vkAllocateCommandBuffers(_device, &allocInfo, &buf) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate secondary command buffer!");
+        }
+        pool.buffers.push_back(buf);
+    }
+
+    return pool.buffers[pool.usedBuffers++];
+}
+
+} // namespace vkmv
@@ -0,0 +1,45 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/renderer/DynamicResolution.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vkmv {
+
+// GPU times this far under the budget are left alone, so noise doesn't make frames flicker between sizes
+constexpr float SCALE_UP_THRESHOLD = 0.85f;
+
+// Fraction of the way to the ideal scale taken per frame; GPU times lag behind by the frames in flight
+constexpr float SCALE_RESPONSE = 0.25f;
+
+/**
+ * GPU time is mostly spent per pixel, and pixels go with the square of the scale, so the ideal scale is the current
+ * one times the square root of how far the budget is from the measured time.
+ */
+void DynamicResolution::update(bool enabled, float gpuMilliseconds, float budgetMilliseconds) {
+    if(!enabled) {
+        scale.store(1.0f, std::memory_order_relaxed);
+        return;
+    }
+
+    if(gpuMilliseconds <= 0.0f || budgetMilliseconds <= 0.0f) return;
+    if(gpuMilliseconds <= budgetMilliseconds && gpuMilliseconds >= budgetMilliseconds * SCALE_UP_THRESHOLD) return;
+
+    float current = getScale();
+    float ideal = current * std::sqrt(budgetMilliseconds / gpuMilliseconds);
+    float next = current + (ideal - current) * SCALE_RESPONSE;
+
+    scale.store(std::clamp(next, MIN_RENDER_SCALE, 1.0f), std::memory_order_relaxed);
+}
+
+VkExtent2D DynamicResolution::getScaledExtent(VkExtent2D extent) const {
+    float s = getScale();
+    return VkExtent2D{std::max(1u, static_cast<uint32_t>(std::lround(extent.width * s))),
+                      std::max(1u, static_cast<uint32_t>(std::lround(extent.height * s)))};
+}
+
+} // namespace vkmv
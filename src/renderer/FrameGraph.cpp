@@ -0,0 +1,380 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/renderer/FrameGraph.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#include "vkmv/utils/CpuTrace.hpp"
+
+namespace vkmv {
+
+struct UsageInfo {
+    VkPipelineStageFlags2 stages;
+    VkAccessFlags2 access;
+    VkAccessFlags2 writeAccess;
+    VkImageLayout layout;
+};
+
+static UsageInfo getUsageInfo(ResourceUsage usage) {
+    switch(usage) {
+    case ResourceUsage::ColorAttachment:
+        return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    case ResourceUsage::DepthAttachment:
+        return {VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL};
+    case ResourceUsage::DepthRead:
+        return {VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL};
+    case ResourceUsage::SampledFragment:
+        return {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    case ResourceUsage::SampledCompute:
+        return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    case ResourceUsage::StorageReadCompute:
+        return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_GENERAL};
+    case ResourceUsage::StorageWriteCompute:
+        return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL};
+    case ResourceUsage::StorageReadVertex:
+        return {VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_GENERAL};
+    case ResourceUsage::TransferSrc:
+        return {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+    case ResourceUsage::TransferDst:
+        return {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+    case ResourceUsage::VertexBuffer:
+        return {VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED};
+    case ResourceUsage::IndexBuffer:
+        return {VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED};
+    case ResourceUsage::IndirectBuffer:
+        return {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED};
+    case ResourceUsage::UniformBuffer:
+        return {VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                VK_ACCESS_2_UNIFORM_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED};
+    case ResourceUsage::Present:
+        // Presentation is ordered by the render semaphore, so the barrier only needs the layout transition
+        return {VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR};
+    }
+
+    throw std::runtime_error("Unknown frame graph resource usage!");
+}
+
+FrameGraph::PassBuilder& FrameGraph::PassBuilder::read(FrameGraphResource resource, ResourceUsage usage) {
+    graph.passes[pass].accesses.push_back(Access{resource, usage, false});
+    return *this;
+}
+
+FrameGraph::PassBuilder& FrameGraph::PassBuilder::write(FrameGraphResource resource, ResourceUsage usage) {
+    graph.passes[pass].accesses.push_back(Access{resource, usage, true});
+    return *this;
+}
+
+FrameGraph::PassBuilder& FrameGraph::PassBuilder::sideEffects() {
+    graph.passes[pass].sideEffects = true;
+    return *this;
+}
+
+void FrameGraph::init(ResourceManager* pResourceManager, GpuProfiler* pProfiler) {
+    resourceManager = pResourceManager;
+    profiler = pProfiler;
+}
+
+void FrameGraph::cleanup() {
+    for(TransientSlot& slot : transientSlots) resourceManager->destroyAliasedImages(slot.group);
+    transientSlots.clear();
+}
+
+FrameGraphResource FrameGraph::importImage(const std::string& name, VkImage image, VkImageLayout initialLayout,
+                                           VkPipelineStageFlags2 initialStage, VkImageAspectFlags aspectMask) {
+    Resource resource;
+    resource.name = name;
+    resource.image = image;
+    resource.allocatedImage.image = image;
+    resource.aspectMask = aspectMask;
+    resource.layout = initialLayout;
+    resource.writeStages = initialStage;
+
+    resources.push_back(std::move(resource));
+    return static_cast<FrameGraphResource>(resources.size() - 1);
+}
+
+FrameGraphResource FrameGraph::importBuffer(const std::string& name, VkBuffer buffer) {
+    Resource resource;
+    resource.name = name;
+    resource.buffer = buffer;
+
+    resources.push_back(std::move(resource));
+    return static_cast<FrameGraphResource>(resources.size() - 1);
+}
+
+FrameGraphResource FrameGraph::createImage(const std::string& name, const TransientImageDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.aspectMask = getGenericAspectMask(desc.format);
+    resource.transient = true;
+    resource.desc = desc;
+
+    resources.push_back(std::move(resource));
+    return static_cast<FrameGraphResource>(resources.size() - 1);
+}
+
+void FrameGraph::exportResource(FrameGraphResource resource, ResourceUsage finalUsage) {
+    resources[resource].exported = true;
+    resources[resource].finalUsage = finalUsage;
+}
+
+FrameGraph::PassBuilder FrameGraph::addPass(const std::string& name, RecordFunc record) {
+    Pass pass;
+    pass.name = name;
+    pass.record = std::move(record);
+
+    passes.push_back(std::move(pass));
+    return PassBuilder(*this, static_cast<uint32_t>(passes.size() - 1));
+}
+
+void FrameGraph::execute(VkCommandBuffer buf) {
+    VKMV_TRACE_SCOPE("Execute Frame Graph");
+
+    cull();
+    allocateTransients();
+
+    for(Pass& pass : passes) {
+        if(!pass.live) continue;
+
+        for(const Access& access : pass.accesses) {
+            Resource& resource = resources[access.resource];
+            if(resource.transient && !resource.touched) addAliasingDependencies(resource);
+            resource.touched = true;
+
+            addBarrier(resource, access.usage, access.write);
+        }
+        flushBarriers(buf);
+
+        if(profiler) profiler->beginScope(buf, pass.name, true);
+        pass.record(buf);
+        if(profiler) profiler->endScope(buf);
+    }
+
+    for(Resource& resource : resources) {
+        if(resource.exported) addBarrier(resource, resource.finalUsage, false);
+    }
+    flushBarriers(buf);
+}
+
+void FrameGraph::reset(uint32_t frameSlot) {
+    this->frameSlot = frameSlot;
+    if(transientSlots.size() <= frameSlot) transientSlots.resize(frameSlot + 1);
+
+    passes.clear();
+    resources.clear();
+    culledPassCount = 0;
+}
+
+/**
+ * Walks passes back to front. A pass is live if it has side effects or writes a resource that is exported or read by
+ * a later live pass. Writes never retire a resource from the needed set, since attachments may load earlier contents.
+ */
+void FrameGraph::cull() {
+    std::vector<bool> needed(resources.size(), false);
+    for(size_t i = 0; i < resources.size(); i++) needed[i] = resources[i].exported;
+
+    culledPassCount = 0;
+    for(auto it = passes.rbegin(); it != passes.rend(); ++it) {
+        Pass& pass = *it;
+
+        pass.live = pass.sideEffects;
+        for(const Access& access : pass.accesses) {
+            if(access.write && needed[access.resource]) pass.live = true;
+        }
+
+        if(!pass.live) {
+            culledPassCount++;
+            continue;
+        }
+
+        for(const Access& access : pass.accesses) {
+            if(!access.write) needed[access.resource] = true;
+        }
+    }
+}
+
+static bool operator==(const AliasedImageDesc& a, const AliasedImageDesc& b) {
+    return a.format == b.format && a.usageFlags == b.usageFlags && a.extent.width == b.extent.width && a.extent.height == b.extent.height &&
+           a.extent.depth == b.extent.depth && a.firstUse == b.firstUse && a.lastUse == b.lastUse;
+}
+
+/**
+ * Derives each used transient's lifetime from the live passes and reuses the slot's images if nothing changed since
+ * the last frame executed on it. Transients no live pass touches are not allocated.
+ */
+void FrameGraph::allocateTransients() {
+    std::vector<AliasedImageDesc> descs;
+
+    for(Resource& resource : resources) {
+        if(!resource.transient) continue;
+
+        uint32_t firstUse = UINT32_MAX, lastUse = 0;
+        for(uint32_t i = 0; i < passes.size(); i++) {
+            if(!passes[i].live) continue;
+
+            for(const Access& access : passes[i].accesses) {
+                if(&resources[access.resource] != &resource) continue;
+                firstUse = std::min(firstUse, i);
+                lastUse = std::max(lastUse, i);
+            }
+        }
+        if(firstUse == UINT32_MAX) continue;
+
+        // Exported images are read after the graph, so nothing may be placed over them
+        if(resource.exported) lastUse = static_cast<uint32_t>(passes.size());
+
+        resource.aliasIndex = static_cast<int32_t>(descs.size());
+        descs.push_back(AliasedImageDesc{resource.desc.format, resource.desc.usageFlags, resource.desc.extent, firstUse, lastUse});
+    }
+
+    TransientSlot& slot = transientSlots[frameSlot];
+    if(descs != slot.descs) {
+        resourceManager->destroyAliasedImages(slot.group);
+        if(!descs.empty()) slot.group = resourceManager->allocateAliasedImages(descs);
+        slot.descs = descs;
+    }
+
+    for(Resource& resource : resources) {
+        if(resource.aliasIndex < 0) continue;
+
+        resource.allocatedImage = slot.group.images[resource.aliasIndex].image;
+        resource.image = resource.allocatedImage.image;
+    }
+}
+
+/**
+ * Before its first use, a transient must wait for every earlier transient placed in overlapping memory.
+ */
+void FrameGraph::addAliasingDependencies(Resource& resource) {
+    if(resource.aliasIndex < 0) return;
+
+    const AliasedImageGroup& group = transientSlots[frameSlot].group;
+    const AliasedImage& placed = group.images[resource.aliasIndex];
+    const AliasedImageDesc& desc = transientSlots[frameSlot].descs[resource.aliasIndex];
+
+    for(const Resource& other : resources) {
+        if(other.aliasIndex < 0 || &other == &resource) continue;
+
+        const AliasedImage& otherPlaced = group.images[other.aliasIndex];
+        const AliasedImageDesc& otherDesc = transientSlots[frameSlot].descs[other.aliasIndex];
+
+        bool memoryOverlaps = otherPlaced.allocationIndex == placed.allocationIndex &&
+                              otherPlaced.offset < placed.offset + placed.size && placed.offset < otherPlaced.offset + otherPlaced.size;
+        if(!memoryOverlaps || otherDesc.lastUse >= desc.firstUse) continue;
+
+        resource.writeStages |= other.writeStages | other.readStages;
+        resource.writeAccess |= other.writeAccess;
+    }
+}
+
+/**
+ * Queues the barrier, if any, needed before resource is used with usage, and updates its tracked state.
+ * Writes and layout transitions wait on the last write and every read since it; reads only wait on the
+ * last write, and only if it has not already been made visible to their stage and access.
+ */
+void FrameGraph::addBarrier(Resource& resource, ResourceUsage usage, bool write) {
+    UsageInfo info = getUsageInfo(usage);
+    bool layoutChange = resource.image != VK_NULL_HANDLE && info.layout != resource.layout;
+
+    VkPipelineStageFlags2 srcStages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 srcAccess = VK_ACCESS_2_NONE;
+    bool needsBarrier = false;
+
+    if(write || layoutChange) {
+        srcStages = resource.writeStages | resource.readStages;
+        srcAccess = resource.writeAccess;
+        needsBarrier = layoutChange || srcStages != VK_PIPELINE_STAGE_2_NONE;
+    } else if(resource.writeStages != VK_PIPELINE_STAGE_2_NONE) {
+        srcStages = resource.writeStages;
+        srcAccess = resource.writeAccess;
+        needsBarrier = (info.stages & ~resource.visibleStages) != 0 || (info.access & ~resource.visibleAccess) != 0;
+    }
+
+    if(needsBarrier) {
+        if(resource.image != VK_NULL_HANDLE) {
+            VkImageMemoryBarrier2 barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+            barrier.srcStageMask = srcStages;
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstStageMask = info.stages;
+            barrier.dstAccessMask = info.access;
+            barrier.oldLayout = resource.layout;
+            barrier.newLayout = info.layout;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = resource.image;
+            barrier.subresourceRange.aspectMask = resource.aspectMask;
+            barrier.subresourceRange.baseMipLevel = 0;
+            barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+            imageBarriers.push_back(barrier);
+        } else {
+            VkBufferMemoryBarrier2 barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+            barrier.srcStageMask = srcStages;
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstStageMask = info.stages;
+            barrier.dstAccessMask = info.access;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.buffer = resource.buffer;
+            barrier.offset = 0;
+            barrier.size = VK_WHOLE_SIZE;
+
+            bufferBarriers.push_back(barrier);
+        }
+    }
+
+    if(write) {
+        resource.writeStages = info.stages;
+        resource.writeAccess = info.writeAccess;
+        resource.readStages = VK_PIPELINE_STAGE_2_NONE;
+        resource.visibleStages = VK_PIPELINE_STAGE_2_NONE;
+        resource.visibleAccess = VK_ACCESS_2_NONE;
+    } else if(layoutChange) {
+        // The transition itself acts as the last write; later reads chain from the stages it completed before
+        resource.writeStages = info.stages;
+        resource.writeAccess = VK_ACCESS_2_NONE;
+        resource.readStages = info.stages;
+        resource.visibleStages = info.stages;
+        resource.visibleAccess = info.access;
+    } else {
+        resource.readStages |= info.stages;
+        if(needsBarrier) {
+            resource.visibleStages |= info.stages;
+            resource.visibleAccess |= info.access;
+        }
+    }
+
+    if(resource.image != VK_NULL_HANDLE) resource.layout = info.layout;
+}
+
+void FrameGraph::flushBarriers(VkCommandBuffer buf) {
+    if(imageBarriers.empty() && bufferBarriers.empty()) return;
+
+    VkDependencyInfo depInfo{};
+    depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    depInfo.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+    depInfo.pImageMemoryBarriers = imageBarriers.data();
+    depInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+    depInfo.pBufferMemoryBarriers = bufferBarriers.data();
+
+    vkCmdPipelineBarrier2(buf, &depInfo);
+
+    imageBarriers.clear();
+    bufferBarriers.clear();
+}
+
+} // namespace vkmv
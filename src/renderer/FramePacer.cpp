@@ -0,0 +1,133 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/renderer/FramePacer.hpp"
+
+#include <algorithm>
+
+#include "vkmv/utils/CpuTrace.hpp"
+
+namespace vkmv {
+
+// A frame not displayed by then is taken as displayed, e.g. one presented to a swapchain that was just retired
+constexpr uint64_t DISPLAY_WAIT_TIMEOUT = 250'000'000;   // nanoseconds
+
+// The builder never waits longer than this for the queue to drain, should the renderer stall
+static constexpr std::chrono::milliseconds BUILD_WAIT_TIMEOUT(250);
+
+void FramePacer::init(VkDevice device, VkSemaphore frameTimeline, PFN_vkWaitForPresentKHR waitForPresent) {
+    _device = device;
+    this->frameTimeline = frameTimeline;
+    this->waitForPresent = waitForPresent;
+
+    stopping = false;
+    thread = std::thread(&FramePacer::followFrames, this);
+}
+
+void FramePacer::cleanup() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    pendingCondition.notify_one();
+    if(thread.joinable()) thread.join();
+
+    pending.clear();
+}
+
+void FramePacer::waitToBuild() {
+    VKMV_TRACE_SCOPE("Wait For Frame Pacing");
+
+    uint64_t maxQueued = maxQueuedFrames.load(std::memory_order_relaxed);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    displayedCondition.wait_for(lock, BUILD_WAIT_TIMEOUT, [&]() { return displayedFrames + maxQueued > builtFrames; });
+    builtFrames++;
+}
+
+void FramePacer::frameSubmitted(uint64_t timelineValue, Swapchain* swapchain, uint64_t presentId,
+                                std::chrono::steady_clock::time_point inputTime) {
+    VkSwapchainKHR handle = swapchain ? swapchain->getSwapchain() : VK_NULL_HANDLE;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(PendingFrame{timelineValue, swapchain, handle, presentId, inputTime});
+    }
+    pendingCondition.notify_one();
+}
+
+void FramePacer::releaseSwapchain(VkSwapchainKHR swapchain) {
+    std::unique_lock<std::mutex> lock(mutex);
+    displayedCondition.wait(lock, [&]() {
+        return std::none_of(pending.begin(), pending.end(), [&](const PendingFrame& frame) { return frame.swapchain == swapchain; });
+    });
+}
+
+FramePacingStats FramePacer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    FramePacingStats stats{};
+    stats.latencyMilliseconds = lastLatency;
+    stats.measuredAtPresent = canWaitForPresent();
+
+    uint32_t count = std::min(latencyCount, LATENCY_HISTORY);
+    for(uint32_t i = 0; i < count; i++) {
+        stats.averageMilliseconds += latencies[i];
+        stats.maxMilliseconds = std::max(stats.maxMilliseconds, latencies[i]);
+    }
+    if(count > 0) stats.averageMilliseconds /= static_cast<float>(count);
+
+    return stats;
+}
+
+/**
+ * Frames are displayed in submission order, so following them one at a time from the front of the queue is enough.
+ * Once stopping, the device is idle and whatever is left finishes right away.
+ */
+void FramePacer::followFrames() {
+    CpuTracer::setThreadName("Frame Pacer");
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while(true) {
+        pendingCondition.wait(lock, [this]() { return stopping || !pending.empty(); });
+        if(pending.empty()) return;
+
+        PendingFrame frame = pending.front();
+        lock.unlock();
+
+        VkResult result = waitForDisplay(frame);
+
+        std::chrono::duration<float, std::milli> latency = std::chrono::steady_clock::now() - frame.inputTime;
+
+        lock.lock();
+
+        // Timeouts and out of date swapchains are no measurement
+        if(result == VK_SUCCESS) {
+            lastLatency = latency.count();
+            latencies[latencyCount % LATENCY_HISTORY] = lastLatency;
+            latencyCount++;
+        }
+
+        pending.pop_front();
+        displayedFrames++;
+        displayedCondition.notify_all();
+    }
+}
+
+VkResult FramePacer::waitForDisplay(const PendingFrame& frame) {
+    VKMV_TRACE_SCOPE("Wait For Display");
+
+    if(frame.swapchain != VK_NULL_HANDLE) return frame.owner->waitForPresent(waitForPresent, frame.swapchain, frame.presentId, DISPLAY_WAIT_TIMEOUT);
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &frameTimeline;
+    waitInfo.pValues = &frame.timelineValue;
+
+    return vkWaitSemaphores(_device, &waitInfo, DISPLAY_WAIT_TIMEOUT);
+}
+
+} // namespace vkmv
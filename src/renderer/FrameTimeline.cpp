@@ -0,0 +1,78 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/renderer/FrameTimeline.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include "vkmv/utils/CpuTrace.hpp"
+
+namespace vkmv {
+
+void FrameTimeline::init(VkDevice device) {
+    _device = device;
+
+    VkSemaphoreTypeCreateInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &timelineInfo;
+
+    if(vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create frame timeline semaphore!");
+    }
+}
+
+void FrameTimeline::cleanup() {
+    for(Retirement& retirement : retirements) retirement.destroy();
+    retirements.clear();
+
+    vkDestroySemaphore(_device, semaphore, nullptr);
+    semaphore = VK_NULL_HANDLE;
+}
+
+uint64_t FrameTimeline::getCompletedValue() {
+    vkGetSemaphoreCounterValue(_device, semaphore, &completedValue);
+    return completedValue;
+}
+
+void FrameTimeline::wait(uint64_t value) {
+    if(value <= completedValue) return;
+
+    VKMV_TRACE_SCOPE("Wait For Frame Timeline");
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &semaphore;
+    waitInfo.pValues = &value;
+
+    if(vkWaitSemaphores(_device, &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to wait for frame timeline!");
+    }
+    completedValue = value;
+}
+
+void FrameTimeline::retire(std::function<void()> destroy) {
+    retirements.push_back(Retirement{getPendingValue(), std::move(destroy)});
+}
+
+void FrameTimeline::collect() {
+    if(retirements.empty()) return;
+
+    uint64_t completed = getCompletedValue();
+    while(!retirements.empty() && retirements.front().value <= completed) {
+        // Popped first, so a destroy that retires something else can't invalidate the entry
+        std::function<void()> destroy = std::move(retirements.front().destroy);
+        retirements.pop_front();
+        destroy();
+    }
+}
+
+} // namespace vkmv
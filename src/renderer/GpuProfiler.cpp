@@ -0,0 +1,292 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/renderer/GpuProfiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#include "vkmv/utils/CpuTrace.hpp"
+
+namespace vkmv {
+
+// Results come back in the order of the flag bits, which GpuPipelineStatistics follows
+constexpr VkQueryPipelineStatisticFlags STATISTIC_FLAGS = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+                                                          VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+                                                          VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                                          VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+                                                          VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                                                          VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+                                                          VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+constexpr uint32_t STATISTIC_COUNT = 7;
+
+constexpr uint32_t NO_SCOPE = UINT32_MAX;
+
+void GpuProfiler::init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex, uint32_t framesInFlight, bool pipelineStatistics) {
+    _device = device;
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    uint32_t validBits = queueFamilies[queueFamilyIndex].timestampValidBits;
+    if(validBits == 0) return;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    timestampPeriod = properties.limits.timestampPeriod;
+    timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+    VkQueryPoolCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    createInfo.queryCount = 2 * MAX_GPU_SCOPES * framesInFlight;
+
+    if(vkCreateQueryPool(_device, &createInfo, nullptr, &timestampPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create timestamp query pool!");
+    }
+
+    if(pipelineStatistics) {
+        createInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        createInfo.queryCount = MAX_GPU_SCOPES * framesInFlight;
+        createInfo.pipelineStatistics = STATISTIC_FLAGS;
+
+        if(vkCreateQueryPool(_device, &createInfo, nullptr, &statisticsPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pipeline statistics query pool!");
+        }
+    }
+
+    slots.resize(framesInFlight);
+}
+
+void GpuProfiler::cleanup() {
+    vkDestroyQueryPool(_device, statisticsPool, nullptr);
+    vkDestroyQueryPool(_device, timestampPool, nullptr);
+    statisticsPool = VK_NULL_HANDLE;
+    timestampPool = VK_NULL_HANDLE;
+}
+
+bool GpuProfiler::beginFrame(VkCommandBuffer buf, uint32_t frameSlot) {
+    if(!isSupported()) return false;
+
+    bool read = readBack(frameSlot);
+
+    currentSlot = frameSlot;
+    FrameSlot& slot = slots[frameSlot];
+    slot.scopes.clear();
+    slot.statisticsCount = 0;
+    slot.frame = frameCount++;
+    slot.submitMicroseconds = 0.0;
+
+    openScopes.clear();
+    statisticsOpen = false;
+
+    vkCmdResetQueryPool(buf, timestampPool, 2 * MAX_GPU_SCOPES * frameSlot, 2 * MAX_GPU_SCOPES);
+    if(hasPipelineStatistics()) vkCmdResetQueryPool(buf, statisticsPool, MAX_GPU_SCOPES * frameSlot, MAX_GPU_SCOPES);
+
+    beginScope(buf, "Frame");
+
+    return read;
+}
+
+void GpuProfiler::endFrame(VkCommandBuffer buf) {
+    while(!openScopes.empty()) endScope(buf);
+}
+
+void GpuProfiler::beginScope(VkCommandBuffer buf, const std::string& name, bool statistics) {
+    if(!isSupported()) return;
+
+    FrameSlot& slot = slots[currentSlot];
+    if(slot.scopes.size() == MAX_GPU_SCOPES) {
+        openScopes.push_back(NO_SCOPE);
+        return;
+    }
+
+    uint32_t index = static_cast<uint32_t>(slot.scopes.size());
+    uint32_t statisticsQuery = NO_SCOPE;
+    if(statistics && hasPipelineStatistics() && !statisticsOpen) {
+        statisticsQuery = slot.statisticsCount++;
+        statisticsOpen = true;
+    }
+
+    slot.scopes.push_back(RecordedScope{name, static_cast<uint32_t>(openScopes.size()), statisticsQuery});
+    openScopes.push_back(index);
+
+    vkCmdWriteTimestamp2(buf, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, timestampPool, 2 * (MAX_GPU_SCOPES * currentSlot + index));
+    if(statisticsQuery != NO_SCOPE) vkCmdBeginQuery(buf, statisticsPool, MAX_GPU_SCOPES * currentSlot + statisticsQuery, 0);
+}
+
+void GpuProfiler::endScope(VkCommandBuffer buf) {
+    if(!isSupported() || openScopes.empty()) return;
+
+    uint32_t index = openScopes.back();
+    openScopes.pop_back();
+    if(index == NO_SCOPE) return;
+
+    const RecordedScope& scope = slots[currentSlot].scopes[index];
+    if(scope.statisticsQuery != NO_SCOPE) {
+        vkCmdEndQuery(buf, statisticsPool, MAX_GPU_SCOPES * currentSlot + scope.statisticsQuery);
+        statisticsOpen = false;
+    }
+
+    vkCmdWriteTimestamp2(buf, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, timestampPool, 2 * (MAX_GPU_SCOPES * currentSlot + index) + 1);
+}
+
+void GpuProfiler::frameSubmitted() {
+    if(isSupported()) slots[currentSlot].submitMicroseconds = CpuTracer::getMicroseconds();
+}
+
+VkQueryPipelineStatisticFlags GpuProfiler::getStatisticFlags() const {
+    return hasPipelineStatistics() ? STATISTIC_FLAGS : 0;
+}
+
+GpuFrameProfile GpuProfiler::getLastFrame() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return history.empty() ? GpuFrameProfile{} : history.back();
+}
+
+bool GpuProfiler::writeChromeTrace(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    if(!file) {
+        std::cerr << "Failed to write GPU trace " << path << std::endl;
+        return false;
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"GPU\"}}";
+    writeTraceEvents(file);
+    file << "\n]}\n";
+
+    if(!file) {
+        std::cerr << "Failed to write GPU trace " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Complete ("X") events on a single GPU track; nesting is recovered by the viewer from the timestamps. Statistics go
+ * in each event's args.
+ * 
+ * Without calibrated timestamps the GPU clock is placed on the CPU trace clock from submit times: no frame can start
+ * on the GPU before it was submitted, so the smallest offset that keeps every frame after its submit is the closest
+ * estimate, and is exact for any frame the GPU started right away.
+ */
+void GpuProfiler::writeTraceEvents(std::ostream& out) const {
+    std::deque<GpuFrameProfile> frames;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        frames = history;
+    }
+
+    double offsetMicroseconds = 0.0;
+    bool aligned = false;
+    for(const GpuFrameProfile& frame : frames) {
+        if(frame.submitMicroseconds == 0.0) continue;
+
+        double offset = frame.submitMicroseconds - frame.startMilliseconds * 1000.0;
+        offsetMicroseconds = aligned ? std::max(offsetMicroseconds, offset) : offset;
+        aligned = true;
+    }
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+
+    out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"GPU graphics queue\"}}";
+
+    for(const GpuFrameProfile& frame : frames) {
+        for(const GpuScope& scope : frame.scopes) {
+            out << ",\n{\"name\":\"" << escapeTraceString(scope.name) << "\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+                << ",\"ts\":" << (frame.startMilliseconds + scope.beginMilliseconds) * 1000.0 + offsetMicroseconds
+                << ",\"dur\":" << (scope.endMilliseconds - scope.beginMilliseconds) * 1000.0
+                << ",\"args\":{\"frame\":" << frame.frame;
+
+            if(scope.hasStatistics) {
+                const GpuPipelineStatistics& s = scope.statistics;
+                out << ",\"input vertices\":" << s.inputVertices << ",\"input primitives\":" << s.inputPrimitives
+                    << ",\"vertex invocations\":" << s.vertexInvocations << ",\"clipping invocations\":" << s.clippingInvocations
+                    << ",\"clipping primitives\":" << s.clippingPrimitives << ",\"fragment invocations\":" << s.fragmentInvocations
+                    << ",\"compute invocations\":" << s.computeInvocations;
+            }
+            out << "}}";
+        }
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+bool GpuProfiler::readBack(uint32_t frameSlot) {
+    const FrameSlot& slot = slots[frameSlot];
+    uint32_t scopeCount = static_cast<uint32_t>(slot.scopes.size());
+    if(scopeCount == 0) return false;
+
+    std::vector<uint64_t> timestamps(2 * scopeCount);
+    if(vkGetQueryPoolResults(_device, timestampPool, 2 * MAX_GPU_SCOPES * frameSlot, 2 * scopeCount, timestamps.size() * sizeof(uint64_t),
+                             timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+        return false;
+    }
+
+    // Statistics are optional extras; a frame is still worth keeping without them
+    std::vector<uint64_t> statistics(slot.statisticsCount * STATISTIC_COUNT);
+    if(slot.statisticsCount > 0 &&
+       vkGetQueryPoolResults(_device, statisticsPool, MAX_GPU_SCOPES * frameSlot, slot.statisticsCount, statistics.size() * sizeof(uint64_t),
+                             statistics.data(), STATISTIC_COUNT * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+        statistics.clear();
+    }
+
+    // Frame starts are accumulated from one frame to the next, since the distance to the first frame soon exceeds
+    // what a narrow timestamp can tell apart from a wrap
+    uint64_t start = timestamps[0];
+    if(hasPreviousStart) previousStartMilliseconds += toMilliseconds(previousStart, start);
+    previousStart = start;
+    hasPreviousStart = true;
+
+    GpuFrameProfile profile;
+    profile.frame = slot.frame;
+    profile.startMilliseconds = previousStartMilliseconds;
+    profile.submitMicroseconds = slot.submitMicroseconds;
+    profile.scopes.resize(scopeCount);
+
+    for(uint32_t i = 0; i < scopeCount; i++) {
+        const RecordedScope& recorded = slot.scopes[i];
+        GpuScope& scope = profile.scopes[i];
+        scope.name = recorded.name;
+        scope.depth = recorded.depth;
+        scope.beginMilliseconds = toMilliseconds(start, timestamps[2 * i]);
+        scope.endMilliseconds = toMilliseconds(start, timestamps[2 * i + 1]);
+
+        if(recorded.statisticsQuery != NO_SCOPE && !statistics.empty()) {
+            const uint64_t* values = &statistics[recorded.statisticsQuery * STATISTIC_COUNT];
+            scope.hasStatistics = true;
+            scope.statistics = GpuPipelineStatistics{values[0], values[1], values[2], values[3], values[4], values[5], values[6]};
+        }
+    }
+
+    frameMilliseconds.store(static_cast<float>(profile.scopes[0].endMilliseconds), std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    history.push_back(std::move(profile));
+    if(history.size() > GPU_PROFILE_HISTORY) history.pop_front();
+
+    return true;
+}
+
+/**
+ * Timestamps may be narrower than 64 bits and wrap; one taken before from, as a scope's start may be on some
+ * implementations, counts as from.
+ */
+double GpuProfiler::toMilliseconds(uint64_t from, uint64_t to) const {
+    uint64_t ticks = (to - from) & timestampMask;
+    if(ticks > timestampMask / 2) return 0.0;
+    return static_cast<double>(ticks) * timestampPeriod * 1e-6;
+}
+
+} // namespace vkmv
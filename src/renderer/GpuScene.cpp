@@ -0,0 +1,791 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/renderer/GpuScene.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include "vkmv/utils/Math.hpp"
+
+namespace vkmv {
+
+constexpr uint32_t CULL_WORKGROUP_SIZE = 64;
+
+// Models per secondary command buffer of the scene pass; fewer models are recorded inline, where no hand-off is paid
+constexpr uint32_t MODELS_PER_RECORD_CHUNK = 64;
+
+// scene.glsl decodes every layout with the same attribute offsets
+static_assert(CompactVertex::offsetOf<TangentFrame>() == 8 && TexturedCompactVertex::offsetOf<TangentFrame>() == 8 &&
+              TexturedCompactVertex::offsetOf<HalfTexcoord>() == 12, "Vertex layouts no longer match scene.glsl!");
+
+// Command slots fit a VkDrawIndexedIndirectCommand; non-indexed streams use the first 4 words
+constexpr uint32_t DRAW_COMMAND_STRIDE = 5 * sizeof(uint32_t);
+
+struct CullConstants {
+    float planes[6][4];
+    VkDeviceAddress scene;
+    VkDeviceAddress lodSelections;
+    VkDeviceAddress commands;
+    VkDeviceAddress counts;
+};
+
+struct DrawConstants {
+    float viewProjection[16];
+    VkDeviceAddress scene;
+};
+
+struct MeshletConstants {
+    float viewProjection[16];
+    float cameraPosition[4];
+    VkDeviceAddress scene;
+    VkDeviceAddress lodSelections;
+    uint32_t taskOffset;
+    uint32_t pad;
+};
+
+struct MeshletCullConstants {
+    float viewProjection[16];
+    float cameraPosition[4];
+    VkDeviceAddress scene;
+    VkDeviceAddress lodSelections;
+    VkDeviceAddress clusters;
+    VkDeviceAddress commands;
+    VkDeviceAddress counts;
+    uint32_t taskOffset;
+    uint32_t pad;
+};
+
+struct MeshletDrawConstants {
+    float viewProjection[16];
+    VkDeviceAddress scene;
+    VkDeviceAddress clusters;
+};
+
+// The counts buffer holds one count per stream, then the visible meshlet count of the fallback path
+constexpr uint32_t CLUSTER_COUNT_INDEX = DRAW_STREAM_COUNT;
+
+// Guaranteed minimum of maxComputeWorkGroupCount[0] and maxTaskWorkGroupCount[0]; larger task lists are split
+constexpr uint32_t MAX_TASK_WORKGROUPS = 65535;
+
+void GpuScene::init(Device* pDevice, ResourceManager* pResourceManager, ShaderLibrary* pShaderLibrary, CommandRecorder* pCommandRecorder,
+                    uint32_t framesInFlight) {
+    _device = pDevice->getDevice();
+    resourceManager = pResourceManager;
+    shaderLibrary = pShaderLibrary;
+    commandRecorder = pCommandRecorder;
+    this->framesInFlight = framesInFlight;
+    transformStaging.assign(framesInFlight, AllocatedBuffer{});
+
+    meshShaders = pDevice->isExtensionEnabled(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+    if(meshShaders) cmdDrawMeshTasks = reinterpret_cast<PFN_vkCmdDrawMeshTasksEXT>(vkGetDeviceProcAddr(_device, "vkCmdDrawMeshTasksEXT"));
+
+    createPipelines();
+}
+
+void GpuScene::cleanup() {
+    for(ModelDrawData& data : models) {
+        resourceManager->destroyAllocatedBuffer(data.header);
+        resourceManager->destroyAllocatedBuffer(data.drawItems);
+        resourceManager->destroyAllocatedBuffer(data.primitives);
+        resourceManager->destroyAllocatedBuffer(data.transforms);
+        if(data.clusterTaskCount > 0) resourceManager->destroyAllocatedBuffer(data.clusterTasks);
+        for(AllocatedBuffer& buffer : data.commands) resourceManager->destroyAllocatedBuffer(buffer);
+        for(AllocatedBuffer& buffer : data.counts) resourceManager->destroyAllocatedBuffer(buffer);
+        for(AllocatedBuffer& buffer : data.lodSelections) resourceManager->destroyAllocatedBuffer(buffer);
+        for(AllocatedBuffer& buffer : data.clusters) resourceManager->destroyAllocatedBuffer(buffer);
+        for(AllocatedBuffer& buffer : data.clusterCommands) resourceManager->destroyAllocatedBuffer(buffer);
+    }
+    models.clear();
+    lodInstances.clear();
+    drawItemCount = 0;
+
+    for(AllocatedBuffer& buffer : transformStaging) {
+        if(buffer.buffer != VK_NULL_HANDLE) resourceManager->destroyAllocatedBuffer(buffer);
+    }
+    transformStaging.clear();
+
+    vkDestroyPipelineLayout(_device, cullPipelineLayout, nullptr);
+    vkDestroyPipelineLayout(_device, drawPipelineLayout, nullptr);
+    vkDestroyPipelineLayout(_device, meshletPipelineLayout, nullptr);
+    vkDestroyPipelineLayout(_device, meshletCullPipelineLayout, nullptr);
+    vkDestroyPipelineLayout(_device, meshletDrawPipelineLayout, nullptr);
+}
+
+void GpuScene::addModel(const Model& model) {
+    // Every instance gets an entry, so entries line up with the instances of the models in the order they were added
+    uint32_t firstLodInstance = static_cast<uint32_t>(lodInstances.size());
+    lodInstances.resize(lodInstances.size() + model.instances.size());
+
+    if(model.geometry.buffer == VK_NULL_HANDLE) return;
+
+    std::vector<GpuPrimitive> primitives(model.primitives.size());
+    std::vector<bool> drawable(model.primitives.size(), false);
+    uint32_t skipped = 0;
+
+    for(size_t p = 0; p < model.primitives.size(); p++) {
+        const ModelPrimitive& modelPrimitive = model.primitives[p];
+        GpuPrimitive& primitive = primitives[p];
+
+        VkDeviceSize indexSize = (modelPrimitive.indexType == VK_INDEX_TYPE_UINT16) ? 2 : 4;
+        bool addressable = modelPrimitive.vertexOffset <= std::numeric_limits<uint32_t>::max() &&
+                           modelPrimitive.indexOffset / indexSize <= std::numeric_limits<uint32_t>::max();
+
+        if(modelPrimitive.vertexCount == 0) continue;
+        if(!addressable) {
+            skipped++;
+            continue;
+        }
+
+        primitive.indexCount = modelPrimitive.indexCount;
+        primitive.firstIndex = static_cast<uint32_t>(modelPrimitive.indexOffset / indexSize);
+        primitive.vertexCount = modelPrimitive.vertexCount;
+        primitive.vertexOffset = static_cast<uint32_t>(modelPrimitive.vertexOffset);
+        primitive.vertexStride = getVertexFormatInfo(modelPrimitive.vertexFormat).stride;
+        for(int k = 0; k < 3; k++) {
+            primitive.dequantScale[k] = modelPrimitive.quantization.scale[k];
+            primitive.dequantBias[k] = modelPrimitive.quantization.bias[k];
+        }
+
+        bool meshletsAddressable = modelPrimitive.meshletOffset <= std::numeric_limits<uint32_t>::max() &&
+                                   modelPrimitive.meshletVertexOffset <= std::numeric_limits<uint32_t>::max() &&
+                                   modelPrimitive.meshletTriangleOffset <= std::numeric_limits<uint32_t>::max();
+        if(meshletsAddressable) {
+            primitive.meshletCount = modelPrimitive.meshletCount;
+            primitive.meshletOffset = static_cast<uint32_t>(modelPrimitive.meshletOffset);
+            primitive.meshletVertexOffset = static_cast<uint32_t>(modelPrimitive.meshletVertexOffset);
+            primitive.meshletTriangleOffset = static_cast<uint32_t>(modelPrimitive.meshletTriangleOffset);
+            primitive.lodCount = modelPrimitive.lodCount;
+        }
+
+        if(modelPrimitive.indexCount == 0) primitive.stream = DRAW_STREAM_NON_INDEXED;
+        else if(modelPrimitive.indexType == VK_INDEX_TYPE_UINT16) primitive.stream = DRAW_STREAM_INDEXED_UINT16;
+        else primitive.stream = DRAW_STREAM_INDEXED_UINT32;
+
+        drawable[p] = true;
+    }
+
+    if(skipped > 0) std::cerr << "Skipping " << skipped << " primitive(s) beyond the first 4 GiB of geometry" << std::endl;
+
+    std::vector<float> transforms(model.instances.size() * 16);
+    std::vector<GpuDrawItem> drawItems;
+    std::vector<GpuClusterTask> clusterTasks;
+    uint32_t streamCounts[DRAW_STREAM_COUNT] = {};
+    uint32_t clusterCapacity = 0;
+
+    for(uint32_t i = 0; i < model.instances.size(); i++) {
+        const ModelInstance& instance = model.instances[i];
+        std::memcpy(&transforms[i * 16], instance.transform, sizeof(instance.transform));
+
+        LodInstance& lodInstance = lodInstances[firstLodInstance + i];
+        float meshMin[3] = {FLT_MAX, FLT_MAX, FLT_MAX}, meshMax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+        const ModelMesh& mesh = model.meshes[instance.mesh];
+        for(uint32_t p = mesh.firstPrimitive; p < mesh.firstPrimitive + mesh.primitiveCount; p++) {
+            if(!drawable[p]) continue;
+
+            const ModelPrimitive& modelPrimitive = model.primitives[p];
+            float center[3], halfExtent[3];
+            for(int k = 0; k < 3; k++) {
+                center[k] = 0.5f * (modelPrimitive.boundsMin[k] + modelPrimitive.boundsMax[k]);
+                halfExtent[k] = 0.5f * (modelPrimitive.boundsMax[k] - modelPrimitive.boundsMin[k]);
+            }
+            float radius = std::sqrt(halfExtent[0] * halfExtent[0] + halfExtent[1] * halfExtent[1] + halfExtent[2] * halfExtent[2]);
+
+            GpuDrawItem item{};
+            std::memcpy(item.sphere, center, sizeof(center));
+            item.sphere[3] = radius;
+            item.instance = i;
+            item.primitive = p;
+
+            if(primitives[p].meshletCount > 0) {
+                uint32_t drawItem = static_cast<uint32_t>(drawItems.size());
+                uint32_t largestLevel = 0;
+                for(uint32_t l = 0; l < modelPrimitive.lodCount; l++) {
+                    const ModelLod& lod = modelPrimitive.lods[l];
+                    for(uint32_t first = 0; first < lod.meshletCount; first += MESHLETS_PER_TASK) {
+                        clusterTasks.push_back(GpuClusterTask{drawItem, lod.firstMeshlet + first, std::min(lod.meshletCount - first, MESHLETS_PER_TASK), l});
+                    }
+                    largestLevel = std::max(largestLevel, lod.meshletCount);
+                }
+                clusterCapacity += largestLevel;
+            } else {
+                streamCounts[primitives[p].stream]++;
+            }
+
+            // Primitives drawn whole count as one level at every level of the mesh
+            bool simplified = primitives[p].meshletCount > 0;
+            uint32_t lodCount = simplified ? modelPrimitive.lodCount : 1;
+            uint32_t wholeTriangles = (modelPrimitive.indexCount > 0 ? modelPrimitive.indexCount : modelPrimitive.vertexCount) / 3;
+            lodInstance.lodCount = std::max(lodInstance.lodCount, lodCount);
+            for(uint32_t l = 0; l < MAX_LOD_COUNT; l++) {
+                const ModelLod& lod = modelPrimitive.lods[std::min(l, lodCount - 1)];
+                lodInstance.errors[l] = std::max(lodInstance.errors[l], simplified ? lod.error : 0.0f);
+                lodInstance.triangles[l] += simplified ? lod.triangleCount : wholeTriangles;
+            }
+            for(int k = 0; k < 3; k++) {
+                meshMin[k] = std::min(meshMin[k], modelPrimitive.boundsMin[k]);
+                meshMax[k] = std::max(meshMax[k], modelPrimitive.boundsMax[k]);
+            }
+
+            drawItems.push_back(item);
+
+            float sphere[4];
+            transformSphere(instance.transform, center, radius, sphere, &sphere[3]);
+            for(int k = 0; k < 3; k++) {
+                boundsMin[k] = (drawItemCount == 0) ? sphere[k] - sphere[3] : std::min(boundsMin[k], sphere[k] - sphere[3]);
+                boundsMax[k] = (drawItemCount == 0) ? sphere[k] + sphere[3] : std::max(boundsMax[k], sphere[k] + sphere[3]);
+            }
+            drawItemCount++;
+        }
+
+        if(meshMin[0] <= meshMax[0]) {
+            float center[3], halfExtent[3];
+            for(int k = 0; k < 3; k++) {
+                center[k] = 0.5f * (meshMin[k] + meshMax[k]);
+                halfExtent[k] = 0.5f * (meshMax[k] - meshMin[k]);
+            }
+            std::memcpy(lodInstance.sphere, center, sizeof(center));
+            lodInstance.sphere[3] = std::sqrt(halfExtent[0] * halfExtent[0] + halfExtent[1] * halfExtent[1] + halfExtent[2] * halfExtent[2]);
+        }
+    }
+
+    if(drawItems.empty()) return;
+
+    ModelDrawData data{};
+    data.geometry = model.geometry.buffer;
+    data.drawItemCount = static_cast<uint32_t>(drawItems.size());
+    data.clusterTaskCount = static_cast<uint32_t>(clusterTasks.size());
+    data.clusterCapacity = clusterCapacity;
+    data.firstLodInstance = firstLodInstance;
+    data.instanceCount = static_cast<uint32_t>(model.instances.size());
+
+    uint32_t base = 0;
+    for(uint32_t s = 0; s < DRAW_STREAM_COUNT; s++) {
+        data.streamBase[s] = base;
+        data.streamCapacity[s] = streamCounts[s];
+        base += streamCounts[s];
+    }
+
+    data.drawItems = createStaticBuffer(drawItems.data(), drawItems.size() * sizeof(GpuDrawItem));
+    data.primitives = createStaticBuffer(primitives.data(), primitives.size() * sizeof(GpuPrimitive));
+    data.transforms = createStaticBuffer(transforms.data(), transforms.size() * sizeof(float));
+    if(!clusterTasks.empty()) data.clusterTasks = createStaticBuffer(clusterTasks.data(), clusterTasks.size() * sizeof(GpuClusterTask));
+
+    GpuSceneHeader header{};
+    header.drawItems = resourceManager->getBufferAddress(data.drawItems);
+    header.primitives = resourceManager->getBufferAddress(data.primitives);
+    header.transforms = resourceManager->getBufferAddress(data.transforms);
+    header.geometry = resourceManager->getBufferAddress(model.geometry);
+    header.clusterTasks = clusterTasks.empty() ? 0 : resourceManager->getBufferAddress(data.clusterTasks);
+    header.drawItemCount = data.drawItemCount;
+    header.clusterTaskCount = data.clusterTaskCount;
+    std::memcpy(header.streamBase, data.streamBase, sizeof(header.streamBase));
+
+    data.header = createStaticBuffer(&header, sizeof(header));
+
+    VkBufferUsageFlags perFrameUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                       VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    for(uint32_t f = 0; f < framesInFlight; f++) {
+        data.commands.push_back(resourceManager->allocateBuffer(static_cast<VkDeviceSize>(std::max(base, 1u)) * DRAW_COMMAND_STRIDE, perFrameUsage));
+        data.counts.push_back(resourceManager->allocateBuffer((DRAW_STREAM_COUNT + 1) * sizeof(uint32_t), perFrameUsage));
+
+        // Rewritten every frame, so it lives in host visible memory instead of going through the staging ring
+        data.lodSelections.push_back(resourceManager->allocateBuffer(static_cast<VkDeviceSize>(data.instanceCount) * sizeof(uint32_t),
+                                                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                                                                     VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT));
+
+        if(!meshShaders && clusterCapacity > 0) {
+            data.clusters.push_back(resourceManager->allocateBuffer(static_cast<VkDeviceSize>(clusterCapacity) * 2 * sizeof(uint32_t), perFrameUsage));
+            data.clusterCommands.push_back(resourceManager->allocateBuffer(static_cast<VkDeviceSize>(clusterCapacity) * sizeof(VkDrawIndirectCommand), perFrameUsage));
+        }
+    }
+
+    models.push_back(std::move(data));
+}
+
+void GpuScene::addPasses(FrameGraph& frameGraph, uint32_t frameSlot, const float viewProjection[16], const float cameraPosition[3],
+                         const std::vector<uint32_t>& instanceLods, const std::vector<InstanceTransform>& transformUpdates,
+                         FrameGraphResource colorTarget, FrameGraphResource depthTarget, VkExtent2D extent) {
+    std::vector<uint32_t> selection;
+    for(const ModelDrawData& data : models) {
+        selection.assign(data.instanceCount, 0);
+        for(uint32_t i = 0; i < data.instanceCount && data.firstLodInstance + i < instanceLods.size(); i++) {
+            selection[i] = instanceLods[data.firstLodInstance + i];
+        }
+        resourceManager->enqueueBufferUpload(data.lodSelections[frameSlot], 0, selection.data(), selection.size() * sizeof(uint32_t));
+    }
+
+    if(!transformUpdates.empty()) addTransformPass(frameGraph, frameSlot, transformUpdates);
+
+    std::vector<FrameGraphResource> commandResources, countResources, clusterResources, clusterCommandResources;
+    for(const ModelDrawData& data : models) {
+        commandResources.push_back(frameGraph.importBuffer("Draw Commands", data.commands[frameSlot].buffer));
+        countResources.push_back(frameGraph.importBuffer("Draw Counts", data.counts[frameSlot].buffer));
+
+        if(!data.clusters.empty()) {
+            clusterResources.push_back(frameGraph.importBuffer("Visible Clusters", data.clusters[frameSlot].buffer));
+            clusterCommandResources.push_back(frameGraph.importBuffer("Cluster Commands", data.clusterCommands[frameSlot].buffer));
+        }
+    }
+
+    MeshletConstants meshletConstants{};
+    std::memcpy(meshletConstants.viewProjection, viewProjection, sizeof(meshletConstants.viewProjection));
+    std::memcpy(meshletConstants.cameraPosition, cameraPosition, 3 * sizeof(float));
+
+    if(!models.empty()) {
+        FrameGraph::PassBuilder reset = frameGraph.addPass("Reset Draw Counts", [this, frameSlot](VkCommandBuffer buf) {
+            for(const ModelDrawData& data : models) vkCmdFillBuffer(buf, data.counts[frameSlot].buffer, 0, VK_WHOLE_SIZE, 0);
+        });
+        for(FrameGraphResource counts : countResources) reset.write(counts, ResourceUsage::TransferDst);
+
+        CullConstants constants{};
+        extractFrustumPlanes(viewProjection, constants.planes);
+
+        MeshletCullConstants meshletCullConstants{};
+        std::memcpy(meshletCullConstants.viewProjection, meshletConstants.viewProjection, sizeof(meshletCullConstants.viewProjection));
+        std::memcpy(meshletCullConstants.cameraPosition, meshletConstants.cameraPosition, sizeof(meshletCullConstants.cameraPosition));
+
+        FrameGraph::PassBuilder cull = frameGraph.addPass("Frustum Cull", [this, frameSlot, constants, meshletCullConstants](VkCommandBuffer buf) mutable {
+            vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_COMPUTE, shaderLibrary->getPipeline(cullPipeline));
+
+            for(const ModelDrawData& data : models) {
+                constants.scene = resourceManager->getBufferAddress(data.header);
+                constants.lodSelections = resourceManager->getBufferAddress(data.lodSelections[frameSlot]);
+                constants.commands = resourceManager->getBufferAddress(data.commands[frameSlot]);
+                constants.counts = resourceManager->getBufferAddress(data.counts[frameSlot]);
+
+                vkCmdPushConstants(buf, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+                vkCmdDispatch(buf, (data.drawItemCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+            }
+
+            // Without mesh shaders, meshlets are culled here and drawn as one indirect draw each
+            if(meshShaders) return;
+
+            vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_COMPUTE, shaderLibrary->getPipeline(meshletCullPipeline));
+
+            for(const ModelDrawData& data : models) {
+                if(data.clusters.empty()) continue;
+
+                meshletCullConstants.scene = resourceManager->getBufferAddress(data.header);
+                meshletCullConstants.lodSelections = resourceManager->getBufferAddress(data.lodSelections[frameSlot]);
+                meshletCullConstants.clusters = resourceManager->getBufferAddress(data.clusters[frameSlot]);
+                meshletCullConstants.commands = resourceManager->getBufferAddress(data.clusterCommands[frameSlot]);
+                meshletCullConstants.counts = resourceManager->getBufferAddress(data.counts[frameSlot]);
+
+                for(uint32_t offset = 0; offset < data.clusterTaskCount; offset += MAX_TASK_WORKGROUPS) {
+                    meshletCullConstants.taskOffset = offset;
+                    vkCmdPushConstants(buf, meshletCullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(meshletCullConstants), &meshletCullConstants);
+                    vkCmdDispatch(buf, std::min(data.clusterTaskCount - offset, MAX_TASK_WORKGROUPS), 1, 1);
+                }
+            }
+        });
+        for(size_t m = 0; m < models.size(); m++) {
+            cull.write(countResources[m], ResourceUsage::StorageWriteCompute).write(commandResources[m], ResourceUsage::StorageWriteCompute);
+        }
+        for(size_t c = 0; c < clusterResources.size(); c++) {
+            cull.write(clusterResources[c], ResourceUsage::StorageWriteCompute).write(clusterCommandResources[c], ResourceUsage::StorageWriteCompute);
+        }
+    }
+
+    DrawConstants drawConstants{};
+    std::memcpy(drawConstants.viewProjection, viewProjection, sizeof(drawConstants.viewProjection));
+
+    // Draws of models [begin, end). Secondary command buffers inherit no dynamic state, so every call sets its own.
+    auto recordDraws = [this, frameSlot, drawConstants, meshletConstants, extent](VkCommandBuffer buf, uint32_t begin, uint32_t end) {
+        VkViewport viewport{0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f};
+        VkRect2D scissor{VkOffset2D{0, 0}, extent};
+        vkCmdSetViewport(buf, 0, 1, &viewport);
+        vkCmdSetScissor(buf, 0, 1, &scissor);
+
+        vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, shaderLibrary->getPipeline(drawPipeline));
+
+        DrawConstants modelDrawConstants = drawConstants;
+        for(uint32_t m = begin; m < end; m++) {
+            const ModelDrawData& data = models[m];
+            modelDrawConstants.scene = resourceManager->getBufferAddress(data.header);
+            vkCmdPushConstants(buf, drawPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(modelDrawConstants), &modelDrawConstants);
+
+            VkBuffer commands = data.commands[frameSlot].buffer;
+            VkBuffer counts = data.counts[frameSlot].buffer;
+
+            for(uint32_t s = 0; s < DRAW_STREAM_COUNT; s++) {
+                if(data.streamCapacity[s] == 0) continue;
+
+                VkDeviceSize commandOffset = static_cast<VkDeviceSize>(data.streamBase[s]) * DRAW_COMMAND_STRIDE;
+                VkDeviceSize countOffset = s * sizeof(uint32_t);
+
+                if(s == DRAW_STREAM_NON_INDEXED) {
+                    vkCmdDrawIndirectCount(buf, commands, commandOffset, counts, countOffset, data.streamCapacity[s], DRAW_COMMAND_STRIDE);
+                } else {
+                    vkCmdBindIndexBuffer(buf, data.geometry, 0, (s == DRAW_STREAM_INDEXED_UINT16) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+                    vkCmdDrawIndexedIndirectCount(buf, commands, commandOffset, counts, countOffset, data.streamCapacity[s], DRAW_COMMAND_STRIDE);
+                }
+            }
+        }
+
+        if(meshShaders) {
+            vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, shaderLibrary->getPipeline(meshletPipeline));
+
+            MeshletConstants modelMeshletConstants = meshletConstants;
+            for(uint32_t m = begin; m < end; m++) {
+                const ModelDrawData& data = models[m];
+                modelMeshletConstants.scene = resourceManager->getBufferAddress(data.header);
+                modelMeshletConstants.lodSelections = resourceManager->getBufferAddress(data.lodSelections[frameSlot]);
+
+                for(uint32_t offset = 0; offset < data.clusterTaskCount; offset += MAX_TASK_WORKGROUPS) {
+                    modelMeshletConstants.taskOffset = offset;
+                    vkCmdPushConstants(buf, meshletPipelineLayout, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, 0,
+                                       sizeof(modelMeshletConstants), &modelMeshletConstants);
+                    cmdDrawMeshTasks(buf, std::min(data.clusterTaskCount - offset, MAX_TASK_WORKGROUPS), 1, 1);
+                }
+            }
+        } else {
+            vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, shaderLibrary->getPipeline(meshletDrawPipeline));
+
+            for(uint32_t m = begin; m < end; m++) {
+                const ModelDrawData& data = models[m];
+                if(data.clusters.empty()) continue;
+
+                MeshletDrawConstants meshletDrawConstants{};
+                std::memcpy(meshletDrawConstants.viewProjection, drawConstants.viewProjection, sizeof(meshletDrawConstants.viewProjection));
+                meshletDrawConstants.scene = resourceManager->getBufferAddress(data.header);
+                meshletDrawConstants.clusters = resourceManager->getBufferAddress(data.clusters[frameSlot]);
+                vkCmdPushConstants(buf, meshletDrawPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(meshletDrawConstants), &meshletDrawConstants);
+
+                vkCmdDrawIndirectCount(buf, data.clusterCommands[frameSlot].buffer, 0, data.counts[frameSlot].buffer, CLUSTER_COUNT_INDEX * sizeof(uint32_t),
+                                       data.clusterCapacity, sizeof(VkDrawIndirectCommand));
+            }
+        }
+    };
+
+    FrameGraph::PassBuilder scene = frameGraph.addPass("Scene", [this, &frameGraph, colorTarget, depthTarget, extent, recordDraws](VkCommandBuffer buf) {
+        VkRenderingAttachmentInfo colorAttachmentInfo{};
+        colorAttachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+        colorAttachmentInfo.imageView = frameGraph.getImage(colorTarget).imageView;
+        colorAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        colorAttachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        colorAttachmentInfo.clearValue.color = VkClearColorValue{0, 0, 0, 0};
+
+        VkRenderingAttachmentInfo depthAttachmentInfo{};
+        depthAttachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+        depthAttachmentInfo.imageView = frameGraph.getImage(depthTarget).imageView;
+        depthAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
+        depthAttachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depthAttachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachmentInfo.clearValue.depthStencil.depth = 1.0f;
+
+        VkRenderingInfo renderingInfo{};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+        renderingInfo.renderArea.offset = VkOffset2D{0, 0};
+        renderingInfo.renderArea.extent = extent;
+        renderingInfo.layerCount = 1;
+        renderingInfo.colorAttachmentCount = 1;
+        renderingInfo.pColorAttachments = &colorAttachmentInfo;
+        renderingInfo.pDepthAttachment = &depthAttachmentInfo;
+
+        uint32_t modelCount = static_cast<uint32_t>(models.size());
+        bool parallel = modelCount > MODELS_PER_RECORD_CHUNK && commandRecorder->getThreadCount() > 1;
+        if(parallel) renderingInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+
+        vkCmdBeginRendering(buf, &renderingInfo);
+
+            if(parallel) {
+                VkFormat colorFormat = frameGraph.getImage(colorTarget).imageFormat;
+
+                VkCommandBufferInheritanceRenderingInfo inheritanceInfo{};
+                inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+                inheritanceInfo.colorAttachmentCount = 1;
+                inheritanceInfo.pColorAttachmentFormats = &colorFormat;
+                inheritanceInfo.depthAttachmentFormat = frameGraph.getImage(depthTarget).imageFormat;
+                inheritanceInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+                commandRecorder->recordChunks(buf, inheritanceInfo, modelCount, MODELS_PER_RECORD_CHUNK, recordDraws);
+            } else if(modelCount > 0) {
+                recordDraws(buf, 0, modelCount);
+            }
+
+        vkCmdEndRendering(buf);
+    });
+
+    scene.write(colorTarget, ResourceUsage::ColorAttachment).write(depthTarget, ResourceUsage::DepthAttachment);
+    for(size_t m = 0; m < models.size(); m++) {
+        scene.read(commandResources[m], ResourceUsage::IndirectBuffer).read(countResources[m], ResourceUsage::IndirectBuffer);
+    }
+
+    // Visible clusters are read by the vertex shader, which the indirect buffer barrier does not cover
+    for(size_t c = 0; c < clusterResources.size(); c++) {
+        scene.read(clusterResources[c], ResourceUsage::StorageReadVertex).read(clusterCommandResources[c], ResourceUsage::IndirectBuffer);
+    }
+}
+
+/**
+ * Packs the changed transforms model by model into the frame slot's staging buffer, then adds a pass copying them
+ * into the transform buffers, one region per run of consecutive instances.
+ */
+void GpuScene::addTransformPass(FrameGraph& frameGraph, uint32_t frameSlot, const std::vector<InstanceTransform>& transformUpdates) {
+    std::vector<const InstanceTransform*> sorted(transformUpdates.size());
+    for(size_t u = 0; u < transformUpdates.size(); u++) sorted[u] = &transformUpdates[u];
+    std::stable_sort(sorted.begin(), sorted.end(), [](const InstanceTransform* a, const InstanceTransform* b) { return a->instance < b->instance; });
+
+    constexpr VkDeviceSize TRANSFORM_SIZE = 16 * sizeof(float);
+
+    // Models are in instance order, so one pass over both finds each update's model
+    std::vector<float> staged;
+    std::vector<std::vector<VkBufferCopy>> regions(models.size());
+    size_t m = 0;
+
+    for(size_t u = 0; u < sorted.size(); u++) {
+        // Copy regions may not overlap, so only the last update of an instance is kept
+        const InstanceTransform* update = sorted[u];
+        if(u + 1 < sorted.size() && sorted[u + 1]->instance == update->instance) continue;
+
+        while(m < models.size() && update->instance >= models[m].firstLodInstance + models[m].instanceCount) m++;
+        if(m == models.size()) break;
+        if(update->instance < models[m].firstLodInstance) continue;
+
+        VkDeviceSize srcOffset = staged.size() * sizeof(float);
+        VkDeviceSize dstOffset = static_cast<VkDeviceSize>(update->instance - models[m].firstLodInstance) * TRANSFORM_SIZE;
+        staged.insert(staged.end(), update->transform, update->transform + 16);
+
+        std::vector<VkBufferCopy>& modelRegions = regions[m];
+        if(!modelRegions.empty() && modelRegions.back().srcOffset + modelRegions.back().size == srcOffset &&
+           modelRegions.back().dstOffset + modelRegions.back().size == dstOffset) {
+            modelRegions.back().size += TRANSFORM_SIZE;
+        } else {
+            modelRegions.push_back(VkBufferCopy{srcOffset, dstOffset, TRANSFORM_SIZE});
+        }
+    }
+
+    if(staged.empty()) return;
+
+    // The slot's previous frame is done, so its staging buffer can be replaced
+    VkDeviceSize size = staged.size() * sizeof(float);
+    AllocatedBuffer& staging = transformStaging[frameSlot];
+    if(staging.buffer == VK_NULL_HANDLE || staging.size < size) {
+        VkDeviceSize capacity = std::max(size, staging.buffer == VK_NULL_HANDLE ? 0 : staging.size * 2);
+        if(staging.buffer != VK_NULL_HANDLE) resourceManager->destroyAllocatedBuffer(staging);
+        staging = resourceManager->allocateBuffer(capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                  VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT);
+    }
+    resourceManager->enqueueBufferUpload(staging, 0, staged.data(), size);
+
+    // Transforms are read by compute, vertex, task and mesh shaders, more stages than a declared usage covers, so
+    // the pass records its own barriers and is kept alive explicitly
+    frameGraph.addPass("Update Transforms", [this, frameSlot, regions](VkCommandBuffer buf) {
+        VkMemoryBarrier2 barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+
+        VkDependencyInfo dependencyInfo{};
+        dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependencyInfo.memoryBarrierCount = 1;
+        dependencyInfo.pMemoryBarriers = &barrier;
+
+        // Earlier frames may still be reading the transforms about to be overwritten
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier2(buf, &dependencyInfo);
+
+        for(size_t m = 0; m < models.size(); m++) {
+            if(regions[m].empty()) continue;
+            vkCmdCopyBuffer(buf, transformStaging[frameSlot].buffer, models[m].transforms.buffer, static_cast<uint32_t>(regions[m].size()), regions[m].data());
+        }
+
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+        vkCmdPipelineBarrier2(buf, &dependencyInfo);
+    }).sideEffects();
+}
+
+bool GpuScene::getBounds(float boundsMin[3], float boundsMax[3]) const {
+    if(drawItemCount == 0) return false;
+
+    std::memcpy(boundsMin, this->boundsMin, sizeof(this->boundsMin));
+    std::memcpy(boundsMax, this->boundsMax, sizeof(this->boundsMax));
+    return true;
+}
+
+/**
+ * Builds a scene pipeline drawing into the R16G16B16A16 color target with depth. Mesh shader stages replace the
+ * vertex input and input assembly state, which Vulkan then ignores.
+ */
+static VkPipeline createScenePipeline(PipelineCache& pipelineCache, const std::vector<std::shared_ptr<ShaderModule>>& shaders,
+                                      const std::vector<VkShaderStageFlagBits>& stageFlags, VkPipelineLayout layout, VkCullModeFlags cullMode) {
+    std::vector<VkPipelineShaderStageCreateInfo> stages(shaders.size());
+    for(size_t i = 0; i < shaders.size(); i++) {
+        stages[i].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[i].stage = stageFlags[i];
+        stages[i].module = shaders[i]->getShaderModule();
+        stages[i].pName = "main";
+    }
+
+    // Vertices are pulled in the shader, so there is no fixed function vertex input
+    VkPipelineVertexInputStateCreateInfo vertexInput{};
+    vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterization{};
+    rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterization.cullMode = cullMode;
+    rasterization.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterization.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisample{};
+    multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+    VkPipelineColorBlendAttachmentState blendAttachment{};
+    blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    VkPipelineColorBlendStateCreateInfo colorBlend{};
+    colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlend.attachmentCount = 1;
+    colorBlend.pAttachments = &blendAttachment;
+
+    VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    VkFormat colorFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+    VkPipelineRenderingCreateInfo renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &colorFormat;
+    renderingInfo.depthAttachmentFormat = VK_FORMAT_D32_SFLOAT;
+
+    VkGraphicsPipelineCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    createInfo.pNext = &renderingInfo;
+    createInfo.stageCount = static_cast<uint32_t>(stages.size());
+    createInfo.pStages = stages.data();
+    createInfo.pVertexInputState = &vertexInput;
+    createInfo.pInputAssemblyState = &inputAssembly;
+    createInfo.pViewportState = &viewportState;
+    createInfo.pRasterizationState = &rasterization;
+    createInfo.pMultisampleState = &multisample;
+    createInfo.pDepthStencilState = &depthStencil;
+    createInfo.pColorBlendState = &colorBlend;
+    createInfo.pDynamicState = &dynamicState;
+    createInfo.layout = layout;
+
+    return pipelineCache.createGraphicsPipeline(createInfo);
+}
+
+static VkPipeline createComputePipeline(PipelineCache& pipelineCache, const std::shared_ptr<ShaderModule>& shader, VkPipelineLayout layout) {
+    VkComputePipelineCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    createInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    createInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    createInfo.stage.module = shader->getShaderModule();
+    createInfo.stage.pName = "main";
+    createInfo.layout = layout;
+
+    return pipelineCache.createComputePipeline(createInfo);
+}
+
+static VkPipelineLayout createPushConstantLayout(VkDevice device, VkShaderStageFlags stages, uint32_t size) {
+    VkPushConstantRange range{stages, 0, size};
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.pushConstantRangeCount = 1;
+    layoutInfo.pPushConstantRanges = &range;
+
+    VkPipelineLayout layout;
+    if(vkCreatePipelineLayout(device, &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create GPU scene pipeline layout!");
+    }
+
+    return layout;
+}
+
+void GpuScene::createPipelines() {
+    cullPipelineLayout = createPushConstantLayout(_device, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(CullConstants));
+    drawPipelineLayout = createPushConstantLayout(_device, VK_SHADER_STAGE_VERTEX_BIT, sizeof(DrawConstants));
+
+    cullPipeline = shaderLibrary->registerPipeline({"cull.comp.spv"}, [this](PipelineCache& pipelineCache, const std::vector<std::shared_ptr<ShaderModule>>& shaders) {
+        return createComputePipeline(pipelineCache, shaders[0], cullPipelineLayout);
+    });
+
+    // Whole primitives may be double sided or mirrored, so they are drawn without back face culling
+    drawPipeline = shaderLibrary->registerPipeline({"mesh.vert.spv", "mesh.frag.spv"}, [this](PipelineCache& pipelineCache, const std::vector<std::shared_ptr<ShaderModule>>& shaders) {
+        return createScenePipeline(pipelineCache, shaders, {VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT}, drawPipelineLayout, VK_CULL_MODE_NONE);
+    });
+
+    // Meshlets are cone culled as single sided (the glTF default), so the rasterizer culls back faces to match.
+    // Only the pipelines of the chosen path are created; the other path's shaders may not be supported.
+    if(meshShaders) {
+        meshletPipelineLayout = createPushConstantLayout(_device, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, sizeof(MeshletConstants));
+
+        meshletPipeline = shaderLibrary->registerPipeline({"meshlet.task.spv", "meshlet.mesh.spv", "mesh.frag.spv"},
+                                                          [this](PipelineCache& pipelineCache, const std::vector<std::shared_ptr<ShaderModule>>& shaders) {
+            return createScenePipeline(pipelineCache, shaders, {VK_SHADER_STAGE_TASK_BIT_EXT, VK_SHADER_STAGE_MESH_BIT_EXT, VK_SHADER_STAGE_FRAGMENT_BIT},
+                                       meshletPipelineLayout, VK_CULL_MODE_BACK_BIT);
+        });
+    } else {
+        meshletCullPipelineLayout = createPushConstantLayout(_device, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(MeshletCullConstants));
+        meshletDrawPipelineLayout = createPushConstantLayout(_device, VK_SHADER_STAGE_VERTEX_BIT, sizeof(MeshletDrawConstants));
+
+        meshletCullPipeline = shaderLibrary->registerPipeline({"meshlet_cull.comp.spv"}, [this](PipelineCache& pipelineCache, const std::vector<std::shared_ptr<ShaderModule>>& shaders) {
+            return createComputePipeline(pipelineCache, shaders[0], meshletCullPipelineLayout);
+        });
+
+        meshletDrawPipeline = shaderLibrary->registerPipeline({"meshlet.vert.spv", "mesh.frag.spv"}, [this](PipelineCache& pipelineCache, const std::vector<std::shared_ptr<ShaderModule>>& shaders) {
+            return createScenePipeline(pipelineCache, shaders, {VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT}, meshletDrawPipelineLayout, VK_CULL_MODE_BACK_BIT);
+        });
+    }
+}
+
+/**
+ * Creates a buffer the shaders read by device address and fills it through the staging ring.
+ */
+AllocatedBuffer GpuScene::createStaticBuffer(const void* data, VkDeviceSize size) {
+    AllocatedBuffer buffer = resourceManager->allocateBuffer(size,
+                                                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                                             VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                                                             VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                                                             VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                                                             VMA_ALLOCATION_CREATE_MAPPED_BIT);
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    VkDeviceSize uploaded = 0;
+    while(uploaded < size) {
+        uploaded += resourceManager->enqueueBufferUpload(buffer, uploaded, bytes + uploaded, size - uploaded);
+
+        // Draw data is small next to geometry; if the ring is full, drain it instead of deferring the model
+        if(uploaded < size) resourceManager->flushUploads();
+    }
+
+    return buffer;
+}
+
+} // namespace vkmv
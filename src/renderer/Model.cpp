@@ -0,0 +1,15 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/renderer/Model.hpp"
+
+namespace vkmv {
+
+void destroyModel(ResourceManager& resourceManager, Model& model) {
+    if(model.geometry.buffer != VK_NULL_HANDLE) resourceManager.destroyAllocatedBuffer(model.geometry);
+    model = Model{};
+}
+
+} // namespace vkmv
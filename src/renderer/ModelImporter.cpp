@@ -0,0 +1,617 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/renderer/ModelImporter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "vkmv/assets/GeometryProcessing.hpp"
+#include "vkmv/utils/CpuTrace.hpp"
+#include "vkmv/utils/Math.hpp"
+
+namespace vkmv {
+
+// Generated streams are placed at this alignment, which keeps them word aligned for vertex pulling
+constexpr VkDeviceSize GEOMETRY_ALIGNMENT = 16;
+
+// Primitives per job; small enough to balance 2000-mesh scenes, large enough to amortize scheduling
+constexpr uint32_t PRIMITIVES_PER_JOB = 4;
+
+// Each detail level targets this fraction of the previous level's triangles. The chain ends early once a level
+// keeps more than LOD_MIN_REDUCTION of them (locked seams and borders) or fits in a single meshlet.
+constexpr float LOD_REDUCTION = 0.5f;
+constexpr float LOD_MIN_REDUCTION = 0.8f;
+
+// Overdraw ordering may raise the cache optimized ACMR by at most this factor
+constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+// Heap used while processing a primitive, to size batches: decoded attributes and reorder tables per vertex; the
+// source and optimized index lists, the detail levels and the meshlet arrays per index
+constexpr size_t DECODED_BYTES_PER_VERTEX = 72;
+constexpr size_t DECODED_BYTES_PER_INDEX = 20;
+
+// Vertices packed per job during upload
+constexpr uint32_t PACK_VERTICES_PER_JOB = 16384;
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static bool isDrawable(const GltfAsset& asset, const GltfPrimitive& primitive) {
+    if(primitive.mode != GLTF_MODE_TRIANGLES || primitive.position == GLTF_INVALID_INDEX) return false;
+
+    for(uint32_t accessor : {primitive.position, primitive.normal, primitive.tangent, primitive.texcoord0, primitive.indices}) {
+        if(accessor == GLTF_INVALID_INDEX) continue;
+        if(asset.accessors()[accessor].sparse || asset.accessors()[accessor].bufferView == GLTF_INVALID_INDEX) return false;
+    }
+
+    return true;
+}
+
+// Builds the meshlets of one detail level and appends them to the primitive's meshlet arrays
+static ModelLod appendLodMeshlets(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                                  std::vector<Meshlet>& meshlets, std::vector<uint32_t>& meshletVertices, std::vector<uint32_t>& meshletTriangles) {
+    std::vector<Meshlet> levelMeshlets;
+    std::vector<uint32_t> levelVertices, levelTriangles;
+    buildMeshlets(positions, vertexCount, indices, indexCount, levelMeshlets, levelVertices, levelTriangles);
+
+    ModelLod lod{};
+    lod.firstMeshlet = static_cast<uint32_t>(meshlets.size());
+    lod.meshletCount = static_cast<uint32_t>(levelMeshlets.size());
+
+    for(Meshlet meshlet : levelMeshlets) {
+        meshlet.vertexOffset += static_cast<uint32_t>(meshletVertices.size());
+        meshlet.triangleOffset += static_cast<uint32_t>(meshletTriangles.size());
+        lod.triangleCount += meshlet.triangleCount;
+        meshlets.push_back(meshlet);
+    }
+    meshletVertices.insert(meshletVertices.end(), levelVertices.begin(), levelVertices.end());
+    meshletTriangles.insert(meshletTriangles.end(), levelTriangles.begin(), levelTriangles.end());
+
+    return lod;
+}
+
+// Decodes the first components of the elements of an accessor into a tightly packed float array, either all of
+// them or the ones listed in order
+static std::vector<float> decodeFloats(const GltfAsset& asset, uint32_t accessor, uint32_t components, const std::vector<uint32_t>& order = {}) {
+    uint32_t count = order.empty() ? asset.accessors()[accessor].count : static_cast<uint32_t>(order.size());
+    std::vector<float> out(static_cast<size_t>(count) * components);
+
+    float element[4];
+    for(uint32_t i = 0; i < count; i++) {
+        asset.readFloats(accessor, order.empty() ? i : order[i], element);
+        std::memcpy(out.data() + static_cast<size_t>(i) * components, element, components * sizeof(float));
+    }
+
+    return out;
+}
+
+ModelImport::ModelImport(JobSystem& jobSystem, std::string path, size_t batchBudget)
+: m_jobSystem(jobSystem), m_path(std::move(path)), m_batchBudget(batchBudget) {
+    m_jobSystem.submit([this]() { run(); }, &m_counter);
+}
+
+ModelImport::~ModelImport() {
+    wait();
+}
+
+void ModelImport::wait() {
+    m_jobSystem.wait(m_counter);
+}
+
+/**
+ * Runs as one job per batch. The first one also parses the file and plans the batches.
+ */
+void ModelImport::run() {
+    VKMV_TRACE_SCOPE("Import Model");
+
+    try {
+        if(!m_asset) {
+            m_asset = std::make_unique<GltfAsset>(m_path);
+            m_stage.store(Stage::Processing, std::memory_order_release);
+
+            buildTables();
+            planBatches();
+            buildNodes();
+        }
+
+        if(m_currentBatch < m_batches.size()) processBatch();
+
+        m_stage.store(Stage::Ready, std::memory_order_release);
+    } catch(const std::exception& e) {
+        m_error = e.what();
+        m_stage.store(Stage::Failed, std::memory_order_release);
+    }
+}
+
+/**
+ * Creates the mesh table and one entry per drawable primitive, so later stages can run per primitive in parallel.
+ */
+void ModelImport::buildTables() {
+    VKMV_TRACE_SCOPE("Build Import Tables");
+
+    const GltfAsset& asset = *m_asset;
+
+    for(const GltfMesh& mesh : asset.meshes()) {
+        ModelMesh modelMesh{static_cast<uint32_t>(m_primitiveData.size()), 0};
+
+        for(uint32_t p = 0; p < mesh.primitiveCount; p++) {
+            uint32_t gltfPrimitive = mesh.firstPrimitive + p;
+
+            if(!isDrawable(asset, asset.primitives()[gltfPrimitive])) {
+                std::cerr << "Skipping unsupported glTF primitive (mode " << asset.primitives()[gltfPrimitive].mode << ")" << std::endl;
+                continue;
+            }
+
+            PrimitiveData data;
+            data.gltfPrimitive = gltfPrimitive;
+            m_primitiveData.push_back(std::move(data));
+            modelMesh.primitiveCount++;
+        }
+
+        m_model.meshes.push_back(modelMesh);
+    }
+
+    m_model.primitives.resize(m_primitiveData.size());
+}
+
+/**
+ * Splits the primitives into consecutive batches by their estimated processing heap use, and notes the last batch
+ * reading each buffer view so its pages can be dropped right after it.
+ */
+void ModelImport::planBatches() {
+    const GltfAsset& asset = *m_asset;
+    m_lastBatchOfView.assign(asset.bufferViews().size(), UINT32_MAX);
+
+    size_t batchBytes = 0;
+    for(uint32_t p = 0; p < m_primitiveData.size(); p++) {
+        const GltfPrimitive& primitive = asset.primitives()[m_primitiveData[p].gltfPrimitive];
+
+        size_t vertexCount = asset.accessors()[primitive.position].count;
+        size_t indexCount = (primitive.indices != GLTF_INVALID_INDEX) ? asset.accessors()[primitive.indices].count : vertexCount;
+        size_t bytes = vertexCount * DECODED_BYTES_PER_VERTEX + indexCount * DECODED_BYTES_PER_INDEX;
+
+        if(m_batches.empty() || batchBytes + bytes > m_batchBudget) {
+            m_batches.push_back(ImportBatch{p, p});
+            batchBytes = 0;
+        }
+        m_batches.back().endPrimitive = p + 1;
+        batchBytes += bytes;
+
+        uint32_t batch = static_cast<uint32_t>(m_batches.size() - 1);
+        for(uint32_t accessor : {primitive.position, primitive.normal, primitive.tangent, primitive.texcoord0, primitive.indices}) {
+            if(accessor != GLTF_INVALID_INDEX) m_lastBatchOfView[asset.accessors()[accessor].bufferView] = batch;
+        }
+    }
+}
+
+/**
+ * Processes the primitives of the current batch in parallel, drops the file pages no later batch reads, then lays
+ * the batch out after the previous ones and fills its primitive tables.
+ */
+void ModelImport::processBatch() {
+    VKMV_TRACE_SCOPE("Process Import Batch");
+
+    const ImportBatch& batch = m_batches[m_currentBatch];
+    uint32_t firstPrimitive = batch.firstPrimitive;
+    uint32_t primitiveCount = batch.endPrimitive - batch.firstPrimitive;
+
+    JobCounter processing;
+    m_jobSystem.parallelFor(primitiveCount, PRIMITIVES_PER_JOB, [this, firstPrimitive](uint32_t begin, uint32_t end) {
+        for(uint32_t i = begin; i < end; i++) processPrimitive(firstPrimitive + i);
+    }, &processing);
+    m_jobSystem.wait(processing);
+
+    for(uint32_t v = 0; v < m_lastBatchOfView.size(); v++) {
+        if(m_lastBatchOfView[v] == m_currentBatch) m_asset->releaseBufferView(v);
+    }
+
+    for(uint32_t i = batch.firstPrimitive; i < batch.endPrimitive; i++) {
+        const PrimitiveData& data = m_primitiveData[i];
+        m_sourceCacheStatistics.triangleCount += data.sourceCacheStatistics.triangleCount;
+        m_sourceCacheStatistics.vertexCount += data.sourceCacheStatistics.vertexCount;
+        m_sourceCacheStatistics.transformedCount += data.sourceCacheStatistics.transformedCount;
+        m_optimizedCacheStatistics.triangleCount += data.optimizedCacheStatistics.triangleCount;
+        m_optimizedCacheStatistics.vertexCount += data.optimizedCacheStatistics.vertexCount;
+        m_optimizedCacheStatistics.transformedCount += data.optimizedCacheStatistics.transformedCount;
+    }
+
+    layoutBatch();
+
+    JobCounter preparing;
+    m_jobSystem.parallelFor(primitiveCount, PRIMITIVES_PER_JOB, [this, firstPrimitive](uint32_t begin, uint32_t end) {
+        for(uint32_t i = begin; i < end; i++) preparePrimitive(firstPrimitive + i);
+    }, &preparing);
+    m_jobSystem.wait(preparing);
+}
+
+/**
+ * Decoding, cache optimization, LOD generation, meshlet generation and tangent generation. Attributes are decoded in
+ * the optimized vertex order, so upload() packs the final vertices directly.
+ */
+void ModelImport::processPrimitive(uint32_t index) {
+    VKMV_TRACE_SCOPE("Process Primitive");
+
+    const GltfAsset& asset = *m_asset;
+    PrimitiveData& data = m_primitiveData[index];
+    const GltfPrimitive& primitive = asset.primitives()[data.gltfPrimitive];
+
+    uint32_t vertexCount = asset.accessors()[primitive.position].count;
+    std::vector<float> positions = decodeFloats(asset, primitive.position, 3);
+
+    std::vector<uint32_t> indices;
+    uint32_t indexCount = vertexCount;
+    if(primitive.indices != GLTF_INVALID_INDEX) {
+        indexCount = asset.accessors()[primitive.indices].count;
+        indices.resize(indexCount);
+        for(uint32_t i = 0; i < indexCount; i++) indices[i] = asset.readUint(primitive.indices, i);
+
+        reorderPrimitive(data, indices, positions);
+        vertexCount = data.vertexCount;
+        indexCount = static_cast<uint32_t>(indices.size());
+    } else {
+        data.vertexCount = vertexCount;
+    }
+    const uint32_t* indexData = indices.empty() ? nullptr : indices.data();
+
+    data.lods.push_back(appendLodMeshlets(positions.data(), vertexCount, indexData, indexCount, data.meshlets, data.meshletVertices, data.meshletTriangles));
+
+    // Levels are simplified from the previous one, so their errors add up
+    std::vector<uint32_t> levelIndices;
+    const uint32_t* levelData = indexData;
+    uint32_t levelCount = indexCount;
+    float error = 0.0f;
+
+    while(data.lods.size() < MAX_LOD_COUNT && data.lods.back().triangleCount > MESHLET_MAX_TRIANGLES) {
+        uint32_t target = static_cast<uint32_t>(levelCount / 3 * LOD_REDUCTION) * 3;
+
+        std::vector<uint32_t> simplified(levelCount);
+        float levelError;
+        uint32_t simplifiedCount = simplifyMesh(positions.data(), vertexCount, levelData, levelCount, target, simplified.data(), &levelError);
+        if(simplifiedCount == 0 || simplifiedCount > levelCount * LOD_MIN_REDUCTION) break;
+
+        simplified.resize(simplifiedCount);
+        levelIndices = std::move(simplified);
+        levelData = levelIndices.data();
+        levelCount = simplifiedCount;
+        error += levelError;
+
+        ModelLod lod = appendLodMeshlets(positions.data(), vertexCount, levelData, levelCount, data.meshlets, data.meshletVertices, data.meshletTriangles);
+        lod.error = error;
+        data.lods.push_back(lod);
+    }
+
+    std::vector<float> normals;
+    if(primitive.normal == GLTF_INVALID_INDEX) {
+        normals.resize(static_cast<size_t>(vertexCount) * 3);
+        generateNormals(positions.data(), vertexCount, indexData, indexCount, normals.data());
+    } else {
+        normals = decodeFloats(asset, primitive.normal, 3, data.vertexOrder);
+    }
+
+    std::vector<float> tangents, texcoords;
+    if(primitive.texcoord0 != GLTF_INVALID_INDEX) {
+        texcoords = decodeFloats(asset, primitive.texcoord0, 2, data.vertexOrder);
+
+        if(primitive.tangent == GLTF_INVALID_INDEX) {
+            tangents.resize(static_cast<size_t>(vertexCount) * 4);
+            generateTangents(positions.data(), normals.data(), texcoords.data(), vertexCount, indexData, indexCount, tangents.data());
+        } else {
+            tangents = decodeFloats(asset, primitive.tangent, 4, data.vertexOrder);
+        }
+    }
+
+    data.vertexFormat = texcoords.empty() ? VERTEX_FORMAT_COMPACT : VERTEX_FORMAT_COMPACT_TEXTURED;
+    data.quantization = computePositionQuantization(positions.data(), vertexCount);
+    data.positions = std::move(positions);
+    data.normals = std::move(normals);
+    data.tangents = std::move(tangents);
+    data.texcoords = std::move(texcoords);
+
+    // Only decoding needed the source order
+    std::vector<uint32_t>().swap(data.vertexOrder);
+}
+
+/**
+ * Reorders the triangles of an indexed primitive for the post-transform cache, then for overdraw, then numbers the
+ * vertices in order of first use and copies every attribute in that order. indices and positions are rewritten in
+ * the new order; vertices no triangle uses are dropped.
+ */
+void ModelImport::reorderPrimitive(PrimitiveData& data, std::vector<uint32_t>& indices, std::vector<float>& positions) {
+    const GltfAsset& asset = *m_asset;
+    const GltfPrimitive& primitive = asset.primitives()[data.gltfPrimitive];
+    uint32_t sourceVertexCount = asset.accessors()[primitive.position].count;
+
+    // Triangles with out of range indices would make the optimizers read past their per vertex arrays
+    uint32_t write = 0;
+    for(uint32_t i = 0; i + 2 < indices.size(); i += 3) {
+        if(indices[i] >= sourceVertexCount || indices[i + 1] >= sourceVertexCount || indices[i + 2] >= sourceVertexCount) continue;
+        for(uint32_t c = 0; c < 3; c++) indices[write++] = indices[i + c];
+    }
+    indices.resize(write);
+    uint32_t indexCount = write;
+
+    data.sourceCacheStatistics = analyzeVertexCache(indices.data(), indexCount, sourceVertexCount);
+
+    std::vector<uint32_t> optimized(indexCount);
+    optimizeVertexCache(indices.data(), indexCount, sourceVertexCount, optimized.data());
+    optimizeOverdraw(optimized.data(), indexCount, positions.data(), sourceVertexCount, OVERDRAW_THRESHOLD);
+
+    std::vector<uint32_t> remap(sourceVertexCount);
+    data.vertexCount = optimizeVertexFetchRemap(optimized.data(), indexCount, sourceVertexCount, remap.data());
+    data.vertexOrder.resize(data.vertexCount);
+    for(uint32_t v = 0; v < sourceVertexCount; v++) {
+        if(remap[v] != UNREFERENCED_VERTEX) data.vertexOrder[remap[v]] = v;
+    }
+    for(uint32_t i = 0; i < indexCount; i++) indices[i] = remap[optimized[i]];
+
+    data.optimizedCacheStatistics = analyzeVertexCache(indices.data(), indexCount, data.vertexCount);
+
+    std::vector<float> reorderedPositions(static_cast<size_t>(data.vertexCount) * 3);
+    for(uint32_t v = 0; v < data.vertexCount; v++) {
+        std::memcpy(&reorderedPositions[v * 3], &positions[static_cast<size_t>(data.vertexOrder[v]) * 3], 3 * sizeof(float));
+    }
+    positions = std::move(reorderedPositions);
+
+    // 16 bit indices also replace 8 bit ones, which need VK_EXT_index_type_uint8
+    if(data.vertexCount <= 65536) data.indices16.assign(indices.begin(), indices.end());
+    else data.indices32 = indices;
+
+}
+
+/**
+ * Serial pass that assigns every generated stream of the current batch a range in its intermediate buffer. The
+ * batch goes after the previous ones in the geometry buffer, which is what the primitive offsets point into.
+ */
+void ModelImport::layoutBatch() {
+    VKMV_TRACE_SCOPE("Layout Geometry");
+
+    ImportBatch& batch = m_batches[m_currentBatch];
+    batch.geometryOffset = m_geometrySize;
+
+    uint32_t primitive = batch.firstPrimitive;
+    auto placeGenerated = [&](const void* src, VkDeviceSize size) {
+        VkDeviceSize offset = batch.size;
+        m_uploads.push_back(GeometryUpload{offset, src, size, primitive});
+        batch.size = alignUp(batch.size + size, GEOMETRY_ALIGNMENT);
+        return batch.geometryOffset + offset;
+    };
+
+    for(; primitive < batch.endPrimitive; primitive++) {
+        PrimitiveData& data = m_primitiveData[primitive];
+
+        if(data.vertexCount > 0) {
+            VkDeviceSize size = static_cast<VkDeviceSize>(data.vertexCount) * getVertexFormatInfo(data.vertexFormat).stride;
+            data.verticesOffset = placeGenerated(nullptr, size);
+        }
+        if(!data.indices16.empty()) data.indicesOffset = placeGenerated(data.indices16.data(), data.indices16.size() * sizeof(uint16_t));
+        if(!data.indices32.empty()) data.indicesOffset = placeGenerated(data.indices32.data(), data.indices32.size() * sizeof(uint32_t));
+
+        if(!data.meshlets.empty()) {
+            data.meshletsOffset = placeGenerated(data.meshlets.data(), data.meshlets.size() * sizeof(Meshlet));
+            data.meshletVerticesOffset = placeGenerated(data.meshletVertices.data(), data.meshletVertices.size() * sizeof(uint32_t));
+            data.meshletTrianglesOffset = placeGenerated(data.meshletTriangles.data(), data.meshletTriangles.size() * sizeof(uint32_t));
+        }
+    }
+
+    m_geometrySize += batch.size;
+}
+
+/**
+ * Fills the ModelPrimitive for a primitive from the layout. Bounds are the position quantization range.
+ */
+void ModelImport::preparePrimitive(uint32_t index) {
+    PrimitiveData& data = m_primitiveData[index];
+    ModelPrimitive& modelPrimitive = m_model.primitives[index];
+
+    modelPrimitive.vertexOffset = data.verticesOffset;
+    modelPrimitive.vertexFormat = data.vertexFormat;
+    modelPrimitive.quantization = data.quantization;
+    modelPrimitive.vertexCount = data.vertexCount;
+
+    modelPrimitive.meshletCount = static_cast<uint32_t>(data.meshlets.size());
+    modelPrimitive.meshletOffset = data.meshletsOffset;
+    modelPrimitive.meshletVertexOffset = data.meshletVerticesOffset;
+    modelPrimitive.meshletTriangleOffset = data.meshletTrianglesOffset;
+    modelPrimitive.lodCount = static_cast<uint32_t>(data.lods.size());
+    std::copy(data.lods.begin(), data.lods.end(), modelPrimitive.lods);
+
+    for(int k = 0; k < 3; k++) {
+        modelPrimitive.boundsMin[k] = data.quantization.bias[k];
+        modelPrimitive.boundsMax[k] = data.quantization.bias[k] + data.quantization.scale[k];
+    }
+
+    modelPrimitive.indexOffset = data.indicesOffset;
+    if(!data.indices32.empty()) {
+        modelPrimitive.indexCount = static_cast<uint32_t>(data.indices32.size());
+        modelPrimitive.indexType = VK_INDEX_TYPE_UINT32;
+    } else {
+        modelPrimitive.indexCount = static_cast<uint32_t>(data.indices16.size());
+        modelPrimitive.indexType = VK_INDEX_TYPE_UINT16;
+    }
+}
+
+/**
+ * Copies the node hierarchy breadth first, so nodes end up sorted by depth with parents ahead of their children,
+ * and creates an instance for every node with a mesh.
+ */
+void ModelImport::buildNodes() {
+    VKMV_TRACE_SCOPE("Build Nodes");
+
+    const GltfAsset& asset = *m_asset;
+    std::vector<uint32_t> roots;
+
+    if(asset.defaultScene() != GLTF_INVALID_INDEX) {
+        const GltfScene& scene = asset.scenes()[asset.defaultScene()];
+        roots.assign(asset.sceneRoots().begin() + scene.firstRoot, asset.sceneRoots().begin() + scene.firstRoot + scene.rootCount);
+    } else {
+        // Without scenes every parentless node is a root
+        std::vector<bool> isChild(asset.nodes().size(), false);
+        for(uint32_t child : asset.nodeChildren()) isChild[child] = true;
+        for(uint32_t n = 0; n < asset.nodes().size(); n++) if(!isChild[n]) roots.push_back(n);
+    }
+
+    struct QueueEntry {
+        uint32_t node;                      // glTF node
+        uint32_t depth;
+        uint32_t parent;                    // index into m_model.nodes
+    };
+
+    static const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+    std::vector<QueueEntry> queue;
+    for(uint32_t root : roots) queue.push_back(QueueEntry{root, 0, MODEL_NODE_ROOT});
+
+    // World transforms of the nodes built so far, for the instances' initial transforms
+    std::vector<float> worldTransforms;
+
+    for(size_t q = 0; q < queue.size(); q++) {
+        QueueEntry entry = queue[q];
+
+        // The asset rejects nodes with several parents, so only a cycle can run this deep
+        if(entry.depth > asset.nodes().size()) throw std::runtime_error("glTF node hierarchy contains a cycle!");
+
+        const GltfNode& node = asset.nodes()[entry.node];
+        uint32_t index = static_cast<uint32_t>(m_model.nodes.size());
+
+        ModelNode modelNode{entry.parent, {}};
+        std::memcpy(modelNode.localTransform, node.localTransform, sizeof(modelNode.localTransform));
+        m_model.nodes.push_back(modelNode);
+
+        worldTransforms.resize(worldTransforms.size() + 16);
+        const float* parentWorld = (entry.parent == MODEL_NODE_ROOT) ? identity : &worldTransforms[entry.parent * 16];
+        multiplyMatrices(parentWorld, node.localTransform, &worldTransforms[index * 16]);
+
+        if(node.mesh != GLTF_INVALID_INDEX) {
+            ModelInstance instance{node.mesh, index, {}};
+            std::memcpy(instance.transform, &worldTransforms[index * 16], sizeof(instance.transform));
+            m_model.instances.push_back(instance);
+        }
+
+        for(uint32_t c = 0; c < node.childCount; c++) {
+            queue.push_back(QueueEntry{asset.nodeChildren()[node.firstChild + c], entry.depth + 1, index});
+        }
+    }
+}
+
+bool ModelImport::upload(ResourceManager& resourceManager, VkDeviceSize byteBudget) {
+    VKMV_TRACE_SCOPE("Upload Geometry");
+
+    if(m_currentBatch < m_batches.size()) {
+        ImportBatch& batch = m_batches[m_currentBatch];
+        if(batch.buffer.buffer == VK_NULL_HANDLE && batch.size > 0) batch.buffer = resourceManager.allocateIntermediateBuffer(batch.size);
+
+        VkDeviceSize spent = 0;
+        std::vector<VertexPack> packs;
+
+        // Large regions are split across calls so a single huge stream cannot stall a frame
+        while(m_nextUpload < m_uploads.size() && spent < byteBudget) {
+            const GeometryUpload& region = m_uploads[m_nextUpload];
+
+            VkDeviceSize size = std::min(region.size - m_nextUploadOffset, byteBudget - spent);
+            VkDeviceSize dstOffset = region.dstOffset + m_nextUploadOffset;
+            VkDeviceSize staged = 0;
+
+            if(region.data != nullptr) {
+                const uint8_t* src = static_cast<const uint8_t*>(region.data) + m_nextUploadOffset;
+                staged = resourceManager.enqueueBufferUpload(batch.buffer, dstOffset, src, size);
+            } else {
+                // Vertices are reserved whole and packed below, once this call's ranges are known
+                uint32_t stride = getVertexFormatInfo(m_primitiveData[region.primitive].vertexFormat).stride;
+                size -= size % stride;
+                if(size == 0) break;
+
+                uint8_t* dst = static_cast<uint8_t*>(resourceManager.reserveBufferUpload(batch.buffer, dstOffset, size, stride, staged));
+                uint32_t firstVertex = static_cast<uint32_t>(m_nextUploadOffset / stride);
+                uint32_t vertexCount = static_cast<uint32_t>(staged / stride);
+
+                for(uint32_t v = 0; v < vertexCount; v += PACK_VERTICES_PER_JOB) {
+                    uint32_t count = std::min(PACK_VERTICES_PER_JOB, vertexCount - v);
+                    packs.push_back(VertexPack{region.primitive, firstVertex + v, count, dst + static_cast<size_t>(v) * stride});
+                }
+            }
+
+            spent += staged;
+            m_nextUploadOffset += staged;
+
+            if(m_nextUploadOffset == region.size) {
+                m_nextUpload++;
+                m_nextUploadOffset = 0;
+            }
+
+            // Staging ring is full; continue once earlier frames retire their copies
+            if(staged < size) break;
+        }
+
+        // The reserved memory is flushed by the next submitUploads(), so it has to be filled before returning
+        JobCounter packing;
+        m_jobSystem.parallelFor(static_cast<uint32_t>(packs.size()), 1, [this, &packs](uint32_t begin, uint32_t end) {
+            for(uint32_t i = begin; i < end; i++) packVertexRange(packs[i]);
+        }, &packing);
+        m_jobSystem.wait(packing);
+
+        if(m_nextUpload < m_uploads.size()) return false;
+
+        // Staging copied everything the batch generated; only then is the next one decoded
+        for(uint32_t i = batch.firstPrimitive; i < batch.endPrimitive; i++) m_primitiveData[i] = PrimitiveData{};
+        m_uploads.clear();
+        m_nextUpload = 0;
+
+        if(++m_currentBatch < m_batches.size()) {
+            m_stage.store(Stage::Processing, std::memory_order_release);
+            m_jobSystem.submit([this]() { run(); }, &m_counter);
+            return false;
+        }
+    }
+
+    // Every batch is staged, so the geometry size is final and the GPU can gather the batches into place
+    if(m_geometrySize > 0) {
+        m_model.geometry = resourceManager.allocateBuffer(m_geometrySize,
+                                                          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                                                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                                          VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT);
+
+        for(ImportBatch& batch : m_batches) {
+            if(batch.buffer.buffer == VK_NULL_HANDLE) continue;
+
+            resourceManager.enqueueBufferCopy(batch.buffer, 0, m_model.geometry, batch.geometryOffset, batch.size);
+            resourceManager.destroyIntermediateBuffer(batch.buffer);
+            batch.buffer = AllocatedBuffer{};
+        }
+    }
+
+    m_primitiveData.clear();
+    m_batches.clear();
+    m_asset.reset();
+    return true;
+}
+
+void ModelImport::packVertexRange(const VertexPack& pack) const {
+    const PrimitiveData& data = m_primitiveData[pack.primitive];
+    size_t first = pack.firstVertex;
+
+    VertexAttributes attributes;
+    attributes.positions = data.positions.data() + first * 3;
+    attributes.normals = data.normals.data() + first * 3;
+    attributes.tangents = data.tangents.empty() ? nullptr : data.tangents.data() + first * 4;
+    attributes.texcoords = data.texcoords.empty() ? nullptr : data.texcoords.data() + first * 2;
+    attributes.quantization = data.quantization;
+
+    packVertices(data.vertexFormat, attributes, pack.vertexCount, pack.dst);
+}
+
+void ModelImport::cancel(ResourceManager& resourceManager) {
+    for(ImportBatch& batch : m_batches) {
+        if(batch.buffer.buffer != VK_NULL_HANDLE) resourceManager.destroyIntermediateBuffer(batch.buffer);
+        batch.buffer = AllocatedBuffer{};
+    }
+
+    destroyModel(resourceManager, m_model);
+}
+
+} // namespace vkmv
@@ -0,0 +1,180 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/renderer/PipelineCache.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace vkmv {
+
+/**
+ * Returns true if data starts with a version one header written by a driver for this exact device.
+ */
+static bool isCompatibleCacheData(const std::vector<char>& data, const VkPhysicalDeviceProperties& properties) {
+    VkPipelineCacheHeaderVersionOne header;
+    if(data.size() < sizeof(header)) return false;
+
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    return header.headerSize >= sizeof(header) &&
+           header.headerSize <= data.size() &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == properties.vendorID &&
+           header.deviceID == properties.deviceID &&
+           std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void PipelineCache::init(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& path) {
+    _physicalDevice = physicalDevice;
+    _device = device;
+    this->path = path;
+    mainThread = std::this_thread::get_id();
+
+    std::vector<char> data;
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(file) {
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        if(!file.read(data.data(), data.size())) data.clear();
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(_physicalDevice, &properties);
+
+    // A driver update or a different GPU invalidates the file; start empty and overwrite it at cleanup
+    if(!data.empty() && !isCompatibleCacheData(data, properties)) {
+        std::cerr << "Ignoring incompatible pipeline cache " << path << std::endl;
+        data.clear();
+    }
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if(vkCreatePipelineCache(_device, &createInfo, nullptr, &cache) != VK_SUCCESS) {
+        // Drivers may still reject data that passed the header check; retry without it
+        createInfo.initialDataSize = 0;
+        createInfo.pInitialData = nullptr;
+
+        if(vkCreatePipelineCache(_device, &createInfo, nullptr, &cache) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pipeline cache!");
+        }
+    }
+}
+
+void PipelineCache::cleanup() {
+    save();
+
+    for(auto& [thread, threadCache] : threadCaches) vkDestroyPipelineCache(_device, threadCache, nullptr);
+    threadCaches.clear();
+
+    vkDestroyPipelineCache(_device, cache, nullptr);
+    cache = VK_NULL_HANDLE;
+}
+
+VkPipelineCache PipelineCache::getThreadCache() {
+    std::lock_guard<std::mutex> lock(threadCachesMutex);
+
+    auto it = threadCaches.find(std::this_thread::get_id());
+    if(it != threadCaches.end()) return it->second;
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+    VkPipelineCache threadCache;
+    if(vkCreatePipelineCache(_device, &createInfo, nullptr, &threadCache) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline cache!");
+    }
+
+    threadCaches.emplace(std::this_thread::get_id(), threadCache);
+    return threadCache;
+}
+
+VkPipeline PipelineCache::createGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo) {
+    VkPipeline pipeline;
+    if(vkCreateGraphicsPipelines(_device, selectCache(), 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create graphics pipeline!");
+    }
+
+    return pipeline;
+}
+
+VkPipeline PipelineCache::createComputePipeline(const VkComputePipelineCreateInfo& createInfo) {
+    VkPipeline pipeline;
+    if(vkCreateComputePipelines(_device, selectCache(), 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute pipeline!");
+    }
+
+    return pipeline;
+}
+
+void PipelineCache::save() {
+    {
+        std::lock_guard<std::mutex> lock(threadCachesMutex);
+
+        std::vector<VkPipelineCache> sources;
+        for(auto& [thread, threadCache] : threadCaches) sources.push_back(threadCache);
+
+        if(!sources.empty()) vkMergePipelineCaches(_device, cache, static_cast<uint32_t>(sources.size()), sources.data());
+    }
+
+    size_t size = 0;
+    if(vkGetPipelineCacheData(_device, cache, &size, nullptr) != VK_SUCCESS || size == 0) return;
+
+    std::vector<char> data(size);
+    if(vkGetPipelineCacheData(_device, cache, &size, data.data()) != VK_SUCCESS) return;
+    data.resize(size);
+
+    // Write beside the old file and rename over it, so a crash mid-write never leaves a truncated cache
+    std::error_code ec;
+    std::filesystem::path target(path);
+    if(target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), ec);
+
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if(!file || !file.write(data.data(), data.size())) {
+            std::cerr << "Failed to write pipeline cache " << tempPath << std::endl;
+            return;
+        }
+    }
+
+    std::filesystem::rename(tempPath, target, ec);
+    if(ec) std::cerr << "Failed to save pipeline cache " << path << ": " << ec.message() << std::endl;
+}
+
+std::string PipelineCache::getDefaultPath() {
+#ifdef _WIN32
+    const char* base = std::getenv("LOCALAPPDATA");
+    if(base != nullptr) return std::string(base) + "\\vkmv\\pipeline_cache.bin";
+#else
+    const char* xdgCache = std::getenv("XDG_CACHE_HOME");
+    if(xdgCache != nullptr && xdgCache[0] != '\0') return std::string(xdgCache) + "/vkmv/pipeline_cache.bin";
+
+    const char* home = std::getenv("HOME");
+    if(home != nullptr) return std::string(home) + "/.cache/vkmv/pipeline_cache.bin";
+#endif
+
+    return "pipeline_cache.bin";
+}
+
+/**
+ * The main thread uses the main cache directly; other threads get their own cache to avoid contending on it.
+ */
+VkPipelineCache PipelineCache::selectCache() {
+    if(std::this_thread::get_id() == mainThread) return cache;
+    return getThreadCache();
+}
+
+} // namespace vkmv
@@ -6,23 +6,34 @@
 #include "vkmv/renderer/Renderer.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <limits>
 #include <queue>
 #include <set>
 #include <stdexcept>
+#include <thread>
 
 #include <imgui.h>
 #include <imgui_impl_sdl3.h>
 #include <imgui_impl_vulkan.h>
 #include <vk_mem_alloc.h>
 
+#include "vkmv/utils/CpuTrace.hpp"
 #include "vkmv/utils/VulkanHelpers.hpp"
 
 namespace vkmv {
 
-Renderer::Renderer(const Window& window)
-: window(window) {
+// Frames that can't be presented, e.g. while minimized, aren't paced by presentation and are throttled instead
+static constexpr std::chrono::milliseconds UNPRESENTED_FRAME_INTERVAL(16);
+
+Renderer::Renderer(const Window& window, JobSystem& jobSystem, uint32_t framesInFlight)
+: window(&window), jobSystem(&jobSystem), framesInFlight(framesInFlight) {
+    initRenderer();
+}
+
+Renderer::Renderer(VkExtent2D extent, JobSystem& jobSystem, uint32_t framesInFlight)
+: jobSystem(&jobSystem), framesInFlight(framesInFlight), width(extent.width), height(extent.height) {
     initRenderer();
 }
 
@@ -34,49 +45,103 @@ void Renderer::handleEvent(const SDL_Event& e){
 
 }
 
-void Renderer::recordMainCommands(RenderableState& r, VkCommandBuffer& buf, VkImage& swapchainImage) {
-    transitionImageLayout(buf, getCurrentFrame().renderTargetImage.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-
-    VkRenderingAttachmentInfo colorAttachmentInfo{};
-    colorAttachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-    colorAttachmentInfo.imageView = getCurrentFrame().renderTargetImage.imageView;
-    colorAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    colorAttachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachmentInfo.clearValue.color = VkClearColorValue{0, 0, 0, 0};
+/**
+ * At full scale the scene renders straight into the render target. Scaled down, it renders into the corner of a
+ * full size scene target, which is upscaled into the render target before the UI is drawn over it at full resolution.
+ */
+void Renderer::addMainPasses(RenderableState& r, FrameGraphResource renderTarget) {
+    VkExtent2D sceneExtent = dynamicResolution.getScaledExtent(VkExtent2D{width, height});
+    bool scaled = sceneExtent.width != width || sceneExtent.height != height;
+
+    FrameGraphResource sceneTarget = renderTarget;
+    if(scaled) {
+        sceneTarget = frameGraph.createImage("Scene Color", TransientImageDesc{VK_FORMAT_R16G16B16A16_SFLOAT, VkExtent3D{width, height, 1},
+                                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT});
+    }
 
-    VkRenderingInfo renderingInfo{};
-    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
-    renderingInfo.renderArea.offset = VkOffset2D{0 , 0};
-    renderingInfo.renderArea.extent = VkExtent2D{width, height};
-    renderingInfo.layerCount = 1;
-    renderingInfo.viewMask = 0;
-    renderingInfo.colorAttachmentCount = 1;
-    renderingInfo.pColorAttachments = &colorAttachmentInfo;
-    renderingInfo.pDepthAttachment = nullptr;
-    renderingInfo.pStencilAttachment = nullptr; 
+    FrameGraphResource depthTarget = frameGraph.createImage("Depth", TransientImageDesc{VK_FORMAT_D32_SFLOAT, VkExtent3D{width, height, 1},
+                                                            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT});
+    gpuScene.addPasses(frameGraph, getFrameSlot(), r.viewProjection, r.cameraPosition, r.instanceLods,
+                       r.transformUpdates, sceneTarget, depthTarget, sceneExtent);
 
-    vkCmdBeginRendering(buf, &renderingInfo);
+    if(scaled) {
+        frameGraph.addPass("Upscale", [this, sceneTarget, renderTarget, sceneExtent](VkCommandBuffer buf) {
+            blitImageToImage(buf, frameGraph.getImage(sceneTarget).image, frameGraph.getImage(renderTarget).image,
+                             VkExtent3D{sceneExtent.width, sceneExtent.height, 1}, VkExtent3D{width, height, 1});
+        }).read(sceneTarget, ResourceUsage::TransferSrc).write(renderTarget, ResourceUsage::TransferDst);
+    }
 
-        ImGui::Render();
-        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), buf);
+    ImDrawData* uiDrawData = r.ui.getDrawData();
+    if(uiDrawData == nullptr) return;
+
+    frameGraph.addPass("UI", [this, renderTarget, uiDrawData](VkCommandBuffer buf) {
+        VkRenderingAttachmentInfo colorAttachmentInfo{};
+        colorAttachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+        colorAttachmentInfo.imageView = frameGraph.getImage(renderTarget).imageView;
+        colorAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+        colorAttachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+
+        VkRenderingInfo renderingInfo{};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+        renderingInfo.renderArea.offset = VkOffset2D{0 , 0};
+        renderingInfo.renderArea.extent = VkExtent2D{width, height};
+        renderingInfo.layerCount = 1;
+        renderingInfo.viewMask = 0;
+        renderingInfo.colorAttachmentCount = 1;
+        renderingInfo.pColorAttachments = &colorAttachmentInfo;
+        renderingInfo.pDepthAttachment = nullptr;
+        renderingInfo.pStencilAttachment = nullptr; 
+
+        vkCmdBeginRendering(buf, &renderingInfo);
+
+            ImGui_ImplVulkan_RenderDrawData(uiDrawData, buf);
+
+        vkCmdEndRendering(buf);
+    }).write(renderTarget, ResourceUsage::ColorAttachment);
+}
 
-    vkCmdEndRendering(buf);
+void Renderer::addPresentPasses(FrameGraphResource renderTarget, VkImage swapchainImage) {
+    VkExtent2D swapchainExtent = swapchain.getExtent();
 
-    transitionImageLayout(buf, getCurrentFrame().renderTargetImage.image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-    transitionImageLayout(buf, swapchainImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    // The acquire semaphore is waited on at the transfer stage, so the swapchain image's first barrier chains from it
+    FrameGraphResource swapchainTarget = frameGraph.importImage("Swapchain", swapchainImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
 
-    blitImageToImage(buf, getCurrentFrame().renderTargetImage.image, swapchainImage, VkExtent3D{width, height, 1}, VkExtent3D{width, height, 1});
+    frameGraph.addPass("Present Blit", [this, renderTarget, swapchainImage, swapchainExtent](VkCommandBuffer buf) {
+        blitImageToImage(buf, frameGraph.getImage(renderTarget).image, swapchainImage, VkExtent3D{width, height, 1},
+                         VkExtent3D{swapchainExtent.width, swapchainExtent.height, 1});
+    }).read(renderTarget, ResourceUsage::TransferSrc).write(swapchainTarget, ResourceUsage::TransferDst);
 
-    transitionImageLayout(buf, swapchainImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    frameGraph.exportResource(swapchainTarget, ResourceUsage::Present);
 }
 
 void Renderer::drawFrame(RenderableState& r) {
-    vkWaitForFences(device.getDevice(), 1, &getCurrentFrame().renderFence, VK_TRUE, 1'000'000'000);
-    vkResetFences(device.getDevice(), 1, &getCurrentFrame().renderFence);
+    VKMV_TRACE_SCOPE("Draw Frame");
 
-    uint32_t swapchainImageIndex;
-    vkAcquireNextImageKHR(device.getDevice(), swapchain, 1'000'000'000, getCurrentFrame().swapchainSemaphore, nullptr, &swapchainImageIndex);
+    shaderLibrary.processReloads();
+
+    // Queuing more frames than are in flight would only wait on the frame timeline instead
+    framePacer.setMaxQueuedFrames(std::clamp<uint32_t>(r.maxQueuedFrames, 1, framesInFlight));
+
+    // The swapchain is recreated with the new present mode when this frame acquires
+    if(!isHeadless() && r.presentMode != requestedPresentMode) {
+        requestedPresentMode = r.presentMode;
+        swapchainOutOfDate = true;
+    }
+
+    // Everything keyed to this slot is free once the GPU reaches the slot's last submission
+    frameTimeline.wait(getCurrentFrame().timelineValue);
+    frameTimeline.collect();
+    commandRecorder.beginFrame(getFrameSlot());
+
+    resourceManager.retireUploads();
+    processImports(IMPORT_UPLOAD_BUDGET);
+    resourceManager.submitUploads();
+
+    // Headless frames have no swapchain image to acquire, present or synchronize against, and windowed frames may
+    // find none to acquire; either way the frame is still rendered. Acquiring first lets a resize take effect on it.
+    uint32_t swapchainImageIndex = 0;
+    bool present = !isHeadless() && acquireSwapchainImage(swapchainImageIndex);
 
     VkCommandBuffer buf = getCurrentFrame().mainCommandBuffer;
     vkResetCommandBuffer(buf, 0);
@@ -84,28 +149,78 @@ void Renderer::drawFrame(RenderableState& r) {
     VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, nullptr, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, nullptr};
     vkBeginCommandBuffer(buf, &beginInfo);
 
-        recordMainCommands(r, buf, swapchainImages[swapchainImageIndex]);
+        // The slot's previous frame is known to be finished, so its GPU time is ready to drive this frame's scale
+        bool measured = gpuProfiler.beginFrame(buf, getFrameSlot());
+        dynamicResolution.update(r.dynamicResolution, measured ? gpuProfiler.getFrameMilliseconds() : 0.0f, r.gpuBudgetMilliseconds);
+
+        gpuProfiler.beginScope(buf, "Upload Acquires");
+        uint64_t uploadWaitValue = resourceManager.recordUploadAcquires(buf);
+        gpuProfiler.endScope(buf);
+
+        frameGraph.reset(getFrameSlot());
+        FrameGraphResource renderTarget = frameGraph.createImage("Render Target", TransientImageDesc{VK_FORMAT_R16G16B16A16_SFLOAT, VkExtent3D{width, height, 1},
+                                                                 VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                                                                 VK_IMAGE_USAGE_TRANSFER_DST_BIT});
+        addMainPasses(r, renderTarget);
+
+        // Frames that aren't presented are left in the render target, for readback when headless
+        if(!present) frameGraph.exportResource(renderTarget, ResourceUsage::TransferSrc);
+        else addPresentPasses(renderTarget, swapchain.getImage(swapchainImageIndex));
+
+        gpuProfiler.beginScope(buf, "Frame Graph");
+        frameGraph.execute(buf);
+        gpuProfiler.endScope(buf);
+
+        gpuProfiler.endFrame(buf);
 
     vkEndCommandBuffer(buf);
 
     VkSubmitInfo2 submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
 
-    VkSemaphoreSubmitInfo waitSemaphoreInfo{};
-    waitSemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
-    waitSemaphoreInfo.semaphore = getCurrentFrame().swapchainSemaphore;
-    waitSemaphoreInfo.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    VkSemaphoreSubmitInfo waitSemaphoreInfos[2]{};
+    uint32_t waitSemaphoreCount = 0;
 
-    submitInfo.waitSemaphoreInfoCount = 1;
-    submitInfo.pWaitSemaphoreInfos = &waitSemaphoreInfo;
+    if(present) {
+        VkSemaphoreSubmitInfo& waitSemaphoreInfo = waitSemaphoreInfos[waitSemaphoreCount++];
+        waitSemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        waitSemaphoreInfo.semaphore = getCurrentFrame().swapchainSemaphore;
+        waitSemaphoreInfo.stageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+    }
+
+    // Geometry acquired this frame must wait for its copies on the transfer queue
+    if(uploadWaitValue != 0) {
+        VkSemaphoreSubmitInfo& uploadWaitInfo = waitSemaphoreInfos[waitSemaphoreCount++];
+        uploadWaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        uploadWaitInfo.semaphore = resourceManager.getUploadSemaphore();
+        uploadWaitInfo.value = uploadWaitValue;
+        uploadWaitInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    }
 
-    VkSemaphoreSubmitInfo signalSemaphoreInfo{};
-    signalSemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
-    signalSemaphoreInfo.semaphore = swapchainImageResources[swapchainImageIndex].renderSemaphore;
-    signalSemaphoreInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT;
+    submitInfo.waitSemaphoreInfoCount = waitSemaphoreCount;
+    submitInfo.pWaitSemaphoreInfos = waitSemaphoreInfos;
 
-    submitInfo.signalSemaphoreInfoCount = 1;
-    submitInfo.pSignalSemaphoreInfos = &signalSemaphoreInfo;
+    VkSemaphoreSubmitInfo signalSemaphoreInfos[2]{};
+    uint32_t signalSemaphoreCount = 0;
+
+    getCurrentFrame().timelineValue = frameTimeline.advance();
+
+    VkSemaphoreSubmitInfo& timelineSignalInfo = signalSemaphoreInfos[signalSemaphoreCount++];
+    timelineSignalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    timelineSignalInfo.semaphore = frameTimeline.getSemaphore();
+    timelineSignalInfo.value = getCurrentFrame().timelineValue;
+    timelineSignalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    // Presentation only waits on binary semaphores
+    if(present) {
+        VkSemaphoreSubmitInfo& renderSignalInfo = signalSemaphoreInfos[signalSemaphoreCount++];
+        renderSignalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        renderSignalInfo.semaphore = swapchain.getRenderSemaphore(swapchainImageIndex);
+        renderSignalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT;
+    }
+
+    submitInfo.signalSemaphoreInfoCount = signalSemaphoreCount;
+    submitInfo.pSignalSemaphoreInfos = signalSemaphoreInfos;
 
     VkCommandBufferSubmitInfo bufSubmitInfo{};
     bufSubmitInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
@@ -114,168 +229,224 @@ void Renderer::drawFrame(RenderableState& r) {
     submitInfo.commandBufferInfoCount = 1;
     submitInfo.pCommandBufferInfos = &bufSubmitInfo;
 
-    vkQueueSubmit2(device.getGraphicsQueue(), 1, &submitInfo, getCurrentFrame().renderFence);
+    {
+        VKMV_TRACE_SCOPE("Queue Submit");
+        vkQueueSubmit2(device.getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+    }
+    gpuProfiler.frameSubmitted();
 
-    VkPresentInfoKHR presentInfo{};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.pSwapchains = &swapchain;
-    presentInfo.swapchainCount = 1;
-    presentInfo.pImageIndices = &swapchainImageIndex;
+    uint64_t timelineValue = getCurrentFrame().timelineValue;
+    frameCount++;
 
-    presentInfo.pWaitSemaphores = &swapchainImageResources[swapchainImageIndex].renderSemaphore;
-    presentInfo.waitSemaphoreCount = 1;
+    if(!present) {
+        framePacer.frameSubmitted(timelineValue, nullptr, 0, r.inputTime);
+        if(!isHeadless()) std::this_thread::sleep_for(UNPRESENTED_FRAME_INTERVAL);
+        return;
+    }
 
-    vkQueuePresentKHR(device.getGraphicsQueue(), &presentInfo);
+    // Timeline values only grow, so they double as present ids
+    uint64_t presentId = framePacer.canWaitForPresent() ? timelineValue : 0;
 
-    frameCount++;
+    // A suboptimal swapchain still presented this frame; it is replaced before the next one
+    VkResult presentResult = swapchain.present(device.getGraphicsQueue(), swapchainImageIndex, presentId);
+    if(presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR) {
+        swapchainOutOfDate = true;
+    } else if(presentResult != VK_SUCCESS) {
+        throw std::runtime_error("Failed to present swapchain image!");
+    }
+
+    // An out of date present is never displayed, so only the GPU finishing the frame can be waited for
+    bool followPresent = presentId != 0 && presentResult != VK_ERROR_OUT_OF_DATE_KHR;
+    framePacer.frameSubmitted(timelineValue, followPresent ? &swapchain : nullptr,
+                              followPresent ? presentId : 0, r.inputTime);
+}
+
+void Renderer::importModel(const std::string& path, JobSystem& jobSystem) {
+    std::unique_ptr<ModelImport> import = std::make_unique<ModelImport>(jobSystem, path, IMPORT_BATCH_BUDGET);
+
+    std::lock_guard<std::mutex> lock(sceneMutex);
+    imports.push_back(std::move(import));
+}
+
+void Renderer::waitForImports() {
+    while(!imports.empty()) {
+        ModelImport& import = *imports.front();
+        import.wait();
+
+        if(import.getStage() == ModelImport::Stage::Failed) {
+            std::string message = "Failed to import " + import.getPath() + ": " + import.getError();
+            import.cancel(resourceManager);
+            {
+                std::lock_guard<std::mutex> lock(sceneMutex);
+                imports.pop_front();
+            }
+            throw std::runtime_error(message);
+        }
+
+        processImports(std::numeric_limits<VkDeviceSize>::max());
+        resourceManager.flushUploads();
+    }
+}
+
+/**
+ * Imports finish in submission order; only the front import uploads so the per frame budget is respected.
+ */
+void Renderer::processImports(VkDeviceSize byteBudget) {
+    VKMV_TRACE_SCOPE("Process Imports");
+
+    while(true) {
+        // Imports may be queued from another thread; the front one stays put until this thread pops it
+        std::unique_lock<std::mutex> queueLock(sceneMutex);
+        if(imports.empty()) return;
+        ModelImport& import = *imports.front();
+        queueLock.unlock();
+
+        ModelImport::Stage stage = import.getStage();
+        if(stage == ModelImport::Stage::Failed) {
+            std::cerr << "Failed to import " << import.getPath() << ": " << import.getError() << std::endl;
+            import.cancel(resourceManager);
+            std::lock_guard<std::mutex> lock(sceneMutex);
+            imports.pop_front();
+            continue;
+        }
+        if(stage != ModelImport::Stage::Ready) return;
+
+        if(!import.upload(resourceManager, byteBudget)) return;
+
+        const VertexCacheStatistics& source = import.getSourceCacheStatistics();
+        const VertexCacheStatistics& optimized = import.getOptimizedCacheStatistics();
+        if(source.triangleCount > 0) {
+            std::cout << "Imported " << import.getPath() << ": vertex cache ACMR " << source.acmr() << " -> " << optimized.acmr()
+                      << ", ATVR " << source.atvr() << " -> " << optimized.atvr() << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(sceneMutex);
+        models.push_back(import.takeModel());
+        gpuScene.addModel(models.back());
+        imports.pop_front();
+    }
 }
 
 void Renderer::initRenderer() {
-    Instance::create(&instance);
-    createSurface();
+    if(framesInFlight == 0 || framesInFlight > MAX_FRAMES_IN_FLIGHT) throw std::runtime_error("Unsupported number of frames in flight!");
+
+    InstanceParams instanceParams{!isHeadless()};
+    Instance::create(&instance, &instanceParams);
+    if(!isHeadless()) createSurface();
     DeviceParams deviceParams{surface};
     Device::create(&instance, &deviceParams, &device);
-    refreshWindowDims();
-    createSwapchain();
+    frameTimeline.init(device.getDevice());
+
+    PFN_vkWaitForPresentKHR waitForPresent = nullptr;
+    if(device.isExtensionEnabled(VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+        waitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(device.getDevice(), "vkWaitForPresentKHR"));
+    }
+    framePacer.init(device.getDevice(), frameTimeline.getSemaphore(), waitForPresent);
+
+    pipelineCache.init(device.getPhysicalDevice(), device.getDevice(), PipelineCache::getDefaultPath());
+    shaderLibrary.init(&device, &pipelineCache, &frameTimeline, SHADER_DIRECTORY);
+    if(isHeadless()) setRenderExtent(VkExtent2D{width, height});
+    else createSwapchain();
     createCommandPools();
     createSyncObjects();
-    resourceManager.init(instance.getInstance(), device.getPhysicalDevice(), device.getDevice());
-    createRenderTargets();
+    resourceManager.init(instance.getInstance(), device.getPhysicalDevice(), device.getDevice(), device.getGraphicsFamilyIndex(),
+                         device.getTransferFamilyIndex(), device.getTransferQueue());
+    gpuProfiler.init(device.getPhysicalDevice(), device.getDevice(), device.getGraphicsFamilyIndex(), framesInFlight,
+                     device.hasPipelineStatistics());
+    frameGraph.init(&resourceManager, &gpuProfiler);
+    commandRecorder.init(device.getDevice(), device.getGraphicsFamilyIndex(), jobSystem, framesInFlight);
+    commandRecorder.setInheritedStatistics(gpuProfiler.getStatisticFlags());
+    gpuScene.init(&device, &resourceManager, &shaderLibrary, &commandRecorder, framesInFlight);
     initImGUI();
 }
 
 void Renderer::cleanup() {
     vkDeviceWaitIdle(device.getDevice());
+    framePacer.cleanup();
+    frameTimeline.cleanup();
     cleanupImGUI();
-    destroyRenderTargets();
+    gpuScene.cleanup();
+    shaderLibrary.cleanup();
+    pipelineCache.cleanup();
+    frameGraph.cleanup();
+    for(std::unique_ptr<ModelImport>& import : imports) {
+        // Partially uploaded geometry still belongs to the import
+        import->wait();
+        import->cancel(resourceManager);
+    }
+    imports.clear();
+    for(Model& model : models) destroyModel(resourceManager, model);
     resourceManager.cleanup();
-    for(int i = 0; i < swapchainImageResources.size(); i++) vkDestroySemaphore(device.getDevice(), swapchainImageResources[i].renderSemaphore, nullptr);
-    for(int i = 0; i < NUM_FRAMES_IN_FLIGHT; i++) {
-        vkDestroyCommandPool(device.getDevice(), frames[i].commandPool, nullptr);
-
-        vkDestroyFence(device.getDevice(), frames[i].renderFence, nullptr);
-        vkDestroySemaphore(device.getDevice(), frames[i].swapchainSemaphore, nullptr);
+    commandRecorder.cleanup();
+    gpuProfiler.cleanup();
+    for(FrameData& frame : frames) {
+        vkDestroyCommandPool(device.getDevice(), frame.commandPool, nullptr);
+        vkDestroySemaphore(device.getDevice(), frame.swapchainSemaphore, nullptr);
     }
-    for(int i = 0; i < swapchainImageViews.size(); i++) vkDestroyImageView(device.getDevice(), swapchainImageViews[i], nullptr);
-    vkDestroySwapchainKHR(device.getDevice(), swapchain, nullptr);
+    if(!isHeadless()) Swapchain::destroy(&swapchain);
     Device::destroy(&device);
-    SDL_Vulkan_DestroySurface(instance.getInstance(), surface, nullptr);
+    if(!isHeadless()) SDL_Vulkan_DestroySurface(instance.getInstance(), surface, nullptr);
     Instance::destroy(&instance);
 }
 
 void Renderer::createSurface() {
-    SDL_Vulkan_CreateSurface(window.getWindow(), instance.getInstance(), nullptr, &surface);
+    SDL_Vulkan_CreateSurface(window->getWindow(), instance.getInstance(), nullptr, &surface);
 }
 
 void Renderer::createSwapchain() {
-    // Select a Format
-    uint32_t formatCount;
-    vkGetPhysicalDeviceSurfaceFormatsKHR(device.getPhysicalDevice(), surface, &formatCount, nullptr);
-    std::vector<VkSurfaceFormatKHR> formats(formatCount);
-    vkGetPhysicalDeviceSurfaceFormatsKHR(device.getPhysicalDevice(), surface, &formatCount, formats.data());
-
-    swapchainImageFormat = formats[0];
-    for(const auto& format : formats) {
-        if(format.format == VK_FORMAT_B8G8R8A8_SRGB && format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
-            swapchainImageFormat = format;
-            break;
-        }
-    }
+    requestedSwapchainExtent = window->getPixelExtent();
 
-    // Select a Present Mode
-    uint32_t presentModeCount;
-    vkGetPhysicalDeviceSurfacePresentModesKHR(device.getPhysicalDevice(), surface, &presentModeCount, nullptr);
-    std::vector<VkPresentModeKHR> presentModes(presentModeCount);
-    vkGetPhysicalDeviceSurfacePresentModesKHR(device.getPhysicalDevice(), surface, &presentModeCount, presentModes.data());
-
-    VkPresentModeKHR swapchainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
-    for(const auto& presentMode : presentModes) {
-        if(presentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-            swapchainPresentMode = presentMode;
-            break;
-        }
-    }
+    SwapchainParams swapchainParams{surface, requestedSwapchainExtent, requestedPresentMode};
+    Swapchain::create(&device, &swapchainParams, &swapchain);
+    setRenderExtent(swapchain.getExtent());
+}
 
-    // Query for surface capabilities
-    VkSurfaceCapabilitiesKHR surfaceCaps;
-    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device.getPhysicalDevice(), surface, &surfaceCaps);
+/**
+ * Only the swapchain and the render extent change. Transient frame graph images follow the extent on their own,
+ * slot by slot, and the old swapchain is retired on the frame timeline rather than waited for.
+ */
+void Renderer::recreateSwapchain(VkExtent2D extent) {
+    Swapchain::Retired retired = swapchain.recreate(extent, requestedPresentMode);
+
+    // Earlier frames may still be presenting from it, and the frame pacer waiting for those presents; the frame
+    // being recorded is the first that doesn't
+    VkDevice vkDevice = device.getDevice();
+    FramePacer* pacer = &framePacer;
+    frameTimeline.retire([vkDevice, pacer, retired]() mutable {
+        pacer->releaseSwapchain(retired.swapchain);
+        Swapchain::destroyRetired(vkDevice, retired);
+    });
+
+    requestedSwapchainExtent = extent;
+    swapchainOutOfDate = false;
+    setRenderExtent(swapchain.getExtent());
+}
 
-    uint32_t imageCount = surfaceCaps.minImageCount + 1;
-    if(surfaceCaps.maxImageCount > 0 && imageCount > surfaceCaps.maxImageCount) {
-        imageCount = surfaceCaps.maxImageCount;
-    }
+/**
+ * Recreates the swapchain first if the window was resized or presentation found it out of date. Returns false,
+ * acquiring nothing, while the window has no area or changes again before an image can be acquired.
+ */
+bool Renderer::acquireSwapchainImage(uint32_t& imageIndex) {
+    VKMV_TRACE_SCOPE("Acquire Swapchain Image");
 
-    // Select an extent 
-    if(surfaceCaps.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
-        swapchainExtent = surfaceCaps.currentExtent;
-    } else {
-        swapchainExtent = {std::clamp(static_cast<uint32_t>(width), surfaceCaps.minImageExtent.width, surfaceCaps.maxImageExtent.width),
-                           std::clamp(static_cast<uint32_t>(height), surfaceCaps.minImageExtent.height, surfaceCaps.maxImageExtent.height)};
-    }
+    VkExtent2D windowExtent = window->getPixelExtent();
+    if(windowExtent.width == 0 || windowExtent.height == 0) return false;
 
-    VkSwapchainCreateInfoKHR createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-    createInfo.surface = surface;
-    createInfo.minImageCount = imageCount;
-    createInfo.imageFormat = swapchainImageFormat.format;
-    createInfo.imageColorSpace = swapchainImageFormat.colorSpace;
-    createInfo.imageExtent = swapchainExtent;
-    createInfo.imageArrayLayers = 1;
-    createInfo.imageUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-
-    uint32_t queueFamilyIndices[] = {device.getGraphicsFamilyIndex(), device.getPresentFamilyIndex()};
-
-    if(device.getGraphicsFamilyIndex() != device.getPresentFamilyIndex()){
-        createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
-        createInfo.queueFamilyIndexCount = 2;
-        createInfo.pQueueFamilyIndices = queueFamilyIndices;
-    } else {
-        createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if(swapchainOutOfDate || windowExtent.width != requestedSwapchainExtent.width || windowExtent.height != requestedSwapchainExtent.height) {
+        recreateSwapchain(windowExtent);
     }
 
-    createInfo.preTransform = surfaceCaps.currentTransform;
-    createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    createInfo.presentMode = swapchainPresentMode;
-    createInfo.clipped = VK_TRUE;
-
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
-
-    if(vkCreateSwapchainKHR(device.getDevice(), &createInfo, nullptr, &swapchain) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create swapchain!");
+    VkResult result = swapchain.acquireNextImage(getCurrentFrame().swapchainSemaphore, &imageIndex);
+    if(result == VK_ERROR_OUT_OF_DATE_KHR) {
+        // Nothing was signaled, so the semaphore stays usable; the next frame recreates at the newest size
+        swapchainOutOfDate = true;
+        return false;
     }
 
-    vkGetSwapchainImagesKHR(device.getDevice(), swapchain, &imageCount, nullptr);
-    swapchainImages.resize(imageCount);
-    vkGetSwapchainImagesKHR(device.getDevice(), swapchain, &imageCount, swapchainImages.data());
-
-    swapchainImageViews.resize(imageCount);
-    for(size_t i = 0; i < swapchainImageViews.size(); i++) {
-        VkImageViewCreateInfo viewCreateInfo{};
-        viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        viewCreateInfo.image = swapchainImages[i];
-        viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        viewCreateInfo.format = swapchainImageFormat.format;
-
-        viewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
-        viewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
-        viewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
-        viewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
-
-        viewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        viewCreateInfo.subresourceRange.baseMipLevel = 0;
-        viewCreateInfo.subresourceRange.levelCount = 1;
-        viewCreateInfo.subresourceRange.baseArrayLayer = 0;
-        viewCreateInfo.subresourceRange.layerCount = 1;
-
-        if(vkCreateImageView(device.getDevice(), &viewCreateInfo, nullptr, &swapchainImageViews[i]) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create swapchain image view!");
-        }
-    }
-}
+    if(result == VK_SUBOPTIMAL_KHR) swapchainOutOfDate = true;
+    else if(result != VK_SUCCESS) throw std::runtime_error("Failed to acquire swapchain image!");
 
-void Renderer::destroySwapchain() {
-    for(int i = 0; i < swapchainImageViews.size(); i++) vkDestroyImageView(device.getDevice(), swapchainImageViews[i], nullptr);
-    vkDestroySwapchainKHR(device.getDevice(), swapchain, nullptr);
+    return true;
 }
 
 void Renderer::createCommandPools() {
@@ -284,7 +455,8 @@ void Renderer::createCommandPools() {
     createInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
     createInfo.queueFamilyIndex = device.getGraphicsFamilyIndex();
 
-    for(int i=0; i<NUM_FRAMES_IN_FLIGHT; i++) {
+    frames.resize(framesInFlight);
+    for(int i=0; i<framesInFlight; i++) {
         if(vkCreateCommandPool(device.getDevice(), &createInfo, nullptr, &frames[i].commandPool) != VK_SUCCESS){
             throw std::runtime_error("Failed to create command pool!");
         }
@@ -302,62 +474,29 @@ void Renderer::createCommandPools() {
 }
 
 void Renderer::createSyncObjects() {
-    VkFenceCreateInfo fenceInfo{};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
     
-    for(int i = 0; i < NUM_FRAMES_IN_FLIGHT; i++) {
-        if(vkCreateFence(device.getDevice(), &fenceInfo, nullptr, &frames[i].renderFence) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create fence!");
-        }
-
+    for(int i = 0; i < framesInFlight; i++) {
         if(vkCreateSemaphore(device.getDevice(), &semaphoreInfo, nullptr, &frames[i].swapchainSemaphore) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create semaphore!");
         }
     }
-
-    swapchainImageResources.resize(swapchainImages.size());
-    for(int i=0; i < swapchainImages.size(); i++) {
-        if(vkCreateSemaphore(device.getDevice(), &semaphoreInfo, nullptr, &swapchainImageResources[i].renderSemaphore) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create semaphore!");
-        }
-    }
-}
-
-/**
- * @todo Move window size logic into the window class
-*/ 
-void Renderer::createRenderTargets() {
-    int w, h;
-    SDL_GetWindowSizeInPixels(window.getWindow(), &w, &h);
-
-    unsigned int width = static_cast<unsigned int>(w);
-    unsigned int height = static_cast<unsigned int>(h);
-
-    for(int i = 0; i < NUM_FRAMES_IN_FLIGHT; i++) {
-        frames[i].renderTargetImage = resourceManager.allocateImage(VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VkExtent3D{width, height, 1}, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    }
-}
-
-void Renderer::destroyRenderTargets() {
-    for(int i= 0; i < NUM_FRAMES_IN_FLIGHT; i++) {
-        resourceManager.destroyAllocatedImage(frames[i].renderTargetImage);
-    }
 }
 
 Renderer::FrameData& Renderer::getCurrentFrame() {
-    return frames[frameCount % NUM_FRAMES_IN_FLIGHT];
+    return frames[getFrameSlot()];
 }
 
-void Renderer::refreshWindowDims() {
-    int w, h;
-    SDL_GetWindowSizeInPixels(window.getWindow(), &w, &h);
+VkExtent2D Renderer::getRenderExtent() const {
+    uint64_t extent = renderExtent.load(std::memory_order_relaxed);
+    return VkExtent2D{static_cast<uint32_t>(extent >> 32), static_cast<uint32_t>(extent)};
+}
 
-    width = w;
-    height = h;
+void Renderer::setRenderExtent(VkExtent2D extent) {
+    width = extent.width;
+    height = extent.height;
+    renderExtent.store((static_cast<uint64_t>(width) << 32) | height, std::memory_order_relaxed);
 }
 
 void Renderer::initImGUI() {
@@ -379,7 +518,8 @@ void Renderer::initImGUI() {
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
 
     // Setup Platform/Renderer backends
-    ImGui_ImplSDL3_InitForVulkan(window.getWindow());
+    // Without a window there is no platform backend; the Engine feeds display size and timing itself
+    if(!isHeadless()) ImGui_ImplSDL3_InitForVulkan(window->getWindow());
     ImGui_ImplVulkan_InitInfo init_info = {};
     init_info.ApiVersion = VK_VERSION_1_3;
     init_info.Instance = instance.getInstance();
@@ -390,11 +530,13 @@ void Renderer::initImGUI() {
     init_info.DescriptorPool = VK_NULL_HANDLE;
     init_info.RenderPass = VK_NULL_HANDLE;
 
-    init_info.MinImageCount = swapchainImages.size();
-    init_info.ImageCount = swapchainImages.size();
+    // ImGui cycles its vertex buffers over ImageCount, so it needs one per frame that can be in flight
+    uint32_t imageCount = std::max<uint32_t>(framesInFlight, isHeadless() ? 2 : swapchain.getImageCount());
+    init_info.MinImageCount = imageCount;
+    init_info.ImageCount = imageCount;
     init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
 
-    init_info.PipelineCache = VK_NULL_HANDLE;
+    init_info.PipelineCache = pipelineCache.getCache();
     init_info.Subpass = 0;
 
     init_info.DescriptorPoolSize = IMGUI_IMPL_VULKAN_MINIMUM_IMAGE_SAMPLER_POOL_SIZE;
@@ -407,11 +549,14 @@ void Renderer::initImGUI() {
     init_info.MinAllocationSize = 1024*1024;
 
     ImGui_ImplVulkan_Init(&init_info);
+
+    // Otherwise the first ImGui_ImplVulkan_NewFrame() uploads it, on the queue the render thread may be submitting to
+    ImGui_ImplVulkan_CreateFontsTexture();
 }
 
 void Renderer::cleanupImGUI() {
     ImGui_ImplVulkan_Shutdown();
-    ImGui_ImplSDL3_Shutdown();
+    if(!isHeadless()) ImGui_ImplSDL3_Shutdown();
     ImGui::DestroyContext();
 }
 
@@ -5,24 +5,67 @@
 
 #include "vkmv/renderer/ResourceManager.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
+#include <tuple>
 
 namespace vkmv {
+
+// Size of the staging ring; uploads larger than the free space are accepted in parts over several frames
+constexpr VkDeviceSize STAGING_BUFFER_SIZE = 64ull * 1024 * 1024;
+
+// Alignment of every staging allocation, a multiple of any texel block size and of the 4 byte copy offset rule
+constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
     
-void ResourceManager::init(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device) {
+void ResourceManager::init(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, uint32_t graphicsFamilyIndex,
+                           uint32_t transferFamilyIndex, VkQueue transferQueue) {
     _instance = instance;
     _physicalDevice = physicalDevice;
     _device = device;
+    _graphicsFamilyIndex = graphicsFamilyIndex;
+    _transferFamilyIndex = transferFamilyIndex;
+    _transferQueue = transferQueue;
 
     VmaAllocatorCreateInfo allocatorInfo{};
     allocatorInfo.physicalDevice = _physicalDevice;
     allocatorInfo.device = _device;
     allocatorInfo.instance = _instance;
+    allocatorInfo.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
 
     vmaCreateAllocator(&allocatorInfo, &allocator);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = _transferFamilyIndex;
+
+    if(vkCreateCommandPool(_device, &poolInfo, nullptr, &uploadCommandPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create upload command pool!");
+    }
+
+    VkSemaphoreTypeCreateInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &timelineInfo;
+
+    if(vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &uploadSemaphore) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create upload timeline semaphore!");
+    }
+
+    stagingBuffer = allocateBuffer(STAGING_BUFFER_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                   VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT);
 }
 
 void ResourceManager::cleanup() {
+    for(const RetiringBuffer& retiring : retiringBuffers) destroyAllocatedBuffer(retiring.buffer);
+    destroyAllocatedBuffer(stagingBuffer);
+    vkDestroySemaphore(_device, uploadSemaphore, nullptr);
+    vkDestroyCommandPool(_device, uploadCommandPool, nullptr);
     vmaDestroyAllocator(allocator);
 }
 
@@ -47,6 +90,8 @@ VkImageAspectFlags getGenericAspectMask(VkFormat format) {
 
 AllocatedImage ResourceManager::allocateImage(VkFormat format, VkImageUsageFlags usageFlags, VkExtent3D extent, VkMemoryPropertyFlagBits properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
     AllocatedImage allocatedImage;
+    allocatedImage.imageExtent = extent;
+    allocatedImage.imageFormat = format;
 
     VkImageCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -95,4 +140,541 @@ void ResourceManager::destroyAllocatedImage(AllocatedImage allocatedImage) {
     vmaDestroyImage(allocator, allocatedImage.image, allocatedImage.allocation);
 }
 
-} // namespace vkmv
\ No newline at end of file
+/**
+ * Places the largest images first, each at the lowest offset that doesn't collide with an already placed image
+ * whose use interval overlaps its own. Images with different memory type requirements go in separate allocations.
+ */
+AliasedImageGroup ResourceManager::allocateAliasedImages(const std::vector<AliasedImageDesc>& descs) {
+    AliasedImageGroup group;
+    group.images.resize(descs.size());
+
+    std::vector<VkMemoryRequirements> requirements(descs.size());
+    for(size_t i = 0; i < descs.size(); i++) {
+        const AliasedImageDesc& desc = descs[i];
+        AllocatedImage& image = group.images[i].image;
+        image.imageExtent = desc.extent;
+        image.imageFormat = desc.format;
+        image.imageView = VK_NULL_HANDLE;
+
+        VkImageCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        createInfo.imageType = VK_IMAGE_TYPE_2D;
+        createInfo.format = desc.format;
+        createInfo.extent = desc.extent;
+        createInfo.mipLevels = 1;
+        createInfo.arrayLayers = 1;
+        createInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        createInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        createInfo.usage = desc.usageFlags;
+
+        if(vkCreateImage(_device, &createInfo, nullptr, &image.image) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create VkImage!");
+        }
+
+        vkGetImageMemoryRequirements(_device, image.image, &requirements[i]);
+        group.unaliasedSize += requirements[i].size;
+    }
+
+    std::vector<size_t> order(descs.size());
+    for(size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return requirements[a].size > requirements[b].size; });
+
+    std::vector<uint32_t> allocationTypeBits;
+    std::vector<VkDeviceSize> allocationSizes;
+    std::vector<VkDeviceSize> allocationAlignments;
+    std::vector<size_t> placed;
+
+    for(size_t i : order) {
+        const VkMemoryRequirements& req = requirements[i];
+        AliasedImage& aliased = group.images[i];
+        aliased.size = req.size;
+
+        auto typeIt = std::find(allocationTypeBits.begin(), allocationTypeBits.end(), req.memoryTypeBits);
+        aliased.allocationIndex = static_cast<uint32_t>(typeIt - allocationTypeBits.begin());
+        if(typeIt == allocationTypeBits.end()) {
+            allocationTypeBits.push_back(req.memoryTypeBits);
+            allocationSizes.push_back(0);
+            allocationAlignments.push_back(1);
+        }
+
+        auto livesOverlap = [&](size_t other) {
+            return group.images[other].allocationIndex == aliased.allocationIndex &&
+                   descs[other].firstUse <= descs[i].lastUse && descs[i].firstUse <= descs[other].lastUse;
+        };
+
+        // Candidate offsets are 0 and the end of every conflicting image; the lowest that fits wins
+        std::vector<VkDeviceSize> candidates{0};
+        for(size_t other : placed) {
+            if(livesOverlap(other)) candidates.push_back(group.images[other].offset + group.images[other].size);
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        for(VkDeviceSize candidate : candidates) {
+            VkDeviceSize offset = (candidate + req.alignment - 1) / req.alignment * req.alignment;
+
+            bool fits = std::none_of(placed.begin(), placed.end(), [&](size_t other) {
+                const AliasedImage& o = group.images[other];
+                return livesOverlap(other) && offset < o.offset + o.size && o.offset < offset + req.size;
+            });
+
+            if(fits) {
+                aliased.offset = offset;
+                break;
+            }
+        }
+
+        allocationSizes[aliased.allocationIndex] = std::max(allocationSizes[aliased.allocationIndex], aliased.offset + req.size);
+        allocationAlignments[aliased.allocationIndex] = std::max(allocationAlignments[aliased.allocationIndex], req.alignment);
+        placed.push_back(i);
+    }
+
+    for(size_t a = 0; a < allocationTypeBits.size(); a++) {
+        VkMemoryRequirements req{};
+        req.size = allocationSizes[a];
+        req.alignment = allocationAlignments[a];
+        req.memoryTypeBits = allocationTypeBits[a];
+
+        VmaAllocationCreateInfo allocCreateInfo{};
+        allocCreateInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+        VmaAllocation allocation;
+        if(vmaAllocateMemory(allocator, &req, &allocCreateInfo, &allocation, nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate aliased image memory!");
+        }
+
+        group.allocations.push_back(allocation);
+        group.allocatedSize += req.size;
+    }
+
+    for(size_t i = 0; i < descs.size(); i++) {
+        AliasedImage& aliased = group.images[i];
+        aliased.image.allocation = group.allocations[aliased.allocationIndex];
+
+        if(vmaBindImageMemory2(allocator, aliased.image.allocation, aliased.offset, aliased.image.image, nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to bind aliased image memory!");
+        }
+
+        VkImageViewCreateInfo viewCreateInfo{};
+        viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewCreateInfo.image = aliased.image.image;
+        viewCreateInfo.format = descs[i].format;
+
+        viewCreateInfo.subresourceRange.aspectMask = getGenericAspectMask(descs[i].format);
+        viewCreateInfo.subresourceRange.baseMipLevel = 0;
+        viewCreateInfo.subresourceRange.levelCount = 1;
+        viewCreateInfo.subresourceRange.baseArrayLayer = 0;
+        viewCreateInfo.subresourceRange.layerCount = 1;
+
+        if(vkCreateImageView(_device, &viewCreateInfo, nullptr, &aliased.image.imageView) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create image view!");
+        }
+    }
+
+    return group;
+}
+
+void ResourceManager::destroyAliasedImages(AliasedImageGroup& group) {
+    for(AliasedImage& aliased : group.images) {
+        vkDestroyImageView(_device, aliased.image.imageView, nullptr);
+        vkDestroyImage(_device, aliased.image.image, nullptr);
+    }
+
+    for(VmaAllocation allocation : group.allocations) vmaFreeMemory(allocator, allocation);
+
+    group = AliasedImageGroup{};
+}
+
+AllocatedBuffer ResourceManager::allocateBuffer(VkDeviceSize size, VkBufferUsageFlags usageFlags, VmaAllocationCreateFlags allocationFlags) {
+    AllocatedBuffer allocatedBuffer{};
+    allocatedBuffer.size = size;
+
+    VkBufferCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    createInfo.size = size;
+    createInfo.usage = usageFlags;
+    createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocCreateInfo{};
+    allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
+    allocCreateInfo.flags = allocationFlags;
+
+    VmaAllocationInfo allocInfo{};
+    if(vmaCreateBuffer(allocator, &createInfo, &allocCreateInfo, &allocatedBuffer.buffer, &allocatedBuffer.allocation, &allocInfo) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create VkBuffer!");
+    }
+
+    // With ALLOW_TRANSFER_INSTEAD the allocation may land in non host visible memory, in which case it is not mapped
+    allocatedBuffer.mappedData = allocInfo.pMappedData;
+
+    return allocatedBuffer;
+}
+
+VkDeviceAddress ResourceManager::getBufferAddress(const AllocatedBuffer& buffer) const {
+    VkBufferDeviceAddressInfo addressInfo{};
+    addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+    addressInfo.buffer = buffer.buffer;
+
+    return vkGetBufferDeviceAddress(_device, &addressInfo);
+}
+
+void ResourceManager::destroyAllocatedBuffer(AllocatedBuffer allocatedBuffer) {
+    vmaDestroyBuffer(allocator, allocatedBuffer.buffer, allocatedBuffer.allocation);
+}
+
+VkDeviceSize ResourceManager::enqueueBufferUpload(const AllocatedBuffer& dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+    PendingFlush flush;
+    uint8_t* dstData = stageBufferUpload(dst, dstOffset, size, 1, flush);
+    if(flush.size == 0) return 0;
+
+    std::memcpy(dstData, data, flush.size);
+    vmaFlushAllocation(allocator, flush.allocation, flush.offset, flush.size);
+    return flush.size;
+}
+
+void* ResourceManager::reserveBufferUpload(const AllocatedBuffer& dst, VkDeviceSize dstOffset, VkDeviceSize size, VkDeviceSize granularity,
+                                           VkDeviceSize& accepted) {
+    PendingFlush flush;
+    uint8_t* dstData = stageBufferUpload(dst, dstOffset, size, granularity, flush);
+
+    accepted = flush.size;
+    if(accepted == 0) return nullptr;
+
+    pendingFlushes.push_back(flush);
+    return dstData;
+}
+
+AllocatedBuffer ResourceManager::allocateIntermediateBuffer(VkDeviceSize size) {
+    AllocatedBuffer buffer = allocateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                            VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                                            VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                                            VMA_ALLOCATION_CREATE_MAPPED_BIT);
+    intermediateBuffers.push_back(buffer.buffer);
+
+    return buffer;
+}
+
+void ResourceManager::destroyIntermediateBuffer(const AllocatedBuffer& buffer) {
+    // Pending copies go out with the next submission, which signals the value after the current one
+    uint64_t timelineValue = pendingBufferCopies.empty() ? uploadTimelineValue : uploadTimelineValue + 1;
+    retiringBuffers.push_back(RetiringBuffer{buffer, timelineValue});
+}
+
+void ResourceManager::enqueueBufferCopy(const AllocatedBuffer& src, VkDeviceSize srcOffset, const AllocatedBuffer& dst, VkDeviceSize dstOffset,
+                                        VkDeviceSize size) {
+    if(size == 0) return;
+
+    PendingBufferCopy copy{};
+    copy.src = src.buffer;
+    copy.dst = dst.buffer;
+    copy.region.sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2;
+    copy.region.srcOffset = srcOffset;
+    copy.region.dstOffset = dstOffset;
+    copy.region.size = size;
+    pendingBufferCopies.push_back(copy);
+}
+
+void ResourceManager::submitUploads() {
+    // Reserved uploads were written after reserveBufferUpload() returned; the submission makes them visible
+    for(const PendingFlush& flush : pendingFlushes) vmaFlushAllocation(allocator, flush.allocation, flush.offset, flush.size);
+    pendingFlushes.clear();
+
+    if(pendingBufferCopies.empty()) return;
+
+    bool dedicated = (_transferFamilyIndex != _graphicsFamilyIndex);
+    uint64_t timelineValue = uploadTimelineValue + 1;
+    VkCommandBuffer buf = acquireUploadCommandBuffer(timelineValue);
+
+    VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, nullptr, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, nullptr};
+    vkBeginCommandBuffer(buf, &beginInfo);
+
+        // One copy command per source and destination buffer, however many uploads targeted it. Staging copies
+        // come first, so the copies out of intermediate buffers see what they wrote.
+        auto copyOrder = [this](const PendingBufferCopy& copy) {
+            return std::make_tuple(copy.src != stagingBuffer.buffer, copy.dst, copy.src);
+        };
+        std::stable_sort(pendingBufferCopies.begin(), pendingBufferCopies.end(), [&](const PendingBufferCopy& a, const PendingBufferCopy& b) {
+            return copyOrder(a) < copyOrder(b);
+        });
+
+        std::vector<VkBufferCopy2> regions;
+        bool waitedForWrites = false;
+        for(size_t first = 0; first < pendingBufferCopies.size(); ) {
+            const PendingBufferCopy& group = pendingBufferCopies[first];
+
+            // Intermediate buffers are written by this submission's staging copies and by earlier submissions
+            if(group.src != stagingBuffer.buffer && !waitedForWrites) {
+                VkMemoryBarrier2 barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+                barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+                barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+                barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+                barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+
+                VkDependencyInfo depInfo{};
+                depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+                depInfo.memoryBarrierCount = 1;
+                depInfo.pMemoryBarriers = &barrier;
+                vkCmdPipelineBarrier2(buf, &depInfo);
+                waitedForWrites = true;
+            }
+
+            size_t last = first;
+            regions.clear();
+            while(last < pendingBufferCopies.size() && pendingBufferCopies[last].dst == group.dst && pendingBufferCopies[last].src == group.src) {
+                regions.push_back(pendingBufferCopies[last].region);
+                last++;
+            }
+
+            VkCopyBufferInfo2 copyInfo{};
+            copyInfo.sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2;
+            copyInfo.srcBuffer = group.src;
+            copyInfo.dstBuffer = group.dst;
+            copyInfo.regionCount = static_cast<uint32_t>(regions.size());
+            copyInfo.pRegions = regions.data();
+            vkCmdCopyBuffer2(buf, &copyInfo);
+
+            first = last;
+        }
+
+        // With a dedicated family these are release barriers, and the same barriers are later recorded on the
+        // graphics queue as acquires. Otherwise the semaphore wait covers everything.
+        std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+        if(dedicated) {
+            bufferBarriers.reserve(pendingBufferCopies.size());
+            for(const PendingBufferCopy& copy : pendingBufferCopies) {
+                if(isIntermediateBuffer(copy.dst)) continue;
+
+                VkBufferMemoryBarrier2 barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+                barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+                barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+                barrier.srcQueueFamilyIndex = _transferFamilyIndex;
+                barrier.dstQueueFamilyIndex = _graphicsFamilyIndex;
+                barrier.buffer = copy.dst;
+                barrier.offset = copy.region.dstOffset;
+                barrier.size = copy.region.size;
+                bufferBarriers.push_back(barrier);
+            }
+        }
+
+        if(!bufferBarriers.empty()) {
+            VkDependencyInfo depInfo{};
+            depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+            depInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+            depInfo.pBufferMemoryBarriers = bufferBarriers.data();
+            vkCmdPipelineBarrier2(buf, &depInfo);
+        }
+
+    vkEndCommandBuffer(buf);
+
+    VkCommandBufferSubmitInfo bufSubmitInfo{};
+    bufSubmitInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    bufSubmitInfo.commandBuffer = buf;
+
+    VkSemaphoreSubmitInfo signalInfo{};
+    signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    signalInfo.semaphore = uploadSemaphore;
+    signalInfo.value = timelineValue;
+    signalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    VkSubmitInfo2 submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submitInfo.commandBufferInfoCount = 1;
+    submitInfo.pCommandBufferInfos = &bufSubmitInfo;
+    submitInfo.signalSemaphoreInfoCount = 1;
+    submitInfo.pSignalSemaphoreInfos = &signalInfo;
+
+    if(vkQueueSubmit2(_transferQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit upload!");
+    }
+
+    // The acquire side mirrors the release: same families, ranges and layouts, with the other half of the masks
+    for(VkBufferMemoryBarrier2& barrier : bufferBarriers) {
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+        pendingBufferAcquires.push_back(barrier);
+    }
+
+    pendingBufferCopies.clear();
+
+    uploadTimelineValue = timelineValue;
+    unacquiredTimelineValue = timelineValue;
+    stagingSubmissions.push_back(RingSubmission{timelineValue, stagingAllocated});
+}
+
+uint64_t ResourceManager::recordUploadAcquires(VkCommandBuffer buf) {
+    if(!pendingBufferAcquires.empty()) {
+        VkDependencyInfo depInfo{};
+        depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        depInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(pendingBufferAcquires.size());
+        depInfo.pBufferMemoryBarriers = pendingBufferAcquires.data();
+        vkCmdPipelineBarrier2(buf, &depInfo);
+
+        pendingBufferAcquires.clear();
+    }
+
+    uint64_t waitValue = unacquiredTimelineValue;
+    unacquiredTimelineValue = 0;
+    return waitValue;
+}
+
+void ResourceManager::retireUploads() {
+    uint64_t completedValue = 0;
+    vkGetSemaphoreCounterValue(_device, uploadSemaphore, &completedValue);
+
+    while(!stagingSubmissions.empty() && stagingSubmissions.front().timelineValue <= completedValue) {
+        stagingRetired = stagingSubmissions.front().allocatedEnd;
+        stagingSubmissions.pop_front();
+    }
+
+    for(size_t i = 0; i < retiringBuffers.size(); ) {
+        if(retiringBuffers[i].timelineValue > completedValue) {
+            i++;
+            continue;
+        }
+
+        VkBuffer buffer = retiringBuffers[i].buffer.buffer;
+        intermediateBuffers.erase(std::find(intermediateBuffers.begin(), intermediateBuffers.end(), buffer));
+        destroyAllocatedBuffer(retiringBuffers[i].buffer);
+        retiringBuffers[i] = retiringBuffers.back();
+        retiringBuffers.pop_back();
+    }
+}
+
+void ResourceManager::flushUploads() {
+    submitUploads();
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &uploadSemaphore;
+    waitInfo.pValues = &uploadTimelineValue;
+
+    vkWaitSemaphores(_device, &waitInfo, UINT64_MAX);
+    retireUploads();
+}
+
+/**
+ * Returns a command buffer from a finished batch, or allocates a new one when every batch is still in flight.
+ */
+VkCommandBuffer ResourceManager::acquireUploadCommandBuffer(uint64_t timelineValue) {
+    uint64_t completedValue = 0;
+    vkGetSemaphoreCounterValue(_device, uploadSemaphore, &completedValue);
+
+    for(UploadBatch& batch : uploadBatches) {
+        if(batch.timelineValue <= completedValue) {
+            batch.timelineValue = timelineValue;
+            vkResetCommandBuffer(batch.commandBuffer, 0);
+            return batch.commandBuffer;
+        }
+    }
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = uploadCommandPool;
+    allocInfo.commandBufferCount = 1;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+    UploadBatch batch{VK_NULL_HANDLE, timelineValue};
+    if(vkAllocateCommandBuffers(_device, &allocInfo, &batch.commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate upload command buffer!");
+    }
+
+    uploadBatches.push_back(batch);
+    return batch.commandBuffer;
+}
+
+/**
+ * Allocates the memory an upload is written to: the destination itself when it is mapped, otherwise as much of the
+ * staging ring as fits in whole multiples of granularity, with a pending copy into the destination. flush receives
+ * the range to flush once written; its size is the number of bytes accepted.
+ */
+uint8_t* ResourceManager::stageBufferUpload(const AllocatedBuffer& dst, VkDeviceSize dstOffset, VkDeviceSize size, VkDeviceSize granularity,
+                                            PendingFlush& flush) {
+    flush = PendingFlush{};
+    if(size == 0) return nullptr;
+
+    // Integrated and ReBAR GPUs can be written directly, skipping the staging copy entirely
+    if(dst.mappedData != nullptr) {
+        flush = PendingFlush{dst.allocation, dstOffset, size};
+        return static_cast<uint8_t*>(dst.mappedData) + dstOffset;
+    }
+
+    VkDeviceSize wrapPadding;
+    VkDeviceSize accepted = std::min(size, stagingContiguousSpace(wrapPadding));
+    accepted -= accepted % granularity;
+    if(accepted == 0) return nullptr;
+
+    stagingAllocated += wrapPadding;
+    VkDeviceSize srcOffset = allocateStaging(accepted);
+    flush = PendingFlush{stagingBuffer.allocation, srcOffset, accepted};
+    uint8_t* stagingData = static_cast<uint8_t*>(stagingBuffer.mappedData) + srcOffset;
+
+    // Consecutive uploads into the same buffer usually continue each other; extend the last region instead
+    if(!pendingBufferCopies.empty()) {
+        PendingBufferCopy& last = pendingBufferCopies.back();
+        if(last.src == stagingBuffer.buffer && last.dst == dst.buffer &&
+           last.region.srcOffset + last.region.size == srcOffset &&
+           last.region.dstOffset + last.region.size == dstOffset) {
+            last.region.size += accepted;
+            return stagingData;
+        }
+    }
+
+    PendingBufferCopy copy{};
+    copy.src = stagingBuffer.buffer;
+    copy.dst = dst.buffer;
+    copy.region.sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2;
+    copy.region.srcOffset = srcOffset;
+    copy.region.dstOffset = dstOffset;
+    copy.region.size = accepted;
+    pendingBufferCopies.push_back(copy);
+
+    return stagingData;
+}
+
+bool ResourceManager::isIntermediateBuffer(VkBuffer buffer) const {
+    return std::find(intermediateBuffers.begin(), intermediateBuffers.end(), buffer) != intermediateBuffers.end();
+}
+
+/**
+ * Returns the largest allocation that currently fits without splitting, and the padding needed to skip to the
+ * start of the ring when the space at its end is the smaller part. A drained ring is rewound to its start first, so
+ * the whole buffer is contiguous again.
+ */
+VkDeviceSize ResourceManager::stagingContiguousSpace(VkDeviceSize& wrapPadding) {
+    if(stagingAllocated == stagingRetired) {
+        stagingAllocated = (stagingAllocated + STAGING_BUFFER_SIZE - 1) / STAGING_BUFFER_SIZE * STAGING_BUFFER_SIZE;
+        stagingRetired = stagingAllocated;
+    }
+
+    VkDeviceSize free = STAGING_BUFFER_SIZE - (stagingAllocated - stagingRetired);
+    VkDeviceSize head = stagingAllocated % STAGING_BUFFER_SIZE;
+    VkDeviceSize toEnd = STAGING_BUFFER_SIZE - head;
+
+    wrapPadding = 0;
+    if(free <= toEnd) return free;
+
+    VkDeviceSize fromStart = free - toEnd;
+    if(toEnd >= fromStart) return toEnd;
+
+    wrapPadding = toEnd;
+    return fromStart;
+}
+
+/**
+ * Allocates from the ring head. The caller has checked that size fits contiguously.
+ */
+VkDeviceSize ResourceManager::allocateStaging(VkDeviceSize size) {
+    VkDeviceSize offset = stagingAllocated % STAGING_BUFFER_SIZE;
+
+    // Keeping the head aligned satisfies the offset rules of both buffer and image copies
+    stagingAllocated += (size + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+
+    return offset;
+}
+
+} // namespace vkmv
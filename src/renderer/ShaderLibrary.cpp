@@ -0,0 +1,214 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/renderer/ShaderLibrary.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace vkmv {
+
+// Changed files are reloaded one to two intervals after their last write
+static constexpr std::chrono::milliseconds WATCH_INTERVAL(250);
+
+static std::vector<uint32_t> readSpirv(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(!file) throw std::runtime_error("Failed to open shader file: " + path.string());
+
+    size_t size = static_cast<size_t>(file.tellg());
+    if(size == 0 || size % sizeof(uint32_t) != 0) throw std::runtime_error("Invalid SPIR-V size: " + path.string());
+
+    std::vector<uint32_t> code(size / sizeof(uint32_t));
+    file.seekg(0);
+    if(!file.read(reinterpret_cast<char*>(code.data()), size)) throw std::runtime_error("Failed to read shader file: " + path.string());
+
+    return code;
+}
+
+// Paths are keyed the way the watcher reports them, so "./a.spv" and "a.spv" name the same file
+static std::string normalizePath(const std::string& path) {
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+void ShaderLibrary::init(Device* pDevice, PipelineCache* pPipelineCache, FrameTimeline* pFrameTimeline, const std::string& shaderDirectory) {
+    device = pDevice;
+    pipelineCache = pPipelineCache;
+    frameTimeline = pFrameTimeline;
+    this->shaderDirectory = shaderDirectory;
+
+    stopWatching = false;
+    watcher = std::thread(&ShaderLibrary::watchShaderDirectory, this);
+}
+
+void ShaderLibrary::cleanup() {
+    {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        stopWatching = true;
+    }
+    watchCondition.notify_one();
+    if(watcher.joinable()) watcher.join();
+
+    for(RegisteredPipeline& registered : pipelines) vkDestroyPipeline(device->getDevice(), registered.pipeline, nullptr);
+    pipelines.clear();
+    files.clear();
+    modulesByHash.clear();
+    changedPaths.clear();
+}
+
+std::shared_ptr<ShaderModule> ShaderLibrary::load(const std::string& path) {
+    std::string key = normalizePath(path);
+
+    auto it = files.find(key);
+    if(it != files.end()) return it->second;
+
+    std::shared_ptr<ShaderModule> module = createModule(readSpirv(shaderDirectory / key));
+    files[key] = module;
+    return module;
+}
+
+PipelineHandle ShaderLibrary::registerPipeline(const std::vector<std::string>& shaderPaths, PipelineBuilder builder) {
+    RegisteredPipeline registered;
+    for(const std::string& path : shaderPaths) registered.shaderPaths.push_back(normalizePath(path));
+    registered.builder = std::move(builder);
+    registered.pipeline = buildPipeline(registered);
+
+    pipelines.push_back(std::move(registered));
+    return static_cast<PipelineHandle>(pipelines.size() - 1);
+}
+
+bool ShaderLibrary::processReloads() {
+    std::set<std::string> changed;
+    {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        changed.swap(changedPaths);
+    }
+
+    std::vector<std::string> reloaded;
+    for(const std::string& path : changed) {
+        auto it = files.find(path);
+        if(it == files.end()) continue;
+
+        try {
+            std::vector<uint32_t> code = readSpirv(shaderDirectory / path);
+
+            // Editors often touch files without changing them; identical bytecode needs no rebuild
+            if(code == it->second->getCode()) continue;
+
+            it->second = createModule(code);
+            reloaded.push_back(path);
+        } catch(const std::exception& e) {
+            std::cerr << "Failed to reload shader: " << e.what() << std::endl;
+        }
+    }
+    if(reloaded.empty()) return false;
+
+    std::vector<std::pair<RegisteredPipeline*, VkPipeline>> rebuilt;
+    for(RegisteredPipeline& registered : pipelines) {
+        bool affected = std::any_of(registered.shaderPaths.begin(), registered.shaderPaths.end(), [&](const std::string& path) {
+            return std::find(reloaded.begin(), reloaded.end(), path) != reloaded.end();
+        });
+        if(!affected) continue;
+
+        try {
+            rebuilt.emplace_back(&registered, buildPipeline(registered));
+        } catch(const std::exception& e) {
+            std::cerr << "Failed to rebuild pipeline: " << e.what() << std::endl;
+        }
+    }
+    if(rebuilt.empty()) return false;
+
+    // Old pipelines may still be referenced by frames in flight
+    for(auto& [registered, pipeline] : rebuilt) {
+        VkDevice vkDevice = device->getDevice();
+        VkPipeline old = registered->pipeline;
+        frameTimeline->retire([vkDevice, old]() { vkDestroyPipeline(vkDevice, old, nullptr); });
+        registered->pipeline = pipeline;
+    }
+
+    std::cout << "Rebuilt " << rebuilt.size() << " pipeline(s) after shader changes" << std::endl;
+    return true;
+}
+
+std::shared_ptr<ShaderModule> ShaderLibrary::createModule(const std::vector<uint32_t>& code) {
+    uint64_t hash = ShaderModule::hashCode(code);
+
+    // The hash only finds the candidate; the bytecode decides
+    auto it = modulesByHash.find(hash);
+    if(it != modulesByHash.end()) {
+        std::shared_ptr<ShaderModule> existing = it->second.lock();
+        if(existing && existing->getCode() == code) return existing;
+    }
+
+    std::shared_ptr<ShaderModule> module;
+    if(ShaderModule::Create(device, code, &module) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shader module!");
+    }
+
+    modulesByHash[hash] = module;
+    return module;
+}
+
+VkPipeline ShaderLibrary::buildPipeline(const RegisteredPipeline& registered) {
+    std::vector<std::shared_ptr<ShaderModule>> shaders;
+    for(const std::string& path : registered.shaderPaths) shaders.push_back(load(path));
+
+    VkPipeline pipeline = registered.builder(*pipelineCache, shaders);
+    if(pipeline == VK_NULL_HANDLE) throw std::runtime_error("Pipeline builder returned no pipeline!");
+
+    return pipeline;
+}
+
+/**
+ * Polls modification times and sizes under the shader directory and queues the relative paths of changed files.
+ * Polling keeps this portable. A change is only queued once a scan finds the file unchanged since the last one, so
+ * files the shader compiler is still writing aren't picked up half written.
+ */
+void ShaderLibrary::watchShaderDirectory() {
+    struct WatchedFile {
+        std::filesystem::file_time_type writeTime;
+        uintmax_t size;
+        bool settling;      // changed, and not yet seen unchanged for a whole interval
+    };
+    std::unordered_map<std::string, WatchedFile> watchedFiles;
+    bool firstScan = true;
+
+    std::unique_lock<std::mutex> lock(watchMutex);
+    while(!stopWatching) {
+        lock.unlock();
+
+        std::vector<std::string> changed;
+        std::error_code ec;
+        for(auto it = std::filesystem::recursive_directory_iterator(shaderDirectory, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            if(!it->is_regular_file(ec)) continue;
+
+            std::filesystem::file_time_type writeTime = it->last_write_time(ec);
+            if(ec) continue;
+            uintmax_t size = it->file_size(ec);
+            if(ec) continue;
+
+            std::string path = std::filesystem::relative(it->path(), shaderDirectory, ec).generic_string();
+            auto [entry, inserted] = watchedFiles.try_emplace(path, WatchedFile{writeTime, size, !firstScan});
+            WatchedFile& file = entry->second;
+            if(inserted) continue;
+
+            if(file.writeTime != writeTime || file.size != size) {
+                file = WatchedFile{writeTime, size, true};
+            } else if(file.settling) {
+                file.settling = false;
+                changed.push_back(path);
+            }
+        }
+        firstScan = false;
+
+        lock.lock();
+        changedPaths.insert(changed.begin(), changed.end());
+        watchCondition.wait_for(lock, WATCH_INTERVAL, [this] { return stopWatching; });
+    }
+}
+
+} // namespace vkmv
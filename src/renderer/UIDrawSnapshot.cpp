@@ -0,0 +1,49 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/renderer/UIDrawSnapshot.hpp"
+
+#include <cstring>
+
+namespace vkmv {
+
+// ImVector's assignment frees its buffer first; resizing keeps the capacity for the next capture
+template<typename T>
+static void copyVector(const ImVector<T>& source, ImVector<T>& destination) {
+    destination.resize(source.Size);
+    if(source.Size > 0) std::memcpy(destination.Data, source.Data, source.size_in_bytes());
+}
+
+UIDrawSnapshot::~UIDrawSnapshot() {
+    for(ImDrawList* list : m_lists) IM_DELETE(list);
+}
+
+void UIDrawSnapshot::capture(const ImDrawData* drawData) {
+    m_drawData.Clear();
+    if(drawData == nullptr || !drawData->Valid) return;
+
+    while(m_lists.size() < static_cast<size_t>(drawData->CmdListsCount)) m_lists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+
+    for(int i = 0; i < drawData->CmdListsCount; i++) {
+        const ImDrawList* source = drawData->CmdLists[i];
+        ImDrawList* list = m_lists[i];
+        copyVector(source->CmdBuffer, list->CmdBuffer);
+        copyVector(source->IdxBuffer, list->IdxBuffer);
+        copyVector(source->VtxBuffer, list->VtxBuffer);
+        list->Flags = source->Flags;
+        m_drawData.CmdLists.push_back(list);
+    }
+
+    m_drawData.CmdListsCount = drawData->CmdListsCount;
+    m_drawData.TotalIdxCount = drawData->TotalIdxCount;
+    m_drawData.TotalVtxCount = drawData->TotalVtxCount;
+    m_drawData.DisplayPos = drawData->DisplayPos;
+    m_drawData.DisplaySize = drawData->DisplaySize;
+    m_drawData.FramebufferScale = drawData->FramebufferScale;
+    m_drawData.OwnerViewport = drawData->OwnerViewport;
+    m_drawData.Valid = true;
+}
+
+} // namespace vkmv
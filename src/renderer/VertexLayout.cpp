@@ -0,0 +1,209 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/renderer/VertexLayout.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace vkmv {
+
+constexpr float PI = 3.14159265358979f;
+
+// Below the equator, 8 bit octahedral normals have z <= -1/127 before normalization
+constexpr float TANGENT_BASIS_FLIP_Z = -0.001f;
+
+static uint16_t quantizeUnorm16(float v) {
+    return static_cast<uint16_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 65535.0f));
+}
+
+static int8_t quantizeSnorm8(float v) {
+    return static_cast<int8_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * 127.0f));
+}
+
+// Round to nearest even, with overflow to infinity and gradual underflow
+static uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t magnitude = bits & 0x7FFFFFFF;
+
+    if(magnitude >= 0x7F800000) return static_cast<uint16_t>(sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0));
+    if(magnitude >= 0x477FF000) return static_cast<uint16_t>(sign | 0x7C00);
+
+    if(magnitude < 0x38800000) {
+        // Subnormal half: align the implicit bit to the 2^-24 unit, then round
+        if(magnitude < 0x33000000) return static_cast<uint16_t>(sign);
+        uint32_t mantissa = (magnitude & 0x007FFFFF) | 0x00800000;
+        uint32_t shift = 126 - (magnitude >> 23);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if(rest > halfway || (rest == halfway && (half & 1))) half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = (magnitude - 0x38000000) >> 13;
+    uint32_t rest = magnitude & 0x1FFF;
+    if(rest > 0x1000 || (rest == 0x1000 && (half & 1))) half++;
+    return static_cast<uint16_t>(sign | half);
+}
+
+// Matches octDecode in shaders/scene.glsl
+static void octDecode(float x, float y, float n[3]) {
+    n[0] = x;
+    n[1] = y;
+    n[2] = 1.0f - std::fabs(x) - std::fabs(y);
+
+    float t = std::max(-n[2], 0.0f);
+    n[0] += n[0] >= 0.0f ? -t : t;
+    n[1] += n[1] >= 0.0f ? -t : t;
+
+    float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    for(int k = 0; k < 3; k++) n[k] /= length;
+}
+
+// Octahedral encoding at 8 bits per axis. Of the four roundings around the exact encoding, the one that decodes
+// closest to n is kept, which roughly halves the worst case error of plain rounding.
+static void octEncodeSnorm8(const float n[3], int8_t out[2]) {
+    float l1 = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+    if(l1 <= 0.0f) {
+        out[0] = 0;
+        out[1] = 0;
+        return;
+    }
+
+    float x = n[0] / l1, y = n[1] / l1;
+    if(n[2] < 0.0f) {
+        float wrappedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float wrappedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = wrappedX;
+        y = wrappedY;
+    }
+
+    float bestDot = -FLT_MAX;
+    for(int i = 0; i < 4; i++) {
+        float qx = std::clamp((i & 1 ? std::ceil(x * 127.0f) : std::floor(x * 127.0f)), -127.0f, 127.0f);
+        float qy = std::clamp((i & 2 ? std::ceil(y * 127.0f) : std::floor(y * 127.0f)), -127.0f, 127.0f);
+
+        float decoded[3];
+        octDecode(qx / 127.0f, qy / 127.0f, decoded);
+        float dot = decoded[0] * n[0] + decoded[1] * n[1] + decoded[2] * n[2];
+        if(dot > bestDot) {
+            bestDot = dot;
+            out[0] = static_cast<int8_t>(qx);
+            out[1] = static_cast<int8_t>(qy);
+        }
+    }
+}
+
+// Orthonormal basis around a decoded normal (Duff et al. 2017); the tangent angle is measured in it. The basis
+// flips between hemispheres, so the flip sits below the equator where no 8 bit octahedral normal decodes: normals
+// on the equator get the same basis whichever way rounding leaves their z. Matches tangentBasis in scene.glsl.
+static void tangentBasis(const float n[3], float b1[3], float b2[3]) {
+    float sign = n[2] >= TANGENT_BASIS_FLIP_Z ? 1.0f : -1.0f;
+    float a = -1.0f / (sign + n[2]);
+    float b = n[0] * n[1] * a;
+
+    b1[0] = 1.0f + sign * n[0] * n[0] * a;
+    b1[1] = sign * b;
+    b1[2] = -sign * n[0];
+
+    b2[0] = b;
+    b2[1] = sign + n[1] * n[1] * a;
+    b2[2] = -n[1];
+}
+
+PositionQuantization computePositionQuantization(const float* positions, uint32_t vertexCount) {
+    PositionQuantization quantization;
+    if(vertexCount == 0) return quantization;
+
+    float minimum[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float maximum[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for(uint32_t v = 0; v < vertexCount; v++) {
+        for(int k = 0; k < 3; k++) {
+            minimum[k] = std::min(minimum[k], positions[v * 3 + k]);
+            maximum[k] = std::max(maximum[k], positions[v * 3 + k]);
+        }
+    }
+
+    for(int k = 0; k < 3; k++) {
+        quantization.scale[k] = maximum[k] - minimum[k];
+        quantization.bias[k] = minimum[k];
+    }
+
+    return quantization;
+}
+
+void QuantizedPosition::pack(const VertexAttributes& source, uint32_t vertex, uint8_t* destination) {
+    const float* position = &source.positions[static_cast<size_t>(vertex) * 3];
+    const PositionQuantization& q = source.quantization;
+
+    uint16_t packed[4];
+    for(int k = 0; k < 3; k++) packed[k] = q.scale[k] > 0.0f ? quantizeUnorm16((position[k] - q.bias[k]) / q.scale[k]) : 0;
+    packed[3] = 65535;
+
+    std::memcpy(destination, packed, sizeof(packed));
+}
+
+void TangentFrame::pack(const VertexAttributes& source, uint32_t vertex, uint8_t* destination) {
+    int8_t packed[4] = {0, 0, 0, 127};
+    octEncodeSnorm8(&source.normals[static_cast<size_t>(vertex) * 3], packed);
+
+    if(source.tangents) {
+        const float* tangent = &source.tangents[static_cast<size_t>(vertex) * 4];
+
+        // The basis has to come from the normal the shader will see, not the exact one
+        float normal[3], b1[3], b2[3];
+        octDecode(packed[0] / 127.0f, packed[1] / 127.0f, normal);
+        tangentBasis(normal, b1, b2);
+
+        float x = tangent[0] * b1[0] + tangent[1] * b1[1] + tangent[2] * b1[2];
+        float y = tangent[0] * b2[0] + tangent[1] * b2[1] + tangent[2] * b2[2];
+        packed[2] = quantizeSnorm8(std::atan2(y, x) / PI);
+        packed[3] = tangent[3] < 0.0f ? -127 : 127;
+    }
+
+    std::memcpy(destination, packed, sizeof(packed));
+}
+
+void HalfTexcoord::pack(const VertexAttributes& source, uint32_t vertex, uint8_t* destination) {
+    const float* texcoord = &source.texcoords[static_cast<size_t>(vertex) * 2];
+    uint16_t packed[2] = {floatToHalf(texcoord[0]), floatToHalf(texcoord[1])};
+    std::memcpy(destination, packed, sizeof(packed));
+}
+
+static constexpr auto COMPACT_ATTRIBUTES = CompactVertex::attributeDescriptions(0);
+static constexpr auto TEXTURED_COMPACT_ATTRIBUTES = TexturedCompactVertex::attributeDescriptions(0);
+
+VertexFormatInfo getVertexFormatInfo(VertexFormat format) {
+    switch(format) {
+        case VERTEX_FORMAT_COMPACT:
+            return VertexFormatInfo{CompactVertex::stride, COMPACT_ATTRIBUTES.data(), CompactVertex::attributeCount};
+        case VERTEX_FORMAT_COMPACT_TEXTURED:
+            return VertexFormatInfo{TexturedCompactVertex::stride, TEXTURED_COMPACT_ATTRIBUTES.data(), TexturedCompactVertex::attributeCount};
+        default:
+            throw std::runtime_error("Unknown vertex format!");
+    }
+}
+
+void packVertices(VertexFormat format, const VertexAttributes& source, uint32_t vertexCount, uint8_t* destination) {
+    switch(format) {
+        case VERTEX_FORMAT_COMPACT:
+            CompactVertex::pack(source, vertexCount, destination);
+            break;
+        case VERTEX_FORMAT_COMPACT_TEXTURED:
+            TexturedCompactVertex::pack(source, vertexCount, destination);
+            break;
+        default:
+            throw std::runtime_error("Unknown vertex format!");
+    }
+}
+
+} // namespace vkmv
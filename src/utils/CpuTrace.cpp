@@ -0,0 +1,233 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/utils/CpuTrace.hpp"
+
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace vkmv {
+
+// Events a thread may record between flushes; a power of two. 8192 events of 24 bytes is 192 KiB per thread.
+constexpr uint32_t TRACE_RING_CAPACITY = 8192;
+
+static constexpr std::chrono::milliseconds TRACE_FLUSH_INTERVAL(20);
+
+struct TraceEvent {
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+/**
+ * @brief Single producer, single consumer ring. head is only written by the recording thread, tail by the flushing
+ * thread, and each publishes the slots it is done with through its release store.
+ */
+struct TraceRing {
+    TraceEvent events[TRACE_RING_CAPACITY];
+
+    // On cache lines of their own, so each thread's stores don't invalidate the line the other one polls
+    alignas(64) std::atomic<uint32_t> head{0};
+    uint32_t cachedTail = 0;        // recording thread only: the tail when last read, which it never falls behind
+    std::atomic<uint64_t> dropped{0};
+    alignas(64) std::atomic<uint32_t> tail{0};
+
+    uint32_t threadId = 0;
+    std::string threadName;         // guarded by the trace state's mutex, as is named
+    bool named = false;             // whether the running trace has the name yet
+};
+
+struct TraceState {
+    // The clocks' readings at the trace epoch, which trace times count from
+    uint64_t epochTicks = readTraceClock();
+    std::chrono::steady_clock::time_point epochTime = std::chrono::steady_clock::now();
+
+    std::mutex mutex;               // guards rings, thread names and stopping
+    std::condition_variable stopCondition;
+    std::vector<std::unique_ptr<TraceRing>> rings;
+    bool stopping = false;
+
+    std::ofstream file;             // owned by the flushing thread while it runs
+    std::thread flusher;
+};
+
+static thread_local TraceRing* t_traceRing = nullptr;
+
+static TraceState& getTraceState() {
+    static TraceState state;
+    return state;
+}
+
+// Rings outlive their threads, so the flushing thread never reads one that is gone
+static TraceRing* getThreadRing() {
+    if(t_traceRing != nullptr) return t_traceRing;
+
+    TraceState& state = getTraceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    state.rings.push_back(std::make_unique<TraceRing>());
+    t_traceRing = state.rings.back().get();
+    t_traceRing->threadId = static_cast<uint32_t>(state.rings.size());
+    t_traceRing->threadName = "Thread " + std::to_string(t_traceRing->threadId);
+
+    return t_traceRing;
+}
+
+/**
+ * The time stamp counter's rate is measured against the steady clock over the whole time since the epoch, which
+ * makes the estimate more precise the longer the process runs.
+ */
+static double getTicksPerMicrosecond(const TraceState& state) {
+#ifdef VKMV_TRACE_TSC
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - state.epochTime;
+    uint64_t ticks = readTraceClock() - state.epochTicks;
+    return elapsed.count() > 0.0 ? static_cast<double>(ticks) / elapsed.count() : 1000.0;
+#else
+    (void)state;
+    return 1000.0;
+#endif
+}
+
+static void flushRings(TraceState& state) {
+    std::vector<TraceRing*> rings;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for(std::unique_ptr<TraceRing>& ring : state.rings) {
+            rings.push_back(ring.get());
+            if(ring->named) continue;
+
+            state.file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->threadId
+                       << ",\"args\":{\"name\":\"" << escapeTraceString(ring->threadName) << "\"}}";
+            ring->named = true;
+        }
+    }
+
+    double ticksPerMicrosecond = getTicksPerMicrosecond(state);
+
+    for(TraceRing* ring : rings) {
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+
+        for(uint32_t i = tail; i != head; i++) {
+            const TraceEvent& event = ring->events[i & (TRACE_RING_CAPACITY - 1)];
+            state.file << ",\n{\"name\":\"" << escapeTraceString(event.name) << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->threadId
+                       << ",\"ts\":" << static_cast<double>(event.begin - state.epochTicks) / ticksPerMicrosecond
+                       << ",\"dur\":" << static_cast<double>(event.end - event.begin) / ticksPerMicrosecond << "}";
+        }
+
+        ring->tail.store(head, std::memory_order_release);
+    }
+}
+
+static void runFlusher(TraceState& state) {
+    std::unique_lock<std::mutex> lock(state.mutex);
+    while(!state.stopCondition.wait_for(lock, TRACE_FLUSH_INTERVAL, [&]() { return state.stopping; })) {
+        lock.unlock();
+        flushRings(state);
+        lock.lock();
+    }
+}
+
+std::string escapeTraceString(const std::string& string) {
+    std::string escaped;
+    for(char c : string) {
+        if(c == '"' || c == '\\') escaped += '\\';
+        if(static_cast<unsigned char>(c) < 0x20) continue;
+        escaped += c;
+    }
+    return escaped;
+}
+
+void CpuTracer::start(const std::string& path) {
+    TraceState& state = getTraceState();
+    if(state.flusher.joinable()) throw std::runtime_error("A CPU trace is already running!");
+
+    state.file.open(path, std::ios::trunc);
+    if(!state.file) throw std::runtime_error("Failed to open trace file " + path + "!");
+
+    state.file << std::fixed << std::setprecision(3);
+    state.file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    state.file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}}";
+
+    // Scopes that closed after the last trace stopped don't belong in this one
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for(std::unique_ptr<TraceRing>& ring : state.rings) {
+            ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+            ring->named = false;
+        }
+        state.stopping = false;
+    }
+
+    state.flusher = std::thread(runFlusher, std::ref(state));
+    s_enabled.store(true, std::memory_order_relaxed);
+}
+
+void CpuTracer::stop(const TraceEventWriter& appendEvents) {
+    TraceState& state = getTraceState();
+    if(!state.flusher.joinable()) return;
+
+    s_enabled.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stopping = true;
+    }
+    state.stopCondition.notify_all();
+    state.flusher.join();
+
+    flushRings(state);
+    if(appendEvents) appendEvents(state.file);
+
+    state.file << "\n]}\n";
+    state.file.close();
+    if(!state.file) std::cerr << "Failed to write CPU trace" << std::endl;
+
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for(std::unique_ptr<TraceRing>& ring : state.rings) dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+    }
+    if(dropped > 0) std::cerr << "CPU trace dropped " << dropped << " events; rings filled up between flushes" << std::endl;
+}
+
+void CpuTracer::setThreadName(const std::string& name) {
+    TraceRing* ring = getThreadRing();
+
+    TraceState& state = getTraceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    ring->threadName = name;
+    ring->named = false;
+}
+
+void CpuTracer::record(const char* name, uint64_t begin, uint64_t end) {
+    TraceRing* ring = getThreadRing();
+
+    // The flushing thread's tail is only read again once the ring looks full
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    if(head - ring->cachedTail == TRACE_RING_CAPACITY) {
+        ring->cachedTail = ring->tail.load(std::memory_order_acquire);
+        if(head - ring->cachedTail == TRACE_RING_CAPACITY) {
+            ring->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    ring->events[head & (TRACE_RING_CAPACITY - 1)] = TraceEvent{name, begin, end};
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+double CpuTracer::getMicroseconds() {
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - getTraceState().epochTime;
+    return elapsed.count();
+}
+
+} // namespace vkmv
@@ -0,0 +1,226 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/utils/JobSystem.hpp"
+
+#include <algorithm>
+
+#include "vkmv/utils/CpuTrace.hpp"
+
+namespace vkmv {
+
+// Spins before a worker goes to sleep, so bursts of small jobs don't pay for a wake-up each
+constexpr int IDLE_SPIN_COUNT = 64;
+
+// Identifies the worker (and its owning JobSystem) running on the current thread
+static thread_local const void* t_jobSystem = nullptr;
+static thread_local int t_workerIndex = -1;
+
+static uint32_t nextRandom() {
+    static thread_local uint32_t state = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+bool JobSystem::WorkStealingDeque::push(Job* job) {
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    int64_t top = m_top.load(std::memory_order_acquire);
+
+    if(bottom - top >= CAPACITY) return false;
+
+    m_buffer[bottom & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+JobSystem::Job* JobSystem::WorkStealingDeque::pop() {
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = m_top.load(std::memory_order_relaxed);
+
+    if(top > bottom) {
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = m_buffer[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+
+    // Last element: race against thieves for it
+    if(top == bottom) {
+        if(!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) job = nullptr;
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return job;
+}
+
+JobSystem::Job* JobSystem::WorkStealingDeque::steal() {
+    int64_t top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+    if(top >= bottom) return nullptr;
+
+    Job* job = m_buffer[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if(!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+
+    return job;
+}
+
+JobSystem::JobSystem(unsigned int workerCount) {
+    if(workerCount == 0) {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    for(unsigned int i = 0; i < workerCount; i++) m_workers.push_back(std::make_unique<Worker>());
+
+    // Start threads only once every deque exists, since workers steal from each other immediately
+    for(unsigned int i = 0; i < workerCount; i++) m_workers[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_running.store(false);
+    }
+    m_sleepCondition.notify_all();
+
+    for(auto& worker : m_workers) worker->thread.join();
+
+    // Jobs still queued at shutdown are dropped
+    for(Job* job : m_injectionQueue) delete job;
+    for(auto& worker : m_workers) {
+        while(Job* job = worker->deque.pop()) delete job;
+    }
+}
+
+void JobSystem::submit(JobFunction fn, JobCounter* counter) {
+    if(counter) counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    enqueue(new Job{std::move(fn), counter});
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t grainSize, std::function<void(uint32_t, uint32_t)> fn, JobCounter* counter) {
+    grainSize = std::max(grainSize, 1u);
+
+    // Every chunk shares one copy of fn, which lives until the last chunk finishes
+    auto shared = std::make_shared<std::function<void(uint32_t, uint32_t)>>(std::move(fn));
+
+    for(uint32_t begin = 0; begin < count; begin += grainSize) {
+        uint32_t end = std::min(count, begin + grainSize);
+        submit([shared, begin, end]() { (*shared)(begin, end); }, counter);
+    }
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    while(!counter.isDone()) {
+        Job* job = findJob();
+
+        if(job) {
+            execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+unsigned int JobSystem::getThreadIndex() const {
+    return t_jobSystem == this ? static_cast<unsigned int>(t_workerIndex) : getWorkerCount();
+}
+
+void JobSystem::enqueue(Job* job) {
+    bool pushed = false;
+
+    if(t_jobSystem == this) pushed = m_workers[t_workerIndex]->deque.push(job);
+
+    if(!pushed) {
+        std::lock_guard<std::mutex> lock(m_injectionMutex);
+        m_injectionQueue.push_back(job);
+    }
+
+    m_queuedJobs.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock orders this notify after a sleeping worker's predicate check
+    { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+    m_sleepCondition.notify_one();
+}
+
+/**
+ * Looks for work in order of locality: own deque, the injection queue, then a random victim.
+ */
+JobSystem::Job* JobSystem::findJob() {
+    Job* job = nullptr;
+    bool isWorker = (t_jobSystem == this);
+
+    if(isWorker) job = m_workers[t_workerIndex]->deque.pop();
+
+    if(!job) {
+        std::lock_guard<std::mutex> lock(m_injectionMutex);
+        if(!m_injectionQueue.empty()) {
+            job = m_injectionQueue.front();
+            m_injectionQueue.pop_front();
+        }
+    }
+
+    if(!job) {
+        size_t workerCount = m_workers.size();
+        size_t start = nextRandom() % workerCount;
+
+        for(size_t i = 0; i < workerCount && !job; i++) {
+            size_t victim = (start + i) % workerCount;
+            if(isWorker && victim == static_cast<size_t>(t_workerIndex)) continue;
+            job = m_workers[victim]->deque.steal();
+        }
+    }
+
+    if(job) m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+
+    return job;
+}
+
+void JobSystem::execute(Job* job) {
+    job->fn();
+
+    if(job->counter) job->counter->m_pending.fetch_sub(1, std::memory_order_release);
+
+    delete job;
+}
+
+void JobSystem::workerLoop(unsigned int index) {
+    t_jobSystem = this;
+    t_workerIndex = static_cast<int>(index);
+    CpuTracer::setThreadName("Worker " + std::to_string(index));
+
+    int idleSpins = 0;
+
+    while(m_running.load(std::memory_order_relaxed)) {
+        Job* job = findJob();
+
+        if(job) {
+            execute(job);
+            idleSpins = 0;
+            continue;
+        }
+
+        if(++idleSpins < IDLE_SPIN_COUNT) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepCondition.wait(lock, [this]() {
+            return !m_running.load(std::memory_order_relaxed) || m_queuedJobs.load(std::memory_order_acquire) > 0;
+        });
+        idleSpins = 0;
+    }
+}
+
+} // namespace vkmv
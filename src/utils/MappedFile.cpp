@@ -0,0 +1,157 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/utils/MappedFile.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace vkmv {
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if(file == INVALID_HANDLE_VALUE) throw std::runtime_error("Failed to open file: " + path);
+    m_file = file;
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize)) {
+        unmap();
+        throw std::runtime_error("Failed to query file size: " + path);
+    }
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    if(m_size == 0) return;
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(m_mapping == nullptr) {
+        unmap();
+        throw std::runtime_error("Failed to create file mapping: " + path);
+    }
+
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if(m_data == nullptr) {
+        unmap();
+        throw std::runtime_error("Failed to map file: " + path);
+    }
+#else
+    m_fd = open(path.c_str(), O_RDONLY);
+    if(m_fd < 0) throw std::runtime_error("Failed to open file: " + path);
+
+    struct stat st;
+    if(fstat(m_fd, &st) != 0) {
+        unmap();
+        throw std::runtime_error("Failed to query file size: " + path);
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if(m_size == 0) return;
+
+    void* ptr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if(ptr == MAP_FAILED) {
+        unmap();
+        throw std::runtime_error("Failed to map file: " + path);
+    }
+    m_data = static_cast<const uint8_t*>(ptr);
+
+    // Accesses jump between the JSON chunk and individual buffer views, so default readahead is wasted
+    madvise(ptr, m_size, MADV_RANDOM);
+#endif
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if(this == &other) return *this;
+
+    unmap();
+
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+    m_file = std::exchange(other.m_file, nullptr);
+    m_mapping = std::exchange(other.m_mapping, nullptr);
+#else
+    m_fd = std::exchange(other.m_fd, -1);
+#endif
+
+    return *this;
+}
+
+#ifndef _WIN32
+// Expands [ptr, ptr + size) to whole pages, as required by madvise
+static void pageAlignRange(const void* ptr, size_t size, void** alignedPtr, size_t* alignedSize) {
+    static const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+
+    uintptr_t begin = reinterpret_cast<uintptr_t>(ptr) & ~(pageSize - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(ptr) + size;
+
+    *alignedPtr = reinterpret_cast<void*>(begin);
+    *alignedSize = static_cast<size_t>(end - begin);
+}
+#endif
+
+void MappedFile::prefetch(const void* ptr, size_t size) const {
+    if(m_data == nullptr || size == 0) return;
+
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range{const_cast<void*>(ptr), size};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    void* alignedPtr;
+    size_t alignedSize;
+    pageAlignRange(ptr, size, &alignedPtr, &alignedSize);
+    madvise(alignedPtr, alignedSize, MADV_WILLNEED);
+#endif
+}
+
+void MappedFile::release(const void* ptr, size_t size) const {
+    if(m_data == nullptr || size == 0) return;
+
+#ifdef _WIN32
+    // Unlocking pages that are not locked is harmless and lets the working set trimmer drop them first
+    VirtualUnlock(const_cast<void*>(ptr), size);
+#else
+    // Mapping is private and read-only, so dropped pages are simply re-read from the file if touched again
+    void* alignedPtr;
+    size_t alignedSize;
+    pageAlignRange(ptr, size, &alignedPtr, &alignedSize);
+    madvise(alignedPtr, alignedSize, MADV_DONTNEED);
+#endif
+}
+
+void MappedFile::unmap() {
+#ifdef _WIN32
+    if(m_data) UnmapViewOfFile(m_data);
+    if(m_mapping) CloseHandle(m_mapping);
+    if(m_file) CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    if(m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+    if(m_fd >= 0) close(m_fd);
+    m_fd = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+} // namespace vkmv
@@ -0,0 +1,104 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include "vkmv/utils/Math.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vkmv {
+
+void multiplyMatrices(const float a[16], const float b[16], float out[16]) {
+    for(int col = 0; col < 4; col++) {
+        for(int row = 0; row < 4; row++) {
+            float sum = 0.0f;
+            for(int k = 0; k < 4; k++) sum += a[k * 4 + row] * b[col * 4 + k];
+            out[col * 4 + row] = sum;
+        }
+    }
+}
+
+void perspectiveMatrix(float fovY, float aspect, float zNear, float zFar, float out[16]) {
+    float f = 1.0f / std::tan(fovY * 0.5f);
+
+    std::fill(out, out + 16, 0.0f);
+    out[0] = f / aspect;
+    out[5] = -f;
+    out[10] = zFar / (zNear - zFar);
+    out[11] = -1.0f;
+    out[14] = zNear * zFar / (zNear - zFar);
+}
+
+static void normalize(float v[3]) {
+    float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if(length > 0.0f) for(int i = 0; i < 3; i++) v[i] /= length;
+}
+
+static void cross(const float a[3], const float b[3], float out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+void lookAtMatrix(const float eye[3], const float target[3], const float up[3], float out[16]) {
+    float forward[3] = {target[0] - eye[0], target[1] - eye[1], target[2] - eye[2]};
+    normalize(forward);
+
+    float right[3];
+    cross(forward, up, right);
+    normalize(right);
+
+    float trueUp[3];
+    cross(right, forward, trueUp);
+
+    out[0] = right[0];  out[4] = right[1];  out[8] = right[2];
+    out[1] = trueUp[0]; out[5] = trueUp[1]; out[9] = trueUp[2];
+    out[2] = -forward[0]; out[6] = -forward[1]; out[10] = -forward[2];
+    out[3] = 0.0f; out[7] = 0.0f; out[11] = 0.0f;
+
+    out[12] = -(right[0] * eye[0] + right[1] * eye[1] + right[2] * eye[2]);
+    out[13] = -(trueUp[0] * eye[0] + trueUp[1] * eye[1] + trueUp[2] * eye[2]);
+    out[14] = forward[0] * eye[0] + forward[1] * eye[1] + forward[2] * eye[2];
+    out[15] = 1.0f;
+}
+
+/**
+ * Gribb-Hartmann extraction for a 0..1 depth range: the near plane is row 2 alone rather than row 3 + row 2.
+ */
+void extractFrustumPlanes(const float m[16], float planes[6][4]) {
+    auto row = [&](int r, int c) { return m[c * 4 + r]; };
+
+    for(int c = 0; c < 4; c++) {
+        planes[0][c] = row(3, c) + row(0, c);
+        planes[1][c] = row(3, c) - row(0, c);
+        planes[2][c] = row(3, c) + row(1, c);
+        planes[3][c] = row(3, c) - row(1, c);
+        planes[4][c] = row(2, c);
+        planes[5][c] = row(3, c) - row(2, c);
+    }
+
+    for(int p = 0; p < 6; p++) {
+        float length = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+        if(length > 0.0f) for(int c = 0; c < 4; c++) planes[p][c] /= length;
+    }
+}
+
+float getMaxScale(const float t[16]) {
+    float scale = 0.0f;
+    for(int col = 0; col < 3; col++) {
+        float lengthSquared = t[col * 4] * t[col * 4] + t[col * 4 + 1] * t[col * 4 + 1] + t[col * 4 + 2] * t[col * 4 + 2];
+        scale = std::max(scale, lengthSquared);
+    }
+
+    return std::sqrt(scale);
+}
+
+void transformSphere(const float t[16], const float center[3], float radius, float outCenter[3], float* outRadius) {
+    for(int i = 0; i < 3; i++) outCenter[i] = t[i] * center[0] + t[4 + i] * center[1] + t[8 + i] * center[2] + t[12 + i];
+
+    *outRadius = radius * getMaxScale(t);
+}
+
+} // namespace vkmv
@@ -0,0 +1,153 @@
+// Copyright (c) 2025 Benjamin Wei
+//
+// This file is part of the vulkan-model-viewer project.
+// This code is licensed under the MIT license (see http://opensource.org/licenses/MIT)
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "vkmv/assets/GeometryProcessing.hpp"
+
+using namespace vkmv;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                        \
+    do {                                                                                        \
+        if(!(condition)) {                                                                      \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; \
+            failures++;                                                                         \
+        }                                                                                       \
+    } while(false)
+
+struct TestMesh {
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    uint32_t vertexCount = 0;
+};
+
+/**
+ * A torus of rings x segments quads: a regular grid with no boundary and no degenerate triangles, whose faces point
+ * every way, so the overdraw sort has clusters to reorder.
+ */
+static TestMesh makeTorusGrid(uint32_t rings, uint32_t segments) {
+    const float pi = 3.14159265f;
+
+    TestMesh mesh;
+    mesh.vertexCount = rings * segments;
+    for(uint32_t r = 0; r < rings; r++) {
+        for(uint32_t s = 0; s < segments; s++) {
+            float u = 2.0f * pi * r / rings;
+            float v = 2.0f * pi * s / segments;
+            mesh.positions.push_back((2.0f + 0.5f * std::cos(v)) * std::cos(u));
+            mesh.positions.push_back((2.0f + 0.5f * std::cos(v)) * std::sin(u));
+            mesh.positions.push_back(0.5f * std::sin(v));
+        }
+    }
+
+    for(uint32_t r = 0; r < rings; r++) {
+        for(uint32_t s = 0; s < segments; s++) {
+            uint32_t a = r * segments + s;
+            uint32_t b = ((r + 1) % rings) * segments + s;
+            uint32_t c = ((r + 1) % rings) * segments + (s + 1) % segments;
+            uint32_t d = r * segments + (s + 1) % segments;
+            mesh.indices.insert(mesh.indices.end(), {a, b, c, a, c, d});
+        }
+    }
+    return mesh;
+}
+
+// Shuffles whole triangles, the order of an exporter that doesn't care about the cache
+static void shuffleTriangles(std::vector<uint32_t>& indices, uint32_t seed) {
+    std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+    for(size_t t = 0; t < triangles.size(); t++) triangles[t] = {indices[3 * t], indices[3 * t + 1], indices[3 * t + 2]};
+
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(seed));
+
+    for(size_t t = 0; t < triangles.size(); t++) std::copy(triangles[t].begin(), triangles[t].end(), &indices[3 * t]);
+}
+
+// Triangles rotated to start at their smallest index, which keeps the winding, then sorted
+static std::vector<std::array<uint32_t, 3>> canonicalTriangles(const std::vector<uint32_t>& indices) {
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for(size_t i = 0; i + 2 < indices.size(); i += 3) {
+        std::array<uint32_t, 3> triangle = {indices[i], indices[i + 1], indices[i + 2]};
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+static void testAnalyzeVertexCache() {
+    // Two triangles sharing an edge: four distinct vertices, each transformed once
+    std::vector<uint32_t> quad = {0, 1, 2, 0, 2, 3};
+    VertexCacheStatistics statistics = analyzeVertexCache(quad.data(), static_cast<uint32_t>(quad.size()), 4);
+    CHECK(statistics.triangleCount == 2);
+    CHECK(statistics.vertexCount == 4);
+    CHECK(statistics.transformedCount == 4);
+    CHECK(statistics.acmr() == 2.0f);
+    CHECK(statistics.atvr() == 1.0f);
+
+    // A cache of 3 has evicted vertex 0 by the time the last triangle wants it again
+    std::vector<uint32_t> evicting = {0, 1, 2, 3, 4, 5, 0, 4, 5};
+    statistics = analyzeVertexCache(evicting.data(), static_cast<uint32_t>(evicting.size()), 6, 3);
+    CHECK(statistics.transformedCount == 7);
+}
+
+static void testOptimizeVertexCache() {
+    TestMesh mesh = makeTorusGrid(64, 48);
+    shuffleTriangles(mesh.indices, 1);
+    uint32_t indexCount = static_cast<uint32_t>(mesh.indices.size());
+
+    std::vector<uint32_t> optimized(indexCount);
+    optimizeVertexCache(mesh.indices.data(), indexCount, mesh.vertexCount, optimized.data());
+
+    CHECK(canonicalTriangles(optimized) == canonicalTriangles(mesh.indices));
+
+    VertexCacheStatistics before = analyzeVertexCache(mesh.indices.data(), indexCount, mesh.vertexCount);
+    VertexCacheStatistics after = analyzeVertexCache(optimized.data(), indexCount, mesh.vertexCount);
+    std::cout << "grid ACMR " << before.acmr() << " -> " << after.acmr() << ", ATVR " << before.atvr() << " -> " << after.atvr() << std::endl;
+
+    CHECK(after.vertexCount == before.vertexCount);
+    CHECK(after.acmr() < before.acmr());
+    CHECK(after.acmr() < 1.0f);
+    CHECK(after.atvr() < 1.5f);
+}
+
+static void testOptimizeOverdraw() {
+    TestMesh mesh = makeTorusGrid(64, 48);
+    shuffleTriangles(mesh.indices, 2);
+    uint32_t indexCount = static_cast<uint32_t>(mesh.indices.size());
+
+    std::vector<uint32_t> optimized(indexCount);
+    optimizeVertexCache(mesh.indices.data(), indexCount, mesh.vertexCount, optimized.data());
+    float cacheAcmr = analyzeVertexCache(optimized.data(), indexCount, mesh.vertexCount).acmr();
+
+    std::vector<uint32_t> sorted = optimized;
+    optimizeOverdraw(sorted.data(), indexCount, mesh.positions.data(), mesh.vertexCount, 1.05f);
+    float overdrawAcmr = analyzeVertexCache(sorted.data(), indexCount, mesh.vertexCount).acmr();
+    std::cout << "overdraw ACMR " << cacheAcmr << " -> " << overdrawAcmr << std::endl;
+
+    CHECK(canonicalTriangles(sorted) == canonicalTriangles(mesh.indices));
+    CHECK(sorted != optimized);
+    CHECK(overdrawAcmr <= cacheAcmr * 1.05f);
+}
+
+int main() {
+    testAnalyzeVertexCache();
+    testOptimizeVertexCache();
+    testOptimizeOverdraw();
+
+    if(failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}